@@ -14,13 +14,20 @@
 
 #include "client/crash_report_database.h"
 
+#include <string.h>
 #include <sys/stat.h>
 
+#include <tuple>
+#include <utility>
+
 #include "base/logging.h"
 #include "base/strings/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "util/file/directory_reader.h"
 #include "util/file/filesystem.h"
+#include "util/numeric/safe_assignment.h"
+#include "util/stream/output_stream_interface.h"
+#include "util/stream/zlib_output_stream.h"
 
 namespace crashpad {
 
@@ -28,6 +35,27 @@ namespace {
 constexpr base::FilePath::CharType kAttachmentsDirectory[] =
     FILE_PATH_LITERAL("attachments");
 
+// The upload parameters are stored in a file named for the report’s UUID with
+// this extension, in the root attachments directory. They aren’t stored in the
+// report’s own attachments directory, because older versions of Crashpad would
+// upload them as an attachment.
+constexpr base::FilePath::CharType kUploadParametersExtension[] =
+    FILE_PATH_LITERAL(".upload_parameters");
+
+// The upload parameters file begins with this header, which is followed by
+// `count` entries. Each entry is a pair of uint32_t sizes, for the key and the
+// value, followed by the key and the value themselves.
+struct UploadParametersHeader {
+  enum : uint32_t {
+    kMagic = 0x4d524150,  // 'PARM'
+    kVersion = 1,
+  };
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t count;
+};
+
 bool AttachmentNameIsOK(const std::string& name) {
   for (const char c : name) {
     if (c != '_' && c != '-' && c != '.' && !isalnum(c))
@@ -35,6 +63,61 @@ bool AttachmentNameIsOK(const std::string& name) {
   }
   return true;
 }
+
+base::FilePath::StringType NativeAttachmentName(const std::string& name) {
+#if BUILDFLAG(IS_WIN)
+  return base::UTF8ToWide(name);
+#else
+  return name;
+#endif
+}
+
+void AppendUint32(uint32_t value, std::string* data) {
+  data->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool ReadUint32(const std::string& data, size_t* offset, uint32_t* value) {
+  if (data.size() - *offset < sizeof(*value)) {
+    return false;
+  }
+  memcpy(value, &data[*offset], sizeof(*value));
+  *offset += sizeof(*value);
+  return true;
+}
+
+// Writes a stream’s output to a FileWriterInterface.
+class FileWriterOutputStream final : public OutputStreamInterface {
+ public:
+  explicit FileWriterOutputStream(FileWriterInterface* writer)
+      : writer_(writer) {}
+
+  FileWriterOutputStream(const FileWriterOutputStream&) = delete;
+  FileWriterOutputStream& operator=(const FileWriterOutputStream&) = delete;
+
+  ~FileWriterOutputStream() override {}
+
+  // OutputStreamInterface:
+  bool Write(const uint8_t* data, size_t size) override {
+    return writer_->Write(data, size);
+  }
+
+  bool Flush() override { return true; }
+
+ private:
+  FileWriterInterface* writer_;  // weak
+};
+
+bool ReadString(const std::string& data,
+                size_t* offset,
+                uint32_t size,
+                std::string* value) {
+  if (data.size() - *offset < size) {
+    return false;
+  }
+  value->assign(data, *offset, size);
+  *offset += size;
+  return true;
+}
 }  // namespace
 
 CrashReportDatabase::Report::Report()
@@ -46,17 +129,26 @@ CrashReportDatabase::Report::Report()
       last_upload_attempt_time(0),
       upload_attempts(0),
       upload_explicitly_requested(false),
-      total_size(0u) {}
+      total_size(0u),
+      compressed(false) {}
 
 CrashReportDatabase::NewReport::NewReport()
     : writer_(std::make_unique<FileWriter>()),
+      compressed_writer_(),
+      reader_(),
+      gzip_reader_(),
       file_remover_(),
       attachment_writers_(),
       attachment_removers_(),
       uuid_(),
-      database_() {}
+      database_(),
+      compressed_(false) {}
 
-CrashReportDatabase::NewReport::~NewReport() = default;
+CrashReportDatabase::NewReport::~NewReport() {
+  // A report that is abandoned while it is being written is removed, but the
+  // compressed stream must still be finished before it is destroyed.
+  std::ignore = FinishCompressedContent();
+}
 
 bool CrashReportDatabase::NewReport::Initialize(
     CrashReportDatabase* database,
@@ -83,13 +175,54 @@ bool CrashReportDatabase::NewReport::Initialize(
   return true;
 }
 
+void CrashReportDatabase::NewReport::SetCompressed(int level) {
+  compressed_writer_ = std::make_unique<OutputStreamFileWriter>(
+      std::make_unique<ZlibOutputStream>(
+          ZlibOutputStream::Mode::kCompress,
+          ZlibOutputStream::Format::kGzip,
+          level,
+          std::make_unique<FileWriterOutputStream>(writer_.get())));
+  compressed_ = true;
+}
+
+bool CrashReportDatabase::NewReport::FinishCompressedContent() {
+  if (!compressed_writer_) {
+    return true;
+  }
+  const bool success = compressed_writer_->Flush();
+  compressed_writer_.reset();
+  return success;
+}
+
+FileWriterInterface* CrashReportDatabase::NewReport::ContentWriter() {
+  if (compressed_) {
+    DCHECK(compressed_writer_);
+    return compressed_writer_.get();
+  }
+  return writer_.get();
+}
+
 FileReaderInterface* CrashReportDatabase::NewReport::Reader() {
+  if (!FinishCompressedContent()) {
+    return nullptr;
+  }
+
   auto reader = std::make_unique<FileReader>();
   if (!reader->Open(file_remover_.get())) {
     return nullptr;
   }
+  gzip_reader_.reset();
   reader_ = std::move(reader);
-  return reader_.get();
+  if (!compressed_) {
+    return reader_.get();
+  }
+
+  gzip_reader_ = std::make_unique<GzipFileReader>();
+  if (!gzip_reader_->Initialize(reader_.get())) {
+    gzip_reader_.reset();
+    return nullptr;
+  }
+  return gzip_reader_.get();
 }
 
 FileWriter* CrashReportDatabase::NewReport::AddAttachment(
@@ -103,12 +236,8 @@ FileWriter* CrashReportDatabase::NewReport::AddAttachment(
           report_attachments_dir, FilePermissions::kOwnerOnly, true)) {
     return nullptr;
   }
-#if BUILDFLAG(IS_WIN)
-  const std::wstring name_string = base::UTF8ToWide(name);
-#else
-  const std::string name_string = name;
-#endif
-  base::FilePath attachment_path = report_attachments_dir.Append(name_string);
+  base::FilePath attachment_path =
+      report_attachments_dir.Append(NativeAttachmentName(name));
   auto writer = std::make_unique<FileWriter>();
   if (!writer->Open(attachment_path,
                     FileWriteMode::kCreateOrFail,
@@ -120,6 +249,98 @@ FileWriter* CrashReportDatabase::NewReport::AddAttachment(
   return attachment_writers_.back().get();
 }
 
+bool CrashReportDatabase::NewReport::SetUploadParameters(
+    const std::map<std::string, std::string>& parameters) {
+  std::string data;
+  UploadParametersHeader header;
+  header.magic = UploadParametersHeader::kMagic;
+  header.version = UploadParametersHeader::kVersion;
+  if (!AssignIfInRange(&header.count, parameters.size())) {
+    LOG(ERROR) << "too many upload parameters";
+    return false;
+  }
+  data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  for (const auto& kv : parameters) {
+    uint32_t key_size;
+    uint32_t value_size;
+    if (!AssignIfInRange(&key_size, kv.first.size()) ||
+        !AssignIfInRange(&value_size, kv.second.size())) {
+      LOG(ERROR) << "upload parameter " << kv.first << " too large";
+      return false;
+    }
+    AppendUint32(key_size, &data);
+    AppendUint32(value_size, &data);
+    data.append(kv.first);
+    data.append(kv.second);
+  }
+
+  const base::FilePath path = database_->UploadParametersPath(uuid_);
+  FileWriter writer;
+  if (!writer.Open(
+          path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly)) {
+    return false;
+  }
+  ScopedRemoveFile remover(path);
+  if (!writer.Write(data.data(), data.size())) {
+    return false;
+  }
+  attachment_removers_.push_back(std::move(remover));
+  return true;
+}
+
+bool CrashReportDatabase::UploadReport::GetUploadParameters(
+    std::map<std::string, std::string>* parameters) const {
+  ScopedFileHandle handle(
+      OpenFileForRead(database_->UploadParametersPath(uuid)));
+  if (!handle.is_valid()) {
+    // Reports written before upload parameters were stored have none.
+    return false;
+  }
+
+  std::string data;
+  if (!LoggingReadToEOF(handle.get(), &data)) {
+    return false;
+  }
+
+  UploadParametersHeader header;
+  if (data.size() < sizeof(header)) {
+    LOG(ERROR) << "upload parameters size mismatch";
+    return false;
+  }
+  memcpy(&header, data.data(), sizeof(header));
+  if (header.magic != UploadParametersHeader::kMagic ||
+      header.version != UploadParametersHeader::kVersion) {
+    LOG(ERROR) << "upload parameters version mismatch";
+    return false;
+  }
+
+  std::map<std::string, std::string> local_parameters;
+  size_t offset = sizeof(header);
+  for (uint32_t index = 0; index < header.count; ++index) {
+    uint32_t key_size;
+    uint32_t value_size;
+    std::string key;
+    std::string value;
+    if (!ReadUint32(data, &offset, &key_size) ||
+        !ReadUint32(data, &offset, &value_size) ||
+        !ReadString(data, &offset, key_size, &key) ||
+        !ReadString(data, &offset, value_size, &value)) {
+      LOG(ERROR) << "upload parameters size mismatch";
+      return false;
+    }
+    local_parameters[key] = value;
+  }
+
+  if (offset != data.size()) {
+    LOG(ERROR) << "upload parameters size mismatch";
+    return false;
+  }
+
+  parameters->swap(local_parameters);
+  return true;
+}
+
 void CrashReportDatabase::UploadReport::InitializeAttachments() {
   base::FilePath report_attachments_dir = database_->AttachmentsPath(uuid);
   DirectoryReader dir_reader;
@@ -132,16 +353,16 @@ void CrashReportDatabase::UploadReport::InitializeAttachments() {
   while ((dir_result = dir_reader.NextFile(&filename)) ==
          DirectoryReader::Result::kSuccess) {
     const base::FilePath filepath(report_attachments_dir.Append(filename));
-    std::unique_ptr<FileReader> file_reader(std::make_unique<FileReader>());
-    if (!file_reader->Open(filepath)) {
-      continue;
-    }
-    attachment_readers_.emplace_back(std::move(file_reader));
 #if BUILDFLAG(IS_WIN)
     const std::string name_string = base::WideToUTF8(filename.value());
 #else
     const std::string name_string = filename.value();
 #endif
+    std::unique_ptr<FileReader> file_reader(std::make_unique<FileReader>());
+    if (!file_reader->Open(filepath)) {
+      continue;
+    }
+    attachment_readers_.emplace_back(std::move(file_reader));
     attachment_map_[name_string] = attachment_readers_.back().get();
   }
 }
@@ -190,7 +411,30 @@ base::FilePath CrashReportDatabase::AttachmentsRootPath() {
   return DatabasePath().Append(kAttachmentsDirectory);
 }
 
+base::FilePath CrashReportDatabase::UploadParametersPath(const UUID& uuid) {
+#if BUILDFLAG(IS_WIN)
+  const std::wstring uuid_string = uuid.ToWString();
+#else
+  const std::string uuid_string = uuid.ToString();
+#endif
+
+  return AttachmentsRootPath().Append(uuid_string + kUploadParametersExtension);
+}
+
+// static
+bool CrashReportDatabase::UUIDFromUploadParametersName(
+    const base::FilePath& filename,
+    UUID* uuid) {
+  return filename.FinalExtension() == kUploadParametersExtension &&
+         uuid->InitializeFromString(filename.RemoveFinalExtension().value());
+}
+
 void CrashReportDatabase::RemoveAttachmentsByUUID(const UUID& uuid) {
+  const base::FilePath upload_parameters_path = UploadParametersPath(uuid);
+  if (IsRegularFile(upload_parameters_path)) {
+    LoggingRemoveFile(upload_parameters_path);
+  }
+
   base::FilePath report_attachment_dir = AttachmentsPath(uuid);
   if (!IsDirectory(report_attachment_dir, /*allow_symlinks=*/false)) {
     return;
@@ -27,6 +27,8 @@
 #include "util/file/file_io.h"
 #include "util/file/file_reader.h"
 #include "util/file/file_writer.h"
+#include "util/file/gzip_file_reader.h"
+#include "util/file/output_stream_file_writer.h"
 #include "util/file/scoped_remove_file.h"
 #include "util/misc/metrics.h"
 #include "util/misc/uuid.h"
@@ -103,6 +105,11 @@ class CrashReportDatabase {
     //! The total size in bytes taken by the report, including any potential
     //! attachments.
     uint64_t total_size;
+
+    //! Whether the report file at #file_path is stored `gzip`-compressed. When
+    //! it is, the compressed data is a single `gzip` member as written by
+    //! ZlibOutputStream using ZlibOutputStream::Format::kGzip.
+    bool compressed;
   };
 
   //! \brief A crash report that is in the process of being written.
@@ -117,11 +124,33 @@ class CrashReportDatabase {
 
     ~NewReport();
 
-    //! \brief An open FileWriter with which to write the report.
+    //! \brief An open FileWriter with which to write the report file.
+    //!
+    //! If IsCompressed() returns `true`, the report’s content must be written
+    //! with ContentWriter() instead.
     FileWriter* Writer() const { return writer_.get(); }
 
-    //! \brief Returns a FileReaderInterface to the report, or `nullptr` with a
-    //!     message logged.
+    //! \brief Returns whether the report will be stored `gzip`-compressed.
+    //!
+    //! This is the case when the database was asked to compress new reports
+    //! by CrashReportDatabase::SetCompressNewReports(), and supports it.
+    bool IsCompressed() const { return compressed_; }
+
+    //! \brief A FileWriterInterface with which to write the report’s content.
+    //!
+    //! If IsCompressed() returns `true`, the content is compressed into the
+    //! report file as it is written. The returned writer can’t seek, so a
+    //! minidump must be written with MinidumpFileWriter::WriteMinidump() with
+    //! `allow_seek` set to `false`. Otherwise, this returns Writer().
+    //!
+    //! \note No content may be written after Reader() has been called.
+    FileWriterInterface* ContentWriter();
+
+    //! \brief Returns a FileReaderInterface to the report’s content, or
+    //!     `nullptr` with a message logged.
+    //!
+    //! If IsCompressed() returns `true`, the content is decompressed as it is
+    //! read.
     FileReaderInterface* Reader();
 
     //! A unique identifier by which this report will always be known to the
@@ -138,6 +167,21 @@ class CrashReportDatabase {
     //!     the attachment, or `nullptr` on failure with an error logged.
     FileWriter* AddAttachment(const std::string& name);
 
+    //! \brief Stores HTTP form parameters to be sent when the report is
+    //!     uploaded.
+    //!
+    //! This allows the parameters to be computed once, when the report is
+    //! written, instead of being recovered from the report on each upload
+    //! attempt. The stored parameters do not appear among the report’s
+    //! attachments. They are stored outside of the report’s attachments
+    //! directory, so older versions of Crashpad sharing the database don’t
+    //! upload them as an attachment either.
+    //!
+    //! \param[in] parameters The parameters to store.
+    //! \return `true` on success, `false` on failure with an error logged.
+    bool SetUploadParameters(
+        const std::map<std::string, std::string>& parameters);
+
    private:
     friend class CrashReportDatabaseGeneric;
     friend class CrashReportDatabaseMac;
@@ -147,13 +191,23 @@ class CrashReportDatabase {
                     const base::FilePath& directory,
                     const base::FilePath::StringType& extension);
 
+    // Arranges for content written through ContentWriter() to be compressed
+    // at level.
+    void SetCompressed(int level);
+
+    // Finishes writing compressed content. This may be called more than once.
+    bool FinishCompressedContent();
+
     std::unique_ptr<FileWriter> writer_;
+    std::unique_ptr<OutputStreamFileWriter> compressed_writer_;
     std::unique_ptr<FileReader> reader_;
+    std::unique_ptr<GzipFileReader> gzip_reader_;
     ScopedRemoveFile file_remover_;
     std::vector<std::unique_ptr<FileWriter>> attachment_writers_;
     std::vector<ScopedRemoveFile> attachment_removers_;
     UUID uuid_;
     CrashReportDatabase* database_;
+    bool compressed_;
   };
 
   //! \brief A crash report that is in the process of being uploaded.
@@ -177,6 +231,16 @@ class CrashReportDatabase {
       return attachment_map_;
     }
 
+    //! \brief Obtains the HTTP form parameters stored for the report by
+    //!     NewReport::SetUploadParameters().
+    //!
+    //! \param[out] parameters The stored parameters.
+    //! \return `true` on success. `false` if no parameters were stored for the
+    //!     report, or if they could not be read, in which case an error will
+    //!     be logged.
+    bool GetUploadParameters(
+        std::map<std::string, std::string>* parameters) const;
+
    private:
     friend class CrashReportDatabase;
     friend class CrashReportDatabaseGeneric;
@@ -426,6 +490,29 @@ class CrashReportDatabase {
   //! \return The number of reports cleaned.
   virtual int CleanDatabase(time_t lockfile_ttl) { return 0; }
 
+  //! \brief Sets whether reports passed to FinishedWritingCrashReport() are
+  //!     stored `gzip`-compressed.
+  //!
+  //! Compressed reports are identified by Report::compressed. Not all database
+  //! implementations support compression.
+  //!
+  //! \param[in] compress Whether to compress new reports.
+  //! \return `true` on success, or `false` if \a compress is `true` and this
+  //!     database does not support compression.
+  virtual bool SetCompressNewReports(bool compress) { return !compress; }
+
+  //! \brief Sets the compression level used for reports stored compressed
+  //!     after a call to SetCompressNewReports().
+  //!
+  //! Lower levels use less CPU time when a report is stored, at the expense of
+  //! more storage. Database implementations that don’t support compression
+  //! ignore this.
+  //!
+  //! \param[in] level The compression level, from `0` through
+  //!     kZlibBestCompressionLevel, or kZlibDefaultCompressionLevel, which is
+  //!     the default.
+  virtual void SetCompressionLevel(int level) {}
+
  protected:
   CrashReportDatabase() = default;
 
@@ -447,8 +534,31 @@ class CrashReportDatabase {
   //! \return The filepath to the report attachments directory.
   base::FilePath AttachmentsPath(const UUID& uuid);
 
+  //! \brief Build a filepath for the file that holds the upload parameters
+  //!     stored by NewReport::SetUploadParameters().
+  //!
+  //! The file is in AttachmentsRootPath(), beside the report’s attachments
+  //! directory.
+  //!
+  //! \param[in] uuid The unique identifier for the crash report record.
+  //!
+  //! \return The filepath to the report’s upload parameters file.
+  base::FilePath UploadParametersPath(const UUID& uuid);
+
+  //! \brief Determines whether a file in AttachmentsRootPath() holds upload
+  //!     parameters, and for which report.
+  //!
+  //! \param[in] filename The name of the file, without any directory.
+  //! \param[out] uuid The unique identifier for the crash report record that
+  //!     the file belongs to, if it holds upload parameters.
+  //!
+  //! \return `true` if \a filename names an upload parameters file.
+  static bool UUIDFromUploadParametersName(const base::FilePath& filename,
+                                           UUID* uuid);
+
   //! \brief Attempts to remove any attachments associated with the given
-  //!     report UUID. There may not be any, so failing is not an error.
+  //!     report UUID, and its upload parameters. There may not be any, so
+  //!     failing is not an error.
   //!
   //! \param[in] uuid The unique identifier for the crash report record.
   void RemoveAttachmentsByUUID(const UUID& uuid);
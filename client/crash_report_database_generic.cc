@@ -15,21 +15,29 @@
 #include "client/crash_report_database.h"
 
 #include <stdint.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <tuple>
 #include <utility>
 
 #include "base/check_op.h"
 #include "base/logging.h"
+#include "base/numerics/safe_conversions.h"
 #include "build/build_config.h"
 #include "client/settings.h"
 #include "util/file/directory_reader.h"
 #include "util/file/filesystem.h"
+#include "util/misc/clock.h"
+#include "util/misc/fnv1a.h"
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/misc/memory_sanitizer.h"
+#include "util/misc/zlib.h"
 
 namespace crashpad {
 
@@ -51,6 +59,11 @@ using OperationStatus = CrashReportDatabase::OperationStatus;
 
 constexpr base::FilePath::CharType kSettings[] =
     FILE_PATH_LITERAL("settings.dat");
+constexpr base::FilePath::CharType kIndex[] = FILE_PATH_LITERAL("index.dat");
+constexpr base::FilePath::CharType kIndexTemporary[] =
+    FILE_PATH_LITERAL("index.tmp");
+constexpr base::FilePath::CharType kIndexStale[] =
+    FILE_PATH_LITERAL("index.stale");
 
 constexpr base::FilePath::CharType kCrashReportExtension[] =
     FILE_PATH_LITERAL(".dmp");
@@ -77,6 +90,9 @@ enum {
 
   //! \brief Corresponds to upload_explicity_requested bit of the report state.
   kAttributeUploadExplicitlyRequested = 1 << 1,
+
+  //! \brief Corresponds to the compressed bit of the report state.
+  kAttributeCompressed = 1 << 2,
 };
 
 struct ReportMetadata {
@@ -89,6 +105,41 @@ struct ReportMetadata {
   uint8_t attributes = 0;
 };
 
+// A record in the report index. The index is a sequence of these records, each
+// followed by the report’s id. A later record for a UUID supersedes any earlier
+// ones.
+struct IndexRecord {
+  static constexpr uint32_t kMagic = 0x31584449;  // "IDX1"
+
+  uint32_t magic;
+
+  // The size of the record, including the id that follows it.
+  uint32_t size;
+
+  // The FNV-1a hash of the record with this field set to 0, and the id.
+  uint32_t checksum;
+
+  // The report’s state, or -1 if the report has been removed.
+  int32_t state;
+
+  UUID uuid;
+  int64_t creation_time;
+  int64_t last_upload_attempt_time;
+  uint64_t total_size;
+  int32_t upload_attempts;
+  uint32_t attributes;
+};
+static_assert(sizeof(IndexRecord) == 64, "IndexRecord must not have padding");
+
+// The number of times to try to acquire the index lock, and the delay between
+// attempts. The lock is only ever held briefly.
+constexpr int kIndexLockAttempts = 10;
+constexpr uint64_t kIndexLockRetryNanoseconds = 1E6;  // 1 millisecond
+
+// The index is compacted when it holds more than this many superseded records
+// in addition to one for each report.
+constexpr size_t kIndexCompactionSlack = 64;
+
 // A lock held while using database resources.
 class ScopedLockFile {
  public:
@@ -126,6 +177,33 @@ class ScopedLockFile {
     return true;
   }
 
+  // Like ResetAcquire(), but retries for a short time if the lock is held by
+  // another user, and doesn’t log an error when it gives up.
+  bool ResetAcquireWithRetry(const base::FilePath& report_path) {
+    lock_file_.reset();
+
+    base::FilePath lock_path(report_path.RemoveFinalExtension().value() +
+                             kLockExtension);
+    for (int attempt = 0; attempt < kIndexLockAttempts; ++attempt) {
+      if (attempt > 0) {
+        SleepNanoseconds(kIndexLockRetryNanoseconds);
+      }
+
+      ScopedFileHandle lock_fd(OpenFileForWrite(lock_path,
+                                                FileWriteMode::kCreateOrFail,
+                                                FilePermissions::kOwnerOnly));
+      if (!lock_fd.is_valid()) {
+        continue;
+      }
+      lock_file_.reset(lock_path);
+
+      time_t timestamp = time(nullptr);
+      return LoggingWriteFile(lock_fd.get(), &timestamp, sizeof(timestamp));
+    }
+
+    return false;
+  }
+
   // Returns `true` if the lock is held.
   bool is_valid() const { return lock_file_.is_valid(); }
 
@@ -188,6 +266,8 @@ class CrashReportDatabaseGeneric : public CrashReportDatabase {
   OperationStatus DeleteReport(const UUID& uuid) override;
   OperationStatus RequestUpload(const UUID& uuid) override;
   int CleanDatabase(time_t lockfile_ttl) override;
+  bool SetCompressNewReports(bool compress) override;
+  void SetCompressionLevel(int level) override;
   base::FilePath DatabasePath() override;
 
  private:
@@ -211,6 +291,14 @@ class CrashReportDatabaseGeneric : public CrashReportDatabase {
     kSearchable,
   };
 
+  // A report as recorded in the index. A report that has been removed has the
+  // state kUninitialized.
+  struct IndexEntry {
+    Report report;
+    ReportState state;
+  };
+  using IndexEntries = std::map<UUID, IndexEntry>;
+
   // CrashReportDatabase:
   OperationStatus RecordUploadAttempt(UploadReport* report,
                                       bool successful,
@@ -238,9 +326,35 @@ class CrashReportDatabaseGeneric : public CrashReportDatabase {
                                  Report* report);
 
   // Reads metadata for all reports in state and returns it in reports.
+  // Metadata is taken from the index for reports that it knows about, and read
+  // from each report’s metadata file otherwise.
   OperationStatus ReportsInState(ReportState state,
                                  std::vector<Report>* reports);
 
+  // Reads the index, returning the latest entry for each report that hasn’t
+  // been removed in entries. Returns `false` if the index is in use. A missing
+  // or corrupt index is treated as empty, and is rebuilt as reports are read
+  // and recorded by ReportsInState().
+  bool ReadIndex(IndexEntries* entries);
+
+  // Appends records for entries to the index. If the index can’t be updated,
+  // it is removed so that stale records won’t be used.
+  void AppendToIndex(const std::vector<IndexEntry>& entries);
+  void AppendToIndex(const Report& report, ReportState state);
+
+  // Replaces the index with one containing only entries. The index lock must
+  // be held.
+  bool RewriteIndex(const IndexEntries& entries);
+
+  // Serializes entry as an index record, appending it to index.
+  static void SerializeIndexEntry(const IndexEntry& entry, std::string* index);
+
+  // Parses index into entries, and returns the number of records that it held
+  // in record_count. Returns `false` if the index is corrupt.
+  static bool ParseIndex(const std::string& index,
+                         IndexEntries* entries,
+                         size_t* record_count);
+
   // Cleans lone metadata, reports, or expired locks in a particular state.
   int CleanReportsInState(ReportState state, time_t lockfile_ttl);
 
@@ -254,7 +368,7 @@ class CrashReportDatabaseGeneric : public CrashReportDatabase {
   bool CleaningReadMetadata(const base::FilePath& path, Report* report);
 
   // Writes metadata for a new report to the filesystem at path.
-  static bool WriteNewMetadata(const base::FilePath& path);
+  static bool WriteNewMetadata(const base::FilePath& path, bool compressed);
 
   // Writes the metadata for report to the filesystem at path.
   static bool WriteMetadata(const base::FilePath& path, const Report& report);
@@ -267,12 +381,17 @@ class CrashReportDatabaseGeneric : public CrashReportDatabase {
   const base::FilePath base_dir_;
   Settings settings_;
   std::once_flag settings_init_;
+  bool compress_new_reports_;
+  int compression_level_;
   InitializationStateDcheck initialized_;
 };
 
 CrashReportDatabaseGeneric::CrashReportDatabaseGeneric(
     const base::FilePath& path)
-    : base_dir_(path), settings_(path.Append(kSettings)) {}
+    : base_dir_(path),
+      settings_(path.Append(kSettings)),
+      compress_new_reports_(false),
+      compression_level_(kZlibDefaultCompressionLevel) {}
 
 CrashReportDatabaseGeneric::~CrashReportDatabaseGeneric() = default;
 
@@ -305,6 +424,18 @@ base::FilePath CrashReportDatabaseGeneric::DatabasePath() {
   return base_dir_;
 }
 
+bool CrashReportDatabaseGeneric::SetCompressNewReports(bool compress) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  compress_new_reports_ = compress;
+  return true;
+}
+
+void CrashReportDatabaseGeneric::SetCompressionLevel(int level) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK(ZlibIsValidCompressionLevel(level)) << level;
+  compression_level_ = level;
+}
+
 Settings* CrashReportDatabaseGeneric::GetSettings() {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return &SettingsInternal();
@@ -319,6 +450,9 @@ OperationStatus CrashReportDatabaseGeneric::PrepareNewCrashReport(
           this, base_dir_.Append(kNewDirectory), kCrashReportExtension)) {
     return kFileSystemError;
   }
+  if (compress_new_reports_) {
+    new_report->SetCompressed(compression_level_);
+  }
 
   report->reset(new_report.release());
   return kNoError;
@@ -335,13 +469,23 @@ OperationStatus CrashReportDatabaseGeneric::FinishedWritingCrashReport(
     return kBusyError;
   }
 
-  if (!WriteNewMetadata(ReplaceFinalExtension(path, kMetadataExtension))) {
-    return kDatabaseError;
+  if (!report->FinishCompressedContent()) {
+    return kFileSystemError;
   }
 
   FileOffset size = report->Writer()->Seek(0, SEEK_END);
 
   report->Writer()->Close();
+
+  // Compressing no content produces no data, so an empty report is stored as
+  // it is.
+  const bool compressed = report->IsCompressed() && size > 0;
+
+  if (!WriteNewMetadata(ReplaceFinalExtension(path, kMetadataExtension),
+                        compressed)) {
+    return kDatabaseError;
+  }
+
   if (!MoveFileOrDirectory(report->file_remover_.get(), path)) {
     return kFileSystemError;
   }
@@ -356,6 +500,11 @@ OperationStatus CrashReportDatabaseGeneric::FinishedWritingCrashReport(
     std::ignore = remover.release();
   }
 
+  Report new_report;
+  if (ReadMetadata(path, &new_report)) {
+    AppendToIndex(new_report, kPending);
+  }
+
   *uuid = report->ReportID();
 
   Metrics::CrashReportPending(Metrics::PendingReportReason::kNewlyCreated);
@@ -439,6 +588,7 @@ OperationStatus CrashReportDatabaseGeneric::SkipReportUpload(
   if (!MoveFileOrDirectory(path, completed_path)) {
     return kFileSystemError;
   }
+  AppendToIndex(report, kCompleted);
 
   if (!LoggingRemoveFile(ReplaceFinalExtension(path, kMetadataExtension))) {
     return kDatabaseError;
@@ -462,6 +612,10 @@ OperationStatus CrashReportDatabaseGeneric::DeleteReport(const UUID& uuid) {
     return kFileSystemError;
   }
 
+  Report removed_report;
+  removed_report.uuid = uuid;
+  AppendToIndex(removed_report, kUninitialized);
+
   if (!LoggingRemoveFile(ReplaceFinalExtension(path, kMetadataExtension))) {
     return kDatabaseError;
   }
@@ -496,6 +650,7 @@ OperationStatus CrashReportDatabaseGeneric::RequestUpload(const UUID& uuid) {
   if (!WriteMetadata(pending_path, report)) {
     return kDatabaseError;
   }
+  AppendToIndex(report, kPending);
 
   if (pending_path != path) {
     if (!LoggingRemoveFile(ReplaceFinalExtension(path, kMetadataExtension))) {
@@ -534,6 +689,19 @@ int CrashReportDatabaseGeneric::CleanDatabase(time_t lockfile_ttl) {
   removed += CleanReportsInState(kPending, lockfile_ttl);
   removed += CleanReportsInState(kCompleted, lockfile_ttl);
   CleanOrphanedAttachments();
+
+  // An expired index lock was left by a process that died while holding it,
+  // possibly while writing to the index, so remove the index along with it.
+  const base::FilePath index_lock_path(
+      ReplaceFinalExtension(base_dir_.Append(kIndex), kLockExtension));
+  if (IsRegularFile(index_lock_path) &&
+      ScopedLockFile::IsExpired(index_lock_path, lockfile_ttl)) {
+    const base::FilePath index_path(base_dir_.Append(kIndex));
+    if ((!IsRegularFile(index_path) || LoggingRemoveFile(index_path)) &&
+        LoggingRemoveFile(index_lock_path)) {
+      ++removed;
+    }
+  }
 #if !CRASHPAD_FLOCK_ALWAYS_SUPPORTED
   base::FilePath settings_path(kSettings);
   if (Settings::IsLockExpired(settings_path, lockfile_ttl)) {
@@ -587,6 +755,7 @@ OperationStatus CrashReportDatabaseGeneric::RecordUploadAttempt(
   if (!WriteMetadata(report_path, *report)) {
     return kDatabaseError;
   }
+  AppendToIndex(*report, successful ? kCompleted : kPending);
 
   if (!SettingsInternal().SetLastUploadAttemptTime(now)) {
     return kDatabaseError;
@@ -680,18 +849,47 @@ OperationStatus CrashReportDatabaseGeneric::ReportsInState(
     return kDatabaseError;
   }
 
+  // Reports are identified by their report files. Reports with lock files are
+  // in use, and are skipped.
+  std::vector<base::FilePath> report_files;
+  std::set<UUID> locked;
   base::FilePath filename;
   DirectoryReader::Result result;
   while ((result = reader.NextFile(&filename)) ==
          DirectoryReader::Result::kSuccess) {
     const base::FilePath::StringType extension(filename.FinalExtension());
-    if (extension.compare(kCrashReportExtension) != 0) {
-      continue;
+    if (extension.compare(kCrashReportExtension) == 0) {
+      report_files.push_back(dir_path.Append(filename));
+    } else if (extension.compare(kLockExtension) == 0) {
+      locked.insert(UUIDFromReportPath(filename));
     }
+  }
 
-    const base::FilePath filepath(dir_path.Append(filename));
-    ScopedLockFile lock_file;
-    if (!lock_file.ResetAcquire(filepath)) {
+  IndexEntries index;
+  const bool use_index = ReadIndex(&index);
+
+  // Reports missing from the index are read from their metadata files and then
+  // recorded in the index. Their locks are held until the index is updated, so
+  // that the records can’t supersede newer ones.
+  std::vector<IndexEntry> index_updates;
+  std::vector<std::unique_ptr<ScopedLockFile>> index_update_locks;
+
+  for (const base::FilePath& filepath : report_files) {
+    const UUID uuid = UUIDFromReportPath(filepath);
+    if (use_index) {
+      auto it = index.find(uuid);
+      if (it != index.end() && it->second.state == state) {
+        if (locked.find(uuid) == locked.end()) {
+          reports->push_back(it->second.report);
+          reports->back().file_path = filepath;
+        }
+        index.erase(it);
+        continue;
+      }
+    }
+
+    auto lock_file = std::make_unique<ScopedLockFile>();
+    if (!lock_file->ResetAcquire(filepath)) {
       continue;
     }
 
@@ -701,10 +899,225 @@ OperationStatus CrashReportDatabaseGeneric::ReportsInState(
     }
     reports->push_back(report);
     reports->back().file_path = filepath;
+
+    if (use_index) {
+      index_updates.push_back({report, state});
+      index_update_locks.push_back(std::move(lock_file));
+    }
+  }
+
+  if (use_index) {
+    // Any remaining reports that the index places in this state are no longer
+    // present.
+    for (const auto& [uuid, entry] : index) {
+      if (entry.state == state) {
+        IndexEntry removed_entry = {Report(), kUninitialized};
+        removed_entry.report.uuid = uuid;
+        index_updates.push_back(removed_entry);
+      }
+    }
+
+    if (!index_updates.empty()) {
+      AppendToIndex(index_updates);
+    }
   }
+
   return kNoError;
 }
 
+bool CrashReportDatabaseGeneric::ReadIndex(IndexEntries* entries) {
+  DCHECK(entries->empty());
+
+  ScopedLockFile lock_file;
+  const base::FilePath index_path(base_dir_.Append(kIndex));
+  if (!lock_file.ResetAcquireWithRetry(index_path)) {
+    return false;
+  }
+
+  // An update couldn’t be recorded while another user held the lock. Remove
+  // the marker before the index, so that a marker left by a concurrent failed
+  // update isn’t lost.
+  const base::FilePath stale_path(base_dir_.Append(kIndexStale));
+  if (IsRegularFile(stale_path)) {
+    LOG(WARNING) << "stale index, rebuilding";
+    return LoggingRemoveFile(stale_path) &&
+           (!IsRegularFile(index_path) || LoggingRemoveFile(index_path));
+  }
+
+  ScopedFileHandle handle(OpenFileForRead(index_path));
+  if (!handle.is_valid()) {
+    return true;
+  }
+
+  std::string contents;
+  if (!LoggingReadToEOF(handle.get(), &contents)) {
+    return false;
+  }
+  handle.reset();
+
+  size_t record_count;
+  if (!ParseIndex(contents, entries, &record_count)) {
+    LOG(WARNING) << "corrupt index, rebuilding";
+    entries->clear();
+    return LoggingRemoveFile(index_path);
+  }
+
+  if (record_count > entries->size() * 2 + kIndexCompactionSlack) {
+    RewriteIndex(*entries);
+  }
+
+  return true;
+}
+
+void CrashReportDatabaseGeneric::AppendToIndex(
+    const std::vector<IndexEntry>& entries) {
+  std::string records;
+  for (const IndexEntry& entry : entries) {
+    SerializeIndexEntry(entry, &records);
+  }
+
+  const base::FilePath index_path(base_dir_.Append(kIndex));
+  ScopedLockFile lock_file;
+  if (!lock_file.ResetAcquireWithRetry(index_path)) {
+    // The index can only be changed while holding the lock, so mark it stale
+    // instead. The next reader to hold the lock will rebuild it.
+    LOG(WARNING) << "couldn't lock index, marking stale";
+    ScopedFileHandle stale_handle(
+        LoggingOpenFileForWrite(base_dir_.Append(kIndexStale),
+                                FileWriteMode::kReuseOrCreate,
+                                FilePermissions::kOwnerOnly));
+    return;
+  }
+
+  ScopedFileHandle handle(
+      LoggingOpenFileForWrite(index_path,
+                              FileWriteMode::kReuseOrCreate,
+                              FilePermissions::kOwnerOnly));
+  if (handle.is_valid() && LoggingSeekFile(handle.get(), 0, SEEK_END) >= 0 &&
+      LoggingWriteFile(handle.get(), records.data(), records.size())) {
+    return;
+  }
+
+  LOG(WARNING) << "couldn't update index, removing";
+  handle.reset();
+  if (IsRegularFile(index_path)) {
+    LoggingRemoveFile(index_path);
+  }
+}
+
+void CrashReportDatabaseGeneric::AppendToIndex(const Report& report,
+                                               ReportState state) {
+  AppendToIndex(std::vector<IndexEntry>{{report, state}});
+}
+
+bool CrashReportDatabaseGeneric::RewriteIndex(const IndexEntries& entries) {
+  std::string records;
+  for (const auto& [uuid, entry] : entries) {
+    SerializeIndexEntry(entry, &records);
+  }
+
+  const base::FilePath temporary_path(base_dir_.Append(kIndexTemporary));
+  ScopedFileHandle handle(
+      LoggingOpenFileForWrite(temporary_path,
+                              FileWriteMode::kTruncateOrCreate,
+                              FilePermissions::kOwnerOnly));
+  if (!handle.is_valid()) {
+    return false;
+  }
+  ScopedRemoveFile temporary_remover(temporary_path);
+
+  if (!LoggingWriteFile(handle.get(), records.data(), records.size())) {
+    return false;
+  }
+  handle.reset();
+
+  if (!MoveFileOrDirectory(temporary_path, base_dir_.Append(kIndex))) {
+    return false;
+  }
+  std::ignore = temporary_remover.release();
+  return true;
+}
+
+// static
+void CrashReportDatabaseGeneric::SerializeIndexEntry(const IndexEntry& entry,
+                                                     std::string* index) {
+  const Report& report = entry.report;
+
+  IndexRecord record = {};
+  record.magic = IndexRecord::kMagic;
+  record.size = base::checked_cast<uint32_t>(sizeof(record) + report.id.size());
+  record.state = entry.state;
+  record.uuid = report.uuid;
+  record.creation_time = report.creation_time;
+  record.last_upload_attempt_time = report.last_upload_attempt_time;
+  record.total_size = report.total_size;
+  record.upload_attempts = report.upload_attempts;
+  record.attributes =
+      (report.uploaded ? kAttributeUploaded : 0) |
+      (report.upload_explicitly_requested ? kAttributeUploadExplicitlyRequested
+                                          : 0) |
+      (report.compressed ? kAttributeCompressed : 0);
+  record.checksum = FNV1a(
+      report.id.data(), report.id.size(), FNV1a(&record, sizeof(record)));
+
+  index->append(reinterpret_cast<const char*>(&record), sizeof(record));
+  index->append(report.id);
+}
+
+// static
+bool CrashReportDatabaseGeneric::ParseIndex(const std::string& index,
+                                            IndexEntries* entries,
+                                            size_t* record_count) {
+  *record_count = 0;
+  size_t offset = 0;
+  while (offset < index.size()) {
+    IndexRecord record;
+    if (index.size() - offset < sizeof(record)) {
+      return false;
+    }
+    memcpy(&record, &index[offset], sizeof(record));
+    if (record.magic != IndexRecord::kMagic || record.size < sizeof(record) ||
+        record.size > index.size() - offset) {
+      return false;
+    }
+
+    const char* id = &index[offset + sizeof(record)];
+    const size_t id_size = record.size - sizeof(record);
+    const uint32_t checksum = record.checksum;
+    record.checksum = 0;
+    if (FNV1a(id, id_size, FNV1a(&record, sizeof(record))) != checksum) {
+      return false;
+    }
+    offset += record.size;
+    ++*record_count;
+
+    if (record.state == kUninitialized) {
+      entries->erase(record.uuid);
+      continue;
+    }
+    if (record.state != kPending && record.state != kCompleted) {
+      return false;
+    }
+
+    IndexEntry& entry = (*entries)[record.uuid];
+    entry.state = static_cast<ReportState>(record.state);
+    Report& report = entry.report;
+    report = Report();
+    report.uuid = record.uuid;
+    report.id.assign(id, id_size);
+    report.creation_time = record.creation_time;
+    report.last_upload_attempt_time = record.last_upload_attempt_time;
+    report.total_size = record.total_size;
+    report.upload_attempts = record.upload_attempts;
+    report.uploaded = (record.attributes & kAttributeUploaded) != 0;
+    report.upload_explicitly_requested =
+        (record.attributes & kAttributeUploadExplicitlyRequested) != 0;
+    report.compressed = (record.attributes & kAttributeCompressed) != 0;
+  }
+
+  return true;
+}
+
 int CrashReportDatabaseGeneric::CleanReportsInState(ReportState state,
                                                     time_t lockfile_ttl) {
   const base::FilePath dir_path(base_dir_.Append(kReportDirectories[state]));
@@ -782,33 +1195,35 @@ void CrashReportDatabaseGeneric::CleanOrphanedAttachments() {
          DirectoryReader::Result::kSuccess) {
     const base::FilePath report_attachment_dir(
         root_attachments_dir.Append(filename));
+    UUID uuid;
     if (IsDirectory(report_attachment_dir, false)) {
-      UUID uuid;
       if (!uuid.InitializeFromString(filename.value())) {
         LOG(ERROR) << "unexpected attachment dir name " << filename.value();
         continue;
       }
+    } else if (!UUIDFromUploadParametersName(filename, &uuid)) {
+      continue;
+    }
 
-      // Check to see if the report is being created in "new".
-      base::FilePath new_dir_path =
-          base_dir_.Append(kNewDirectory)
-              .Append(uuid.ToString() + kCrashReportExtension);
-      if (IsRegularFile(new_dir_path)) {
-        continue;
-      }
-
-      // Check to see if the report is in "pending" or "completed".
-      ScopedLockFile local_lock;
-      base::FilePath local_path;
-      OperationStatus os =
-          LocateAndLockReport(uuid, kSearchable, &local_path, &local_lock);
-      if (os != kReportNotFound) {
-        continue;
-      }
+    // Check to see if the report is being created in "new".
+    base::FilePath new_dir_path =
+        base_dir_.Append(kNewDirectory)
+            .Append(uuid.ToString() + kCrashReportExtension);
+    if (IsRegularFile(new_dir_path)) {
+      continue;
+    }
 
-      // Couldn't find a report, assume these attachments are orphaned.
-      RemoveAttachmentsByUUID(uuid);
+    // Check to see if the report is in "pending" or "completed".
+    ScopedLockFile local_lock;
+    base::FilePath local_path;
+    OperationStatus os =
+        LocateAndLockReport(uuid, kSearchable, &local_path, &local_lock);
+    if (os != kReportNotFound) {
+      continue;
     }
+
+    // Couldn't find a report, assume these attachments are orphaned.
+    RemoveAttachmentsByUUID(uuid);
   }
 }
 
@@ -847,6 +1262,7 @@ bool CrashReportDatabaseGeneric::ReadMetadata(const base::FilePath& path,
   // potential attachments.
   uint64_t total_size = GetFileSize(path);
   total_size += GetDirectorySize(AttachmentsPath(uuid));
+  total_size += GetFileSize(UploadParametersPath(uuid));
 
   report->uuid = uuid;
   report->upload_attempts = metadata.upload_attempts;
@@ -855,6 +1271,7 @@ bool CrashReportDatabaseGeneric::ReadMetadata(const base::FilePath& path,
   report->uploaded = (metadata.attributes & kAttributeUploaded) != 0;
   report->upload_explicitly_requested =
       (metadata.attributes & kAttributeUploadExplicitlyRequested) != 0;
+  report->compressed = (metadata.attributes & kAttributeCompressed) != 0;
   report->file_path = path;
   report->total_size = total_size;
   return true;
@@ -874,7 +1291,8 @@ bool CrashReportDatabaseGeneric::CleaningReadMetadata(
 }
 
 // static
-bool CrashReportDatabaseGeneric::WriteNewMetadata(const base::FilePath& path) {
+bool CrashReportDatabaseGeneric::WriteNewMetadata(const base::FilePath& path,
+                                                  bool compressed) {
   const base::FilePath metadata_path(
       ReplaceFinalExtension(path, kMetadataExtension));
 
@@ -892,6 +1310,7 @@ bool CrashReportDatabaseGeneric::WriteNewMetadata(const base::FilePath& path) {
 #endif  // defined(MEMORY_SANITIZER)
   metadata = {};
   metadata.creation_time = time(nullptr);
+  metadata.attributes = compressed ? kAttributeCompressed : 0;
 
   return LoggingWriteFile(handle.get(), &metadata, sizeof(metadata));
 }
@@ -922,7 +1341,8 @@ bool CrashReportDatabaseGeneric::WriteMetadata(const base::FilePath& path,
   metadata.attributes =
       (report.uploaded ? kAttributeUploaded : 0) |
       (report.upload_explicitly_requested ? kAttributeUploadExplicitlyRequested
-                                          : 0);
+                                          : 0) |
+      (report.compressed ? kAttributeCompressed : 0);
 
   return LoggingWriteFile(handle.get(), &metadata, sizeof(metadata)) &&
          LoggingWriteFile(handle.get(), report.id.c_str(), report.id.size());
@@ -803,6 +803,7 @@ bool CrashReportDatabaseMac::ReadReportMetadataLocked(
   // potential attachments.
   uint64_t total_size = GetFileSize(path);
   total_size += GetDirectorySize(AttachmentsPath(report->uuid));
+  total_size += GetFileSize(UploadParametersPath(report->uuid));
   report->total_size = total_size;
 
   return true;
@@ -883,31 +884,33 @@ void CrashReportDatabaseMac::CleanOrphanedAttachments() {
          DirectoryReader::Result::kSuccess) {
     const base::FilePath report_attachment_dir(
         root_attachments_dir.Append(filename));
+    UUID uuid;
     if (IsDirectory(report_attachment_dir, false)) {
-      UUID uuid;
       if (!uuid.InitializeFromString(filename.value())) {
         LOG(ERROR) << "unexpected attachment dir name " << filename.value();
         continue;
       }
+    } else if (!UUIDFromUploadParametersName(filename, &uuid)) {
+      continue;
+    }
 
-      // Check to see if the report is being created in "new".
-      base::FilePath new_dir_path =
-          base_dir_.Append(kWriteDirectory)
-              .Append(uuid.ToString() + "." + kCrashReportFileExtension);
-      if (IsRegularFile(new_dir_path)) {
-        continue;
-      }
-
-      // Check to see if the report is in "pending" or "completed".
-      base::FilePath local_path =
-          LocateCrashReport(uuid, kReportStatePending | kReportStateCompleted);
-      if (!local_path.empty()) {
-        continue;
-      }
+    // Check to see if the report is being created in "new".
+    base::FilePath new_dir_path =
+        base_dir_.Append(kWriteDirectory)
+            .Append(uuid.ToString() + "." + kCrashReportFileExtension);
+    if (IsRegularFile(new_dir_path)) {
+      continue;
+    }
 
-      // Couldn't find a report, assume these attachments are orphaned.
-      RemoveAttachmentsByUUID(uuid);
+    // Check to see if the report is in "pending" or "completed".
+    base::FilePath local_path =
+        LocateCrashReport(uuid, kReportStatePending | kReportStateCompleted);
+    if (!local_path.empty()) {
+      continue;
     }
+
+    // Couldn't find a report, assume these attachments are orphaned.
+    RemoveAttachmentsByUUID(uuid);
   }
 }
 
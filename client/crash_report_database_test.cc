@@ -14,6 +14,7 @@
 
 #include "client/crash_report_database.h"
 
+#include "base/numerics/safe_conversions.h"
 #include "build/build_config.h"
 #include "client/settings.h"
 #include "gtest/gtest.h"
@@ -23,6 +24,8 @@
 #include "test/scoped_temp_dir.h"
 #include "util/file/file_io.h"
 #include "util/file/filesystem.h"
+#include "util/file/gzip_file_reader.h"
+#include "util/misc/zlib.h"
 
 #if BUILDFLAG(IS_IOS)
 #include "util/mac/xattr.h"
@@ -794,6 +797,70 @@ TEST_F(CrashReportDatabaseTest, Attachments) {
   EXPECT_EQ(memcmp(test_data, result_buffer, sizeof(test_data)), 0);
 }
 
+TEST_F(CrashReportDatabaseTest, UploadParameters) {
+  const std::map<std::string, std::string> parameters = {
+      {"guid", "00112233-4455-6677-8899-aabbccddeeff"},
+      {"empty", ""},
+      {"list_annotations", "one\ntwo"},
+      {std::string("nul\0key", 7), std::string("nul\0value", 9)},
+  };
+
+  std::unique_ptr<CrashReportDatabase::NewReport> new_report;
+  ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
+            CrashReportDatabase::kNoError);
+  FileWriter* attachment = new_report->AddAttachment("some_file");
+  ASSERT_NE(attachment, nullptr);
+  ASSERT_TRUE(new_report->SetUploadParameters(parameters));
+
+  UUID uuid;
+  ASSERT_EQ(db()->FinishedWritingCrashReport(std::move(new_report), &uuid),
+            CrashReportDatabase::kNoError);
+
+  // A report without stored upload parameters.
+  CrashReportDatabase::Report legacy_report;
+  CreateCrashReport(&legacy_report);
+
+  std::unique_ptr<const CrashReportDatabase::UploadReport> upload_report;
+  ASSERT_EQ(db()->GetReportForUploading(uuid, &upload_report),
+            CrashReportDatabase::kNoError);
+
+  std::map<std::string, std::string> result_parameters;
+  ASSERT_TRUE(upload_report->GetUploadParameters(&result_parameters));
+  EXPECT_EQ(result_parameters, parameters);
+
+  // The upload parameters aren’t presented as an attachment.
+  std::map<std::string, FileReader*> result_attachments =
+      upload_report->GetAttachments();
+  EXPECT_EQ(result_attachments.size(), 1u);
+  EXPECT_NE(result_attachments.find("some_file"), result_attachments.end());
+
+  std::unique_ptr<const CrashReportDatabase::UploadReport> legacy_upload_report;
+  ASSERT_EQ(
+      db()->GetReportForUploading(legacy_report.uuid, &legacy_upload_report),
+      CrashReportDatabase::kNoError);
+  result_parameters.clear();
+  EXPECT_FALSE(legacy_upload_report->GetUploadParameters(&result_parameters));
+  EXPECT_TRUE(result_parameters.empty());
+
+  // The upload parameters are stored beside the report’s attachments
+  // directory, not in it, so older versions of Crashpad don’t upload them as an
+  // attachment. They are removed with the report.
+#if BUILDFLAG(IS_WIN)
+  const std::wstring uuid_string = uuid.ToWString();
+#else
+  const std::string uuid_string = uuid.ToString();
+#endif
+  const base::FilePath attachments_dir(
+      path().Append(FILE_PATH_LITERAL("attachments")));
+  const base::FilePath upload_parameters_path(attachments_dir.Append(
+      uuid_string + FILE_PATH_LITERAL(".upload_parameters")));
+  EXPECT_TRUE(FileExists(upload_parameters_path));
+
+  upload_report.reset();
+  EXPECT_EQ(db()->DeleteReport(uuid), CrashReportDatabase::kNoError);
+  EXPECT_FALSE(FileExists(upload_parameters_path));
+}
+
 TEST_F(CrashReportDatabaseTest, OrphanedAttachments) {
   std::unique_ptr<CrashReportDatabase::NewReport> new_report;
   ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
@@ -803,6 +870,7 @@ TEST_F(CrashReportDatabaseTest, OrphanedAttachments) {
   ASSERT_NE(file1, nullptr);
   FileWriter* file2 = new_report->AddAttachment("file2");
   ASSERT_NE(file2, nullptr);
+  ASSERT_TRUE(new_report->SetUploadParameters({{"key", "value"}}));
 
   UUID expect_uuid = new_report->ReportID();
   UUID uuid;
@@ -821,6 +889,10 @@ TEST_F(CrashReportDatabaseTest, OrphanedAttachments) {
       report_attachments_dir.Append(FILE_PATH_LITERAL("file1")));
   const base::FilePath file_path2(
       report_attachments_dir.Append(FILE_PATH_LITERAL("file2")));
+  const base::FilePath upload_parameters_path(
+      path()
+          .Append(FILE_PATH_LITERAL("attachments"))
+          .Append(uuid_string + FILE_PATH_LITERAL(".upload_parameters")));
 
   CrashReportDatabase::Report report;
   ASSERT_EQ(db()->LookUpCrashReport(uuid, &report),
@@ -859,6 +931,48 @@ TEST_F(CrashReportDatabaseTest, OrphanedAttachments) {
   EXPECT_FALSE(FileExists(file_path1));
   EXPECT_FALSE(FileExists(file_path2));
   EXPECT_FALSE(FileExists(report_attachments_dir));
+  EXPECT_FALSE(FileExists(upload_parameters_path));
+}
+
+TEST_F(CrashReportDatabaseTest, OrphanedUploadParameters) {
+  std::unique_ptr<CrashReportDatabase::NewReport> new_report;
+  ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
+            CrashReportDatabase::kNoError);
+  ASSERT_TRUE(new_report->SetUploadParameters({{"key", "value"}}));
+
+  UUID uuid;
+  ASSERT_EQ(db()->FinishedWritingCrashReport(std::move(new_report), &uuid),
+            CrashReportDatabase::kNoError);
+
+#if BUILDFLAG(IS_WIN)
+  const std::wstring uuid_string = uuid.ToWString();
+#else
+  const std::string uuid_string = uuid.ToString();
+#endif
+  const base::FilePath upload_parameters_path(
+      path()
+          .Append(FILE_PATH_LITERAL("attachments"))
+          .Append(uuid_string + FILE_PATH_LITERAL(".upload_parameters")));
+
+  CrashReportDatabase::Report report;
+  ASSERT_EQ(db()->LookUpCrashReport(uuid, &report),
+            CrashReportDatabase::kNoError);
+
+  EXPECT_EQ(db()->CleanDatabase(0), 0);
+  EXPECT_TRUE(FileExists(upload_parameters_path));
+
+  ASSERT_TRUE(LoggingRemoveFile(report.file_path));
+#if !BUILDFLAG(IS_APPLE) && !BUILDFLAG(IS_WIN)
+  ASSERT_TRUE(LoggingRemoveFile(base::FilePath(
+      report.file_path.RemoveFinalExtension().value() + ".meta")));
+#endif
+
+#if BUILDFLAG(IS_WIN)
+  EXPECT_EQ(db()->CleanDatabase(0), 1);
+#else
+  EXPECT_EQ(db()->CleanDatabase(0), 0);
+#endif
+  EXPECT_FALSE(FileExists(upload_parameters_path));
 }
 
 // This test uses knowledge of the database format to break it, so it only
@@ -930,6 +1044,106 @@ TEST_F(CrashReportDatabaseTest, CleanBrokenDatabase) {
 }
 #endif  // !BUILDFLAG(IS_APPLE) && !BUILDFLAG(IS_WIN)
 
+// This test uses knowledge of the database format to break it, so it only
+// applies to the unified database implementation.
+#if !BUILDFLAG(IS_APPLE) && !BUILDFLAG(IS_WIN)
+TEST_F(CrashReportDatabaseTest, Index) {
+  CrashReportDatabase::Report pending_report;
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&pending_report));
+  CrashReportDatabase::Report completed_report;
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&completed_report));
+  ASSERT_NO_FATAL_FAILURE(UploadReport(completed_report.uuid, true, "id"));
+
+  const base::FilePath index_path(
+      path().Append(FILE_PATH_LITERAL("index.dat")));
+  EXPECT_TRUE(IsRegularFile(index_path));
+
+  auto expect_reports = [this, &pending_report, &completed_report]() {
+    std::vector<CrashReportDatabase::Report> reports;
+    ASSERT_EQ(db()->GetPendingReports(&reports), CrashReportDatabase::kNoError);
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].uuid, pending_report.uuid);
+    EXPECT_EQ(reports[0].file_path, pending_report.file_path);
+    EXPECT_FALSE(reports[0].uploaded);
+
+    reports.clear();
+    ASSERT_EQ(db()->GetCompletedReports(&reports),
+              CrashReportDatabase::kNoError);
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].uuid, completed_report.uuid);
+    EXPECT_TRUE(reports[0].uploaded);
+    EXPECT_EQ(reports[0].id, "id");
+    EXPECT_EQ(reports[0].upload_attempts, 1);
+  };
+  ASSERT_NO_FATAL_FAILURE(expect_reports());
+
+  // Reports that are removed without updating the index aren’t returned.
+  CrashReportDatabase::Report removed_report;
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&removed_report));
+  ASSERT_TRUE(LoggingRemoveFile(removed_report.file_path));
+  ASSERT_NO_FATAL_FAILURE(expect_reports());
+  EXPECT_EQ(db()->CleanDatabase(0), 1);
+
+  // A corrupt index is rebuilt.
+  {
+    ScopedFileHandle handle(
+        LoggingOpenFileForWrite(index_path,
+                                FileWriteMode::kReuseOrCreate,
+                                FilePermissions::kOwnerOnly));
+    ASSERT_TRUE(handle.is_valid());
+    static constexpr char kGarbage[] = "garbage";
+    ASSERT_TRUE(LoggingWriteFile(handle.get(), kGarbage, sizeof(kGarbage)));
+  }
+  ASSERT_NO_FATAL_FAILURE(expect_reports());
+  EXPECT_TRUE(IsRegularFile(index_path));
+  ASSERT_NO_FATAL_FAILURE(expect_reports());
+
+  // So is a missing index.
+  ASSERT_TRUE(LoggingRemoveFile(index_path));
+  ASSERT_NO_FATAL_FAILURE(expect_reports());
+  EXPECT_TRUE(IsRegularFile(index_path));
+
+  // An expired index lock is removed.
+  const base::FilePath index_lock_path(
+      path().Append(FILE_PATH_LITERAL("index.lock")));
+  ScopedFileHandle handle(
+      LoggingOpenFileForWrite(index_lock_path,
+                              FileWriteMode::kCreateOrFail,
+                              FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(handle.is_valid());
+  time_t expired_timestamp = time(nullptr) - 60 * 60 * 24 * 3;
+  ASSERT_TRUE(LoggingWriteFile(
+      handle.get(), &expired_timestamp, sizeof(expired_timestamp)));
+  ASSERT_TRUE(LoggingCloseFile(handle.release()));
+
+  EXPECT_EQ(db()->CleanDatabase(0), 1);
+  EXPECT_FALSE(PathExists(index_lock_path));
+  ASSERT_NO_FATAL_FAILURE(expect_reports());
+
+  // An update made while another user holds the index lock leaves the index in
+  // place, but isn’t lost.
+  handle.reset(LoggingOpenFileForWrite(index_lock_path,
+                                       FileWriteMode::kCreateOrFail,
+                                       FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(handle.is_valid());
+  time_t timestamp = time(nullptr);
+  ASSERT_TRUE(LoggingWriteFile(handle.get(), &timestamp, sizeof(timestamp)));
+  ASSERT_TRUE(LoggingCloseFile(handle.release()));
+
+  ASSERT_NO_FATAL_FAILURE(
+      UploadReport(pending_report.uuid, false, std::string()));
+  EXPECT_TRUE(IsRegularFile(index_path));
+  ASSERT_TRUE(LoggingRemoveFile(index_lock_path));
+
+  std::vector<CrashReportDatabase::Report> reports;
+  ASSERT_EQ(db()->GetPendingReports(&reports), CrashReportDatabase::kNoError);
+  ASSERT_EQ(reports.size(), 1u);
+  EXPECT_EQ(reports[0].uuid, pending_report.uuid);
+  EXPECT_EQ(reports[0].upload_attempts, 1);
+  ASSERT_NO_FATAL_FAILURE(expect_reports());
+}
+#endif  // !BUILDFLAG(IS_APPLE) && !BUILDFLAG(IS_WIN)
+
 TEST_F(CrashReportDatabaseTest, TotalSize_MainReportOnly) {
   std::unique_ptr<CrashReportDatabase::NewReport> new_report;
   ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
@@ -1029,6 +1243,144 @@ TEST_F(CrashReportDatabaseTest, InitializeFromLargerFileRetainsClientId) {
   EXPECT_EQ(client_id, reopened_client_id);
 }
 
+// Only the unified database implementation supports compressed reports.
+#if !BUILDFLAG(IS_APPLE) && !BUILDFLAG(IS_WIN)
+TEST_F(CrashReportDatabaseTest, CompressedReport) {
+  ASSERT_TRUE(db()->SetCompressNewReports(true));
+
+  std::unique_ptr<CrashReportDatabase::NewReport> new_report;
+  ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
+            CrashReportDatabase::kNoError);
+  EXPECT_TRUE(new_report->IsCompressed());
+  static constexpr char kTest[] = "compressed test report";
+  ASSERT_TRUE(new_report->ContentWriter()->Write(kTest, sizeof(kTest)));
+
+  // The report’s content can be read back before the report is finished.
+  FileReaderInterface* new_report_reader = new_report->Reader();
+  ASSERT_TRUE(new_report_reader);
+  char new_report_contents[sizeof(kTest)];
+  ASSERT_TRUE(new_report_reader->ReadExactly(new_report_contents,
+                                             sizeof(new_report_contents)));
+  EXPECT_EQ(memcmp(new_report_contents, kTest, sizeof(new_report_contents)),
+            0);
+
+  UUID uuid;
+  ASSERT_EQ(db()->FinishedWritingCrashReport(std::move(new_report), &uuid),
+            CrashReportDatabase::kNoError);
+
+  CrashReportDatabase::Report report;
+  ASSERT_EQ(db()->LookUpCrashReport(uuid, &report),
+            CrashReportDatabase::kNoError);
+  EXPECT_TRUE(report.compressed);
+
+  {
+    std::unique_ptr<const CrashReportDatabase::UploadReport> upload_report;
+    ASSERT_EQ(db()->GetReportForUploading(uuid, &upload_report),
+              CrashReportDatabase::kNoError);
+    EXPECT_TRUE(upload_report->compressed);
+
+    FileReader* reader = upload_report->Reader();
+    ASSERT_TRUE(GzipFileReader::IsGzip(reader));
+    GzipFileReader gzip_reader;
+    ASSERT_TRUE(gzip_reader.Initialize(reader));
+    char contents[sizeof(kTest)];
+    ASSERT_TRUE(gzip_reader.ReadExactly(contents, sizeof(contents)));
+    EXPECT_EQ(memcmp(contents, kTest, sizeof(contents)), 0);
+    EXPECT_EQ(gzip_reader.Read(contents, 1), 0);
+
+    EXPECT_EQ(db()->RecordUploadComplete(std::move(upload_report), "id"),
+              CrashReportDatabase::kNoError);
+  }
+
+  // The compressed attribute survives changes to the report’s metadata.
+  ASSERT_EQ(db()->LookUpCrashReport(uuid, &report),
+            CrashReportDatabase::kNoError);
+  EXPECT_TRUE(report.compressed);
+  EXPECT_TRUE(report.uploaded);
+
+  // No other copy of the report was left behind.
+  EXPECT_EQ(db()->CleanDatabase(0), 0);
+
+  // Reports are stored uncompressed once compression is disabled.
+  ASSERT_TRUE(db()->SetCompressNewReports(false));
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&report));
+  EXPECT_FALSE(report.compressed);
+}
+
+TEST_F(CrashReportDatabaseTest, CompressedReportEmpty) {
+  ASSERT_TRUE(db()->SetCompressNewReports(true));
+
+  // Compressing no content produces no data, so the report is stored empty and
+  // uncompressed.
+  std::unique_ptr<CrashReportDatabase::NewReport> new_report;
+  ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
+            CrashReportDatabase::kNoError);
+  UUID uuid;
+  ASSERT_EQ(db()->FinishedWritingCrashReport(std::move(new_report), &uuid),
+            CrashReportDatabase::kNoError);
+
+  CrashReportDatabase::Report report;
+  ASSERT_EQ(db()->LookUpCrashReport(uuid, &report),
+            CrashReportDatabase::kNoError);
+  EXPECT_FALSE(report.compressed);
+
+  // A report abandoned while it is being written leaves nothing behind.
+  ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
+            CrashReportDatabase::kNoError);
+  static constexpr char kTest[] = "abandoned compressed test report";
+  ASSERT_TRUE(new_report->ContentWriter()->Write(kTest, sizeof(kTest)));
+  new_report.reset();
+  EXPECT_EQ(db()->CleanDatabase(0), 0);
+}
+
+TEST_F(CrashReportDatabaseTest, CompressedReportLevel) {
+  ASSERT_TRUE(db()->SetCompressNewReports(true));
+
+  // Stores a highly compressible report at level, returning the size of the
+  // stored file after checking its contents.
+  const std::string contents(64 * 1024, 'a');
+  auto stored_size = [this, &contents](int level, FileOffset* size) {
+    db()->SetCompressionLevel(level);
+
+    std::unique_ptr<CrashReportDatabase::NewReport> new_report;
+    ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
+              CrashReportDatabase::kNoError);
+    ASSERT_TRUE(
+        new_report->ContentWriter()->Write(contents.data(), contents.size()));
+
+    UUID uuid;
+    ASSERT_EQ(db()->FinishedWritingCrashReport(std::move(new_report), &uuid),
+              CrashReportDatabase::kNoError);
+
+    std::unique_ptr<const CrashReportDatabase::UploadReport> upload_report;
+    ASSERT_EQ(db()->GetReportForUploading(uuid, &upload_report),
+              CrashReportDatabase::kNoError);
+    EXPECT_TRUE(upload_report->compressed);
+
+    FileReader* reader = upload_report->Reader();
+    GzipFileReader gzip_reader;
+    ASSERT_TRUE(gzip_reader.Initialize(reader));
+    std::string read_contents(contents.size(), '\0');
+    ASSERT_TRUE(
+        gzip_reader.ReadExactly(&read_contents[0], read_contents.size()));
+    EXPECT_EQ(read_contents, contents);
+
+    *size = reader->Seek(0, SEEK_END);
+    ASSERT_GT(*size, 0);
+  };
+
+  // Level 0 stores the data without compressing it.
+  FileOffset uncompressed_size;
+  ASSERT_NO_FATAL_FAILURE(stored_size(0, &uncompressed_size));
+  EXPECT_GT(uncompressed_size, base::checked_cast<FileOffset>(contents.size()));
+
+  FileOffset compressed_size;
+  ASSERT_NO_FATAL_FAILURE(
+      stored_size(kZlibBestCompressionLevel, &compressed_size));
+  EXPECT_LT(compressed_size, uncompressed_size / 10);
+}
+#endif  // !BUILDFLAG(IS_APPLE) && !BUILDFLAG(IS_WIN)
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
@@ -1008,19 +1008,21 @@ void CrashReportDatabaseWin::CleanOrphanedAttachments() {
   while ((result = reader.NextFile(&filename)) ==
          DirectoryReader::Result::kSuccess) {
     const base::FilePath path(root_attachments_dir.Append(filename));
+    UUID uuid;
     if (IsDirectory(path, false)) {
-      UUID uuid;
       if (!uuid.InitializeFromString(filename.value())) {
         LOG(ERROR) << "unexpected attachment dir name " << filename;
         continue;
       }
+    } else if (!UUIDFromUploadParametersName(filename, &uuid)) {
+      continue;
+    }
 
-      // Remove attachments if corresponding report doesn't exist.
-      base::FilePath report_path = reports_dir.Append(
-          uuid.ToWString() + L"." + kCrashReportFileExtension);
-      if (!IsRegularFile(report_path)) {
-        RemoveAttachmentsByUUID(uuid);
-      }
+    // Remove attachments if corresponding report doesn't exist.
+    base::FilePath report_path = reports_dir.Append(
+        uuid.ToWString() + L"." + kCrashReportFileExtension);
+    if (!IsRegularFile(report_path)) {
+      RemoveAttachmentsByUUID(uuid);
     }
   }
 }
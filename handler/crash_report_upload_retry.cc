@@ -0,0 +1,67 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/crash_report_upload_retry.h"
+
+#include <stdint.h>
+#include <time.h>
+
+#include <algorithm>
+
+#include "base/check_op.h"
+#include "handler/crash_report_upload_rate_limit.h"
+#include "util/misc/fnv1a.h"
+
+namespace crashpad {
+
+time_t UploadRetryInterval(int upload_attempts, const UUID& uuid) {
+  DCHECK_GE(upload_attempts, 1);
+
+  // Stop doubling long before the interval could overflow. With the default
+  // kMaxUploadAttempts, this limit is never reached.
+  constexpr int kMaxDoublings = 16;
+  const int doublings =
+      std::min(std::max(upload_attempts, 1) - 1, kMaxDoublings);
+  const time_t interval = kUploadRetryInitialIntervalSeconds << doublings;
+
+  // Hash the UUID to spread its bits over the variation.
+  const uint32_t hash = FNV1a(&uuid, sizeof(uuid));
+
+  // Scale the interval to between 75% and 125% of its nominal value.
+  return interval * (750 + hash % 501) / 1000;
+}
+
+time_t UploadRetryDelay(time_t now,
+                        time_t last_upload_attempt_time,
+                        int upload_attempts,
+                        const UUID& uuid) {
+  if (last_upload_attempt_time > now &&
+      last_upload_attempt_time - now >= kBackwardsClockTolerance) {
+    // The most recent upload attempt purportedly occurred so far in the future
+    // that the timestamp must be bogus.
+    return 0;
+  }
+
+  const time_t interval = UploadRetryInterval(upload_attempts, uuid);
+  const time_t elapsed = now - last_upload_attempt_time;
+  if (elapsed >= interval) {
+    return 0;
+  }
+
+  // If the most recent attempt was in the future, wait no longer than a full
+  // interval from now.
+  return std::min(interval - elapsed, interval);
+}
+
+}  // namespace crashpad
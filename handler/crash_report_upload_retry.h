@@ -0,0 +1,72 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_HANDLER_CRASH_REPORT_UPLOAD_RETRY_H_
+#define CRASHPAD_HANDLER_CRASH_REPORT_UPLOAD_RETRY_H_
+
+#include <time.h>
+
+#include "util/misc/uuid.h"
+
+namespace crashpad {
+
+//! \brief The number of failed upload attempts after which no further attempts
+//!     are made to upload a crash report.
+inline constexpr int kMaxUploadAttempts = 6;
+
+//! \brief The time to wait after a crash report’s first failed upload attempt
+//!     before attempting it again. Each subsequent wait is twice as long as the
+//!     one before it.
+inline constexpr time_t kUploadRetryInitialIntervalSeconds = 15 * 60;
+
+//! \brief Determines the time to wait between a crash report’s most recent
+//!     failed upload attempt and its next attempt.
+//!
+//! The interval starts at kUploadRetryInitialIntervalSeconds and doubles with
+//! each failed attempt. It is then varied by up to 25% in either direction, so
+//! that reports whose uploads failed together, such as during a collection
+//! server outage, are not all retried together. The variation is derived from
+//! \a uuid rather than chosen at random, so that a report’s schedule is
+//! determined entirely by what the database stores for it, and is the same
+//! after the handler restarts.
+//!
+//! \param[in] upload_attempts The number of upload attempts that have been made
+//!     for the report. This must be at least `1`.
+//! \param[in] uuid The report’s UUID.
+//!
+//! \return The retry interval, in seconds.
+time_t UploadRetryInterval(int upload_attempts, const UUID& uuid);
+
+//! \brief Determines how much longer a crash report whose upload has failed
+//!     must wait before its upload is attempted again.
+//!
+//! \param[in] now The current time.
+//! \param[in] last_upload_attempt_time The timestamp of the report’s most
+//!     recent upload attempt. If this is kBackwardsClockTolerance or more in
+//!     the future, it is disregarded.
+//! \param[in] upload_attempts The number of upload attempts that have been made
+//!     for the report. This must be at least `1`.
+//! \param[in] uuid The report’s UUID.
+//!
+//! \return The number of seconds from \a now until the report’s upload may be
+//!     attempted again, or `0` if it may be attempted now. This is never more
+//!     than UploadRetryInterval().
+time_t UploadRetryDelay(time_t now,
+                        time_t last_upload_attempt_time,
+                        int upload_attempts,
+                        const UUID& uuid);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_HANDLER_CRASH_REPORT_UPLOAD_RETRY_H_
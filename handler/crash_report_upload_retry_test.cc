@@ -0,0 +1,86 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/crash_report_upload_retry.h"
+
+#include <time.h>
+
+#include <set>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "handler/crash_report_upload_rate_limit.h"
+#include "util/misc/uuid.h"
+
+namespace crashpad::test {
+namespace {
+
+UUID UUIDForIndex(int index) {
+  UUID uuid;
+  EXPECT_TRUE(uuid.InitializeFromString(
+      "00000000-0000-0000-0000-0000000000" + std::to_string(10 + index)));
+  return uuid;
+}
+
+TEST(CrashReportUploadRetryTest, UploadRetryInterval) {
+  std::set<time_t> first_intervals;
+  for (int index = 0; index < 10; ++index) {
+    const UUID uuid = UUIDForIndex(index);
+
+    time_t nominal_interval = kUploadRetryInitialIntervalSeconds;
+    for (int attempts = 1; attempts <= kMaxUploadAttempts; ++attempts) {
+      const time_t interval = UploadRetryInterval(attempts, uuid);
+      EXPECT_GE(interval, nominal_interval * 3 / 4);
+      EXPECT_LE(interval, nominal_interval * 5 / 4);
+
+      // The interval for a report is the same each time it’s computed.
+      EXPECT_EQ(UploadRetryInterval(attempts, uuid), interval);
+
+      if (attempts == 1) {
+        first_intervals.insert(interval);
+      }
+      nominal_interval *= 2;
+    }
+  }
+
+  // Different reports are retried at different times.
+  EXPECT_GT(first_intervals.size(), 1u);
+}
+
+TEST(CrashReportUploadRetryTest, UploadRetryDelay) {
+  const time_t now = time(nullptr);
+  const UUID uuid = UUIDForIndex(0);
+  const time_t interval = UploadRetryInterval(2, uuid);
+
+  // Wait for the remainder of the interval since the last attempt.
+  EXPECT_EQ(UploadRetryDelay(now, now, 2, uuid), interval);
+  EXPECT_EQ(UploadRetryDelay(now, now - 1, 2, uuid), interval - 1);
+  EXPECT_EQ(UploadRetryDelay(now, now - interval + 1, 2, uuid), 1);
+
+  // Allow the upload once the interval has passed.
+  EXPECT_EQ(UploadRetryDelay(now, now - interval, 2, uuid), 0);
+  EXPECT_EQ(UploadRetryDelay(now, 0, 2, uuid), 0);
+
+  // A last attempt time in the future within kBackwardsClockTolerance causes
+  // a wait of no more than one interval.
+  EXPECT_EQ(UploadRetryDelay(now, now + 1, 2, uuid), interval);
+  EXPECT_EQ(UploadRetryDelay(now, now + kBackwardsClockTolerance - 1, 2, uuid),
+            interval);
+
+  // Beyond kBackwardsClockTolerance, the last attempt time is disregarded.
+  EXPECT_EQ(UploadRetryDelay(now, now + kBackwardsClockTolerance, 2, uuid), 0);
+}
+
+}  // namespace
+}  // namespace crashpad::test
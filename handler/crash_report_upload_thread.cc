@@ -29,10 +29,10 @@
 #include "build/build_config.h"
 #include "client/settings.h"
 #include "handler/crash_report_upload_rate_limit.h"
+#include "handler/crash_report_upload_retry.h"
 #include "handler/minidump_to_upload_parameters.h"
-#include "snapshot/minidump/process_snapshot_minidump.h"
-#include "snapshot/module_snapshot.h"
 #include "util/file/file_reader.h"
+#include "util/file/gzip_file_reader.h"
 #include "util/misc/metrics.h"
 #include "util/misc/uuid.h"
 #include "util/net/http_body.h"
@@ -40,6 +40,7 @@
 #include "util/net/http_transport.h"
 #include "util/net/url.h"
 #include "util/stdlib/map_insert.h"
+#include "util/thread/thread.h"
 
 #if BUILDFLAG(IS_APPLE)
 #include "handler/mac/file_limit_annotation.h"
@@ -56,13 +57,8 @@ namespace {
 // The number of seconds to wait between checking for pending reports.
 const int kRetryWorkIntervalSeconds = 15 * 60;
 
-#if BUILDFLAG(IS_IOS)
-// The number of times to attempt to upload a pending report, repeated on
-// failure. Attempts will happen once per launch, once per call to
-// ReportPending(), and, if Options.watch_pending_reports is true, once every
-// kRetryWorkIntervalSeconds. Currently iOS only.
-const int kRetryAttempts = 5;
-#endif
+// The interval over which rate-limited uploads are permitted one attempt.
+constexpr int kUploadAttemptIntervalSeconds = 60 * 60;  // 1 hour
 
 // Wraps a reference to a no-args function (which can be empty). When this
 // object goes out of scope, invokes the function if it is non-empty.
@@ -87,6 +83,31 @@ class ScopedFunctionInvoker final {
 
 }  // namespace
 
+class CrashReportUploadThread::UploadWorker final : public Thread {
+ public:
+  UploadWorker(CrashReportUploadThread* upload_thread,
+               const std::vector<CrashReportDatabase::Report>* reports,
+               std::atomic<size_t>* next_report)
+      : upload_thread_(upload_thread),
+        reports_(reports),
+        next_report_(next_report) {}
+
+  UploadWorker(const UploadWorker&) = delete;
+  UploadWorker& operator=(const UploadWorker&) = delete;
+
+  ~UploadWorker() override = default;
+
+ private:
+  // Thread:
+  void ThreadMain() override {
+    upload_thread_->ProcessReportsFromList(*reports_, next_report_);
+  }
+
+  CrashReportUploadThread* upload_thread_;  // weak
+  const std::vector<CrashReportDatabase::Report>* reports_;  // weak
+  std::atomic<size_t>* next_report_;  // weak
+};
+
 CrashReportUploadThread::CrashReportUploadThread(
     CrashReportDatabase* database,
     const std::string& url,
@@ -96,13 +117,16 @@ CrashReportUploadThread::CrashReportUploadThread(
       callback_(callback),
       url_(url),
       // When watching for pending reports, check every 15 minutes, even in the
-      // absence of a signal from the handler thread. This allows for failed
-      // uploads to be retried periodically, and for pending reports written by
-      // other processes to be recognized.
+      // absence of a signal from the handler thread. This allows for pending
+      // reports written by other processes to be recognized. Checks occur
+      // sooner when a failed upload becomes due to be retried.
       thread_(options.watch_pending_reports ? kRetryWorkIntervalSeconds
                                             : WorkerThread::kIndefiniteWait,
               this),
       known_pending_report_uuids_(),
+      lock_(),
+      rate_limited_upload_in_progress_(false),
+      next_retry_time_(0),
       database_(database) {
   DCHECK(!url_.empty());
 }
@@ -134,21 +158,27 @@ void CrashReportUploadThread::ProcessPendingReports() {
   // uploads complete (regardless of whether or not that succeeded).
   ScopedFunctionInvoker scoped_function_invoker(callback_);
 
+#if BUILDFLAG(IS_APPLE)
+  RecordFileLimitAnnotation();
+#endif  // BUILDFLAG(IS_APPLE)
+
   std::vector<UUID> known_report_uuids = known_pending_report_uuids_.Drain();
+  std::vector<CrashReportDatabase::Report> known_reports;
   for (const UUID& report_uuid : known_report_uuids) {
     CrashReportDatabase::Report report;
     if (database_->LookUpCrashReport(report_uuid, &report) !=
         CrashReportDatabase::kNoError) {
       continue;
     }
+    known_reports.push_back(report);
+  }
 
-    ProcessPendingReport(report);
+  ProcessPendingReportList(known_reports);
 
-    // Respect Stop() being called after at least one attempt to process a
-    // report.
-    if (!thread_.is_running()) {
-      return;
-    }
+  // Respect Stop() being called after at least one attempt to process a
+  // report.
+  if (!thread_.is_running()) {
+    return;
   }
 
   // Known pending reports are always processed (above). The rest of this
@@ -167,17 +197,61 @@ void CrashReportUploadThread::ProcessPendingReports() {
     return;
   }
 
-  for (const CrashReportDatabase::Report& report : reports) {
-    if (std::find(known_report_uuids.begin(),
-                  known_report_uuids.end(),
-                  report.uuid) != known_report_uuids.end()) {
-      // An attempt to process the report already occurred above. The report is
-      // still pending, so upload must have failed. Don’t retry it immediately,
-      // it can wait until at least the next pass through this method.
-      continue;
-    }
+  // An attempt to process known reports already occurred above. Any that are
+  // still pending must have failed to upload. Don’t retry them immediately,
+  // they can wait until at least the next pass through this method.
+  reports.erase(
+      std::remove_if(reports.begin(),
+                     reports.end(),
+                     [&known_report_uuids](
+                         const CrashReportDatabase::Report& report) {
+                       return std::find(known_report_uuids.begin(),
+                                        known_report_uuids.end(),
+                                        report.uuid) !=
+                              known_report_uuids.end();
+                     }),
+      reports.end());
+
+  // Start with the oldest reports, so that a steady stream of new reports
+  // can’t indefinitely delay older ones.
+  std::stable_sort(reports.begin(),
+                   reports.end(),
+                   [](const CrashReportDatabase::Report& lhs,
+                      const CrashReportDatabase::Report& rhs) {
+                     return lhs.creation_time < rhs.creation_time;
+                   });
+
+  ProcessPendingReportList(reports);
+}
+
+void CrashReportUploadThread::ProcessPendingReportList(
+    const std::vector<CrashReportDatabase::Report>& reports) {
+  std::atomic<size_t> next_report(0);
+
+  const size_t worker_count = std::min<size_t>(
+      std::max(options_.upload_concurrency, 1u), reports.size());
+  if (worker_count <= 1) {
+    ProcessReportsFromList(reports, &next_report);
+    return;
+  }
+
+  std::vector<std::unique_ptr<UploadWorker>> workers;
+  for (size_t index = 0; index < worker_count; ++index) {
+    workers.push_back(
+        std::make_unique<UploadWorker>(this, &reports, &next_report));
+    workers.back()->Start();
+  }
+  for (const auto& worker : workers) {
+    worker->Join();
+  }
+}
 
-    ProcessPendingReport(report);
+void CrashReportUploadThread::ProcessReportsFromList(
+    const std::vector<CrashReportDatabase::Report>& reports,
+    std::atomic<size_t>* next_report) {
+  size_t index;
+  while ((index = next_report->fetch_add(1)) < reports.size()) {
+    ProcessPendingReport(reports[index]);
 
     // Respect Stop() being called after at least one attempt to process a
     // report.
@@ -189,9 +263,10 @@ void CrashReportUploadThread::ProcessPendingReports() {
 
 void CrashReportUploadThread::ProcessPendingReport(
     const CrashReportDatabase::Report& report) {
-#if BUILDFLAG(IS_APPLE)
-  RecordFileLimitAnnotation();
-#endif  // BUILDFLAG(IS_APPLE)
+  // Database operations are serialized among upload threads, because the
+  // database’s settings may not tolerate concurrent access from a single
+  // process. The lock is released while the report is being uploaded.
+  std::unique_lock<std::mutex> lock(lock_);
 
   Settings* const settings = database_->GetSettings();
 
@@ -206,13 +281,17 @@ void CrashReportUploadThread::ProcessPendingReport(
     return;
   }
 
-  if (ShouldRateLimitUpload(report))
+  if (ShouldDeferRetry(report))
     return;
 
-#if BUILDFLAG(IS_IOS)
-  if (ShouldRateLimitRetry(report))
+  if (ShouldRateLimitUpload(report))
     return;
-#endif  // BUILDFLAG(IS_IOS)
+
+  const std::function<void()> end_rate_limited_upload = [this, &report]() {
+    EndRateLimitedUpload(report);
+  };
+  ScopedFunctionInvoker scoped_end_rate_limited_upload(
+      end_rate_limited_upload);
 
   std::unique_ptr<const CrashReportDatabase::UploadReport> upload_report;
   CrashReportDatabase::OperationStatus status =
@@ -240,9 +319,12 @@ void CrashReportUploadThread::ProcessPendingReport(
       NOTREACHED();
   }
 
+  lock.unlock();
   std::string response_body;
   UploadResult upload_result =
       UploadReport(upload_report.get(), &response_body);
+  lock.lock();
+
   switch (upload_result) {
     case UploadResult::kSuccess:
       database_->RecordUploadComplete(std::move(upload_report), response_body);
@@ -253,27 +335,19 @@ void CrashReportUploadThread::ProcessPendingReport(
           report.uuid, Metrics::CrashSkippedReason::kPrepareForUploadFailed);
       break;
     case UploadResult::kRetry:
-#if BUILDFLAG(IS_IOS)
-      if (upload_report->upload_attempts > kRetryAttempts) {
+      // The attempt is recorded in the database when upload_report is
+      // destroyed, and the report remains pending until it is retried.
+      if (upload_report->upload_attempts + 1 >= kMaxUploadAttempts) {
         upload_report.reset();
         database_->SkipReportUpload(report.uuid,
                                     Metrics::CrashSkippedReason::kUploadFailed);
       } else {
         Metrics::CrashUploadSkipped(
             Metrics::CrashSkippedReason::kUploadFailedButCanRetry);
-        retry_uuid_time_map_[report.uuid] =
-            time(nullptr) +
-            (1 << upload_report->upload_attempts) * kRetryWorkIntervalSeconds;
+        ScheduleRetry(time(nullptr) +
+                      UploadRetryInterval(upload_report->upload_attempts + 1,
+                                          report.uuid));
       }
-#else
-      upload_report.reset();
-
-      // TODO(mark): Deal with retries properly: don’t call SkipReportUplaod()
-      // if the result was kRetry and the report hasn’t already been retried
-      // too many times.
-      database_->SkipReportUpload(report.uuid,
-                                  Metrics::CrashSkippedReason::kUploadFailed);
-#endif
       break;
   }
 }
@@ -289,14 +363,20 @@ CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
     return UploadResult::kPermanentFailure;
   }
 
+  // The parameters are normally stored with the report when it’s written.
+  // Reports written without them have them recovered from the minidump file.
+  //
   // Ignore any errors that might occur when attempting to interpret the
   // minidump file. This may result in its being uploaded with few or no
   // parameters, but as long as there’s a dump file, the server can decide what
   // to do with it.
-  ProcessSnapshotMinidump minidump_process_snapshot;
-  if (minidump_process_snapshot.Initialize(reader)) {
-    parameters =
-        BreakpadHTTPFormParametersFromMinidump(&minidump_process_snapshot);
+  //
+  // The parameters only require a small part of the minidump, so only that
+  // part is read. It’s read with ordinary reads rather than through a mapping,
+  // so that a truncated file or an I/O error is reported as a failed read
+  // instead of raising SIGBUS in the handler.
+  if (!report->GetUploadParameters(&parameters)) {
+    BreakpadHTTPFormParametersFromMinidumpFile(reader, &parameters);
   }
 
   if (!reader->SeekSet(start_offset)) {
@@ -305,6 +385,7 @@ CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
 
   HTTPMultipartBuilder http_multipart_builder;
   http_multipart_builder.SetGzipEnabled(options_.upload_gzip);
+  http_multipart_builder.SetGzipCompressionLevel(options_.upload_gzip_level);
 
   static constexpr char kMinidumpKey[] = "upload_file_minidump";
 
@@ -322,10 +403,28 @@ CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
         it.first, it.first, it.second, "application/octet-stream");
   }
 
-  http_multipart_builder.SetFileAttachment(kMinidumpKey,
-                                           report->uuid.ToString() + ".dmp",
-                                           reader,
-                                           "application/octet-stream");
+  // A report stored compressed is placed into a compressed body as-is. It
+  // only needs to be decompressed when the body won’t be compressed.
+  GzipFileReader gzip_reader;
+  if (report->compressed && options_.upload_gzip) {
+    http_multipart_builder.SetCompressedFileAttachment(
+        kMinidumpKey,
+        report->uuid.ToString() + ".dmp",
+        reader,
+        "application/octet-stream");
+  } else {
+    FileReaderInterface* minidump_reader = reader;
+    if (report->compressed) {
+      if (!gzip_reader.Initialize(reader)) {
+        return UploadResult::kPermanentFailure;
+      }
+      minidump_reader = &gzip_reader;
+    }
+    http_multipart_builder.SetFileAttachment(kMinidumpKey,
+                                             report->uuid.ToString() + ".dmp",
+                                             minidump_reader,
+                                             "application/octet-stream");
+  }
 
   std::unique_ptr<HTTPTransport> http_transport(HTTPTransport::Create());
   if (!http_transport) {
@@ -374,7 +473,49 @@ CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
 }
 
 void CrashReportUploadThread::DoWork(const WorkerThread* thread) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    next_retry_time_ = 0;
+  }
+
   ProcessPendingReports();
+
+  // Reports that are pending only because they’re waiting to be retried will
+  // be found when scanning for pending reports. If the first of them becomes
+  // due to be retried before the next scan, scan then instead.
+  if (options_.watch_pending_reports) {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (next_retry_time_ != 0) {
+      const time_t delay =
+          std::max<time_t>(next_retry_time_ - time(nullptr), 1);
+      if (delay < kRetryWorkIntervalSeconds) {
+        thread_.SetNextWorkDelay(delay);
+      }
+    }
+  }
+}
+
+bool CrashReportUploadThread::ShouldDeferRetry(
+    const CrashReportDatabase::Report& report) {
+  if (report.upload_attempts <= 0 || report.upload_explicitly_requested)
+    return false;
+
+  const time_t now = time(nullptr);
+  const time_t delay = UploadRetryDelay(now,
+                                        report.last_upload_attempt_time,
+                                        report.upload_attempts,
+                                        report.uuid);
+  if (delay == 0)
+    return false;
+
+  ScheduleRetry(now + delay);
+  return true;
+}
+
+void CrashReportUploadThread::ScheduleRetry(time_t retry_time) {
+  if (next_retry_time_ == 0 || retry_time < next_retry_time_) {
+    next_retry_time_ = retry_time;
+  }
 }
 
 bool CrashReportUploadThread::ShouldRateLimitUpload(
@@ -382,34 +523,50 @@ bool CrashReportUploadThread::ShouldRateLimitUpload(
   if (report.upload_explicitly_requested || !options_.rate_limit)
     return false;
 
+  // A report whose upload has already failed is retried once the rate limit
+  // permits, rather than being abandoned.
+  const bool is_retry = report.upload_attempts > 0;
+  const time_t now = time(nullptr);
+
+  // The attempt in progress will be recorded as the last upload attempt once
+  // it’s over, which would cause this report to be throttled.
+  if (rate_limited_upload_in_progress_) {
+    if (is_retry) {
+      ScheduleRetry(now + kUploadAttemptIntervalSeconds);
+    } else {
+      database_->SkipReportUpload(
+          report.uuid, Metrics::CrashSkippedReason::kUploadThrottled);
+    }
+    return true;
+  }
+
   Settings* const settings = database_->GetSettings();
   time_t last_upload_attempt_time;
   if (settings->GetLastUploadAttemptTime(&last_upload_attempt_time)) {
-    const time_t now = time(nullptr);
-    constexpr int kUploadAttemptIntervalSeconds = 60 * 60;  // 1 hour
     const auto should_rate_limit = ShouldRateLimit(
         now, last_upload_attempt_time, kUploadAttemptIntervalSeconds);
     if (should_rate_limit.skip_reason.has_value()) {
-      database_->SkipReportUpload(report.uuid, *should_rate_limit.skip_reason);
+      if (is_retry) {
+        ScheduleRetry(std::max(now, last_upload_attempt_time) +
+                      kUploadAttemptIntervalSeconds);
+      } else {
+        database_->SkipReportUpload(report.uuid,
+                                    *should_rate_limit.skip_reason);
+      }
       return true;
     }
   }
+
+  rate_limited_upload_in_progress_ = true;
   return false;
 }
 
-#if BUILDFLAG(IS_IOS)
-bool CrashReportUploadThread::ShouldRateLimitRetry(
+void CrashReportUploadThread::EndRateLimitedUpload(
     const CrashReportDatabase::Report& report) {
-  if (retry_uuid_time_map_.find(report.uuid) != retry_uuid_time_map_.end()) {
-    time_t now = time(nullptr);
-    if (now < retry_uuid_time_map_[report.uuid]) {
-      return true;
-    } else {
-      retry_uuid_time_map_.erase(report.uuid);
-    }
-  }
-  return false;
+  if (report.upload_explicitly_requested || !options_.rate_limit)
+    return;
+
+  rate_limited_upload_in_progress_ = false;
 }
-#endif
 
 }  // namespace crashpad
@@ -15,14 +15,20 @@
 #ifndef CRASHPAD_HANDLER_CRASH_REPORT_UPLOAD_THREAD_H_
 #define CRASHPAD_HANDLER_CRASH_REPORT_UPLOAD_THREAD_H_
 
+#include <time.h>
+
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "build/build_config.h"
 #include "client/crash_report_database.h"
 #include "util/misc/uuid.h"
+#include "util/misc/zlib.h"
 #include "util/stdlib/thread_safe_vector.h"
 #include "util/thread/stoppable.h"
 #include "util/thread/worker_thread.h"
@@ -57,11 +63,24 @@ class CrashReportUploadThread : public WorkerThread::Delegate,
     //! Whether uploads should use `gzip` compression.
     bool upload_gzip;
 
+    //! The compression level to use for uploads when #upload_gzip is `true`,
+    //! from `0` through kZlibBestCompressionLevel, or
+    //! kZlibDefaultCompressionLevel. Lower levels use less CPU time but upload
+    //! more data. Reports stored compressed are uploaded without being
+    //! recompressed.
+    int upload_gzip_level = kZlibDefaultCompressionLevel;
+
     //! Whether to periodically check for new pending reports not already known
     //! to exist. When `false`, only an initial upload attempt will be made for
     //! reports known to exist by having been added by the ReportPending()
     //! method. No scans for new pending reports will be conducted.
     bool watch_pending_reports;
+
+    //! The maximum number of reports to upload at once. Reports are started
+    //! in the order in which they became known, oldest first. All uploads are
+    //! made to the same URL, so this is also the limit on the number of
+    //! connections to the collection server. A value of `0` is treated as `1`.
+    unsigned int upload_concurrency = 1;
   };
 
   //! \brief Observation callback invoked each time the in-process handler
@@ -129,6 +148,8 @@ class CrashReportUploadThread : public WorkerThread::Delegate,
   bool is_running() const { return thread_.is_running(); }
 
  private:
+  class UploadWorker;
+
   //! \brief The result code from UploadReport().
   enum class UploadResult {
     //! \brief The crash report was uploaded successfully.
@@ -158,6 +179,25 @@ class CrashReportUploadThread : public WorkerThread::Delegate,
   //! well.
   void ProcessPendingReports();
 
+  //! \brief Calls ProcessPendingReport() on each of \a reports, using up to
+  //!     Options::upload_concurrency threads.
+  //!
+  //! Reports are started in order. This method returns once they have all been
+  //! processed, or once Stop() has been called and each thread has finished the
+  //! report that it was processing.
+  void ProcessPendingReportList(
+      const std::vector<CrashReportDatabase::Report>& reports);
+
+  //! \brief Processes reports from \a reports until none remain or Stop() is
+  //!     called. This may be called on several threads at once.
+  //!
+  //! \param[in] reports The reports to process.
+  //! \param[in,out] next_report The index in \a reports of the next report to
+  //!     process, shared by all callers processing \a reports.
+  void ProcessReportsFromList(
+      const std::vector<CrashReportDatabase::Report>& reports,
+      std::atomic<size_t>* next_report);
+
   //! \brief Processes a single pending report from the database.
   //!
   //! \param[in] report The crash report to process.
@@ -198,40 +238,69 @@ class CrashReportUploadThread : public WorkerThread::Delegate,
   //!
   //! This currently implements very simplistic rate-limiting, compatible with
   //! the Breakpad client, where the strategy is to permit one upload attempt
-  //! per hour, and retire reports that would exceed this limit or for which the
-  //! upload fails on the first attempt.
+  //! per hour, and retire new reports that would exceed this limit. Reports
+  //! whose upload has already failed are instead left pending, and retried
+  //! once the limit permits.
   //! If upload was requested explicitly (i.e. by user action), do not throttle
   //! the upload.
   //!
-  //! TODO(mark): Provide a proper rate-limiting strategy and allow for failed
-  //! upload attempts to be retried.
+  //! An upload attempt is only recorded in the database once it completes, so
+  //! while an upload that is subject to rate limiting is in progress, other
+  //! such uploads are throttled too. If this method returns `false`,
+  //! EndRateLimitedUpload() must be called once the attempt for \a report is
+  //! over.
+  //!
+  //! #lock_ must be held.
+  //!
+  //! TODO(mark): Provide a proper rate-limiting strategy.
   bool ShouldRateLimitUpload(const CrashReportDatabase::Report& report);
 
-#if BUILDFLAG(IS_IOS)
-  //! \brief Rate-limit report retries.
+  //! \brief Allows further uploads to be considered by ShouldRateLimitUpload()
+  //!     after the attempt for \a report is over.
+  //!
+  //! #lock_ must be held.
+  void EndRateLimitedUpload(const CrashReportDatabase::Report& report);
+
+  //! \brief Determines whether a report whose upload has failed must wait
+  //!     longer before its upload is attempted again.
   //!
   //! \param[in] report The crash report to process.
   //!
-  //! This implements a per-report retry rate limit (as opposed to per upload
-  //! rate limit in ShouldRateLimitUpload). When a report upload ends in a retry
-  //! state, an in-memory only timestamp is stored in |retry_uuid_time_map_|
-  //! with the next possible retry time. This timestamp is a backoff from the
-  //! main thread work interval, doubling on each attemt. Because this is only
-  //! stored in memory, on restart reports in the retry state will always be
-  //! tried once, and then fall back into the next backoff. This continues until
-  //! kRetryAttempts is reached.
-  bool ShouldRateLimitRetry(const CrashReportDatabase::Report& report);
-#endif
+  //! This implements a per-report retry schedule (as opposed to the per-upload
+  //! rate limit in ShouldRateLimitUpload). Failed uploads are retried after the
+  //! delay given by UploadRetryDelay(), an exponential backoff from the most
+  //! recent attempt. The number of attempts and the time of the most recent
+  //! one are stored in the database, so the schedule is maintained across
+  //! restarts. If upload was requested explicitly (i.e. by user action), do
+  //! not defer the upload.
+  //!
+  //! If this method returns `true`, the time at which \a report may be retried
+  //! is passed to ScheduleRetry().
+  //!
+  //! #lock_ must be held.
+  bool ShouldDeferRetry(const CrashReportDatabase::Report& report);
+
+  //! \brief Arranges for pending reports to be processed again no later than
+  //!     \a retry_time, when a report whose upload has failed may be retried.
+  //!
+  //! #lock_ must be held.
+  void ScheduleRetry(time_t retry_time);
 
   const Options options_;
   const ProcessPendingReportsObservationCallback callback_;
   const std::string url_;
   WorkerThread thread_;
   ThreadSafeVector<UUID> known_pending_report_uuids_;
-#if BUILDFLAG(IS_IOS)
-  // This is not thread-safe, and only used by the worker thread.
-  std::map<UUID, time_t> retry_uuid_time_map_;
-#endif
+
+  // Serializes database operations among upload threads, and protects the
+  // members below.
+  std::mutex lock_;
+  bool rate_limited_upload_in_progress_;
+
+  // The earliest time passed to ScheduleRetry() during the current pass
+  // through ProcessPendingReports(), or 0 if there is none.
+  time_t next_retry_time_;
+
   CrashReportDatabase* database_;  // weak
 };
 
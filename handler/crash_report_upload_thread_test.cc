@@ -0,0 +1,305 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/crash_report_upload_thread.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base/numerics/safe_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "build/build_config.h"
+#include "client/crash_report_database.h"
+#include "client/settings.h"
+#include "gtest/gtest.h"
+#include "test/scoped_temp_dir.h"
+#include "util/synchronization/semaphore.h"
+#include "util/thread/thread.h"
+
+#if COMPILER_MSVC
+#pragma warning(push)
+#pragma warning(disable: 4244 4245 4267 4702)
+#endif
+
+#include "third_party/cpp-httplib/cpp-httplib/httplib.h"
+
+#if COMPILER_MSVC
+#pragma warning(pop)
+#endif
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr char kResponseBody[] = "server-report-id";
+
+// A stand-in for a crash report collection server, which accepts uploads on a
+// local port. Each request is held until the expected number of requests are
+// being handled at once, or until a timeout expires, so that the number of
+// concurrent uploads can be observed.
+class TestUploadServer : public Thread {
+ public:
+  explicit TestUploadServer(size_t expected_concurrency)
+      : server_(),
+        lock_(),
+        in_flight_changed_(),
+        expected_concurrency_(expected_concurrency),
+        in_flight_(0),
+        max_in_flight_(0),
+        requests_(0),
+        response_status_(200),
+        port_(0) {
+    server_.Post("/upload",
+                 [this](const httplib::Request& request,
+                        httplib::Response& response) {
+                   response.status = HandleUpload();
+                   response.set_content(kResponseBody, "text/plain");
+                 });
+    port_ = base::checked_cast<uint16_t>(server_.bind_to_any_port("localhost"));
+  }
+
+  TestUploadServer(const TestUploadServer&) = delete;
+  TestUploadServer& operator=(const TestUploadServer&) = delete;
+
+  ~TestUploadServer() override = default;
+
+  std::string URL() const {
+    return base::StringPrintf("http://localhost:%d/upload", port_);
+  }
+
+  void StopServer() { server_.stop(); }
+
+  size_t max_in_flight() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return max_in_flight_;
+  }
+
+  size_t requests() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return requests_;
+  }
+
+  void set_response_status(int response_status) {
+    std::lock_guard<std::mutex> lock(lock_);
+    response_status_ = response_status;
+  }
+
+ private:
+  // Returns the HTTP status to respond with.
+  int HandleUpload() {
+    std::unique_lock<std::mutex> lock(lock_);
+    ++requests_;
+    ++in_flight_;
+    max_in_flight_ = std::max(max_in_flight_, in_flight_);
+    in_flight_changed_.notify_all();
+    in_flight_changed_.wait_for(lock, std::chrono::seconds(2), [this]() {
+      return max_in_flight_ >= expected_concurrency_;
+    });
+    --in_flight_;
+    return response_status_;
+  }
+
+  // Thread:
+  void ThreadMain() override { server_.listen_after_bind(); }
+
+  httplib::Server server_;
+  std::mutex lock_;
+  std::condition_variable in_flight_changed_;
+  const size_t expected_concurrency_;
+  size_t in_flight_;
+  size_t max_in_flight_;
+  size_t requests_;
+  int response_status_;
+  uint16_t port_;
+};
+
+class CrashReportUploadThreadTest : public testing::Test {
+ public:
+  CrashReportUploadThreadTest() = default;
+
+  CrashReportUploadThreadTest(const CrashReportUploadThreadTest&) = delete;
+  CrashReportUploadThreadTest& operator=(const CrashReportUploadThreadTest&) =
+      delete;
+
+ protected:
+  CrashReportDatabase* db() { return database_.get(); }
+
+  void CreatePendingReports(size_t count) {
+    for (size_t index = 0; index < count; ++index) {
+      std::unique_ptr<CrashReportDatabase::NewReport> new_report;
+      ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
+                CrashReportDatabase::kNoError);
+      static constexpr char kReportContents[] = "not a minidump";
+      ASSERT_TRUE(new_report->Writer()->Write(kReportContents,
+                                              sizeof(kReportContents)));
+      UUID uuid;
+      ASSERT_EQ(db()->FinishedWritingCrashReport(std::move(new_report), &uuid),
+                CrashReportDatabase::kNoError);
+    }
+  }
+
+  // Runs a single pass of a CrashReportUploadThread over the pending reports
+  // in the database.
+  void UploadPendingReports(const std::string& url,
+                            const CrashReportUploadThread::Options& options) {
+    Semaphore pass_complete(0);
+    CrashReportUploadThread upload_thread(
+        db(), url, options, [&pass_complete]() { pass_complete.Signal(); });
+    upload_thread.Start();
+    EXPECT_TRUE(pass_complete.TimedWait(30));
+    upload_thread.Stop();
+  }
+
+ private:
+  // testing::Test:
+  void SetUp() override {
+    database_ = CrashReportDatabase::Initialize(temp_dir_.path());
+    ASSERT_TRUE(database_);
+    ASSERT_TRUE(database_->GetSettings()->SetUploadsEnabled(true));
+  }
+
+  ScopedTempDir temp_dir_;
+  std::unique_ptr<CrashReportDatabase> database_;
+};
+
+CrashReportUploadThread::Options UploadOptions(unsigned int concurrency,
+                                               bool rate_limit) {
+  CrashReportUploadThread::Options options;
+  options.identify_client_via_url = false;
+  options.rate_limit = rate_limit;
+  options.upload_gzip = false;
+  options.watch_pending_reports = true;
+  options.upload_concurrency = concurrency;
+  return options;
+}
+
+TEST_F(CrashReportUploadThreadTest, ConcurrentUploads) {
+  constexpr size_t kReportCount = 8;
+  constexpr unsigned int kConcurrency = 4;
+  ASSERT_NO_FATAL_FAILURE(CreatePendingReports(kReportCount));
+
+  TestUploadServer server(kConcurrency);
+  server.Start();
+  UploadPendingReports(server.URL(), UploadOptions(kConcurrency, false));
+  server.StopServer();
+  server.Join();
+
+  EXPECT_EQ(server.requests(), kReportCount);
+  EXPECT_GT(server.max_in_flight(), 1u);
+  EXPECT_LE(server.max_in_flight(), kConcurrency);
+
+  std::vector<CrashReportDatabase::Report> reports;
+  ASSERT_EQ(db()->GetPendingReports(&reports), CrashReportDatabase::kNoError);
+  EXPECT_TRUE(reports.empty());
+
+  ASSERT_EQ(db()->GetCompletedReports(&reports),
+            CrashReportDatabase::kNoError);
+  ASSERT_EQ(reports.size(), kReportCount);
+  for (const CrashReportDatabase::Report& report : reports) {
+    EXPECT_TRUE(report.uploaded);
+    EXPECT_EQ(report.id, kResponseBody);
+  }
+}
+
+TEST_F(CrashReportUploadThreadTest, ConcurrentUploadsRateLimited) {
+  constexpr size_t kReportCount = 8;
+  constexpr unsigned int kConcurrency = 4;
+  ASSERT_NO_FATAL_FAILURE(CreatePendingReports(kReportCount));
+
+  // Only a single upload is expected, so don’t hold it waiting for others.
+  TestUploadServer server(1);
+  server.Start();
+  UploadPendingReports(server.URL(), UploadOptions(kConcurrency, true));
+  server.StopServer();
+  server.Join();
+
+  // The rate limit permits one upload per hour, regardless of the number of
+  // upload threads.
+  EXPECT_EQ(server.requests(), 1u);
+
+  std::vector<CrashReportDatabase::Report> reports;
+  ASSERT_EQ(db()->GetPendingReports(&reports), CrashReportDatabase::kNoError);
+  EXPECT_TRUE(reports.empty());
+
+  ASSERT_EQ(db()->GetCompletedReports(&reports),
+            CrashReportDatabase::kNoError);
+  ASSERT_EQ(reports.size(), kReportCount);
+  EXPECT_EQ(std::count_if(reports.begin(),
+                          reports.end(),
+                          [](const CrashReportDatabase::Report& report) {
+                            return report.uploaded;
+                          }),
+            1);
+}
+
+TEST_F(CrashReportUploadThreadTest, RetryAfterFailure) {
+  ASSERT_NO_FATAL_FAILURE(CreatePendingReports(1));
+
+  TestUploadServer server(1);
+  server.set_response_status(503);
+  server.Start();
+
+  // The failed upload leaves the report pending, with the attempt recorded.
+  UploadPendingReports(server.URL(), UploadOptions(1, false));
+  EXPECT_EQ(server.requests(), 1u);
+
+  std::vector<CrashReportDatabase::Report> reports;
+  ASSERT_EQ(db()->GetPendingReports(&reports), CrashReportDatabase::kNoError);
+  ASSERT_EQ(reports.size(), 1u);
+  EXPECT_EQ(reports[0].upload_attempts, 1);
+  EXPECT_FALSE(reports[0].uploaded);
+
+  // The report isn’t retried until its retry interval has passed, even if the
+  // upload thread is restarted.
+  UploadPendingReports(server.URL(), UploadOptions(1, false));
+  EXPECT_EQ(server.requests(), 1u);
+
+  reports.clear();
+  ASSERT_EQ(db()->GetPendingReports(&reports), CrashReportDatabase::kNoError);
+  ASSERT_EQ(reports.size(), 1u);
+  EXPECT_EQ(reports[0].upload_attempts, 1);
+
+  server.StopServer();
+  server.Join();
+}
+
+TEST_F(CrashReportUploadThreadTest, RetryAfterFailureRateLimited) {
+  ASSERT_NO_FATAL_FAILURE(CreatePendingReports(1));
+
+  TestUploadServer server(1);
+  server.set_response_status(503);
+  server.Start();
+  UploadPendingReports(server.URL(), UploadOptions(1, true));
+  server.StopServer();
+  server.Join();
+  EXPECT_EQ(server.requests(), 1u);
+
+  // Even though the failed attempt counts against the rate limit, the report
+  // remains pending so that it can be retried.
+  std::vector<CrashReportDatabase::Report> reports;
+  ASSERT_EQ(db()->GetPendingReports(&reports), CrashReportDatabase::kNoError);
+  ASSERT_EQ(reports.size(), 1u);
+  EXPECT_EQ(reports[0].upload_attempts, 1);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -24,6 +24,7 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -50,6 +51,7 @@
 #include "util/misc/address_types.h"
 #include "util/misc/metrics.h"
 #include "util/misc/paths.h"
+#include "util/misc/zlib.h"
 #include "util/numeric/in_range_cast.h"
 #include "util/stdlib/map_insert.h"
 #include "util/stdlib/string_number_conversion.h"
@@ -98,6 +100,14 @@ namespace {
 #endif  // BUILDFLAG(IS_WIN) || BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
         // BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_MAC)
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+// The name of the file in the database directory that caches metadata parsed
+// from crashing processes’ modules.
+constexpr base::FilePath::CharType kModuleMetadataCacheFileName[] =
+    FILE_PATH_LITERAL("module_metadata");
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+
 void Usage(const base::FilePath& me) {
   // clang-format off
   fprintf(stderr,
@@ -112,7 +122,16 @@ void Usage(const base::FilePath& me) {
 "                              at the time of the crash\n"
   // clang-format on
 #endif  // ATTACHMENTS_SUPPORTED
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+      // clang-format off
+"      --compress-reports      store crash reports gzip-compressed\n"
+  // clang-format on
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
       // clang-format off
+"      --compression-level=LEVEL\n"
+"                              zlib compression level for reports and\n"
+"                              uploads, from 0 (fastest) to 9 (smallest)\n"
 "      --database=PATH         store the crash report database at PATH\n"
   // clang-format on
 #if BUILDFLAG(IS_APPLE)
@@ -179,6 +198,9 @@ void Usage(const base::FilePath& me) {
       // clang-format off
 "      --sanitization-information=SANITIZATION_INFORMATION_ADDRESS\n"
 "                              the address of a SanitizationInformation struct.\n"
+"      --shared-client-concurrency=COUNT\n"
+"                              handle up to COUNT crash dump requests from\n"
+"                              clients on a shared connection at once\n"
 "      --shared-client-connection the file descriptor provided by\n"
 "                              --initial-client-fd is shared among multiple\n"
 "                              clients\n"
@@ -188,6 +210,8 @@ void Usage(const base::FilePath& me) {
 #endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
         // BUILDFLAG(IS_ANDROID)
       // clang-format off
+"      --upload-concurrency=COUNT\n"
+"                              upload up to COUNT crash reports at once\n"
 "      --url=URL               send crash reports to this Breakpad server URL,\n"
 "                              only if uploads are enabled for the database\n"
   // clang-format on
@@ -233,6 +257,8 @@ struct Options {
   VMAddress exception_information_address;
   VMAddress sanitization_information_address;
   int initial_client_fd;
+  unsigned int shared_client_concurrency;
+  bool compress_reports;
   bool shared_client_connection;
 #if BUILDFLAG(IS_ANDROID)
   bool write_minidump_to_log;
@@ -242,6 +268,8 @@ struct Options {
   std::string pipe_name;
   InitialClientData initial_client_data;
 #endif  // BUILDFLAG(IS_APPLE)
+  std::optional<int> compression_level;
+  unsigned int upload_concurrency;
   bool identify_client_via_url;
   bool monitor_self;
   bool periodic_tasks;
@@ -583,6 +611,11 @@ int HandlerMain(int argc,
 #if defined(ATTACHMENTS_SUPPORTED)
     kOptionAttachment,
 #endif  // defined(ATTACHMENTS_SUPPORTED)
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+    kOptionCompressReports,
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+    kOptionCompressionLevel,
     kOptionDatabase,
 #if BUILDFLAG(IS_APPLE)
     kOptionHandshakeFD,
@@ -616,9 +649,11 @@ int HandlerMain(int argc,
 #endif  // BUILDFLAG(IS_APPLE)
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
     kOptionSanitizationInformation,
+    kOptionSharedClientConcurrency,
     kOptionSharedClientConnection,
     kOptionTraceParentWithException,
 #endif
+    kOptionUploadConcurrency,
     kOptionURL,
 #if BUILDFLAG(IS_CHROMEOS)
     kOptionUseCrosCrashReporter,
@@ -639,6 +674,14 @@ int HandlerMain(int argc,
 #if defined(ATTACHMENTS_SUPPORTED)
     {"attachment", required_argument, nullptr, kOptionAttachment},
 #endif  // ATTACHMENTS_SUPPORTED
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+    {"compress-reports", no_argument, nullptr, kOptionCompressReports},
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+    {"compression-level",
+     required_argument,
+     nullptr,
+     kOptionCompressionLevel},
     {"database", required_argument, nullptr, kOptionDatabase},
 #if BUILDFLAG(IS_APPLE)
     {"handshake-fd", required_argument, nullptr, kOptionHandshakeFD},
@@ -693,6 +736,10 @@ int HandlerMain(int argc,
      required_argument,
      nullptr,
      kOptionSanitizationInformation},
+    {"shared-client-concurrency",
+     required_argument,
+     nullptr,
+     kOptionSharedClientConcurrency},
     {"shared-client-connection",
      no_argument,
      nullptr,
@@ -703,6 +750,10 @@ int HandlerMain(int argc,
      kOptionTraceParentWithException},
 #endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
         // BUILDFLAG(IS_ANDROID)
+    {"upload-concurrency",
+     required_argument,
+     nullptr,
+     kOptionUploadConcurrency},
     {"url", required_argument, nullptr, kOptionURL},
 #if BUILDFLAG(IS_CHROMEOS)
     {"use-cros-crash-reporter",
@@ -730,9 +781,11 @@ int HandlerMain(int argc,
   options.identify_client_via_url = true;
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
   options.initial_client_fd = kInvalidFileHandle;
+  options.shared_client_concurrency = 1;
 #endif
   options.periodic_tasks = true;
   options.rate_limit = true;
+  options.upload_concurrency = 1;
   options.upload_gzip = true;
 #if BUILDFLAG(IS_ANDROID)
   options.write_minidump_to_database = true;
@@ -754,6 +807,25 @@ int HandlerMain(int argc,
         break;
       }
 #endif  // ATTACHMENTS_SUPPORTED
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+      case kOptionCompressReports: {
+        options.compress_reports = true;
+        break;
+      }
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+      case kOptionCompressionLevel: {
+        int compression_level;
+        if (!StringToNumber(optarg, &compression_level) ||
+            compression_level < 0 ||
+            compression_level > kZlibBestCompressionLevel) {
+          ToolSupport::UsageHint(
+              me, "--compression-level requires a level from 0 to 9");
+          return ExitFailure();
+        }
+        options.compression_level = compression_level;
+        break;
+      }
       case kOptionDatabase: {
         options.database = base::FilePath(
             ToolSupport::CommandLineArgumentToFilePathStringType(optarg));
@@ -859,6 +931,15 @@ int HandlerMain(int argc,
         }
         break;
       }
+      case kOptionSharedClientConcurrency: {
+        if (!StringToNumber(optarg, &options.shared_client_concurrency) ||
+            options.shared_client_concurrency < 1) {
+          ToolSupport::UsageHint(
+              me, "--shared-client-concurrency requires a positive count");
+          return ExitFailure();
+        }
+        break;
+      }
       case kOptionSharedClientConnection: {
         options.shared_client_connection = true;
         break;
@@ -873,6 +954,15 @@ int HandlerMain(int argc,
       }
 #endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
         // BUILDFLAG(IS_ANDROID)
+      case kOptionUploadConcurrency: {
+        if (!StringToNumber(optarg, &options.upload_concurrency) ||
+            options.upload_concurrency < 1) {
+          ToolSupport::UsageHint(
+              me, "--upload-concurrency requires a positive count");
+          return ExitFailure();
+        }
+        break;
+      }
       case kOptionURL: {
         options.url = optarg;
         break;
@@ -958,6 +1048,12 @@ int HandlerMain(int argc,
         me, "--shared-client-connection requires --initial-client-fd");
     return ExitFailure();
   }
+  if (options.shared_client_concurrency != 1 &&
+      !options.shared_client_connection) {
+    ToolSupport::UsageHint(
+        me, "--shared-client-concurrency requires --shared-client-connection");
+    return ExitFailure();
+  }
 #if BUILDFLAG(IS_ANDROID)
   if (!options.write_minidump_to_log && !options.write_minidump_to_database) {
     ToolSupport::UsageHint(me,
@@ -1014,6 +1110,16 @@ int HandlerMain(int argc,
     return ExitFailure();
   }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  if (options.compress_reports && !database->SetCompressNewReports(true)) {
+    LOG(WARNING) << "database doesn't support compressed reports";
+  }
+  if (options.compression_level) {
+    database->SetCompressionLevel(*options.compression_level);
+  }
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+
   ScopedStoppable upload_thread;
   if (!options.url.empty()) {
     // TODO(scottmg): options.rate_limit should be removed when we have a
@@ -1025,6 +1131,10 @@ int HandlerMain(int argc,
     upload_thread_options.rate_limit = options.rate_limit;
     upload_thread_options.upload_gzip = options.upload_gzip;
     upload_thread_options.watch_pending_reports = options.periodic_tasks;
+    upload_thread_options.upload_concurrency = options.upload_concurrency;
+    if (options.compression_level) {
+      upload_thread_options.upload_gzip_level = *options.compression_level;
+    }
 
     upload_thread.Reset(new CrashReportUploadThread(
         database.get(),
@@ -1057,32 +1167,45 @@ int HandlerMain(int argc,
 
     exception_handler = std::move(cros_handler);
   } else {
-    exception_handler = std::make_unique<CrashReportExceptionHandler>(
-        database.get(),
-        static_cast<CrashReportUploadThread*>(upload_thread.Get()),
-        &options.annotations,
-        &options.attachments,
-        true,
-        false,
-        user_stream_sources);
+    auto crash_report_exception_handler =
+        std::make_unique<CrashReportExceptionHandler>(
+            database.get(),
+            static_cast<CrashReportUploadThread*>(upload_thread.Get()),
+            &options.annotations,
+            &options.attachments,
+            true,
+            false,
+            kZlibBestCompressionLevel,
+            user_stream_sources);
+    crash_report_exception_handler->SetModuleMetadataCachePath(
+        options.database.Append(kModuleMetadataCacheFileName));
+    exception_handler = std::move(crash_report_exception_handler);
   }
 #else
-  exception_handler = std::make_unique<CrashReportExceptionHandler>(
-      database.get(),
-      static_cast<CrashReportUploadThread*>(upload_thread.Get()),
-      &options.annotations,
+  auto crash_report_exception_handler =
+      std::make_unique<CrashReportExceptionHandler>(
+          database.get(),
+          static_cast<CrashReportUploadThread*>(upload_thread.Get()),
+          &options.annotations,
 #if defined(ATTACHMENTS_SUPPORTED)
-      &options.attachments,
+          &options.attachments,
 #endif  // ATTACHMENTS_SUPPORTED
 #if BUILDFLAG(IS_ANDROID)
-      options.write_minidump_to_database,
-      options.write_minidump_to_log,
+          options.write_minidump_to_database,
+          options.write_minidump_to_log,
+          options.compression_level.value_or(kZlibBestCompressionLevel),
 #endif  // BUILDFLAG(IS_ANDROID)
 #if BUILDFLAG(IS_LINUX)
-      true,
-      false,
+          true,
+          false,
+          kZlibBestCompressionLevel,
 #endif  // BUILDFLAG(IS_LINUX)
-      user_stream_sources);
+          user_stream_sources);
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_ANDROID)
+  crash_report_exception_handler->SetModuleMetadataCachePath(
+      options.database.Append(kModuleMetadataCacheFileName));
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_ANDROID)
+  exception_handler = std::move(crash_report_exception_handler);
 #endif  // BUILDFLAG(IS_CHROMEOS)
 
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
@@ -1160,6 +1283,8 @@ int HandlerMain(int argc,
   }
 #elif BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
   ExceptionHandlerServer exception_handler_server;
+  exception_handler_server.SetMaxConcurrentRequests(
+      options.shared_client_concurrency);
 #endif  // BUILDFLAG(IS_APPLE)
 
   base::GlobalHistogramAllocator* histogram_allocator = nullptr;
@@ -29,12 +29,14 @@ bool CaptureSnapshot(
     const std::map<std::string, std::string>& process_annotations,
     uid_t client_uid,
     VMAddress requesting_thread_stack_address,
+    ModuleMetadataCache* module_metadata_cache,
     pid_t* requesting_thread_id,
     std::unique_ptr<ProcessSnapshotLinux>* snapshot,
     std::unique_ptr<ProcessSnapshotSanitized>* sanitized_snapshot) {
   std::unique_ptr<ProcessSnapshotLinux> process_snapshot(
       new ProcessSnapshotLinux());
-  if (!process_snapshot->Initialize(connection)) {
+  if (!process_snapshot->Initialize(
+          connection, /* memory_cache_size= */ 0, module_metadata_cache)) {
     Metrics::ExceptionCaptureResult(Metrics::CaptureResult::kSnapshotFailed);
     return false;
   }
@@ -15,6 +15,7 @@
 #ifndef CRASHPAD_HANDLER_LINUX_CAPTURE_SNAPSHOT_H_
 #define CRASHPAD_HANDLER_LINUX_CAPTURE_SNAPSHOT_H_
 
+#include <stddef.h>
 #include <sys/types.h>
 
 #include <map>
@@ -29,6 +30,17 @@
 
 namespace crashpad {
 
+//! \brief The number of threads that read a captured snapshot’s memory while
+//!     its minidump is being written.
+//!
+//! Only memory that can be read on several threads at once is read ahead. See
+//! MinidumpWritable::SetReadAhead().
+constexpr size_t kMinidumpReadAheadThreadCount = 4;
+
+//! \brief The maximum number of bytes of a captured snapshot’s memory that may
+//!     be read ahead of writing it to a minidump.
+constexpr size_t kMinidumpReadAheadMemoryBudget = 16 * 1024 * 1024;
+
 //! \brief Captures a snapshot of a client over \a connection.
 //!
 //! \param[in] connection A PtraceConnection to the client to snapshot.
@@ -41,6 +53,8 @@ namespace crashpad {
 //!     address, the exception will be assigned to the thread whose stack
 //!     address range contains this address. If 0, \a requesting_thread_id will
 //!     be -1.
+//! \param[in] module_metadata_cache A cache of module metadata to use while
+//!     capturing the snapshot. Optional.
 //! \param[out] requesting_thread_id The thread ID of the thread corresponding
 //!     to \a requesting_thread_stack_address. Set to -1 if the thread ID could
 //!     not be determined. Optional.
@@ -58,6 +72,7 @@ bool CaptureSnapshot(
     const std::map<std::string, std::string>& process_annotations,
     uid_t client_uid,
     VMAddress requesting_thread_stack_address,
+    ModuleMetadataCache* module_metadata_cache,
     pid_t* requesting_thread_id,
     std::unique_ptr<ProcessSnapshotLinux>* process_snapshot,
     std::unique_ptr<ProcessSnapshotSanitized>* sanitized_snapshot);
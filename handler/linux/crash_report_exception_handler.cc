@@ -21,9 +21,12 @@
 #include "build/build_config.h"
 #include "client/settings.h"
 #include "handler/linux/capture_snapshot.h"
+#include "handler/minidump_to_upload_parameters.h"
 #include "minidump/minidump_file_writer.h"
+#include "snapshot/elf/module_metadata_cache.h"
 #include "snapshot/linux/process_snapshot_linux.h"
 #include "snapshot/sanitized/process_snapshot_sanitized.h"
+#include "util/file/buffered_file_writer.h"
 #include "util/file/file_helper.h"
 #include "util/file/file_reader.h"
 #include "util/file/output_stream_file_writer.h"
@@ -78,9 +81,12 @@ class Logger final : public LogOutputStream::Delegate {
 #endif
 };
 
-bool WriteMinidumpLogFromFile(FileReaderInterface* file_reader) {
+bool WriteMinidumpLogFromFile(FileReaderInterface* file_reader,
+                              int compression_level) {
   ZlibOutputStream stream(
       ZlibOutputStream::Mode::kCompress,
+      ZlibOutputStream::Format::kZlib,
+      compression_level,
       std::make_unique<Base94OutputStream>(
           Base94OutputStream::Mode::kEncode,
           std::make_unique<LogOutputStream>(std::make_unique<Logger>())));
@@ -106,6 +112,7 @@ CrashReportExceptionHandler::CrashReportExceptionHandler(
     const std::vector<base::FilePath>* attachments,
     bool write_minidump_to_database,
     bool write_minidump_to_log,
+    int log_compression_level,
     const UserStreamDataSources* user_stream_data_sources)
     : database_(database),
       upload_thread_(upload_thread),
@@ -113,12 +120,21 @@ CrashReportExceptionHandler::CrashReportExceptionHandler(
       attachments_(attachments),
       write_minidump_to_database_(write_minidump_to_database),
       write_minidump_to_log_(write_minidump_to_log),
-      user_stream_data_sources_(user_stream_data_sources) {
+      log_compression_level_(log_compression_level),
+      user_stream_data_sources_(user_stream_data_sources),
+      module_metadata_cache_path_(),
+      module_metadata_cache_lock_(),
+      user_streams_lock_() {
   DCHECK(write_minidump_to_database_ | write_minidump_to_log_);
 }
 
 CrashReportExceptionHandler::~CrashReportExceptionHandler() = default;
 
+void CrashReportExceptionHandler::SetModuleMetadataCachePath(
+    const base::FilePath& path) {
+  module_metadata_cache_path_ = path;
+}
+
 bool CrashReportExceptionHandler::HandleException(
     pid_t client_process_id,
     uid_t client_uid,
@@ -169,16 +185,35 @@ bool CrashReportExceptionHandler::HandleExceptionWithConnection(
     VMAddress requesting_thread_stack_address,
     pid_t* requesting_thread_id,
     UUID* local_report_id) {
+  // The cache is reloaded for each crash, because other handlers sharing the
+  // database may have updated it. Each crash gets its own copy, because
+  // several may be handled at once.
+  std::unique_ptr<ModuleMetadataCache> module_metadata_cache;
+  if (!module_metadata_cache_path_.empty()) {
+    module_metadata_cache =
+        std::make_unique<ModuleMetadataCache>(module_metadata_cache_path_);
+    std::lock_guard<std::mutex> lock(module_metadata_cache_lock_);
+    module_metadata_cache->Load();
+  }
+
   std::unique_ptr<ProcessSnapshotLinux> process_snapshot;
   std::unique_ptr<ProcessSnapshotSanitized> sanitized_snapshot;
-  if (!CaptureSnapshot(connection,
-                       info,
-                       *process_annotations_,
-                       client_uid,
-                       requesting_thread_stack_address,
-                       requesting_thread_id,
-                       &process_snapshot,
-                       &sanitized_snapshot)) {
+  const bool captured = CaptureSnapshot(connection,
+                                        info,
+                                        *process_annotations_,
+                                        client_uid,
+                                        requesting_thread_stack_address,
+                                        module_metadata_cache.get(),
+                                        requesting_thread_id,
+                                        &process_snapshot,
+                                        &sanitized_snapshot);
+
+  if (module_metadata_cache) {
+    std::lock_guard<std::mutex> lock(module_metadata_cache_lock_);
+    module_metadata_cache->Save();
+  }
+
+  if (!captured) {
     return false;
   }
 
@@ -220,19 +255,33 @@ bool CrashReportExceptionHandler::WriteMinidumpToDatabase(
 
   MinidumpFileWriter minidump;
   minidump.InitializeFromSnapshot(snapshot);
-  AddUserExtensionStreams(user_stream_data_sources_, snapshot, &minidump);
+  minidump.SetReadAhead(kMinidumpReadAheadThreadCount,
+                        kMinidumpReadAheadMemoryBudget);
+  {
+    std::lock_guard<std::mutex> lock(user_streams_lock_);
+    AddUserExtensionStreams(user_stream_data_sources_, snapshot, &minidump);
+  }
 
-  if (!minidump.WriteEverything(new_report->Writer())) {
-    LOG(ERROR) << "WriteEverything failed";
+  // A report stored compressed is compressed as it is written, so the
+  // minidump can’t seek back to finish its header.
+  BufferedFileWriter writer(new_report->ContentWriter());
+  if (!minidump.WriteMinidump(&writer, !new_report->IsCompressed()) ||
+      !writer.Flush()) {
+    LOG(ERROR) << "WriteMinidump failed";
     Metrics::ExceptionCaptureResult(
         Metrics::CaptureResult::kMinidumpWriteFailed);
     return false;
   }
 
+  // If this fails, the upload thread will recover the parameters from the
+  // minidump instead.
+  new_report->SetUploadParameters(
+      BreakpadHTTPFormParametersFromMinidump(snapshot));
+
   bool write_minidump_to_log_succeed = false;
   if (write_minidump_to_log) {
     if (auto* file_reader = new_report->Reader()) {
-      if (WriteMinidumpLogFromFile(file_reader))
+      if (WriteMinidumpLogFromFile(file_reader, log_compression_level_))
         write_minidump_to_log_succeed = true;
       else
         LOG(ERROR) << "WriteMinidumpLogFromFile failed";
@@ -289,10 +338,17 @@ bool CrashReportExceptionHandler::WriteMinidumpToLog(
                          : implicit_cast<ProcessSnapshot*>(process_snapshot);
   MinidumpFileWriter minidump;
   minidump.InitializeFromSnapshot(snapshot);
-  AddUserExtensionStreams(user_stream_data_sources_, snapshot, &minidump);
+  minidump.SetReadAhead(kMinidumpReadAheadThreadCount,
+                        kMinidumpReadAheadMemoryBudget);
+  {
+    std::lock_guard<std::mutex> lock(user_streams_lock_);
+    AddUserExtensionStreams(user_stream_data_sources_, snapshot, &minidump);
+  }
 
   OutputStreamFileWriter writer(std::make_unique<ZlibOutputStream>(
       ZlibOutputStream::Mode::kCompress,
+      ZlibOutputStream::Format::kZlib,
+      log_compression_level_,
       std::make_unique<Base94OutputStream>(
           Base94OutputStream::Mode::kEncode,
           std::make_unique<LogOutputStream>(std::make_unique<Logger>()))));
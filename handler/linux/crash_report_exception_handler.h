@@ -16,8 +16,10 @@
 #define CRASHPAD_HANDLER_LINUX_CRASH_REPORT_EXCEPTION_HANDLER_H_
 
 #include <map>
+#include <mutex>
 #include <string>
 
+#include "base/files/file_path.h"
 #include "client/crash_report_database.h"
 #include "handler/crash_report_upload_thread.h"
 #include "handler/linux/exception_handler_server.h"
@@ -34,6 +36,9 @@ class ProcessSnapshotSanitized;
 
 //! \brief An exception handler that writes crash reports for exceptions
 //!     to a CrashReportDatabase.
+//!
+//! This class is thread-safe, so it may handle several exceptions at once.
+//! Calls to the UserStreamDataSource objects it is given are serialized.
 class CrashReportExceptionHandler : public ExceptionHandlerServer::Delegate {
  public:
   //! \brief Creates a new object that will store crash reports in \a database.
@@ -58,6 +63,9 @@ class CrashReportExceptionHandler : public ExceptionHandlerServer::Delegate {
   //!     written to database.
   //! \param[in] write_minidump_to_log Whether the minidump shall be written to
   //!     log.
+  //! \param[in] log_compression_level The zlib compression level, from `0`
+  //!     to `9`, applied to minidumps written to log. Ignored if \a
+  //!     write_minidump_to_log is `false`.
   //! \param[in] user_stream_data_sources Data sources to be used to extend
   //!     crash reports. For each crash report that is written, the data sources
   //!     are called in turn. These data sources may contribute additional
@@ -69,6 +77,7 @@ class CrashReportExceptionHandler : public ExceptionHandlerServer::Delegate {
       const std::vector<base::FilePath>* attachments,
       bool write_minidump_to_database,
       bool write_minidump_to_log,
+      int log_compression_level,
       const UserStreamDataSources* user_stream_data_sources);
 
   CrashReportExceptionHandler(const CrashReportExceptionHandler&) = delete;
@@ -77,6 +86,15 @@ class CrashReportExceptionHandler : public ExceptionHandlerServer::Delegate {
 
   ~CrashReportExceptionHandler() override;
 
+  //! \brief Caches metadata parsed from crashing processes’ modules in the file
+  //!     at \a path, to be reused when handling later crashes.
+  //!
+  //! The cache is not used unless this method is called.
+  //!
+  //! \param[in] path The path of the cache file. This is conventionally in the
+  //!     database’s directory.
+  void SetModuleMetadataCachePath(const base::FilePath& path);
+
   // ExceptionHandlerServer::Delegate:
 
   bool HandleException(pid_t client_process_id,
@@ -115,7 +133,17 @@ class CrashReportExceptionHandler : public ExceptionHandlerServer::Delegate {
   const std::vector<base::FilePath>* attachments_;  // weak
   bool write_minidump_to_database_;
   bool write_minidump_to_log_;
+  int log_compression_level_;
   const UserStreamDataSources* user_stream_data_sources_;  // weak
+  base::FilePath module_metadata_cache_path_;
+
+  // Serializes loading and saving the module metadata cache. Each exception
+  // is handled with its own ModuleMetadataCache object.
+  std::mutex module_metadata_cache_lock_;
+
+  // Serializes calls to user_stream_data_sources_, which need not be
+  // thread-safe.
+  std::mutex user_streams_lock_;
 };
 
 }  // namespace crashpad
@@ -198,6 +198,7 @@ bool CrosCrashReportExceptionHandler::HandleExceptionWithConnection(
                        *process_annotations_,
                        client_uid,
                        requesting_thread_stack_address,
+                       /* module_metadata_cache= */ nullptr,
                        requesting_thread_id,
                        &process_snapshot,
                        &sanitized_snapshot)) {
@@ -225,7 +226,12 @@ bool CrosCrashReportExceptionHandler::HandleExceptionWithConnection(
 
   MinidumpFileWriter minidump;
   minidump.InitializeFromSnapshot(snapshot);
-  AddUserExtensionStreams(user_stream_data_sources_, snapshot, &minidump);
+  minidump.SetReadAhead(kMinidumpReadAheadThreadCount,
+                        kMinidumpReadAheadMemoryBudget);
+  {
+    std::lock_guard<std::mutex> lock(user_streams_lock_);
+    AddUserExtensionStreams(user_stream_data_sources_, snapshot, &minidump);
+  }
 
   FileWriter file_writer;
   if (!file_writer.OpenMemfd(base::FilePath("minidump"))) {
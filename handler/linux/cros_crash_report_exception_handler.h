@@ -18,6 +18,7 @@
 #include <sys/types.h>
 
 #include <map>
+#include <mutex>
 #include <string>
 
 #include "client/crash_report_database.h"
@@ -32,6 +33,9 @@ namespace crashpad {
 
 //! \brief An exception handler that writes crash reports to the ChromeOS
 //!     crash_reporter.
+//!
+//! This class is thread-safe, so it may handle several exceptions at once.
+//! Calls to the UserStreamDataSource objects it is given are serialized.
 class CrosCrashReportExceptionHandler
     : public ExceptionHandlerServer::Delegate {
  public:
@@ -98,6 +102,10 @@ class CrosCrashReportExceptionHandler
   const UserStreamDataSources* user_stream_data_sources_;  // weak
   base::FilePath dump_dir_;
   bool always_allow_feedback_;
+
+  // Serializes calls to user_stream_data_sources_, which need not be
+  // thread-safe.
+  std::mutex user_streams_lock_;
 };
 
 }  // namespace crashpad
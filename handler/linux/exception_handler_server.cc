@@ -23,7 +23,13 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
 #include <utility>
+#include <vector>
 
 #include "base/check_op.h"
 #include "base/compiler_specific.h"
@@ -36,6 +42,9 @@
 #include "util/linux/proc_task_reader.h"
 #include "util/linux/socket.h"
 #include "util/misc/as_underlying_type.h"
+#include "util/misc/clock.h"
+#include "util/misc/metrics.h"
+#include "util/thread/thread.h"
 
 namespace crashpad {
 
@@ -237,12 +246,188 @@ class PtraceStrategyDeciderImpl : public PtraceStrategyDecider {
 
 }  // namespace
 
+// Handles crash dump requests from clients on a shared socket on a pool of
+// worker threads.
+class ExceptionHandlerServer::RequestDispatcher {
+ public:
+  RequestDispatcher(ExceptionHandlerServer* server,
+                    size_t max_concurrent_requests)
+      : server_(server),
+        workers_(),
+        queue_(),
+        active_clients_(),
+        lock_(),
+        request_available_(),
+        space_available_(),
+        max_concurrent_requests_(max_concurrent_requests),
+        max_queued_requests_(max_concurrent_requests *
+                             kMaxQueuedRequestsPerThread),
+        stopping_(false) {}
+
+  RequestDispatcher(const RequestDispatcher&) = delete;
+  RequestDispatcher& operator=(const RequestDispatcher&) = delete;
+
+  ~RequestDispatcher() { DCHECK(workers_.empty()); }
+
+  // Queues a request to be handled by a worker thread, starting the worker
+  // threads if necessary. If the queue is full, this waits until a worker
+  // thread takes a request from it. Returns `false` without queuing the request
+  // if the client already has kMaxQueuedRequestsPerClient requests waiting.
+  bool Enqueue(const ucred& creds,
+               const ExceptionHandlerProtocol::ClientInformation& client_info,
+               VMAddress requesting_thread_stack_address) {
+    std::unique_lock<std::mutex> lock(lock_);
+    DCHECK(!stopping_);
+
+    if (workers_.empty()) {
+      for (size_t index = 0; index < max_concurrent_requests_; ++index) {
+        workers_.push_back(std::make_unique<Worker>(this));
+        workers_.back()->Start();
+      }
+    }
+
+    // Requests from one client are handled one at a time, so without a limit,
+    // a single client could fill the queue and delay requests from every other
+    // client.
+    const size_t client_requests =
+        std::count_if(queue_.begin(), queue_.end(), [&](const Request& queued) {
+          return queued.creds.pid == creds.pid;
+        });
+    if (client_requests >= kMaxQueuedRequestsPerClient) {
+      LOG(WARNING) << "too many queued requests from pid " << creds.pid;
+      return false;
+    }
+
+    // A worker thread is always handling a request while the queue is full,
+    // and signals when it takes the next one, so this wait ends. Run() only
+    // checks for Stop() between requests, so there’s no need to wake for it
+    // here.
+    space_available_.wait(
+        lock, [this]() { return queue_.size() < max_queued_requests_; });
+
+    Request& request = queue_.emplace_back();
+    request.creds = creds;
+    request.client_info = client_info;
+    request.requesting_thread_stack_address = requesting_thread_stack_address;
+    request.receive_time = ClockMonotonicNanoseconds();
+    Metrics::CrashDumpRequestQueueDepth(queue_.size());
+
+    request_available_.notify_one();
+    return true;
+  }
+
+  // Waits for requests that are being handled to complete and joins the worker
+  // threads. Clients with requests that were not started are resumed without
+  // a crash dump.
+  void StopAndJoin() {
+    std::deque<Request> abandoned;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      stopping_ = true;
+      abandoned.swap(queue_);
+    }
+    request_available_.notify_all();
+
+    for (const Request& request : abandoned) {
+      SendSIGCONT(request.creds.pid, -1);
+    }
+
+    for (auto& worker : workers_) {
+      worker->Join();
+    }
+    workers_.clear();
+  }
+
+ private:
+  struct Request {
+    ucred creds;
+    ExceptionHandlerProtocol::ClientInformation client_info;
+    VMAddress requesting_thread_stack_address;
+    uint64_t receive_time;
+  };
+
+  class Worker : public Thread {
+   public:
+    explicit Worker(RequestDispatcher* dispatcher) : dispatcher_(dispatcher) {}
+
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+
+    ~Worker() override = default;
+
+   private:
+    // Thread:
+    void ThreadMain() override { dispatcher_->RunWorker(); }
+
+    RequestDispatcher* dispatcher_;
+  };
+
+  void RunWorker() {
+    std::unique_lock<std::mutex> lock(lock_);
+    while (true) {
+      Request request;
+      while (!stopping_ && !TakeRequest(&request)) {
+        request_available_.wait(lock);
+      }
+      if (stopping_) {
+        return;
+      }
+      space_available_.notify_one();
+
+      lock.unlock();
+      pid_t requesting_thread_id = -1;
+      server_->delegate_->HandleException(
+          request.creds.pid,
+          request.creds.uid,
+          request.client_info,
+          request.requesting_thread_stack_address,
+          &requesting_thread_id);
+      SendSIGCONT(request.creds.pid, requesting_thread_id);
+      Metrics::CrashDumpRequestLatency(ClockMonotonicNanoseconds() -
+                                       request.receive_time);
+      lock.lock();
+
+      active_clients_.erase(request.creds.pid);
+    }
+  }
+
+  // Removes the first request in the queue from a client that doesn’t already
+  // have a request being handled, and marks its client as active. Returns
+  // `false` if there is no such request. lock_ must be held.
+  bool TakeRequest(Request* request) {
+    for (auto iterator = queue_.begin(); iterator != queue_.end(); ++iterator) {
+      if (active_clients_.insert(iterator->creds.pid).second) {
+        *request = *iterator;
+        queue_.erase(iterator);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  ExceptionHandlerServer* server_;  // weak
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::deque<Request> queue_;
+
+  // Processes with a request being handled by a worker thread.
+  std::set<pid_t> active_clients_;
+
+  std::mutex lock_;
+  std::condition_variable request_available_;
+  std::condition_variable space_available_;
+  const size_t max_concurrent_requests_;
+  const size_t max_queued_requests_;
+  bool stopping_;
+};
+
 ExceptionHandlerServer::ExceptionHandlerServer()
     : clients_(),
       shutdown_event_(),
       strategy_decider_(new PtraceStrategyDeciderImpl()),
+      dispatcher_(),
       delegate_(nullptr),
       pollfd_(),
+      max_concurrent_requests_(1),
       keep_running_(true) {}
 
 ExceptionHandlerServer::~ExceptionHandlerServer() = default;
@@ -252,6 +437,13 @@ void ExceptionHandlerServer::SetPtraceStrategyDecider(
   strategy_decider_ = std::move(decider);
 }
 
+void ExceptionHandlerServer::SetMaxConcurrentRequests(
+    size_t max_concurrent_requests) {
+  DCHECK_GE(max_concurrent_requests, 1u);
+  DCHECK(!delegate_);
+  max_concurrent_requests_ = max_concurrent_requests;
+}
+
 bool ExceptionHandlerServer::InitializeWithClient(ScopedFileHandle sock,
                                                   bool multiple_clients) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
@@ -295,12 +487,17 @@ void ExceptionHandlerServer::Run(Delegate* delegate) {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   delegate_ = delegate;
 
+  if (max_concurrent_requests_ > 1) {
+    dispatcher_ =
+        std::make_unique<RequestDispatcher>(this, max_concurrent_requests_);
+  }
+
   while (keep_running_ && clients_.size() > 0) {
     epoll_event poll_event;
     int res = HANDLE_EINTR(epoll_wait(pollfd_.get(), &poll_event, 1, -1));
     if (res < 0) {
       PLOG(ERROR) << "epoll_wait";
-      return;
+      break;
     }
     DCHECK_EQ(res, 1);
 
@@ -314,6 +511,11 @@ void ExceptionHandlerServer::Run(Delegate* delegate) {
       HandleEvent(eventp, poll_event.events);
     }
   }
+
+  if (dispatcher_) {
+    dispatcher_->StopAndJoin();
+    dispatcher_.reset();
+  }
 }
 
 void ExceptionHandlerServer::Stop() {
@@ -467,6 +669,14 @@ bool ExceptionHandlerServer::HandleCrashDumpRequest(
               kTypeCrashDumpFailed);
 
     case PtraceStrategyDecider::Strategy::kDirectPtrace: {
+      if (multiple_clients && dispatcher_) {
+        if (!dispatcher_->Enqueue(
+                creds, client_info, requesting_thread_stack_address)) {
+          SendSIGCONT(client_process_id, requesting_thread_id);
+        }
+        return true;
+      }
+
       delegate_->HandleException(client_process_id,
                                  client_uid,
                                  client_info,
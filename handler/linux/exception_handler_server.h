@@ -15,6 +15,7 @@
 #ifndef CRASHPAD_HANDLER_LINUX_EXCEPTION_HANDLER_SERVER_H_
 #define CRASHPAD_HANDLER_LINUX_EXCEPTION_HANDLER_SERVER_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <sys/socket.h>
 
@@ -70,6 +71,13 @@ class PtraceStrategyDecider {
 //!     process.
 class ExceptionHandlerServer {
  public:
+  //! \brief The interface that receives crash dump requests.
+  //!
+  //! If SetMaxConcurrentRequests() has been called with a value greater than 1,
+  //! HandleException() may be called on several threads at once, and at the
+  //! same time as HandleExceptionWithBroker() is called on the thread that
+  //! called Run(). Delegates used this way must be thread-safe. Otherwise, all
+  //! calls are made on the thread that called Run().
   class Delegate {
    public:
     //! \brief Called on receipt of a crash dump request from a client.
@@ -121,12 +129,48 @@ class ExceptionHandlerServer {
 
   ~ExceptionHandlerServer();
 
+  //! \brief The number of crash dump requests, per worker thread, that may wait
+  //!     to be handled before Run() stops receiving new requests.
+  //!
+  //! \sa SetMaxConcurrentRequests()
+  static constexpr size_t kMaxQueuedRequestsPerThread = 4;
+
+  //! \brief The number of crash dump requests from one client process that may
+  //!     wait to be handled.
+  //!
+  //! Further requests from the client are dropped, and the client is resumed
+  //! without a crash dump, until one of its requests is started.
+  //!
+  //! \sa SetMaxConcurrentRequests()
+  static constexpr size_t kMaxQueuedRequestsPerClient = 2;
+
   //! \brief Sets the handler's PtraceStrategyDecider.
   //!
   //! If this method is not called, a default PtraceStrategyDecider will be
   //! used.
   void SetPtraceStrategyDecider(std::unique_ptr<PtraceStrategyDecider> decider);
 
+  //! \brief Sets the maximum number of crash dump requests from clients on a
+  //!     shared socket that may be handled at once.
+  //!
+  //! By default, one request is handled at a time, on the thread that called
+  //! Run(). When \a max_concurrent_requests is greater than 1, requests that
+  //! are handled by `ptrace`-attaching the client directly are passed to a pool
+  //! of up to \a max_concurrent_requests worker threads, so Delegate methods
+  //! may be called concurrently, and the Delegate passed to Run() must be
+  //! thread-safe. Requests from the same client process are still handled one
+  //! at a time, in the order they were received. Once
+  //! #kMaxQueuedRequestsPerThread requests per worker thread are waiting to be
+  //! handled, Run() stops receiving new requests until one of them is started.
+  //! No more than #kMaxQueuedRequestsPerClient of the waiting requests may come
+  //! from the same client process, so that one client can’t fill the queue.
+  //!
+  //! This method must be called before Run().
+  //!
+  //! \param[in] max_concurrent_requests The maximum number of requests to
+  //!     handle at once. Must be at least 1.
+  void SetMaxConcurrentRequests(size_t max_concurrent_requests);
+
   //! \brief Initializes this object.
   //!
   //! This method must be successfully called before Run().
@@ -156,6 +200,8 @@ class ExceptionHandlerServer {
   void Stop();
 
  private:
+  class RequestDispatcher;
+
   struct Event {
     enum class Type {
       // Used by Stop() to shutdown the server.
@@ -186,8 +232,10 @@ class ExceptionHandlerServer {
   std::unordered_map<int, std::unique_ptr<Event>> clients_;
   std::unique_ptr<Event> shutdown_event_;
   std::unique_ptr<PtraceStrategyDecider> strategy_decider_;
+  std::unique_ptr<RequestDispatcher> dispatcher_;
   Delegate* delegate_;
   ScopedFileHandle pollfd_;
+  size_t max_concurrent_requests_;
   std::atomic<bool> keep_running_;
   InitializationStateDcheck initialized_;
 };
@@ -14,9 +14,20 @@
 
 #include "handler/linux/exception_handler_server.h"
 
+#include <poll.h>
+#include <stdlib.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "base/posix/eintr_wrapper.h"
 #include "build/build_config.h"
 #include "gtest/gtest.h"
 #include "snapshot/linux/process_snapshot_linux.h"
@@ -26,6 +37,7 @@
 #include "util/linux/exception_handler_client.h"
 #include "util/linux/ptrace_client.h"
 #include "util/linux/scoped_pr_set_ptracer.h"
+#include "util/linux/socket.h"
 #include "util/misc/uuid.h"
 #include "util/synchronization/semaphore.h"
 #include "util/thread/thread.h"
@@ -368,6 +380,12 @@ TEST_P(ExceptionHandlerServerTest, RequestCrashDumpDirectPtrace) {
                                true);
 }
 
+TEST_P(ExceptionHandlerServerTest, RequestCrashDumpConcurrent) {
+  Server()->SetMaxConcurrentRequests(4);
+  ExpectCrashDumpUsingStrategy(PtraceStrategyDecider::Strategy::kDirectPtrace,
+                               true);
+}
+
 TEST_P(ExceptionHandlerServerTest, RequestCrashDumpError) {
   ExpectCrashDumpUsingStrategy(PtraceStrategyDecider::Strategy::kError, false);
 }
@@ -377,6 +395,331 @@ INSTANTIATE_TEST_SUITE_P(ExceptionHandlerServerTestSuite,
                          testing::Bool()
 );
 
+// Holds each crash dump request until Release() is called, recording how many
+// requests are handled at once.
+class BlockingDelegate : public ExceptionHandlerServer::Delegate {
+ public:
+  BlockingDelegate()
+      : Delegate(),
+        active_clients_(),
+        lock_(),
+        changed_(),
+        started_(0),
+        finished_(0),
+        active_(0),
+        max_active_(0),
+        client_overlapped_(false),
+        released_(false) {}
+
+  BlockingDelegate(const BlockingDelegate&) = delete;
+  BlockingDelegate& operator=(const BlockingDelegate&) = delete;
+
+  ~BlockingDelegate() {}
+
+  // Allows requests that have been started, and any started later, to finish.
+  void Release() {
+    std::lock_guard<std::mutex> lock(lock_);
+    released_ = true;
+    changed_.notify_all();
+  }
+
+  bool WaitForStarted(size_t count, double timeout_seconds) {
+    std::unique_lock<std::mutex> lock(lock_);
+    return changed_.wait_for(
+        lock, std::chrono::duration<double>(timeout_seconds), [&]() {
+          return started_ >= count;
+        });
+  }
+
+  bool WaitForFinished(size_t count, double timeout_seconds) {
+    std::unique_lock<std::mutex> lock(lock_);
+    return changed_.wait_for(
+        lock, std::chrono::duration<double>(timeout_seconds), [&]() {
+          return finished_ >= count;
+        });
+  }
+
+  // The largest number of requests that were handled at once.
+  size_t MaxActive() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return max_active_;
+  }
+
+  // Whether two requests from the same client were handled at once.
+  bool ClientOverlapped() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return client_overlapped_;
+  }
+
+  bool HandleException(pid_t client_process_id,
+                       uid_t client_uid,
+                       const ExceptionHandlerProtocol::ClientInformation& info,
+                       VMAddress requesting_thread_stack_address,
+                       pid_t* requesting_thread_id = nullptr,
+                       UUID* local_report_id = nullptr) override {
+    std::unique_lock<std::mutex> lock(lock_);
+    if (active_clients_[client_process_id]++ > 0) {
+      client_overlapped_ = true;
+    }
+    ++started_;
+    max_active_ = std::max(max_active_, ++active_);
+    changed_.notify_all();
+
+    EXPECT_TRUE(changed_.wait_for(
+        lock, std::chrono::seconds(5), [this]() { return released_; }));
+
+    --active_clients_[client_process_id];
+    --active_;
+    ++finished_;
+    changed_.notify_all();
+
+    if (requesting_thread_id) {
+      *requesting_thread_id = -1;
+    }
+    return true;
+  }
+
+  bool HandleExceptionWithBroker(
+      pid_t client_process_id,
+      uid_t client_uid,
+      const ExceptionHandlerProtocol::ClientInformation& info,
+      int broker_sock,
+      UUID* local_report_id = nullptr) override {
+    ADD_FAILURE();
+    return false;
+  }
+
+ private:
+  // The number of requests being handled for each client.
+  std::map<pid_t, size_t> active_clients_;
+
+  std::mutex lock_;
+  std::condition_variable changed_;
+  size_t started_;
+  size_t finished_;
+  size_t active_;
+  size_t max_active_;
+  bool client_overlapped_;
+  bool released_;
+};
+
+class ExceptionHandlerServerConcurrencyTest : public testing::Test {
+ public:
+  ExceptionHandlerServerConcurrencyTest()
+      : server_(),
+        delegate_(),
+        server_thread_(&server_, &delegate_),
+        sock_to_handler_() {}
+
+  ExceptionHandlerServerConcurrencyTest(
+      const ExceptionHandlerServerConcurrencyTest&) = delete;
+  ExceptionHandlerServerConcurrencyTest& operator=(
+      const ExceptionHandlerServerConcurrencyTest&) = delete;
+
+  ~ExceptionHandlerServerConcurrencyTest() = default;
+
+ protected:
+  static constexpr size_t kMaxConcurrentRequests = 3;
+
+  void SetUp() override {
+    int socks[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, socks), 0);
+    sock_to_handler_.reset(socks[0]);
+
+    server_.SetPtraceStrategyDecider(
+        std::make_unique<MockPtraceStrategyDecider>(
+            PtraceStrategyDecider::Strategy::kDirectPtrace));
+    server_.SetMaxConcurrentRequests(kMaxConcurrentRequests);
+    ASSERT_TRUE(server_.InitializeWithClient(ScopedFileHandle(socks[1]),
+                                             /* multiple_clients= */ true));
+  }
+
+  // Sends a message from this process without waiting for a response.
+  void SendMessage(
+      ExceptionHandlerProtocol::ClientToServerMessage::Type type) {
+    ExceptionHandlerProtocol::ClientToServerMessage message;
+    message.type = type;
+    message.requesting_thread_stack_address = 0;
+    ASSERT_EQ(UnixCredentialSocket::SendMsg(
+                  sock_to_handler_.get(), &message, sizeof(message)),
+              0);
+  }
+
+  // Returns `true` if the server responds to this process within the timeout.
+  bool WaitForResponse(int timeout_ms) {
+    pollfd poll_fd = {};
+    poll_fd.fd = sock_to_handler_.get();
+    poll_fd.events = POLLIN;
+    int res = HANDLE_EINTR(poll(&poll_fd, 1, timeout_ms));
+    EXPECT_GE(res, 0) << ErrnoMessage("poll");
+    return res > 0;
+  }
+
+  ExceptionHandlerServer server_;
+  BlockingDelegate delegate_;
+  RunServerThread server_thread_;
+  ScopedFileHandle sock_to_handler_;
+};
+
+TEST_F(ExceptionHandlerServerConcurrencyTest, ClientsHandledConcurrently) {
+  ScopedStopServerAndJoinThread stop_server(&server_, &server_thread_);
+  server_thread_.Start();
+
+  std::vector<pid_t> children;
+  for (size_t index = 0; index < kMaxConcurrentRequests; ++index) {
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0) << ErrnoMessage("fork");
+    if (pid == 0) {
+      ExceptionHandlerClient client(sock_to_handler_.get(), true);
+      ExceptionHandlerProtocol::ClientInformation info;
+      _exit(client.RequestCrashDump(info) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    children.push_back(pid);
+  }
+
+  // Every client’s request is started before any of them finishes.
+  EXPECT_TRUE(delegate_.WaitForStarted(kMaxConcurrentRequests, 5.0));
+  EXPECT_EQ(delegate_.MaxActive(), kMaxConcurrentRequests);
+  delegate_.Release();
+
+  for (pid_t child : children) {
+    int status;
+    ASSERT_EQ(HANDLE_EINTR(waitpid(child, &status, 0)), child)
+        << ErrnoMessage("waitpid");
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), EXIT_SUCCESS);
+  }
+  EXPECT_FALSE(delegate_.ClientOverlapped());
+}
+
+TEST_F(ExceptionHandlerServerConcurrencyTest, ClientRequestsSerialized) {
+  ScopedStopServerAndJoinThread stop_server(&server_, &server_thread_);
+  server_thread_.Start();
+
+  // Wait for the first request to start, so that the rest stay within the
+  // per-client queue limit.
+  constexpr size_t kRequests =
+      ExceptionHandlerServer::kMaxQueuedRequestsPerClient + 1;
+  SendMessage(
+      ExceptionHandlerProtocol::ClientToServerMessage::kTypeCrashDumpRequest);
+  ASSERT_TRUE(delegate_.WaitForStarted(1, 5.0));
+  for (size_t index = 1; index < kRequests; ++index) {
+    SendMessage(
+        ExceptionHandlerProtocol::ClientToServerMessage::kTypeCrashDumpRequest);
+  }
+
+  // Worker threads are available, but the later requests from this process
+  // wait for the first to finish.
+  EXPECT_FALSE(delegate_.WaitForStarted(2, 0.2));
+  delegate_.Release();
+
+  EXPECT_TRUE(delegate_.WaitForFinished(kRequests, 5.0));
+  EXPECT_EQ(delegate_.MaxActive(), 1u);
+  EXPECT_FALSE(delegate_.ClientOverlapped());
+}
+
+TEST_F(ExceptionHandlerServerConcurrencyTest, QueueLimit) {
+  ScopedStopServerAndJoinThread stop_server(&server_, &server_thread_);
+  server_thread_.Start();
+
+  // Each child process sends as many requests as a client may have queued, and
+  // exits without waiting for them. There are enough requests to keep every
+  // worker thread busy, fill the queue, and have one more that can’t be
+  // queued.
+  constexpr size_t kMaxQueuedRequests =
+      kMaxConcurrentRequests *
+      ExceptionHandlerServer::kMaxQueuedRequestsPerThread;
+  constexpr size_t kRequestsPerChild =
+      ExceptionHandlerServer::kMaxQueuedRequestsPerClient;
+  constexpr size_t kChildren =
+      (kMaxConcurrentRequests + kMaxQueuedRequests) / kRequestsPerChild + 1;
+  constexpr size_t kRequests = kChildren * kRequestsPerChild;
+  static_assert(kRequests > kMaxConcurrentRequests + kMaxQueuedRequests);
+
+  std::vector<pid_t> children;
+  for (size_t index = 0; index < kChildren; ++index) {
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0) << ErrnoMessage("fork");
+    if (pid == 0) {
+      for (size_t request = 0; request < kRequestsPerChild; ++request) {
+        SendMessage(ExceptionHandlerProtocol::ClientToServerMessage::
+                        kTypeCrashDumpRequest);
+      }
+      _exit(EXIT_SUCCESS);
+    }
+    children.push_back(pid);
+  }
+
+  // Wait for the children to exit without reaping them, so that their process
+  // IDs aren’t reused while the server still has requests from them.
+  for (pid_t child : children) {
+    siginfo_t siginfo;
+    ASSERT_EQ(HANDLE_EINTR(waitid(P_PID, child, &siginfo, WEXITED | WNOWAIT)),
+              0)
+        << ErrnoMessage("waitid");
+  }
+  ASSERT_TRUE(delegate_.WaitForStarted(kMaxConcurrentRequests, 5.0));
+
+  // The server stops receiving messages while the queue is full, so it doesn’t
+  // respond to a credentials check until a queued request is started.
+  SendMessage(
+      ExceptionHandlerProtocol::ClientToServerMessage::kTypeCheckCredentials);
+  EXPECT_FALSE(WaitForResponse(200));
+
+  delegate_.Release();
+  ASSERT_TRUE(WaitForResponse(5000));
+  ExceptionHandlerProtocol::ServerToClientMessage response;
+  ASSERT_TRUE(LoggingReadFileExactly(
+      sock_to_handler_.get(), &response, sizeof(response)));
+  EXPECT_EQ(response.type,
+            ExceptionHandlerProtocol::ServerToClientMessage::kTypeCredentials);
+
+  EXPECT_TRUE(delegate_.WaitForFinished(kRequests, 5.0));
+  EXPECT_EQ(delegate_.MaxActive(), kMaxConcurrentRequests);
+  EXPECT_FALSE(delegate_.ClientOverlapped());
+
+  for (pid_t child : children) {
+    int status;
+    ASSERT_EQ(HANDLE_EINTR(waitpid(child, &status, 0)), child)
+        << ErrnoMessage("waitpid");
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), EXIT_SUCCESS);
+  }
+}
+
+TEST_F(ExceptionHandlerServerConcurrencyTest, ClientQueueLimit) {
+  ScopedStopServerAndJoinThread stop_server(&server_, &server_thread_);
+  server_thread_.Start();
+
+  // The first request is started, the next ones fill this process’ share of the
+  // queue, and the last is dropped.
+  SendMessage(
+      ExceptionHandlerProtocol::ClientToServerMessage::kTypeCrashDumpRequest);
+  ASSERT_TRUE(delegate_.WaitForStarted(1, 5.0));
+  constexpr size_t kAcceptedRequests =
+      ExceptionHandlerServer::kMaxQueuedRequestsPerClient + 1;
+  for (size_t index = 1; index <= kAcceptedRequests; ++index) {
+    SendMessage(
+        ExceptionHandlerProtocol::ClientToServerMessage::kTypeCrashDumpRequest);
+  }
+
+  // Dropping the last request doesn’t stop the server from receiving messages,
+  // even though the handler is still busy with the first.
+  SendMessage(
+      ExceptionHandlerProtocol::ClientToServerMessage::kTypeCheckCredentials);
+  ASSERT_TRUE(WaitForResponse(5000));
+  ExceptionHandlerProtocol::ServerToClientMessage response;
+  ASSERT_TRUE(LoggingReadFileExactly(
+      sock_to_handler_.get(), &response, sizeof(response)));
+  EXPECT_EQ(response.type,
+            ExceptionHandlerProtocol::ServerToClientMessage::kTypeCredentials);
+
+  delegate_.Release();
+  EXPECT_TRUE(delegate_.WaitForFinished(kAcceptedRequests, 5.0));
+  EXPECT_FALSE(delegate_.WaitForFinished(kAcceptedRequests + 1, 0.2));
+  EXPECT_EQ(delegate_.MaxActive(), 1u);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
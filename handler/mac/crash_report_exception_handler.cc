@@ -24,10 +24,12 @@
 #include "base/strings/stringprintf.h"
 #include "client/settings.h"
 #include "handler/mac/file_limit_annotation.h"
+#include "handler/minidump_to_upload_parameters.h"
 #include "minidump/minidump_file_writer.h"
 #include "minidump/minidump_user_extension_stream_data_source.h"
 #include "snapshot/crashpad_info_client_options.h"
 #include "snapshot/mac/process_snapshot_mac.h"
+#include "util/file/buffered_file_writer.h"
 #include "util/file/file_helper.h"
 #include "util/file/file_io.h"
 #include "util/file/file_reader.h"
@@ -190,12 +192,18 @@ kern_return_t CrashReportExceptionHandler::CatchMachException(
       CopyFileContent(&reader, writer);
     }
 
-    if (!minidump.WriteEverything(new_report->Writer())) {
+    BufferedFileWriter writer(new_report->Writer());
+    if (!minidump.WriteEverything(&writer) || !writer.Flush()) {
       Metrics::ExceptionCaptureResult(
           Metrics::CaptureResult::kMinidumpWriteFailed);
       return KERN_FAILURE;
     }
 
+    // If this fails, the upload thread will recover the parameters from the
+    // minidump instead.
+    new_report->SetUploadParameters(
+        BreakpadHTTPFormParametersFromMinidump(&process_snapshot));
+
     UUID uuid;
     database_status =
         database_->FinishedWritingCrashReport(std::move(new_report), &uuid);
@@ -14,10 +14,26 @@
 
 #include "handler/minidump_to_upload_parameters.h"
 
+#include <windows.h>
+#include <dbghelp.h>
+#include <stddef.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "base/logging.h"
 #include "client/annotation.h"
+#include "minidump/minidump_extensions.h"
+#include "snapshot/annotation_snapshot.h"
+#include "snapshot/minidump/minidump_annotation_reader.h"
+#include "snapshot/minidump/minidump_simple_string_dictionary_reader.h"
+#include "snapshot/minidump/minidump_string_list_reader.h"
 #include "snapshot/module_snapshot.h"
 #include "snapshot/process_snapshot.h"
+#include "util/file/file_reader.h"
+#include "util/file/gzip_file_reader.h"
+#include "util/misc/uuid.h"
 #include "util/stdlib/map_insert.h"
 
 namespace crashpad {
@@ -34,28 +50,33 @@ void InsertOrReplaceMapEntry(std::map<std::string, std::string>* map,
   }
 }
 
-}  // namespace
+// Accumulates upload parameters from the process and its modules, applying the
+// precedence rules described for BreakpadHTTPFormParametersFromMinidump().
+class UploadParametersBuilder {
+ public:
+  explicit UploadParametersBuilder(
+      const std::map<std::string, std::string>& process_simple_map)
+      : parameters_(process_simple_map), list_annotations_() {}
 
-std::map<std::string, std::string> BreakpadHTTPFormParametersFromMinidump(
-    const ProcessSnapshot* process_snapshot) {
-  std::map<std::string, std::string> parameters =
-      process_snapshot->AnnotationsSimpleMap();
+  UploadParametersBuilder(const UploadParametersBuilder&) = delete;
+  UploadParametersBuilder& operator=(const UploadParametersBuilder&) = delete;
 
-  std::string list_annotations;
-  for (const ModuleSnapshot* module : process_snapshot->Modules()) {
-    for (const auto& kv : module->AnnotationsSimpleMap()) {
-      if (!parameters.insert(kv).second) {
+  void AddModule(const std::map<std::string, std::string>& simple_map,
+                 const std::vector<std::string>& annotations_vector,
+                 const std::vector<AnnotationSnapshot>& annotation_objects) {
+    for (const auto& kv : simple_map) {
+      if (!parameters_.insert(kv).second) {
         LOG(WARNING) << "duplicate key " << kv.first << ", discarding value "
                      << kv.second;
       }
     }
 
-    for (const std::string& annotation : module->AnnotationsVector()) {
-      list_annotations.append(annotation);
-      list_annotations.append("\n");
+    for (const std::string& annotation : annotations_vector) {
+      list_annotations_.append(annotation);
+      list_annotations_.append("\n");
     }
 
-    for (const AnnotationSnapshot& annotation : module->AnnotationObjects()) {
+    for (const AnnotationSnapshot& annotation : annotation_objects) {
       if (annotation.type != static_cast<uint16_t>(Annotation::Type::kString)) {
         continue;
       }
@@ -63,25 +84,303 @@ std::map<std::string, std::string> BreakpadHTTPFormParametersFromMinidump(
       std::string value(reinterpret_cast<const char*>(annotation.value.data()),
                         annotation.value.size());
       std::pair<std::string, std::string> entry(annotation.name, value);
-      if (!parameters.insert(entry).second) {
+      if (!parameters_.insert(entry).second) {
         LOG(WARNING) << "duplicate annotation name " << annotation.name
                      << ", discarding value " << value;
       }
     }
   }
 
-  if (!list_annotations.empty()) {
-    // Remove the final newline character.
-    list_annotations.resize(list_annotations.size() - 1);
+  std::map<std::string, std::string> Finish(const UUID& client_id) {
+    if (!list_annotations_.empty()) {
+      // Remove the final newline character.
+      list_annotations_.resize(list_annotations_.size() - 1);
+
+      InsertOrReplaceMapEntry(
+          &parameters_, "list_annotations", list_annotations_);
+    }
+
+    InsertOrReplaceMapEntry(&parameters_, "guid", client_id.ToString());
+
+    return std::move(parameters_);
+  }
+
+ private:
+  std::map<std::string, std::string> parameters_;
+  std::string list_annotations_;
+};
+
+// The remaining functions read only as much of a minidump file as is needed to
+// build the upload parameters. They apply the same validation as
+// ProcessSnapshotMinidump to the structures that they read, so that they
+// succeed and fail in the same cases.
+
+bool ReadStreamDirectory(
+    FileReaderInterface* file_reader,
+    std::map<uint32_t, MINIDUMP_LOCATION_DESCRIPTOR>* streams) {
+  MINIDUMP_HEADER header;
+  if (!file_reader->ReadExactly(&header, sizeof(header))) {
+    return false;
+  }
+
+  if (header.Signature != MINIDUMP_SIGNATURE) {
+    LOG(ERROR) << "minidump signature mismatch";
+    return false;
+  }
+
+  if (header.Version != MINIDUMP_VERSION) {
+    LOG(ERROR) << "minidump version mismatch";
+    return false;
+  }
+
+  if (!file_reader->SeekSet(header.StreamDirectoryRva)) {
+    return false;
+  }
+
+  std::vector<MINIDUMP_DIRECTORY> directory(header.NumberOfStreams);
+  if (!directory.empty() &&
+      !file_reader->ReadExactly(
+          &directory[0], header.NumberOfStreams * sizeof(directory[0]))) {
+    return false;
+  }
+
+  for (const MINIDUMP_DIRECTORY& entry : directory) {
+    if (!streams->insert(std::make_pair(entry.StreamType, entry.Location))
+             .second) {
+      LOG(ERROR) << "duplicate streams for type " << entry.StreamType;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ReadCrashpadInfo(FileReaderInterface* file_reader,
+                      const MINIDUMP_LOCATION_DESCRIPTOR& location,
+                      MinidumpCrashpadInfo* crashpad_info) {
+  // None of the fields following `reserved` are needed.
+  constexpr size_t crashpad_info_min_size =
+      offsetof(MinidumpCrashpadInfo, reserved);
+  if (location.DataSize < crashpad_info_min_size) {
+    LOG(ERROR) << "crashpad_info size mismatch";
+    return false;
+  }
+
+  if (!file_reader->SeekSet(location.Rva) ||
+      !file_reader->ReadExactly(crashpad_info, crashpad_info_min_size)) {
+    return false;
+  }
+
+  if (crashpad_info->version != MinidumpCrashpadInfo::kVersion) {
+    LOG(ERROR) << "crashpad_info version mismatch";
+    return false;
+  }
+
+  return true;
+}
+
+bool ReadModuleCrashpadInfoLinks(
+    FileReaderInterface* file_reader,
+    const MINIDUMP_LOCATION_DESCRIPTOR& location,
+    std::map<uint32_t, MINIDUMP_LOCATION_DESCRIPTOR>* links) {
+  if (location.Rva == 0) {
+    return true;
+  }
 
-    InsertOrReplaceMapEntry(&parameters, "list_annotations", list_annotations);
+  if (location.DataSize < sizeof(MinidumpModuleCrashpadInfoList)) {
+    LOG(ERROR) << "module_crashpad_info_list size mismatch";
+    return false;
+  }
+
+  if (!file_reader->SeekSet(location.Rva)) {
+    return false;
+  }
+
+  uint32_t count;
+  if (!file_reader->ReadExactly(&count, sizeof(count))) {
+    return false;
+  }
+
+  if (location.DataSize != sizeof(MinidumpModuleCrashpadInfoList) +
+                               count * sizeof(MinidumpModuleCrashpadInfoLink)) {
+    LOG(ERROR) << "module_crashpad_info_list size mismatch";
+    return false;
+  }
+
+  std::unique_ptr<MinidumpModuleCrashpadInfoLink[]> minidump_links(
+      new MinidumpModuleCrashpadInfoLink[count]);
+  if (!file_reader->ReadExactly(
+          &minidump_links[0], count * sizeof(MinidumpModuleCrashpadInfoLink))) {
+    return false;
+  }
+
+  for (uint32_t index = 0; index < count; ++index) {
+    const MinidumpModuleCrashpadInfoLink& minidump_link = minidump_links[index];
+    if (!links
+             ->insert(std::make_pair(minidump_link.minidump_module_list_index,
+                                     minidump_link.location))
+             .second) {
+      LOG(WARNING)
+          << "duplicate module_crashpad_info_list minidump_module_list_index "
+          << minidump_link.minidump_module_list_index;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ReadModuleCount(FileReaderInterface* file_reader,
+                     const MINIDUMP_LOCATION_DESCRIPTOR& location,
+                     uint32_t* module_count) {
+  if (location.DataSize < sizeof(MINIDUMP_MODULE_LIST)) {
+    LOG(ERROR) << "module_list size mismatch";
+    return false;
+  }
+
+  if (!file_reader->SeekSet(location.Rva) ||
+      !file_reader->ReadExactly(module_count, sizeof(*module_count))) {
+    return false;
+  }
+
+  if (sizeof(MINIDUMP_MODULE_LIST) + *module_count * sizeof(MINIDUMP_MODULE) !=
+      location.DataSize) {
+    LOG(ERROR) << "module_list size mismatch";
+    return false;
+  }
+
+  return true;
+}
+
+bool ReadModuleAnnotations(FileReaderInterface* file_reader,
+                           const MINIDUMP_LOCATION_DESCRIPTOR& location,
+                           UploadParametersBuilder* builder) {
+  if (location.Rva == 0) {
+    return true;
+  }
+
+  MinidumpModuleCrashpadInfo module_crashpad_info;
+  if (location.DataSize < sizeof(module_crashpad_info)) {
+    LOG(ERROR) << "minidump_module_crashpad_info size mismatch";
+    return false;
+  }
+
+  if (!file_reader->SeekSet(location.Rva) ||
+      !file_reader->ReadExactly(&module_crashpad_info,
+                                sizeof(module_crashpad_info))) {
+    return false;
+  }
+
+  if (module_crashpad_info.version != MinidumpModuleCrashpadInfo::kVersion) {
+    LOG(ERROR) << "minidump_module_crashpad_info version mismatch";
+    return false;
+  }
+
+  std::vector<std::string> annotations_vector;
+  std::map<std::string, std::string> simple_map;
+  std::vector<AnnotationSnapshot> annotation_objects;
+  if (!internal::ReadMinidumpStringList(file_reader,
+                                        module_crashpad_info.list_annotations,
+                                        &annotations_vector) ||
+      !internal::ReadMinidumpSimpleStringDictionary(
+          file_reader,
+          module_crashpad_info.simple_annotations,
+          &simple_map) ||
+      !internal::ReadMinidumpAnnotationList(
+          file_reader,
+          module_crashpad_info.annotation_objects,
+          &annotation_objects)) {
+    return false;
+  }
+
+  builder->AddModule(simple_map, annotations_vector, annotation_objects);
+  return true;
+}
+
+}  // namespace
+
+std::map<std::string, std::string> BreakpadHTTPFormParametersFromMinidump(
+    const ProcessSnapshot* process_snapshot) {
+  UploadParametersBuilder builder(process_snapshot->AnnotationsSimpleMap());
+  for (const ModuleSnapshot* module : process_snapshot->Modules()) {
+    builder.AddModule(module->AnnotationsSimpleMap(),
+                      module->AnnotationsVector(),
+                      module->AnnotationObjects());
   }
 
   UUID client_id;
   process_snapshot->ClientID(&client_id);
-  InsertOrReplaceMapEntry(&parameters, "guid", client_id.ToString());
+  return builder.Finish(client_id);
+}
+
+bool BreakpadHTTPFormParametersFromMinidumpFile(
+    FileReaderInterface* file_reader,
+    std::map<std::string, std::string>* parameters) {
+  if (!file_reader->SeekSet(0)) {
+    return false;
+  }
+
+  std::unique_ptr<GzipFileReader> gzip_file_reader;
+  if (GzipFileReader::IsGzip(file_reader)) {
+    gzip_file_reader = std::make_unique<GzipFileReader>();
+    if (!gzip_file_reader->Initialize(file_reader)) {
+      return false;
+    }
+    file_reader = gzip_file_reader.get();
+  }
+
+  std::map<uint32_t, MINIDUMP_LOCATION_DESCRIPTOR> streams;
+  if (!ReadStreamDirectory(file_reader, &streams)) {
+    return false;
+  }
+
+  MinidumpCrashpadInfo crashpad_info;
+  std::map<std::string, std::string> process_simple_map;
+  const auto crashpad_info_it = streams.find(kMinidumpStreamTypeCrashpadInfo);
+  if (crashpad_info_it != streams.end()) {
+    if (!ReadCrashpadInfo(
+            file_reader, crashpad_info_it->second, &crashpad_info) ||
+        !internal::ReadMinidumpSimpleStringDictionary(
+            file_reader,
+            crashpad_info.simple_annotations,
+            &process_simple_map)) {
+      return false;
+    }
+  }
+
+  UploadParametersBuilder builder(process_simple_map);
+
+  const auto module_list_it = streams.find(kMinidumpStreamTypeModuleList);
+  if (module_list_it != streams.end()) {
+    // As with ProcessSnapshotMinidump, a module list can only be interpreted
+    // along with the Crashpad information stream.
+    if (crashpad_info_it == streams.end()) {
+      LOG(ERROR) << "module_list without crashpad_info";
+      return false;
+    }
+
+    std::map<uint32_t, MINIDUMP_LOCATION_DESCRIPTOR> links;
+    uint32_t module_count;
+    if (!ReadModuleCrashpadInfoLinks(
+            file_reader, crashpad_info.module_list, &links) ||
+        !ReadModuleCount(file_reader, module_list_it->second, &module_count)) {
+      return false;
+    }
+
+    // Modules without a link contribute no annotations, so only the linked
+    // modules are visited, in module list order.
+    for (const auto& link : links) {
+      if (link.first >= module_count) {
+        break;
+      }
+      if (!ReadModuleAnnotations(file_reader, link.second, &builder)) {
+        return false;
+      }
+    }
+  }
 
-  return parameters;
+  *parameters = builder.Finish(crashpad_info.client_id);
+  return true;
 }
 
 }  // namespace crashpad
@@ -20,6 +20,7 @@
 
 namespace crashpad {
 
+class FileReaderInterface;
 class ProcessSnapshot;
 
 //! \brief Given a ProcessSnapshot, returns a map of key-value pairs to use as
@@ -56,6 +57,26 @@ class ProcessSnapshot;
 std::map<std::string, std::string> BreakpadHTTPFormParametersFromMinidump(
     const ProcessSnapshot* process_snapshot);
 
+//! \brief Reads a minidump file and returns a map of key-value pairs to use as
+//!     HTTP form parameters for upload to a Breakpad crash report collection
+//!     server.
+//!
+//! This produces the same map as BreakpadHTTPFormParametersFromMinidump()
+//! would for a ProcessSnapshotMinidump initialized from \a file_reader, but
+//! only reads the stream directory, the Crashpad information stream, the
+//! module list, and the annotations that these refer to. Other streams, such
+//! as thread stacks and memory, are neither read nor validated, so this is
+//! much faster for large minidumps.
+//!
+//! \param[in] file_reader A file reader positioned anywhere in a minidump file,
+//!     which may be gzip-compressed.
+//! \param[out] parameters A string map of the annotations.
+//!
+//! \return `true` on success. `false` on failure, with a message logged.
+bool BreakpadHTTPFormParametersFromMinidumpFile(
+    FileReaderInterface* file_reader,
+    std::map<std::string, std::string>* parameters);
+
 }  // namespace crashpad
 
 #endif  // HANDLER_MINIDUMP_TO_UPLOAD_PARAMETERS_H_
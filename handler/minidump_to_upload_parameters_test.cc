@@ -15,22 +15,25 @@
 #include "handler/minidump_to_upload_parameters.h"
 
 #include "gtest/gtest.h"
+#include "minidump/minidump_file_writer.h"
+#include "snapshot/minidump/process_snapshot_minidump.h"
 #include "snapshot/test/test_module_snapshot.h"
 #include "snapshot/test/test_process_snapshot.h"
+#include "snapshot/test/test_system_snapshot.h"
+#include "util/file/string_file.h"
 #include "util/misc/uuid.h"
 
 namespace crashpad {
 namespace test {
 namespace {
 
-TEST(MinidumpToUploadParameters, PrecedenceRules) {
-  const std::string guid = "00112233-4455-6677-8899-aabbccddeeff";
-  UUID uuid;
-  ASSERT_TRUE(uuid.InitializeFromString(guid));
+constexpr char kGUID[] = "00112233-4455-6677-8899-aabbccddeeff";
 
-  TestProcessSnapshot process_snapshot;
-  process_snapshot.SetClientID(uuid);
-  process_snapshot.SetAnnotationsSimpleMap({
+void InitializeProcessSnapshot(TestProcessSnapshot* process_snapshot) {
+  UUID uuid;
+  ASSERT_TRUE(uuid.InitializeFromString(kGUID));
+  process_snapshot->SetClientID(uuid);
+  process_snapshot->SetAnnotationsSimpleMap({
       {"process-1", "abcdefg"},
       {"list_annotations", "BAD: process_annotations"},
       {"guid", "BAD: process_annotations"},
@@ -55,7 +58,7 @@ TEST(MinidumpToUploadParameters, PrecedenceRules) {
       {"list_annotations", 1, {'B', 'A', 'D', '*', '0', '-', '1'}},
       {"first", 1, {'B', 'A', 'D', '*', '0', '-', '2'}},
   });
-  process_snapshot.AddModule(std::move(module_snapshot_0));
+  process_snapshot->AddModule(std::move(module_snapshot_0));
 
   auto module_snapshot_1 = std::make_unique<TestModuleSnapshot>();
   module_snapshot_1->SetAnnotationsVector(
@@ -74,24 +77,80 @@ TEST(MinidumpToUploadParameters, PrecedenceRules) {
       {"list_annotations", 1, {'B', 'A', 'D', '*', '1', '-', '1'}},
       {"second", 1, {'B', 'A', 'D', '*', '1', '-', '2'}},
   });
-  process_snapshot.AddModule(std::move(module_snapshot_1));
+  process_snapshot->AddModule(std::move(module_snapshot_1));
+}
 
-  auto upload_parameters =
-      BreakpadHTTPFormParametersFromMinidump(&process_snapshot);
+void ExpectUploadParameters(
+    const std::map<std::string, std::string>& upload_parameters) {
 
   EXPECT_EQ(upload_parameters.size(), 10u);
-  EXPECT_EQ(upload_parameters["process-1"], "abcdefg");
-  EXPECT_EQ(upload_parameters["first"], "process");
-  EXPECT_EQ(upload_parameters["module-0-1"], "goat");
-  EXPECT_EQ(upload_parameters["module-0-2"], "doge");
-  EXPECT_EQ(upload_parameters["module-0-3"], "star");
-  EXPECT_EQ(upload_parameters["second"], "module 0");
-  EXPECT_EQ(upload_parameters["module-1-1"], "bear");
-  EXPECT_EQ(upload_parameters["module-1-4"], "moon");
-  EXPECT_EQ(upload_parameters["list_annotations"],
+  EXPECT_EQ(upload_parameters.at("process-1"), "abcdefg");
+  EXPECT_EQ(upload_parameters.at("first"), "process");
+  EXPECT_EQ(upload_parameters.at("module-0-1"), "goat");
+  EXPECT_EQ(upload_parameters.at("module-0-2"), "doge");
+  EXPECT_EQ(upload_parameters.at("module-0-3"), "star");
+  EXPECT_EQ(upload_parameters.at("second"), "module 0");
+  EXPECT_EQ(upload_parameters.at("module-1-1"), "bear");
+  EXPECT_EQ(upload_parameters.at("module-1-4"), "moon");
+  EXPECT_EQ(upload_parameters.at("list_annotations"),
             "list-module-0-1\nlist-module-0-2\n"
             "list-module-1-1\nlist-module-1-2");
-  EXPECT_EQ(upload_parameters["guid"], guid);
+  EXPECT_EQ(upload_parameters.at("guid"), kGUID);
+}
+
+TEST(MinidumpToUploadParameters, PrecedenceRules) {
+  TestProcessSnapshot process_snapshot;
+  ASSERT_NO_FATAL_FAILURE(InitializeProcessSnapshot(&process_snapshot));
+
+  ExpectUploadParameters(
+      BreakpadHTTPFormParametersFromMinidump(&process_snapshot));
+}
+
+TEST(MinidumpToUploadParameters, MinidumpFile) {
+  TestProcessSnapshot process_snapshot;
+  ASSERT_NO_FATAL_FAILURE(InitializeProcessSnapshot(&process_snapshot));
+  process_snapshot.SetSystem(std::make_unique<TestSystemSnapshot>());
+
+  // A module without annotations is not linked from the Crashpad information
+  // stream, and must not disturb the order of the other modules.
+  process_snapshot.AddModule(std::make_unique<TestModuleSnapshot>());
+
+  auto module_snapshot = std::make_unique<TestModuleSnapshot>();
+  module_snapshot->SetAnnotationsVector({"list-module-3-1"});
+  module_snapshot->SetAnnotationsSimpleMap({{"module-3-1", "lion"}});
+  process_snapshot.AddModule(std::move(module_snapshot));
+
+  MinidumpFileWriter minidump_file_writer;
+  minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  std::map<std::string, std::string> upload_parameters;
+  ASSERT_TRUE(BreakpadHTTPFormParametersFromMinidumpFile(&string_file,
+                                                         &upload_parameters));
+
+  ProcessSnapshotMinidump minidump_process_snapshot;
+  ASSERT_TRUE(minidump_process_snapshot.Initialize(&string_file));
+  EXPECT_EQ(upload_parameters,
+            BreakpadHTTPFormParametersFromMinidump(&minidump_process_snapshot));
+
+  EXPECT_EQ(upload_parameters.size(), 11u);
+  EXPECT_EQ(upload_parameters["module-3-1"], "lion");
+  EXPECT_EQ(upload_parameters["list_annotations"],
+            "list-module-0-1\nlist-module-0-2\n"
+            "list-module-1-1\nlist-module-1-2\n"
+            "list-module-3-1");
+  EXPECT_EQ(upload_parameters["guid"], kGUID);
+}
+
+TEST(MinidumpToUploadParameters, MinidumpFileInvalid) {
+  StringFile string_file;
+  string_file.SetString(std::string(64, 'x'));
+
+  std::map<std::string, std::string> upload_parameters;
+  EXPECT_FALSE(BreakpadHTTPFormParametersFromMinidumpFile(&string_file,
+                                                          &upload_parameters));
+  EXPECT_TRUE(upload_parameters.empty());
 }
 
 }  // namespace
@@ -21,9 +21,11 @@
 #include "client/crash_report_database.h"
 #include "client/settings.h"
 #include "handler/crash_report_upload_thread.h"
+#include "handler/minidump_to_upload_parameters.h"
 #include "minidump/minidump_file_writer.h"
 #include "minidump/minidump_user_extension_stream_data_source.h"
 #include "snapshot/win/process_snapshot_win.h"
+#include "util/file/buffered_file_writer.h"
 #include "util/file/file_helper.h"
 #include "util/file/file_writer.h"
 #include "util/misc/metrics.h"
@@ -105,13 +107,19 @@ unsigned int CrashReportExceptionHandler::ExceptionHandlerServerException(
     AddUserExtensionStreams(
         user_stream_data_sources_, &process_snapshot, &minidump);
 
-    if (!minidump.WriteEverything(new_report->Writer())) {
+    BufferedFileWriter writer(new_report->Writer());
+    if (!minidump.WriteEverything(&writer) || !writer.Flush()) {
       LOG(ERROR) << "WriteEverything failed";
       Metrics::ExceptionCaptureResult(
           Metrics::CaptureResult::kMinidumpWriteFailed);
       return termination_code;
     }
 
+    // If this fails, the upload thread will recover the parameters from the
+    // minidump instead.
+    new_report->SetUploadParameters(
+        BreakpadHTTPFormParametersFromMinidump(&process_snapshot));
+
     for (const auto& attachment : (*attachments_)) {
       FileReader file_reader;
       if (!file_reader.Open(attachment)) {
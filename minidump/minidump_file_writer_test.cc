@@ -17,10 +17,16 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
 #include <iterator>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
+#include "base/format_macros.h"
+#include "base/strings/stringprintf.h"
 #include "build/build_config.h"
 #include "gtest/gtest.h"
 #include "minidump/minidump_stream_writer.h"
@@ -554,6 +560,252 @@ TEST(MinidumpFileWriter, InitializeFromSnapshot_CrashpadInfo) {
                   string_file.string(), directory[6].Location));
 }
 
+TEST(MinidumpFileWriter, ReadAhead) {
+  TestProcessSnapshot process_snapshot;
+
+  auto system_snapshot = std::make_unique<TestSystemSnapshot>();
+  system_snapshot->SetCPUArchitecture(kCPUArchitectureX86_64);
+  system_snapshot->SetOperatingSystem(SystemSnapshot::kOperatingSystemLinux);
+  process_snapshot.SetSystem(std::move(system_snapshot));
+
+  constexpr size_t kMemoryCount = 16;
+  constexpr size_t kMemorySizeUnit = 0x1003;
+  for (size_t index = 0; index < kMemoryCount; ++index) {
+    auto memory_snapshot = std::make_unique<TestMemorySnapshot>();
+    memory_snapshot->SetAddress(0x10000000 + index * 0x100000);
+    memory_snapshot->SetSize((index + 1) * kMemorySizeUnit);
+    memory_snapshot->SetValue(static_cast<char>('a' + index));
+
+    // Snapshots that can’t be read concurrently are read as they are written,
+    // between those that are read ahead.
+    memory_snapshot->SetSupportsConcurrentReads(index % 4 != 3);
+    if (index == kMemoryCount / 2) {
+      memory_snapshot->SetShouldFailRead(true);
+    }
+    process_snapshot.AddExtraMemory(std::move(memory_snapshot));
+  }
+
+  std::string expected;
+  {
+    MinidumpFileWriter minidump_file_writer;
+    minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+    StringFile string_file;
+    ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+    expected = string_file.string();
+  }
+
+  static constexpr struct {
+    size_t thread_count;
+    size_t memory_budget;
+  } kReadAheadConfigurations[] = {
+      {1, 0},
+      {1, kMemorySizeUnit * kMemoryCount * kMemoryCount},
+      {4, kMemorySizeUnit * 4},
+      {4, kMemorySizeUnit * kMemoryCount * kMemoryCount},
+      {kMemoryCount * 2, kMemorySizeUnit * kMemoryCount * kMemoryCount},
+  };
+  for (const auto& configuration : kReadAheadConfigurations) {
+    SCOPED_TRACE(base::StringPrintf("thread_count %" PRIuS
+                                    ", memory_budget %" PRIuS,
+                                    configuration.thread_count,
+                                    configuration.memory_budget));
+
+    MinidumpFileWriter minidump_file_writer;
+    minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+    minidump_file_writer.SetReadAhead(configuration.thread_count,
+                                      configuration.memory_budget);
+    StringFile string_file;
+    ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+    EXPECT_EQ(string_file.string(), expected);
+  }
+}
+
+// Tracks how much memory snapshot content has been read ahead of being written
+// to a minidump file. Content read on the writing thread is read as it is
+// written, and is not tracked.
+class ReadAheadTracker {
+ public:
+  ReadAheadTracker()
+      : regions_held_(),
+        lock_(),
+        writer_thread_(std::this_thread::get_id()),
+        bytes_held_(0),
+        max_bytes_held_(0) {}
+
+  ReadAheadTracker(const ReadAheadTracker&) = delete;
+  ReadAheadTracker& operator=(const ReadAheadTracker&) = delete;
+
+  ~ReadAheadTracker() {}
+
+  // Records that size bytes of content, which will be written to the minidump
+  // file ending at file_end, have been read.
+  void RegionRead(size_t size, FileOffset file_end) {
+    if (std::this_thread::get_id() == writer_thread_) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(lock_);
+    regions_held_.emplace_back(file_end, size);
+    bytes_held_ += size;
+    max_bytes_held_ = std::max(max_bytes_held_, bytes_held_);
+  }
+
+  // Releases the content of every region that has been written once the
+  // minidump file reaches position.
+  void FileWritten(FileOffset position) {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (auto it = regions_held_.begin(); it != regions_held_.end();) {
+      if (it->first <= position) {
+        bytes_held_ -= it->second;
+        it = regions_held_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  size_t max_bytes_held() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return max_bytes_held_;
+  }
+
+ private:
+  std::vector<std::pair<FileOffset, size_t>> regions_held_;
+  std::mutex lock_;
+  const std::thread::id writer_thread_;
+  size_t bytes_held_;
+  size_t max_bytes_held_;
+};
+
+class ReadAheadTrackingMemorySnapshot final : public MemorySnapshot {
+ public:
+  ReadAheadTrackingMemorySnapshot(ReadAheadTracker* tracker,
+                                  uint64_t address,
+                                  size_t size,
+                                  char value)
+      : tracker_(tracker),
+        address_(address),
+        size_(size),
+        file_end_(0),
+        value_(value) {}
+
+  ReadAheadTrackingMemorySnapshot(const ReadAheadTrackingMemorySnapshot&) =
+      delete;
+  ReadAheadTrackingMemorySnapshot& operator=(
+      const ReadAheadTrackingMemorySnapshot&) = delete;
+
+  ~ReadAheadTrackingMemorySnapshot() override {}
+
+  void SetFileEnd(FileOffset file_end) { file_end_ = file_end; }
+
+  // MemorySnapshot:
+  uint64_t Address() const override { return address_; }
+  size_t Size() const override { return size_; }
+
+  bool Read(Delegate* delegate) const override {
+    std::string buffer(size_, value_);
+    tracker_->RegionRead(size_, file_end_);
+    return delegate->MemorySnapshotDelegateRead(&buffer[0], size_);
+  }
+
+  bool SupportsConcurrentReads() const override { return true; }
+
+  const MemorySnapshot* MergeWithOtherSnapshot(
+      const MemorySnapshot* other) const override {
+    // The regions in these tests never overlap.
+    ADD_FAILURE();
+    return nullptr;
+  }
+
+ private:
+  ReadAheadTracker* tracker_;  // weak
+  uint64_t address_;
+  size_t size_;
+  FileOffset file_end_;
+  char value_;
+};
+
+class ReadAheadTrackingStringFile final : public StringFile {
+ public:
+  explicit ReadAheadTrackingStringFile(ReadAheadTracker* tracker)
+      : StringFile(), tracker_(tracker) {}
+
+  ReadAheadTrackingStringFile(const ReadAheadTrackingStringFile&) = delete;
+  ReadAheadTrackingStringFile& operator=(const ReadAheadTrackingStringFile&) =
+      delete;
+
+  ~ReadAheadTrackingStringFile() override {}
+
+  // FileWriterInterface:
+  bool Write(const void* data, size_t size) override {
+    if (!StringFile::Write(data, size)) {
+      return false;
+    }
+    tracker_->FileWritten(SeekGet());
+    return true;
+  }
+
+ private:
+  ReadAheadTracker* tracker_;  // weak
+};
+
+TEST(MinidumpFileWriter, ReadAheadMemoryBudget) {
+  ReadAheadTracker tracker;
+  TestProcessSnapshot process_snapshot;
+
+  auto system_snapshot = std::make_unique<TestSystemSnapshot>();
+  system_snapshot->SetCPUArchitecture(kCPUArchitectureX86_64);
+  system_snapshot->SetOperatingSystem(SystemSnapshot::kOperatingSystemLinux);
+  process_snapshot.SetSystem(std::move(system_snapshot));
+
+  // The region in the middle is larger than the memory budget, and must be read
+  // as it is written rather than being held in memory alongside the others.
+  constexpr size_t kMemoryBudget = 0x10000;
+  constexpr size_t kMemorySizes[] = {
+      0x3001, 0x5003, 0x7005, kMemoryBudget * 4 + 1, 0x4007, 0x6009, 0x800b};
+  std::vector<ReadAheadTrackingMemorySnapshot*> memory_snapshots;
+  for (size_t index = 0; index < std::size(kMemorySizes); ++index) {
+    auto memory_snapshot = std::make_unique<ReadAheadTrackingMemorySnapshot>(
+        &tracker,
+        0x10000000 + index * 0x100000,
+        kMemorySizes[index],
+        static_cast<char>('a' + index));
+    memory_snapshots.push_back(memory_snapshot.get());
+    process_snapshot.AddExtraMemory(std::move(memory_snapshot));
+  }
+
+  std::string expected;
+  {
+    MinidumpFileWriter minidump_file_writer;
+    minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+    StringFile string_file;
+    ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+    expected = string_file.string();
+  }
+
+  // Each region’s content is distinct, so its position in the file is where its
+  // content first appears.
+  for (size_t index = 0; index < memory_snapshots.size(); ++index) {
+    const size_t offset = expected.find(
+        std::string(kMemorySizes[index], static_cast<char>('a' + index)));
+    ASSERT_NE(offset, std::string::npos);
+    memory_snapshots[index]->SetFileEnd(offset + kMemorySizes[index]);
+  }
+
+  for (size_t thread_count : {1, 4}) {
+    SCOPED_TRACE(base::StringPrintf("thread_count %" PRIuS, thread_count));
+
+    MinidumpFileWriter minidump_file_writer;
+    minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+    minidump_file_writer.SetReadAhead(thread_count, kMemoryBudget);
+    ReadAheadTrackingStringFile string_file(&tracker);
+    ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+    EXPECT_EQ(string_file.string(), expected);
+    EXPECT_GT(tracker.max_bytes_held(), 0u);
+    EXPECT_LE(tracker.max_bytes_held(), kMemoryBudget);
+  }
+}
+
 TEST(MinidumpFileWriter, SameStreamType) {
   MinidumpFileWriter minidump_file;
 
@@ -26,6 +26,36 @@
 
 namespace crashpad {
 
+namespace {
+
+// The value used to fill the parts of a memory range that could not be read.
+constexpr uint8_t kUnreadableFill = 0xfe;
+
+// Collects a memory snapshot’s contents in a buffer.
+class ReadAheadDelegate final : public MemorySnapshot::Delegate {
+ public:
+  explicit ReadAheadDelegate(std::vector<uint8_t>* data) : data_(data) {}
+
+  ReadAheadDelegate(const ReadAheadDelegate&) = delete;
+  ReadAheadDelegate& operator=(const ReadAheadDelegate&) = delete;
+
+  ~ReadAheadDelegate() override {}
+
+  // MemorySnapshot::Delegate:
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    data_->insert(data_->end(), bytes, bytes + size);
+    return true;
+  }
+
+  bool MemorySnapshotDelegateAcceptsChunks() const override { return true; }
+
+ private:
+  std::vector<uint8_t>* data_;  // weak
+};
+
+}  // namespace
+
 SnapshotMinidumpMemoryWriter::SnapshotMinidumpMemoryWriter(
     const MemorySnapshot* memory_snapshot)
     : internal::MinidumpWritable(),
@@ -33,15 +63,26 @@ SnapshotMinidumpMemoryWriter::SnapshotMinidumpMemoryWriter(
       memory_descriptor_(),
       registered_memory_descriptors_(),
       memory_snapshot_(memory_snapshot),
-      file_writer_(nullptr) {}
+      file_writer_(nullptr),
+      bytes_written_(0),
+      read_ahead_data_(),
+      read_ahead_(false) {}
 
 SnapshotMinidumpMemoryWriter::~SnapshotMinidumpMemoryWriter() {}
 
 bool SnapshotMinidumpMemoryWriter::MemorySnapshotDelegateRead(void* data,
                                                               size_t size) {
   DCHECK_EQ(state(), kStateWritable);
-  DCHECK_EQ(size, UnderlyingSnapshot()->Size());
-  return file_writer_->Write(data, size);
+  DCHECK_LE(size, UnderlyingSnapshot()->Size() - bytes_written_);
+  if (!file_writer_->Write(data, size)) {
+    return false;
+  }
+  bytes_written_ += size;
+  return true;
+}
+
+bool SnapshotMinidumpMemoryWriter::MemorySnapshotDelegateAcceptsChunks() const {
+  return true;
 }
 
 bool SnapshotMinidumpMemoryWriter::WriteObject(
@@ -49,23 +90,63 @@ bool SnapshotMinidumpMemoryWriter::WriteObject(
   DCHECK_EQ(state(), kStateWritable);
   DCHECK(!file_writer_);
 
+  if (read_ahead_) {
+    read_ahead_ = false;
+    std::vector<uint8_t> data;
+    data.swap(read_ahead_data_);
+    return data.empty() || file_writer->Write(data.data(), data.size());
+  }
+
   base::AutoReset<FileWriterInterface*> file_writer_reset(&file_writer_,
                                                           file_writer);
+  bytes_written_ = 0;
 
-  // This will result in MemorySnapshotDelegateRead() being called.
+  // This will result in MemorySnapshotDelegateRead() being called, possibly
+  // several times.
   if (!memory_snapshot_->Read(this)) {
     // If the Read() fails (perhaps because the process' memory map has changed
-    // since it the range was captured), write an empty block of memory. It
-    // would be nice to instead not include this memory, but at this point in
-    // the writing process, it would be difficult to amend the minidump's
+    // since it the range was captured), fill the rest of the block of memory.
+    // It would be nice to instead not include this memory, but at this point
+    // in the writing process, it would be difficult to amend the minidump's
     // structure. See https://crashpad.chromium.org/234 for background.
-    std::vector<uint8_t> empty(memory_snapshot_->Size(), 0xfe);
-    MemorySnapshotDelegateRead(empty.data(), empty.size());
+    const size_t remaining = memory_snapshot_->Size() - bytes_written_;
+    std::vector<uint8_t> empty(std::min(remaining, size_t{64 * 1024}),
+                               kUnreadableFill);
+    while (bytes_written_ < memory_snapshot_->Size()) {
+      const size_t fill_size =
+          std::min(memory_snapshot_->Size() - bytes_written_, empty.size());
+      if (!MemorySnapshotDelegateRead(empty.data(), fill_size)) {
+        break;
+      }
+    }
   }
 
   return true;
 }
 
+bool SnapshotMinidumpMemoryWriter::CanReadAhead() {
+  DCHECK_EQ(state(), kStateWritable);
+
+  return memory_snapshot_->SupportsConcurrentReads();
+}
+
+void SnapshotMinidumpMemoryWriter::ReadAheadObject() {
+  DCHECK_EQ(state(), kStateWritable);
+  DCHECK(!read_ahead_);
+
+  const size_t size = memory_snapshot_->Size();
+  read_ahead_data_.clear();
+  read_ahead_data_.reserve(size);
+  ReadAheadDelegate delegate(&read_ahead_data_);
+
+  // As in WriteObject(), if the read fails, the part of the range that wasn’t
+  // read is filled.
+  if (!memory_snapshot_->Read(&delegate)) {
+    read_ahead_data_.resize(size, kUnreadableFill);
+  }
+  read_ahead_ = true;
+}
+
 const MINIDUMP_MEMORY_DESCRIPTOR*
 SnapshotMinidumpMemoryWriter::MinidumpMemoryDescriptor() const {
   DCHECK_EQ(state(), kStateWritable);
@@ -75,11 +75,14 @@ class SnapshotMinidumpMemoryWriter : public internal::MinidumpWritable,
 
   // MemorySnapshot::Delegate:
   bool MemorySnapshotDelegateRead(void* data, size_t size) override;
+  bool MemorySnapshotDelegateAcceptsChunks() const override;
 
   // MinidumpWritable:
   bool Freeze() override;
   size_t SizeOfObject() final;
   bool WriteObject(FileWriterInterface* file_writer) override;
+  bool CanReadAhead() override;
+  void ReadAheadObject() override;
 
   //! \brief Returns the object’s desired byte-boundary alignment.
   //!
@@ -115,6 +118,14 @@ class SnapshotMinidumpMemoryWriter : public internal::MinidumpWritable,
   std::vector<MINIDUMP_MEMORY_DESCRIPTOR*> registered_memory_descriptors_;
   const MemorySnapshot* memory_snapshot_;
   FileWriterInterface* file_writer_;
+
+  // The number of bytes of the memory snapshot written by WriteObject() so far.
+  size_t bytes_written_;
+
+  // The memory snapshot’s contents, read by ReadAheadObject() to be written by
+  // WriteObject().
+  std::vector<uint8_t> read_ahead_data_;
+  bool read_ahead_;
 };
 
 //! \brief The writer for a MINIDUMP_MEMORY_LIST stream in a minidump file,
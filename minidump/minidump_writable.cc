@@ -16,12 +16,17 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <iterator>
+#include <memory>
+#include <mutex>
 
 #include "base/check_op.h"
 #include "base/logging.h"
 #include "util/file/file_writer.h"
 #include "util/numeric/safe_assignment.h"
+#include "util/thread/thread.h"
 
 namespace {
 
@@ -32,6 +37,131 @@ constexpr size_t kMaximumAlignment = 16;
 namespace crashpad {
 namespace internal {
 
+// Hands out objects whose content can be read ahead to reader threads, in the
+// order that they will be written, while limiting the amount of content that
+// has been read but not yet written.
+class MinidumpWritable::ReadAheadQueue {
+ public:
+  ReadAheadQueue(const std::vector<MinidumpWritable*>& objects,
+                 size_t memory_budget)
+      : objects_(objects),
+        sizes_(),
+        read_(objects.size(), false),
+        readers_(),
+        lock_(),
+        object_read_(),
+        space_available_(),
+        memory_budget_(memory_budget),
+        bytes_held_(0),
+        next_object_(0),
+        stopped_(false) {
+    sizes_.reserve(objects_.size());
+    for (MinidumpWritable* object : objects_) {
+      sizes_.push_back(object->SizeOfObject());
+      DCHECK_LE(sizes_.back(), memory_budget_);
+    }
+  }
+
+  ReadAheadQueue(const ReadAheadQueue&) = delete;
+  ReadAheadQueue& operator=(const ReadAheadQueue&) = delete;
+
+  ~ReadAheadQueue() { DCHECK(readers_.empty()); }
+
+  // Starts thread_count reader threads.
+  void Start(size_t thread_count) {
+    for (size_t index = 0; index < thread_count; ++index) {
+      readers_.push_back(std::make_unique<Reader>(this));
+      readers_.back()->Start();
+    }
+  }
+
+  // Stops handing out objects, and waits for the reader threads to finish the
+  // objects that they are reading.
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      stopped_ = true;
+    }
+    space_available_.notify_all();
+
+    for (const auto& reader : readers_) {
+      reader->Join();
+    }
+    readers_.clear();
+  }
+
+  // Waits until the content of the object at index has been read.
+  void WaitForObject(size_t index) {
+    std::unique_lock<std::mutex> lock(lock_);
+    object_read_.wait(lock, [this, index] { return read_[index]; });
+  }
+
+  // Releases the object at index from the memory budget once it has been
+  // written.
+  void ObjectWritten(size_t index) {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      DCHECK(read_[index]);
+      bytes_held_ -= sizes_[index];
+    }
+    space_available_.notify_all();
+  }
+
+ private:
+  class Reader : public Thread {
+   public:
+    explicit Reader(ReadAheadQueue* queue) : Thread(), queue_(queue) {}
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    ~Reader() override {}
+
+   private:
+    // Thread:
+    void ThreadMain() override { queue_->RunReader(); }
+
+    ReadAheadQueue* queue_;  // weak
+  };
+
+  void RunReader() {
+    std::unique_lock<std::mutex> lock(lock_);
+    while (true) {
+      space_available_.wait(lock, [this] {
+        if (stopped_ || next_object_ == objects_.size()) {
+          return true;
+        }
+        return bytes_held_ <= memory_budget_ - sizes_[next_object_];
+      });
+      if (stopped_ || next_object_ == objects_.size()) {
+        return;
+      }
+
+      const size_t index = next_object_++;
+      bytes_held_ += sizes_[index];
+      lock.unlock();
+
+      objects_[index]->ReadAheadObject();
+
+      lock.lock();
+      read_[index] = true;
+      object_read_.notify_all();
+    }
+  }
+
+  const std::vector<MinidumpWritable*>& objects_;  // weak
+  std::vector<size_t> sizes_;
+  std::vector<bool> read_;
+  std::vector<std::unique_ptr<Reader>> readers_;
+  std::mutex lock_;
+  std::condition_variable object_read_;
+  std::condition_variable space_available_;
+  const size_t memory_budget_;
+  size_t bytes_held_;
+  size_t next_object_;
+  bool stopped_;
+};
+
 MinidumpWritable::~MinidumpWritable() {
 }
 
@@ -59,10 +189,16 @@ bool MinidumpWritable::WriteEverything(FileWriterInterface* file_writer) {
   DCHECK_EQ(state_, kStateWritable);
   DCHECK_EQ(write_sequence.front(), this);
 
-  for (MinidumpWritable* writable : write_sequence) {
-    if (!writable->WritePaddingAndObject(file_writer)) {
+  if (read_ahead_thread_count_ > 0) {
+    if (!WriteSequenceWithReadAhead(write_sequence, file_writer)) {
       return false;
     }
+  } else {
+    for (MinidumpWritable* writable : write_sequence) {
+      if (!writable->WritePaddingAndObject(file_writer)) {
+        return false;
+      }
+    }
   }
 
   DCHECK_EQ(state_, kStateWritten);
@@ -70,6 +206,52 @@ bool MinidumpWritable::WriteEverything(FileWriterInterface* file_writer) {
   return true;
 }
 
+void MinidumpWritable::SetReadAhead(size_t thread_count,
+                                    size_t memory_budget) {
+  DCHECK_EQ(state_, kStateMutable);
+
+  read_ahead_thread_count_ = thread_count;
+  read_ahead_memory_budget_ = memory_budget;
+}
+
+bool MinidumpWritable::WriteSequenceWithReadAhead(
+    const std::vector<MinidumpWritable*>& write_sequence,
+    FileWriterInterface* file_writer) {
+  // Objects larger than the memory budget are read as they are written, so
+  // that the budget bounds the content held in memory at any time.
+  std::vector<MinidumpWritable*> read_ahead_objects;
+  for (MinidumpWritable* writable : write_sequence) {
+    if (writable->CanReadAhead() &&
+        writable->SizeOfObject() <= read_ahead_memory_budget_) {
+      read_ahead_objects.push_back(writable);
+    }
+  }
+
+  ReadAheadQueue queue(read_ahead_objects, read_ahead_memory_budget_);
+  queue.Start(std::min(read_ahead_thread_count_, read_ahead_objects.size()));
+
+  bool success = true;
+  size_t read_ahead_index = 0;
+  for (MinidumpWritable* writable : write_sequence) {
+    if (read_ahead_index < read_ahead_objects.size() &&
+        writable == read_ahead_objects[read_ahead_index]) {
+      queue.WaitForObject(read_ahead_index);
+      success = writable->WritePaddingAndObject(file_writer);
+      queue.ObjectWritten(read_ahead_index);
+      ++read_ahead_index;
+    } else {
+      success = writable->WritePaddingAndObject(file_writer);
+    }
+
+    if (!success) {
+      break;
+    }
+  }
+
+  queue.Stop();
+  return success;
+}
+
 void MinidumpWritable::RegisterRVA(RVA* rva) {
   DCHECK_LE(state_, kStateFrozen);
 
@@ -102,6 +284,8 @@ MinidumpWritable::MinidumpWritable()
       registered_location_descriptors_(),
       registered_location_descriptor64s_(),
       leading_pad_bytes_(0),
+      read_ahead_thread_count_(0),
+      read_ahead_memory_budget_(0),
       state_(kStateMutable) {}
 
 bool MinidumpWritable::Freeze() {
@@ -288,6 +472,13 @@ bool MinidumpWritable::WillWriteAtOffsetImpl(FileOffset offset) {
   return true;
 }
 
+bool MinidumpWritable::CanReadAhead() {
+  return false;
+}
+
+void MinidumpWritable::ReadAheadObject() {
+}
+
 bool MinidumpWritable::WritePaddingAndObject(FileWriterInterface* file_writer) {
   DCHECK_EQ(state_, kStateWritable);
 
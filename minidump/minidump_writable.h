@@ -56,6 +56,30 @@ class MinidumpWritable {
   //! \note This method should rarely be overridden.
   virtual bool WriteEverything(FileWriterInterface* file_writer);
 
+  //! \brief Configures WriteEverything() to read content ahead of writing it.
+  //!
+  //! By default, WriteEverything() writes one object at a time, and objects
+  //! that capture memory from a snapshot process read it as they are written.
+  //! When \a thread_count is nonzero, WriteEverything() starts \a thread_count
+  //! threads that read this content in the order it will be written, while
+  //! earlier objects are being written. The resulting minidump file is
+  //! identical.
+  //!
+  //! Only content that can be read on several threads at once is read ahead,
+  //! such as memory snapshots whose MemorySnapshot::SupportsConcurrentReads()
+  //! returns `true`, and only if it fits within \a memory_budget. Other
+  //! content is read as it is written.
+  //!
+  //! \param[in] thread_count The number of threads to read content on, or `0`
+  //!     to read content as it is written.
+  //! \param[in] memory_budget The maximum number of bytes of content that may
+  //!     be read but not yet written at any time. An object whose content is
+  //!     larger than this is never read ahead.
+  //!
+  //! \note Valid in #kStateMutable. This only has an effect on the object on
+  //!     which WriteEverything() is called.
+  void SetReadAhead(size_t thread_count, size_t memory_budget);
+
   //! \brief Registers a file offset pointer as one that should point to the
   //!     object on which this method is called.
   //!
@@ -267,7 +291,37 @@ class MinidumpWritable {
   //!     #kStateWritten after this method returns.
   virtual bool WriteObject(FileWriterInterface* file_writer) = 0;
 
+  //! \brief Returns whether ReadAheadObject() should be called before
+  //!     WriteObject() when WriteEverything() reads content ahead of writing.
+  //!
+  //! The default implementation returns `false`.
+  //!
+  //! \note Valid in #kStateWritable.
+  virtual bool CanReadAhead();
+
+  //! \brief Reads the object’s content into memory, so that WriteObject() can
+  //!     write it without reading it from its source.
+  //!
+  //! This is called on a thread other than the one calling WriteObject(), and
+  //! concurrently with other objects’ WriteObject() and ReadAheadObject()
+  //! methods. It will only be called if CanReadAhead() returns `true`, and is
+  //! called before WriteObject(). The object must not access any state shared
+  //! with other objects.
+  //!
+  //! The default implementation does nothing.
+  //!
+  //! \note Valid in #kStateWritable.
+  virtual void ReadAheadObject();
+
  private:
+  class ReadAheadQueue;
+
+  // Writes the objects in write_sequence, while threads read the content of
+  // objects that support it ahead of time.
+  bool WriteSequenceWithReadAhead(
+      const std::vector<MinidumpWritable*>& write_sequence,
+      FileWriterInterface* file_writer);
+
   std::vector<RVA*> registered_rvas_;  // weak
 
   std::vector<RVA64*> registered_rva64s_;  // weak
@@ -280,6 +334,8 @@ class MinidumpWritable {
       registered_location_descriptor64s_;
 
   size_t leading_pad_bytes_;
+  size_t read_ahead_thread_count_;
+  size_t read_ahead_memory_budget_;
   State state_;
 };
 
@@ -72,6 +72,60 @@ static_assert(sizeof(process_types::AnnotationList<NATIVE_TRAITS>) ==
 
 #undef NATIVE_TRAITS
 
+namespace {
+
+// Reads small structures from a target process a window at a time, serving
+// later reads that fall within the same window from a local copy. Annotations
+// are usually objects with static storage duration, placed near one another,
+// so a single window tends to hold many nodes of an annotation list.
+class WindowedReader {
+ public:
+  explicit WindowedReader(const ProcessMemoryRange* memory)
+      : memory_(memory), window_address_(0), window_size_(0) {}
+
+  WindowedReader(const WindowedReader&) = delete;
+  WindowedReader& operator=(const WindowedReader&) = delete;
+
+  ~WindowedReader() = default;
+
+  bool Read(VMAddress address, size_t size, void* buffer) {
+    if (!InWindow(address, size)) {
+      // Windows are aligned, so that they never span more than one page.
+      std::vector<ProcessMemory::BatchRead> reads(1);
+      reads[0].address = address & ~VMAddress{kWindowSize - 1};
+      reads[0].size = kWindowSize;
+      reads[0].buffer = window_;
+      memory_->ReadBatch(&reads);
+      window_address_ = reads[0].address;
+      window_size_ = reads[0].bytes_read;
+
+      // Structures that cross the end of a window are read directly.
+      if (!InWindow(address, size)) {
+        return memory_->Read(address, size, buffer);
+      }
+    }
+
+    memcpy(buffer, window_ + (address - window_address_), size);
+    return true;
+  }
+
+ private:
+  static constexpr size_t kWindowSize = 4096;
+
+  bool InWindow(VMAddress address, size_t size) const {
+    return address >= window_address_ &&
+           address - window_address_ <= window_size_ &&
+           size <= window_size_ - (address - window_address_);
+  }
+
+  const ProcessMemoryRange* memory_;
+  VMAddress window_address_;
+  size_t window_size_;
+  char window_[kWindowSize];
+};
+
+}  // namespace
+
 ImageAnnotationReader::ImageAnnotationReader(const ProcessMemoryRange* memory)
     : memory_(memory) {}
 
@@ -120,11 +174,17 @@ bool ImageAnnotationReader::ReadAnnotationList(
     return false;
   }
 
+  // The list is walked first, with nodes that are near one another read
+  // together. The names and values of all of the annotations found are then
+  // read in a single batch.
+  std::vector<process_types::Annotation<Traits>> nodes;
+  std::vector<size_t> node_indices;
+  WindowedReader node_reader(memory_);
   process_types::Annotation<Traits> current = annotation_list.head;
   for (size_t index = 0; current.link_node != annotation_list.tail_pointer &&
                          index < kMaxNumberOfAnnotations;
        ++index) {
-    if (!memory_->Read(current.link_node, sizeof(current), &current)) {
+    if (!node_reader.Read(current.link_node, sizeof(current), &current)) {
       LOG(ERROR) << "could not read annotation at index " << index;
       return false;
     }
@@ -133,23 +193,53 @@ bool ImageAnnotationReader::ReadAnnotationList(
       continue;
     }
 
-    AnnotationSnapshot snapshot;
-    snapshot.type = current.type;
+    nodes.push_back(current);
+    node_indices.push_back(index);
+  }
 
-    if (!memory_->ReadCStringSizeLimited(
-            current.name, Annotation::kNameMaxLength, &snapshot.name)) {
-      LOG(WARNING) << "could not read annotation name at index " << index;
+  std::vector<AnnotationSnapshot> snapshots(nodes.size());
+  std::vector<char> names(nodes.size() * Annotation::kNameMaxLength);
+  std::vector<ProcessMemory::BatchRead> reads(nodes.size() * 2);
+  for (size_t index = 0; index < nodes.size(); ++index) {
+    ProcessMemory::BatchRead& name_read = reads[index * 2];
+    name_read.address = nodes[index].name;
+    name_read.size = Annotation::kNameMaxLength;
+    name_read.buffer = &names[index * Annotation::kNameMaxLength];
+
+    AnnotationSnapshot& snapshot = snapshots[index];
+    snapshot.type = nodes[index].type;
+    snapshot.value.resize(std::min(static_cast<size_t>(nodes[index].size),
+                                   Annotation::kValueMaxSize));
+
+    ProcessMemory::BatchRead& value_read = reads[index * 2 + 1];
+    value_read.address = nodes[index].value;
+    value_read.size = snapshot.value.size();
+    value_read.buffer = snapshot.value.data();
+  }
+  memory_->ReadBatch(&reads);
+
+  for (size_t index = 0; index < nodes.size(); ++index) {
+    // A name may be read only partially if it is close to the end of its
+    // mapping, but it must be terminated within the part that was read.
+    const ProcessMemory::BatchRead& name_read = reads[index * 2];
+    const char* name = static_cast<const char*>(name_read.buffer);
+    const char* nul =
+        static_cast<const char*>(memchr(name, '\0', name_read.bytes_read));
+    if (!nul) {
+      LOG(WARNING) << "could not read annotation name at index "
+                   << node_indices[index];
       continue;
     }
 
-    size_t value_length =
-        std::min(static_cast<size_t>(current.size), Annotation::kValueMaxSize);
-    snapshot.value.resize(value_length);
-    if (!memory_->Read(current.value, value_length, snapshot.value.data())) {
-      LOG(WARNING) << "could not read annotation value at index " << index;
+    const ProcessMemory::BatchRead& value_read = reads[index * 2 + 1];
+    if (value_read.bytes_read != value_read.size) {
+      LOG(WARNING) << "could not read annotation value at index "
+                   << node_indices[index];
       continue;
     }
 
+    AnnotationSnapshot& snapshot = snapshots[index];
+    snapshot.name.assign(name, nul - name);
     annotations->push_back(std::move(snapshot));
   }
 
@@ -24,7 +24,10 @@
 #include "client/annotation.h"
 #include "client/annotation_list.h"
 #include "client/simple_string_dictionary.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/strings/stringprintf.h"
 #include "gtest/gtest.h"
+#include "snapshot/snapshot_constants.h"
 #include "test/multiprocess_exec.h"
 #include "test/process_type.h"
 #include "util/file/file_io.h"
@@ -141,6 +144,71 @@ TEST(ImageAnnotationReader, ReadFromSelf) {
                     FromPointerCast<VMAddress>(&annotations));
 }
 
+TEST(ImageAnnotationReader, ReadManyFromSelf) {
+  // Add more annotations than are read, some of them empty, so that the list
+  // spans several pages and is cut off at kMaxNumberOfAnnotations.
+  constexpr size_t kAnnotationCount = kMaxNumberOfAnnotations + 100;
+  std::vector<std::string> names(kAnnotationCount);
+  std::vector<std::string> values(kAnnotationCount);
+  std::vector<std::unique_ptr<Annotation>> storage;
+  AnnotationList annotations;
+  for (size_t index = 0; index < kAnnotationCount; ++index) {
+    names[index] = base::StringPrintf("annotation %zu", index);
+    values[index] = base::StringPrintf("value %zu", index);
+    storage.push_back(std::make_unique<Annotation>(
+        Annotation::Type::kString, names[index].c_str(), values[index].data()));
+    if (index % 3 != 0) {
+      storage.back()->SetSize(
+          base::checked_cast<Annotation::ValueSizeType>(values[index].size()));
+    }
+    annotations.Add(storage.back().get());
+  }
+
+#if BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  FakePtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(GetSelfProcess()));
+  ProcessMemoryLinux memory(&connection);
+#else
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+#endif
+
+#if defined(ARCH_CPU_64_BITS)
+  constexpr bool am_64_bit = true;
+#else
+  constexpr bool am_64_bit = false;
+#endif
+
+  ProcessMemoryRange range;
+  ASSERT_TRUE(range.Initialize(&memory, am_64_bit));
+
+  ImageAnnotationReader reader(&range);
+  std::vector<AnnotationSnapshot> annotation_list;
+  ASSERT_TRUE(reader.AnnotationsList(FromPointerCast<VMAddress>(&annotations),
+                                     &annotation_list));
+
+  std::vector<const Annotation*> expected;
+  size_t index = 0;
+  for (const Annotation* annotation : annotations) {
+    if (index++ == kMaxNumberOfAnnotations) {
+      break;
+    }
+    if (annotation->size() != 0) {
+      expected.push_back(annotation);
+    }
+  }
+
+  ASSERT_EQ(annotation_list.size(), expected.size());
+  for (index = 0; index < expected.size(); ++index) {
+    const AnnotationSnapshot& annotation = annotation_list[index];
+    EXPECT_EQ(annotation.name, expected[index]->name());
+    EXPECT_EQ(annotation.type, AsUnderlyingType(expected[index]->type()));
+    EXPECT_EQ(std::string(annotation.value.begin(), annotation.value.end()),
+              std::string(static_cast<const char*>(expected[index]->value()),
+                          expected[index]->size()));
+  }
+}
+
 CRASHPAD_CHILD_TEST_MAIN(ReadAnnotationsFromChildTestMain) {
   SimpleStringDictionary map;
   std::vector<std::unique_ptr<Annotation>> storage;
@@ -335,9 +335,19 @@ ElfImageReader::NoteReader::Result ElfImageReader::NoteReader::ReadNote(
     return Result::kError;
   }
 
+  // Read the name and the description together. The description is only
+  // needed if the name matches the filter, but notes are small enough that
+  // fetching it speculatively is cheaper than a second round trip.
   std::string local_name(note_info.n_namesz, '\0');
-  if (!segment_range_->Read(
-          current_address_, note_info.n_namesz, &local_name[0])) {
+  std::string local_desc(note_info.n_descsz, '\0');
+  std::vector<ProcessMemory::BatchRead> reads(2);
+  reads[0] = {current_address_, local_name.size(), &local_name[0], 0};
+  reads[1] = {current_address_ + padded_namesz,
+              local_desc.size(),
+              &local_desc[0],
+              0};
+  const bool read_desc = segment_range_->ReadBatch(&reads);
+  if (reads[0].bytes_read != reads[0].size) {
     return Result::kError;
   }
   if (!local_name.empty()) {
@@ -356,9 +366,7 @@ ElfImageReader::NoteReader::Result ElfImageReader::NoteReader::ReadNote(
 
   current_address_ += padded_namesz;
 
-  std::string local_desc(note_info.n_descsz, '\0');
-  if (!segment_range_->Read(
-          current_address_, note_info.n_descsz, &local_desc[0])) {
+  if (!read_desc) {
     return Result::kError;
   }
   *desc_address = current_address_;
@@ -398,10 +406,15 @@ bool ElfImageReader::Initialize(const ProcessMemoryRange& memory,
     return false;
   }
 
-  uint8_t e_ident[EI_NIDENT];
-  if (!memory_.Read(ehdr_address_, EI_NIDENT, e_ident)) {
+  // e_ident begins both header variants, so read the entire header for the
+  // expected bitness at once and verify its identification afterwards.
+  if (!(memory_.Is64Bit()
+            ? memory_.Read(ehdr_address_, sizeof(header_64_), &header_64_)
+            : memory_.Read(ehdr_address_, sizeof(header_32_), &header_32_))) {
     return false;
   }
+  const unsigned char* e_ident =
+      memory_.Is64Bit() ? header_64_.e_ident : header_32_.e_ident;
 
   if (e_ident[EI_MAG0] != ELFMAG0 || e_ident[EI_MAG1] != ELFMAG1 ||
       e_ident[EI_MAG2] != ELFMAG2 || e_ident[EI_MAG3] != ELFMAG3) {
@@ -430,12 +443,6 @@ bool ElfImageReader::Initialize(const ProcessMemoryRange& memory,
     return false;
   }
 
-  if (!(memory_.Is64Bit()
-            ? memory_.Read(ehdr_address_, sizeof(header_64_), &header_64_)
-            : memory_.Read(ehdr_address_, sizeof(header_32_), &header_32_))) {
-    return false;
-  }
-
 #define VERIFY_HEADER(header)                                  \
   do {                                                         \
     if (header.e_type != ET_EXEC && header.e_type != ET_DYN) { \
@@ -578,15 +585,9 @@ bool ElfImageReader::GetDynamicSymbol(const std::string& name,
 bool ElfImageReader::ReadDynamicStringTableAtOffset(VMSize offset,
                                                     std::string* string) {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-  if (!InitializeDynamicArray()) {
-    return false;
-  }
-
   VMAddress string_table_address;
   VMSize string_table_size;
-  if (!GetAddressFromDynamicArray(DT_STRTAB, true, &string_table_address) ||
-      !dynamic_array_->GetValue(DT_STRSZ, true, &string_table_size)) {
-    LOG(ERROR) << "missing string table info";
+  if (!GetDynamicStringTable(true, &string_table_address, &string_table_size)) {
     return false;
   }
   if (offset >= string_table_size) {
@@ -594,14 +595,6 @@ bool ElfImageReader::ReadDynamicStringTableAtOffset(VMSize offset,
     return false;
   }
 
-  // GNU ld.so doesn't adjust the vdso's dynamic array entries by the load bias.
-  // If the address is too small to point into the loaded module range and is
-  // small enough to be an offset from the base of the module, adjust it now.
-  if (string_table_address < memory_.Base() &&
-      string_table_address < memory_.Size()) {
-    string_table_address += GetLoadBias();
-  }
-
   if (!memory_.ReadCStringSizeLimited(
           string_table_address + offset, string_table_size - offset, string)) {
     LOG(ERROR) << "missing nul-terminator";
@@ -610,6 +603,31 @@ bool ElfImageReader::ReadDynamicStringTableAtOffset(VMSize offset,
   return true;
 }
 
+void ElfImageReader::GetMetadataRanges(
+    std::vector<CheckedRange<VMAddress, VMSize>>* ranges) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  size_t phdr_index = 0;
+  VMAddress note_address;
+  VMSize note_size;
+  while (program_headers_->GetNoteSegment(
+      &phdr_index, &note_address, &note_size)) {
+    ranges->emplace_back(note_address + GetLoadBias(), note_size);
+  }
+
+  VMAddress string_table_address;
+  VMSize string_table_size;
+  VMSize offset;
+  if (GetDynamicStringTable(false, &string_table_address, &string_table_size) &&
+      dynamic_array_->GetValue(DT_SONAME, false, &offset) &&
+      offset < string_table_size) {
+    // The name’s length isn’t known until it’s read, so only cover its start.
+    constexpr VMSize kSoNameSize = 256;
+    ranges->emplace_back(string_table_address + offset,
+                         std::min(string_table_size - offset, kSoNameSize));
+  }
+}
+
 bool ElfImageReader::GetDebugAddress(VMAddress* debug) {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   if (!InitializeDynamicArray()) {
@@ -722,12 +740,50 @@ bool ElfImageReader::InitializeDynamicSymbolTable() {
     return false;
   }
 
-  symbol_table_.reset(new ElfSymbolTableReader(
-      &memory_, this, symbol_table_address, number_of_symbol_table_entries));
+  // Prefer DT_GNU_HASH for lookups. Its Bloom filter rejects most names that
+  // aren't present without walking a chain, which is the common case when
+  // probing every module for a symbol that few of them define.
+  ElfSymbolTableReader::HashTableType hash_table_type =
+      ElfSymbolTableReader::HashTableType::kNone;
+  VMAddress hash_table_address = 0;
+  if (GetAddressFromDynamicArray(DT_GNU_HASH, false, &hash_table_address)) {
+    hash_table_type = ElfSymbolTableReader::HashTableType::kGnu;
+  } else if (GetAddressFromDynamicArray(DT_HASH, false, &hash_table_address)) {
+    hash_table_type = ElfSymbolTableReader::HashTableType::kSysV;
+  }
+
+  symbol_table_.reset(new ElfSymbolTableReader(&memory_,
+                                               this,
+                                               symbol_table_address,
+                                               number_of_symbol_table_entries,
+                                               hash_table_type,
+                                               hash_table_address));
   symbol_table_initialized_.set_valid();
   return true;
 }
 
+bool ElfImageReader::GetDynamicStringTable(bool log,
+                                           VMAddress* address,
+                                           VMSize* size) {
+  if (!InitializeDynamicArray()) {
+    return false;
+  }
+
+  if (!GetAddressFromDynamicArray(DT_STRTAB, log, address) ||
+      !dynamic_array_->GetValue(DT_STRSZ, log, size)) {
+    LOG_IF(ERROR, log) << "missing string table info";
+    return false;
+  }
+
+  // GNU ld.so doesn't adjust the vdso's dynamic array entries by the load bias.
+  // If the address is too small to point into the loaded module range and is
+  // small enough to be an offset from the base of the module, adjust it now.
+  if (*address < memory_.Base() && *address < memory_.Size()) {
+    *address += GetLoadBias();
+  }
+  return true;
+}
+
 bool ElfImageReader::GetAddressFromDynamicArray(uint64_t tag,
                                                 bool log,
                                                 VMAddress* address) {
@@ -21,12 +21,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "snapshot/elf/elf_dynamic_array_reader.h"
 #include "snapshot/elf/elf_symbol_table_reader.h"
 #include "util/misc/address_types.h"
 #include "util/misc/initialization_state.h"
 #include "util/misc/initialization_state_dcheck.h"
+#include "util/numeric/checked_range.h"
 #include "util/process/process_memory_range.h"
 
 namespace crashpad {
@@ -188,6 +190,17 @@ class ElfImageReader {
   //! \return `true` on success. Otherwise `false` with a message logged.
   bool ReadDynamicStringTableAtOffset(VMSize offset, std::string* string);
 
+  //! \brief Adds the regions of memory holding this image’s notes and the
+  //!     name referenced by `DT_SONAME` to \a ranges.
+  //!
+  //! These small structures are read to identify a module. Collecting their
+  //! regions for many images allows them to be fetched together, for example
+  //! by ProcessMemoryCached::Prefetch(), rather than by a separate read for
+  //! each.
+  //!
+  //! \param[in,out] ranges The vector to append the regions to.
+  void GetMetadataRanges(std::vector<CheckedRange<VMAddress, VMSize>>* ranges);
+
   //! \brief Determine the debug address.
   //!
   //! The debug address is a pointer to an `r_debug` struct defined in
@@ -274,6 +287,7 @@ class ElfImageReader {
   bool InitializeProgramHeaders(bool verbose);
   bool InitializeDynamicArray();
   bool InitializeDynamicSymbolTable();
+  bool GetDynamicStringTable(bool log, VMAddress* address, VMSize* size);
   bool GetAddressFromDynamicArray(uint64_t tag, bool log, VMAddress* address);
 
   union {
@@ -16,10 +16,18 @@
 
 #include <dlfcn.h>
 #include <link.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "build/build_config.h"
 #include "gtest/gtest.h"
+#include "snapshot/elf/elf_symbol_table_reader.h"
 #include "test/multiprocess_exec.h"
 #include "test/process_type.h"
 #include "test/scoped_module_handle.h"
@@ -184,7 +192,7 @@ void ReadThisExecutableInTarget(ProcessType process,
 
 void ReadLibcInTarget(ProcessType process,
                       VMAddress elf_address,
-                      VMAddress getpid_address) {
+                      const std::map<std::string, VMAddress>& symbols) {
 #if defined(ARCH_CPU_64_BITS)
   constexpr bool am_64_bit = true;
 #else
@@ -206,7 +214,10 @@ void ReadLibcInTarget(ProcessType process,
   ElfImageReader reader;
   ASSERT_TRUE(reader.Initialize(range, elf_address));
 
-  ExpectSymbol(&reader, "getpid", getpid_address);
+  for (const auto& symbol : symbols) {
+    SCOPED_TRACE(symbol.first);
+    ExpectSymbol(&reader, symbol.first, symbol.second);
+  }
 }
 
 TEST(ElfImageReader, MainExecutableSelf) {
@@ -255,8 +266,16 @@ TEST(ElfImageReader, OneModuleSelf) {
   ASSERT_TRUE(dladdr(reinterpret_cast<void*>(getpid), &info)) << "dladdr:"
                                                               << dlerror();
   VMAddress elf_address = FromPointerCast<VMAddress>(info.dli_fbase);
-  ReadLibcInTarget(
-      GetSelfProcess(), elf_address, FromPointerCast<VMAddress>(getpid));
+
+  // Look up several symbols so that lookups through the module's hash table
+  // visit more than one bucket.
+  ReadLibcInTarget(GetSelfProcess(),
+                   elf_address,
+                   {{"close", FromPointerCast<VMAddress>(close)},
+                    {"dup", FromPointerCast<VMAddress>(dup)},
+                    {"getpid", FromPointerCast<VMAddress>(getpid)},
+                    {"getppid", FromPointerCast<VMAddress>(getppid)},
+                    {"pipe", FromPointerCast<VMAddress>(pipe)}});
 }
 
 CRASHPAD_CHILD_TEST_MAIN(ReadLibcChild) {
@@ -290,7 +309,8 @@ class ReadLibcChildTest : public MultiprocessExec {
     CheckedReadFileExactly(ReadPipeHandle(), &elf_address, sizeof(elf_address));
     CheckedReadFileExactly(
         ReadPipeHandle(), &getpid_address, sizeof(getpid_address));
-    ReadLibcInTarget(ChildProcess(), elf_address, getpid_address);
+    ReadLibcInTarget(
+        ChildProcess(), elf_address, {{"getpid", getpid_address}});
   }
 };
 
@@ -300,6 +320,371 @@ TEST(ElfImageReader, OneModuleChild) {
   test.Run();
 }
 
+#if defined(ARCH_CPU_64_BITS)
+using Ehdr = Elf64_Ehdr;
+using Phdr = Elf64_Phdr;
+using Dyn = Elf64_Dyn;
+using Sym = Elf64_Sym;
+constexpr unsigned char kElfClass = ELFCLASS64;
+constexpr unsigned char kFunctionSymbolInfo =
+    ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+#else
+using Ehdr = Elf32_Ehdr;
+using Phdr = Elf32_Phdr;
+using Dyn = Elf32_Dyn;
+using Sym = Elf32_Sym;
+constexpr unsigned char kElfClass = ELFCLASS32;
+constexpr unsigned char kFunctionSymbolInfo =
+    ELF32_ST_INFO(STB_GLOBAL, STT_FUNC);
+#endif  // ARCH_CPU_64_BITS
+
+uint32_t SysVHash(const std::string& name) {
+  uint32_t hash = 0;
+  for (unsigned char c : name) {
+    hash = (hash << 4) + c;
+    const uint32_t high = hash & 0xf0000000;
+    if (high) {
+      hash ^= high >> 24;
+    }
+    hash &= ~high;
+  }
+  return hash;
+}
+
+uint32_t GnuHash(const std::string& name) {
+  uint32_t hash = 5381;
+  for (unsigned char c : name) {
+    hash = hash * 33 + c;
+  }
+  return hash;
+}
+
+// An ELF image built in this process’ memory, with a dynamic symbol table and
+// optionally DT_HASH and DT_GNU_HASH tables. Linkers always emit at least one
+// of the hash tables, so this allows testing lookups in modules that have only
+// one of them, or neither. The image’s preferred address is the one it’s built
+// at, so its load bias is 0.
+class TestElfImage {
+ public:
+  // The symbol table holds |undefined_names|, followed by |defined_names|.
+  // The defined symbol named defined_names[i] has the value returned by
+  // SymbolValue(i) and size i + 1.
+  TestElfImage(const std::vector<std::string>& undefined_names,
+               const std::vector<std::string>& defined_names,
+               bool dt_hash,
+               bool dt_gnu_hash) {
+    // Symbol 0 is the reserved undefined symbol, with an empty name.
+    std::string strings(1, '\0');
+    std::vector<Sym> symbols(1);
+    for (const std::string& name : undefined_names) {
+      Sym symbol = {};
+      symbol.st_name = AddString(name, &strings);
+      symbol.st_info = kFunctionSymbolInfo;
+      symbol.st_shndx = SHN_UNDEF;
+      symbols.push_back(symbol);
+    }
+    const uint32_t symoffset = static_cast<uint32_t>(symbols.size());
+
+    // DT_GNU_HASH requires the defined symbols to be sorted by bucket.
+    const uint32_t gnu_nbuckets =
+        static_cast<uint32_t>(defined_names.size() / 4 + 1);
+    std::vector<size_t> order(defined_names.size());
+    for (size_t index = 0; index < order.size(); ++index) {
+      order[index] = index;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return GnuHash(defined_names[a]) % gnu_nbuckets <
+             GnuHash(defined_names[b]) % gnu_nbuckets;
+    });
+    for (size_t index : order) {
+      Sym symbol = {};
+      symbol.st_name = AddString(defined_names[index], &strings);
+      symbol.st_value = SymbolValue(index);
+      symbol.st_size = index + 1;
+      symbol.st_info = kFunctionSymbolInfo;
+      symbol.st_shndx = 1;
+      symbols.push_back(symbol);
+    }
+    symbol_count_ = symbols.size();
+
+    std::vector<uint32_t> sysv_hash;
+    if (dt_hash) {
+      constexpr uint32_t kNBucket = 7;
+      sysv_hash.resize(2 + kNBucket + symbols.size());
+      sysv_hash[0] = kNBucket;
+      sysv_hash[1] = static_cast<uint32_t>(symbols.size());
+      uint32_t* buckets = &sysv_hash[2];
+      uint32_t* chains = &sysv_hash[2 + kNBucket];
+      for (uint32_t index = 1; index < symbols.size(); ++index) {
+        uint32_t& bucket =
+            buckets[SysVHash(&strings[symbols[index].st_name]) % kNBucket];
+        chains[index] = bucket;
+        bucket = index;
+      }
+    }
+
+    std::vector<uint32_t> gnu_hash;
+    if (dt_gnu_hash) {
+      using BloomWord = decltype(Sym::st_value);
+      constexpr uint32_t kBloomWordBits = sizeof(BloomWord) * 8;
+      constexpr uint32_t kBloomSize = 2;
+      constexpr uint32_t kBloomShift = 6;
+      std::vector<BloomWord> bloom(kBloomSize);
+      std::vector<uint32_t> buckets(gnu_nbuckets);
+      std::vector<uint32_t> chains;
+      for (uint32_t index = symoffset; index < symbols.size(); ++index) {
+        const uint32_t hash = GnuHash(&strings[symbols[index].st_name]);
+        bloom[(hash / kBloomWordBits) % kBloomSize] |=
+            (BloomWord{1} << (hash % kBloomWordBits)) |
+            (BloomWord{1} << ((hash >> kBloomShift) % kBloomWordBits));
+
+        uint32_t& bucket = buckets[hash % gnu_nbuckets];
+        if (!bucket) {
+          bucket = index;
+        } else {
+          chains.back() &= ~1u;
+        }
+        chains.push_back(hash | 1);
+      }
+
+      gnu_hash = {gnu_nbuckets, symoffset, kBloomSize, kBloomShift};
+      const uint32_t* bloom_words = reinterpret_cast<uint32_t*>(bloom.data());
+      gnu_hash.insert(gnu_hash.end(),
+                      bloom_words,
+                      bloom_words + sizeof(BloomWord) / 4 * kBloomSize);
+      gnu_hash.insert(gnu_hash.end(), buckets.begin(), buckets.end());
+      gnu_hash.insert(gnu_hash.end(), chains.begin(), chains.end());
+    }
+
+    // Lay out the image, keeping each part aligned.
+    constexpr size_t kPhdrCount = 2;
+    constexpr size_t kDynCount = 7;
+    size_t size = 0;
+    auto allocate = [&size](size_t part_size) {
+      const size_t offset = size;
+      size += (part_size + 7) & ~7;
+      return offset;
+    };
+    allocate(sizeof(Ehdr));
+    const size_t phdrs_offset = allocate(sizeof(Phdr) * kPhdrCount);
+    const size_t dyns_offset = allocate(sizeof(Dyn) * kDynCount);
+    const size_t symbols_offset = allocate(sizeof(Sym) * symbols.size());
+    const size_t strings_offset = allocate(strings.size());
+    const size_t sysv_hash_offset =
+        allocate(sizeof(uint32_t) * sysv_hash.size());
+    const size_t gnu_hash_offset = allocate(sizeof(uint32_t) * gnu_hash.size());
+
+    image_.resize(size / sizeof(image_[0]));
+    char* base = reinterpret_cast<char*>(image_.data());
+    address_ = FromPointerCast<VMAddress>(base);
+    symbol_table_address_ = address_ + symbols_offset;
+    sysv_hash_address_ = dt_hash ? address_ + sysv_hash_offset : 0;
+    gnu_hash_address_ = dt_gnu_hash ? address_ + gnu_hash_offset : 0;
+
+    Ehdr* ehdr = reinterpret_cast<Ehdr*>(base);
+    memcpy(ehdr->e_ident, ELFMAG, SELFMAG);
+    ehdr->e_ident[EI_CLASS] = kElfClass;
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+    ehdr->e_ident[EI_DATA] = ELFDATA2LSB;
+#elif defined(ARCH_CPU_BIG_ENDIAN)
+    ehdr->e_ident[EI_DATA] = ELFDATA2MSB;
+#endif
+    ehdr->e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr->e_type = ET_DYN;
+    ehdr->e_version = EV_CURRENT;
+    ehdr->e_phoff = phdrs_offset;
+    ehdr->e_ehsize = sizeof(Ehdr);
+    ehdr->e_phentsize = sizeof(Phdr);
+    ehdr->e_phnum = kPhdrCount;
+
+    Phdr* phdrs = reinterpret_cast<Phdr*>(base + phdrs_offset);
+    phdrs[0].p_type = PT_LOAD;
+    phdrs[0].p_offset = 0;
+    phdrs[0].p_vaddr = address_;
+    phdrs[0].p_filesz = size;
+    phdrs[0].p_memsz = size;
+    phdrs[1].p_type = PT_DYNAMIC;
+    phdrs[1].p_offset = dyns_offset;
+    phdrs[1].p_vaddr = address_ + dyns_offset;
+    phdrs[1].p_filesz = sizeof(Dyn) * kDynCount;
+    phdrs[1].p_memsz = sizeof(Dyn) * kDynCount;
+
+    Dyn* dyn = reinterpret_cast<Dyn*>(base + dyns_offset);
+    auto add_dyn = [&dyn](decltype(Dyn::d_tag) tag, VMAddress value) {
+      dyn->d_tag = tag;
+      dyn->d_un.d_ptr = value;
+      ++dyn;
+    };
+    add_dyn(DT_SYMTAB, symbol_table_address_);
+    add_dyn(DT_SYMENT, sizeof(Sym));
+    add_dyn(DT_STRTAB, address_ + strings_offset);
+    add_dyn(DT_STRSZ, strings.size());
+    if (dt_hash) {
+      add_dyn(DT_HASH, sysv_hash_address_);
+    }
+    if (dt_gnu_hash) {
+      add_dyn(DT_GNU_HASH, gnu_hash_address_);
+    }
+    add_dyn(DT_NULL, 0);
+
+    memcpy(base + symbols_offset, symbols.data(), sizeof(Sym) * symbols.size());
+    memcpy(base + strings_offset, strings.data(), strings.size());
+    if (dt_hash) {
+      memcpy(base + sysv_hash_offset,
+             sysv_hash.data(),
+             sizeof(uint32_t) * sysv_hash.size());
+    }
+    if (dt_gnu_hash) {
+      memcpy(base + gnu_hash_offset,
+             gnu_hash.data(),
+             sizeof(uint32_t) * gnu_hash.size());
+    }
+  }
+
+  TestElfImage(const TestElfImage&) = delete;
+  TestElfImage& operator=(const TestElfImage&) = delete;
+
+  static VMAddress SymbolValue(size_t index) { return 0x10000 + 0x10 * index; }
+
+  VMAddress Address() const { return address_; }
+  VMAddress SymbolTableAddress() const { return symbol_table_address_; }
+  VMSize SymbolCount() const { return symbol_count_; }
+  VMAddress SysVHashAddress() const { return sysv_hash_address_; }
+  VMAddress GnuHashAddress() const { return gnu_hash_address_; }
+
+ private:
+  static uint32_t AddString(const std::string& string, std::string* strings) {
+    const uint32_t offset = static_cast<uint32_t>(strings->size());
+    strings->append(string.c_str(), string.size() + 1);
+    return offset;
+  }
+
+  // uint64_t elements keep every part of the image suitably aligned.
+  std::vector<uint64_t> image_;
+  VMAddress address_;
+  VMAddress symbol_table_address_;
+  VMSize symbol_count_;
+  VMAddress sysv_hash_address_;
+  VMAddress gnu_hash_address_;
+};
+
+// Looks symbols up in a TestElfImage through each hash table that it has, and
+// through ElfImageReader, and expects the same results as scanning its symbol
+// table.
+void ExpectHashLookupsMatchScan(bool dt_hash, bool dt_gnu_hash) {
+#if defined(ARCH_CPU_64_BITS)
+  constexpr bool am_64_bit = true;
+#else
+  constexpr bool am_64_bit = false;
+#endif  // ARCH_CPU_64_BITS
+
+  std::vector<std::string> undefined_names;
+  for (int index = 0; index < 5; ++index) {
+    undefined_names.push_back("undefined_" + std::to_string(index));
+  }
+  std::vector<std::string> defined_names;
+  for (int index = 0; index < 100; ++index) {
+    defined_names.push_back("symbol_" + std::to_string(index));
+  }
+  TestElfImage image(undefined_names, defined_names, dt_hash, dt_gnu_hash);
+
+#if BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  FakePtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(GetSelfProcess()));
+  ProcessMemoryLinux memory(&connection);
+#else
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+#endif
+
+  ProcessMemoryRange range;
+  ASSERT_TRUE(range.Initialize(&memory, am_64_bit));
+
+  ElfImageReader reader;
+  ASSERT_TRUE(reader.Initialize(range, image.Address()));
+
+  ElfSymbolTableReader scan(
+      &range, &reader, image.SymbolTableAddress(), image.SymbolCount());
+  std::vector<std::unique_ptr<ElfSymbolTableReader>> hash_readers;
+  if (dt_hash) {
+    hash_readers.push_back(std::make_unique<ElfSymbolTableReader>(
+        &range,
+        &reader,
+        image.SymbolTableAddress(),
+        image.SymbolCount(),
+        ElfSymbolTableReader::HashTableType::kSysV,
+        image.SysVHashAddress()));
+  }
+  if (dt_gnu_hash) {
+    hash_readers.push_back(std::make_unique<ElfSymbolTableReader>(
+        &range,
+        &reader,
+        image.SymbolTableAddress(),
+        image.SymbolCount(),
+        ElfSymbolTableReader::HashTableType::kGnu,
+        image.GnuHashAddress()));
+  }
+
+  std::vector<std::string> names = defined_names;
+  names.insert(names.end(),
+               {"notasymbol", "symbol_", "symbol_100", "Symbol_0"});
+  for (size_t index = 0; index < names.size(); ++index) {
+    const std::string& name = names[index];
+    SCOPED_TRACE(name);
+
+    ElfSymbolTableReader::SymbolInformation scan_info;
+    const bool scan_found = scan.GetSymbol(name, &scan_info);
+    ASSERT_EQ(scan_found, index < defined_names.size());
+    if (scan_found) {
+      EXPECT_EQ(scan_info.address, TestElfImage::SymbolValue(index));
+      EXPECT_EQ(scan_info.size, index + 1);
+    }
+
+    for (const auto& hash_reader : hash_readers) {
+      ElfSymbolTableReader::SymbolInformation info;
+      ASSERT_EQ(hash_reader->GetSymbol(name, &info), scan_found);
+      if (scan_found) {
+        EXPECT_EQ(info.address, scan_info.address);
+        EXPECT_EQ(info.size, scan_info.size);
+      }
+    }
+
+    // ElfImageReader finds the same symbols, except that without a hash
+    // table, the number of symbols isn’t known, so it can’t find any.
+    VMAddress address;
+    VMSize size;
+    ASSERT_EQ(reader.GetDynamicSymbol(name, &address, &size),
+              scan_found && (dt_hash || dt_gnu_hash));
+    if (scan_found && (dt_hash || dt_gnu_hash)) {
+      EXPECT_EQ(address, scan_info.address);
+      EXPECT_EQ(size, scan_info.size);
+    }
+  }
+
+  for (const std::string& name : undefined_names) {
+    SCOPED_TRACE(name);
+    VMAddress address;
+    VMSize size;
+    EXPECT_FALSE(reader.GetDynamicSymbol(name, &address, &size));
+  }
+}
+
+TEST(ElfImageReader, DtHashOnlyLookupsMatchScan) {
+  ExpectHashLookupsMatchScan(true, false);
+}
+
+TEST(ElfImageReader, DtGnuHashOnlyLookupsMatchScan) {
+  ExpectHashLookupsMatchScan(false, true);
+}
+
+TEST(ElfImageReader, BothHashTablesLookupsMatchScan) {
+  ExpectHashLookupsMatchScan(true, true);
+}
+
+TEST(ElfImageReader, NoHashTableLookupsMatchScan) {
+  ExpectHashLookupsMatchScan(false, false);
+}
+
 #if BUILDFLAG(IS_FUCHSIA)
 
 // crashpad_snapshot_test_both_dt_hash_styles is specially built and forced to
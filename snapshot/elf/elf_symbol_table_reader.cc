@@ -16,6 +16,7 @@
 
 #include <elf.h>
 
+#include "base/logging.h"
 #include "snapshot/elf/elf_image_reader.h"
 
 namespace crashpad {
@@ -46,23 +47,263 @@ uint8_t GetVisibility(const Elf64_Sym& sym) {
   return ELF64_ST_VISIBILITY(sym.st_other);
 }
 
+template <typename SymEnt>
+void SetSymbolInformation(const SymEnt& entry,
+                          ElfSymbolTableReader::SymbolInformation* info) {
+  info->address = entry.st_value;
+  info->size = entry.st_size;
+  info->shndx = entry.st_shndx;
+  info->binding = GetBinding(entry);
+  info->type = GetType(entry);
+  info->visibility = GetVisibility(entry);
+}
+
+// The hash function for DT_HASH tables, from the System V ABI.
+uint32_t SysVHash(const std::string& name) {
+  uint32_t hash = 0;
+  for (unsigned char c : name) {
+    hash = (hash << 4) + c;
+    const uint32_t high = hash & 0xf0000000;
+    if (high) {
+      hash ^= high >> 24;
+    }
+    hash &= ~high;
+  }
+  return hash;
+}
+
+// The hash function for DT_GNU_HASH tables.
+uint32_t GnuHash(const std::string& name) {
+  uint32_t hash = 5381;
+  for (unsigned char c : name) {
+    hash = hash * 33 + c;
+  }
+  return hash;
+}
+
 }  // namespace
 
 ElfSymbolTableReader::ElfSymbolTableReader(const ProcessMemoryRange* memory,
                                            ElfImageReader* elf_reader,
                                            VMAddress address,
-                                           VMSize num_entries)
+                                           VMSize num_entries,
+                                           HashTableType hash_table_type,
+                                           VMAddress hash_table_address)
     : memory_(memory),
       elf_reader_(elf_reader),
       base_address_(address),
-      num_entries_(num_entries) {}
+      num_entries_(num_entries),
+      hash_table_type_(hash_table_type),
+      hash_table_address_(hash_table_address) {}
 
 ElfSymbolTableReader::~ElfSymbolTableReader() {}
 
 bool ElfSymbolTableReader::GetSymbol(const std::string& name,
                                      SymbolInformation* info) {
-  return memory_->Is64Bit() ? ScanSymbolTable<Elf64_Sym>(name, info)
-                            : ScanSymbolTable<Elf32_Sym>(name, info);
+  return memory_->Is64Bit() ? LookUpSymbol<Elf64_Sym>(name, info)
+                            : LookUpSymbol<Elf32_Sym>(name, info);
+}
+
+template <typename SymEnt>
+bool ElfSymbolTableReader::LookUpSymbol(const std::string& name,
+                                        SymbolInformation* info_out) {
+  bool found;
+  switch (hash_table_type_) {
+    case HashTableType::kNone:
+      break;
+
+    case HashTableType::kSysV:
+      if (LookUpSysVHash<SymEnt>(name, info_out, &found)) {
+        return found;
+      }
+      break;
+
+    case HashTableType::kGnu:
+      if (LookUpGnuHash<SymEnt>(name, info_out, &found)) {
+        return found;
+      }
+      break;
+  }
+  return ScanSymbolTable<SymEnt>(name, info_out);
+}
+
+template <typename SymEnt>
+bool ElfSymbolTableReader::LookUpSysVHash(const std::string& name,
+                                          SymbolInformation* info_out,
+                                          bool* found) {
+  struct {
+    uint32_t nbucket;
+    uint32_t nchain;
+  } header;
+  if (!memory_->Read(hash_table_address_, sizeof(header), &header)) {
+    LOG(ERROR) << "failed to read DT_HASH header";
+    return false;
+  }
+
+  *found = false;
+  if (header.nbucket == 0) {
+    return true;
+  }
+
+  const VMAddress buckets_address = hash_table_address_ + sizeof(header);
+  const VMAddress chains_address =
+      buckets_address + sizeof(uint32_t) * header.nbucket;
+
+  uint32_t index;
+  if (!memory_->Read(
+          buckets_address + sizeof(index) * (SysVHash(name) % header.nbucket),
+          sizeof(index),
+          &index)) {
+    LOG(ERROR) << "failed to read DT_HASH bucket";
+    return false;
+  }
+
+  // A chain can't be longer than the table, so stop there rather than loop
+  // forever if the table is corrupt.
+  for (uint32_t length = 0; index != STN_UNDEF; ++length) {
+    if (index >= header.nchain || length >= header.nchain) {
+      LOG(ERROR) << "invalid DT_HASH chain";
+      return false;
+    }
+
+    bool matched;
+    if (!MatchSymbol<SymEnt>(index, name, info_out, &matched)) {
+      return false;
+    }
+    if (matched) {
+      *found = true;
+      return true;
+    }
+
+    if (!memory_->Read(
+            chains_address + sizeof(index) * index, sizeof(index), &index)) {
+      LOG(ERROR) << "failed to read DT_HASH chain";
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename SymEnt>
+bool ElfSymbolTableReader::LookUpGnuHash(const std::string& name,
+                                         SymbolInformation* info_out,
+                                         bool* found) {
+  // See https://flapenguin.me/2017/05/10/elf-lookup-dt-gnu-hash/ and
+  // https://sourceware.org/ml/binutils/2006-10/msg00377.html.
+  struct {
+    uint32_t nbuckets;
+    uint32_t symoffset;
+    uint32_t bloom_size;
+    uint32_t bloom_shift;
+  } header;
+  if (!memory_->Read(hash_table_address_, sizeof(header), &header)) {
+    LOG(ERROR) << "failed to read DT_GNU_HASH header";
+    return false;
+  }
+
+  using BloomWord = decltype(SymEnt::st_value);
+  constexpr uint32_t kBloomWordBits = sizeof(BloomWord) * 8;
+  if (header.bloom_shift >= 32) {
+    LOG(ERROR) << "invalid DT_GNU_HASH bloom shift " << header.bloom_shift;
+    return false;
+  }
+
+  *found = false;
+  if (header.nbuckets == 0) {
+    return true;
+  }
+
+  const uint32_t hash = GnuHash(name);
+
+  // The Bloom filter rejects most names that aren't in the table without
+  // needing to walk a chain.
+  const VMAddress bloom_address = hash_table_address_ + sizeof(header);
+  if (header.bloom_size > 0) {
+    BloomWord bloom_word;
+    if (!memory_->Read(bloom_address + sizeof(bloom_word) *
+                                           ((hash / kBloomWordBits) %
+                                            header.bloom_size),
+                       sizeof(bloom_word),
+                       &bloom_word)) {
+      LOG(ERROR) << "failed to read DT_GNU_HASH bloom filter";
+      return false;
+    }
+    const BloomWord mask =
+        (BloomWord{1} << (hash % kBloomWordBits)) |
+        (BloomWord{1} << ((hash >> header.bloom_shift) % kBloomWordBits));
+    if ((bloom_word & mask) != mask) {
+      return true;
+    }
+  }
+
+  const VMAddress buckets_address =
+      bloom_address + sizeof(BloomWord) * header.bloom_size;
+  const VMAddress chains_address =
+      buckets_address + sizeof(uint32_t) * header.nbuckets;
+
+  uint32_t index;
+  if (!memory_->Read(buckets_address + sizeof(index) * (hash % header.nbuckets),
+                     sizeof(index),
+                     &index)) {
+    LOG(ERROR) << "failed to read DT_GNU_HASH bucket";
+    return false;
+  }
+  if (index < header.symoffset) {
+    return true;
+  }
+
+  for (; index < num_entries_; ++index) {
+    uint32_t chain_hash;
+    if (!memory_->Read(
+            chains_address + sizeof(chain_hash) * (index - header.symoffset),
+            sizeof(chain_hash),
+            &chain_hash)) {
+      LOG(ERROR) << "failed to read DT_GNU_HASH chain";
+      return false;
+    }
+
+    // Chain entries hold each symbol's hash, with the low bit replaced by a
+    // flag marking the end of the chain.
+    if ((chain_hash | 1) == (hash | 1)) {
+      bool matched;
+      if (!MatchSymbol<SymEnt>(index, name, info_out, &matched)) {
+        return false;
+      }
+      if (matched) {
+        *found = true;
+        return true;
+      }
+    }
+
+    if (chain_hash & 1) {
+      return true;
+    }
+  }
+
+  LOG(ERROR) << "unterminated DT_GNU_HASH chain";
+  return false;
+}
+
+template <typename SymEnt>
+bool ElfSymbolTableReader::MatchSymbol(VMSize index,
+                                       const std::string& name,
+                                       SymbolInformation* info_out,
+                                       bool* matched) {
+  SymEnt entry;
+  if (!memory_->Read(
+          base_address_ + index * sizeof(entry), sizeof(entry), &entry)) {
+    LOG(ERROR) << "failed to read symbol " << index;
+    return false;
+  }
+
+  std::string string;
+  *matched = elf_reader_->ReadDynamicStringTableAtOffset(entry.st_name,
+                                                         &string) &&
+             string == name;
+  if (*matched) {
+    SetSymbolInformation(entry, info_out);
+  }
+  return true;
 }
 
 template <typename SymEnt>
@@ -75,12 +316,7 @@ bool ElfSymbolTableReader::ScanSymbolTable(const std::string& name,
   while (i < num_entries_ && memory_->Read(address, sizeof(entry), &entry)) {
     if (elf_reader_->ReadDynamicStringTableAtOffset(entry.st_name, &string) &&
         string == name) {
-      info_out->address = entry.st_value;
-      info_out->size = entry.st_size;
-      info_out->shndx = entry.st_shndx;
-      info_out->binding = GetBinding(entry);
-      info_out->type = GetType(entry);
-      info_out->visibility = GetVisibility(entry);
+      SetSymbolInformation(entry, info_out);
       return true;
     }
     // TODO(scottmg): This should respect DT_SYMENT if present.
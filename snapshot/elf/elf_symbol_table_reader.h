@@ -56,12 +56,34 @@ class ElfSymbolTableReader {
     uint8_t visibility;
   };
 
-  // TODO(jperaza): Support using .hash and .gnu.hash sections to improve symbol
-  // lookup.
+  //! \brief The type of hash table used to look up symbols.
+  enum class HashTableType {
+    //! \brief There is no hash table. Symbols are found by scanning the
+    //!     symbol table.
+    kNone,
+
+    //! \brief A System V hash table, identified by `DT_HASH`.
+    kSysV,
+
+    //! \brief A GNU hash table, identified by `DT_GNU_HASH`.
+    kGnu,
+  };
+
+  //! \param[in] memory A memory reader for the remote process.
+  //! \param[in] elf_reader The reader for the image containing the symbol
+  //!     table, used to read symbol names from its dynamic string table.
+  //! \param[in] address The address of the symbol table.
+  //! \param[in] num_entries The number of entries in the symbol table.
+  //! \param[in] hash_table_type The type of hash table at \a
+  //!     hash_table_address.
+  //! \param[in] hash_table_address The address of the hash table. Ignored if
+  //!     \a hash_table_type is HashTableType::kNone.
   ElfSymbolTableReader(const ProcessMemoryRange* memory,
                        ElfImageReader* elf_reader,
                        VMAddress address,
-                       VMSize num_entries);
+                       VMSize num_entries,
+                       HashTableType hash_table_type = HashTableType::kNone,
+                       VMAddress hash_table_address = 0);
 
   ElfSymbolTableReader(const ElfSymbolTableReader&) = delete;
   ElfSymbolTableReader& operator=(const ElfSymbolTableReader&) = delete;
@@ -70,12 +92,39 @@ class ElfSymbolTableReader {
 
   //! \brief Lookup information about a symbol.
   //!
+  //! If a hash table is available, only the symbols it contains can be found.
+  //! This includes every symbol defined by the module, but a `DT_GNU_HASH`
+  //! table omits undefined symbols. If the hash table can't be read, the
+  //! symbol table is scanned instead.
+  //!
   //! \param[in] name The name of the symbol to search for.
   //! \param[out] info The symbol information, if found.
   //! \return `true` if the symbol is found.
   bool GetSymbol(const std::string& name, SymbolInformation* info);
 
  private:
+  template <typename SymEnt>
+  bool LookUpSymbol(const std::string& name, SymbolInformation* info);
+
+  // The hash table lookups return false if the table can't be read, and
+  // otherwise set found to whether name is in the table.
+  template <typename SymEnt>
+  bool LookUpSysVHash(const std::string& name,
+                      SymbolInformation* info,
+                      bool* found);
+  template <typename SymEnt>
+  bool LookUpGnuHash(const std::string& name,
+                     SymbolInformation* info,
+                     bool* found);
+
+  // Returns false if the symbol at index can't be read, and otherwise sets
+  // matched to whether it is named name.
+  template <typename SymEnt>
+  bool MatchSymbol(VMSize index,
+                   const std::string& name,
+                   SymbolInformation* info,
+                   bool* matched);
+
   template <typename SymEnt>
   bool ScanSymbolTable(const std::string& name, SymbolInformation* info);
 
@@ -83,6 +132,8 @@ class ElfSymbolTableReader {
   ElfImageReader* const elf_reader_;  // weak
   const VMAddress base_address_;
   const VMSize num_entries_;
+  const HashTableType hash_table_type_;
+  const VMAddress hash_table_address_;
 };
 
 }  // namespace crashpad
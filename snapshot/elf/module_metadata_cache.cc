@@ -0,0 +1,281 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/elf/module_metadata_cache.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "util/file/file_io.h"
+#include "util/file/filesystem.h"
+#include "util/file/scoped_remove_file.h"
+#include "util/misc/random_string.h"
+
+namespace crashpad {
+
+namespace {
+
+// The cache file begins with a FileHeader, followed by FileHeader::entry_count
+// FileEntry structures ordered from most to least recently used.
+
+struct FileHeader {
+  static constexpr uint32_t kMagic = 'CPmc';
+  static constexpr uint32_t kVersion = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t padding;
+};
+
+struct FileEntry {
+  uint64_t device;
+  uint64_t inode;
+  int64_t modification_time;
+  uint64_t build_id_offset;
+  uint64_t crashpad_info_offset;
+  uint8_t build_id_size;
+  uint8_t has_crashpad_info;
+  uint8_t padding[6];
+  uint8_t build_id[ModuleMetadataCache::kMaxBuildIDSize];
+};
+
+}  // namespace
+
+ModuleMetadataCache::Entry::Entry()
+    : build_id(),
+      build_id_offset(0),
+      crashpad_info_offset(0),
+      has_crashpad_info(false) {}
+
+ModuleMetadataCache::Entry::~Entry() = default;
+
+ModuleMetadataCache::ModuleMetadataCache(const base::FilePath& path,
+                                         size_t max_entries)
+    : entries_(),
+      index_(),
+      path_(path),
+      max_entries_(max_entries),
+      modified_(false) {}
+
+ModuleMetadataCache::~ModuleMetadataCache() = default;
+
+bool ModuleMetadataCache::Load() {
+  Clear();
+  modified_ = false;
+
+  std::vector<std::pair<Key, Entry>> file_entries;
+  size_t file_entry_count;
+  if (!ReadFile(&file_entries, &file_entry_count)) {
+    return false;
+  }
+
+  for (auto& [key, entry] : file_entries) {
+    if (index_.find(key) == index_.end()) {
+      entries_.emplace_back(key, std::move(entry));
+      index_[key] = std::prev(entries_.end());
+    }
+  }
+
+  modified_ = file_entry_count != entries_.size();
+  return true;
+}
+
+bool ModuleMetadataCache::Save() {
+  if (!modified_) {
+    return true;
+  }
+
+  // Another handler may have saved the cache since it was loaded. Its entries
+  // are kept, as less recently used than the entries here.
+  std::vector<std::pair<Key, Entry>> saved_entries;
+  size_t saved_entry_count;
+  if (ReadFile(&saved_entries, &saved_entry_count)) {
+    for (auto& [key, entry] : saved_entries) {
+      if (entries_.size() >= max_entries_) {
+        break;
+      }
+      if (index_.find(key) == index_.end()) {
+        entries_.emplace_back(key, std::move(entry));
+        index_[key] = std::prev(entries_.end());
+      }
+    }
+  }
+
+  std::vector<FileEntry> file_entries;
+  file_entries.reserve(entries_.size());
+  for (const auto& [key, entry] : entries_) {
+    FileEntry file_entry;
+    memset(&file_entry, 0, sizeof(file_entry));
+    file_entry.device = key.device;
+    file_entry.inode = key.inode;
+    file_entry.modification_time = key.modification_time;
+    file_entry.build_id_offset = entry.build_id_offset;
+    file_entry.crashpad_info_offset = entry.crashpad_info_offset;
+    file_entry.build_id_size = static_cast<uint8_t>(entry.build_id.size());
+    file_entry.has_crashpad_info = entry.has_crashpad_info;
+    std::copy(
+        entry.build_id.begin(), entry.build_id.end(), file_entry.build_id);
+    file_entries.push_back(file_entry);
+  }
+
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = FileHeader::kMagic;
+  header.version = FileHeader::kVersion;
+  header.entry_count = static_cast<uint32_t>(file_entries.size());
+
+  // Write to a temporary file that replaces the cache once complete, so that
+  // a cache being read is never partially written. The temporary file’s name
+  // is unique, so that handlers saving the cache at the same time don’t write
+  // to the same file.
+  ScopedRemoveFile new_file(base::FilePath(
+      path_.value() + "." + RandomString() + ".new"));
+  {
+    ScopedFileHandle handle(
+        LoggingOpenFileForWrite(new_file.get(),
+                                FileWriteMode::kCreateOrFail,
+                                FilePermissions::kOwnerOnly));
+    if (!handle.is_valid()) {
+      new_file.release();
+      return false;
+    }
+    if (!LoggingWriteFile(handle.get(), &header, sizeof(header)) ||
+        (!file_entries.empty() &&
+         !LoggingWriteFile(handle.get(),
+                           file_entries.data(),
+                           file_entries.size() * sizeof(FileEntry)))) {
+      return false;
+    }
+  }
+
+  if (!MoveFileOrDirectory(new_file.get(), path_)) {
+    return false;
+  }
+  new_file.release();
+
+  modified_ = false;
+  return true;
+}
+
+bool ModuleMetadataCache::Lookup(const Key& key, Entry* entry) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return false;
+  }
+
+  // This doesn’t mark the cache as modified, so that a crash in which every
+  // module was found doesn’t rewrite the file. The new order is saved with the
+  // next entry that is inserted.
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *entry = it->second->second;
+  return true;
+}
+
+void ModuleMetadataCache::Insert(const Key& key, const Entry& entry) {
+  if (entry.build_id.empty() || entry.build_id.size() > kMaxBuildIDSize ||
+      max_entries_ == 0) {
+    return;
+  }
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+
+  while (entries_.size() >= max_entries_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+
+  entries_.emplace_front(key, entry);
+  index_[key] = entries_.begin();
+  modified_ = true;
+}
+
+bool ModuleMetadataCache::ReadFile(
+    std::vector<std::pair<Key, Entry>>* entries,
+    size_t* file_entry_count) {
+  entries->clear();
+  *file_entry_count = 0;
+
+  ScopedFileHandle handle(OpenFileForRead(path_));
+  if (!handle.is_valid()) {
+    if (errno == ENOENT) {
+      return true;
+    }
+    PLOG(ERROR) << "open " << path_.value();
+    return false;
+  }
+
+  FileHeader header;
+  if (!LoggingReadFileExactly(handle.get(), &header, sizeof(header))) {
+    return false;
+  }
+  if (header.magic != FileHeader::kMagic ||
+      header.version != FileHeader::kVersion) {
+    LOG(ERROR) << "invalid module metadata cache " << path_.value();
+    return false;
+  }
+
+  // Entries beyond the limit are the least recently used, so they can be
+  // discarded if the limit has been lowered.
+  const size_t entry_count =
+      std::min(static_cast<size_t>(header.entry_count), max_entries_);
+  std::vector<FileEntry> file_entries(entry_count);
+  if (entry_count > 0 &&
+      !LoggingReadFileExactly(handle.get(),
+                              file_entries.data(),
+                              entry_count * sizeof(FileEntry))) {
+    return false;
+  }
+
+  entries->reserve(entry_count);
+  for (const FileEntry& file_entry : file_entries) {
+    if (file_entry.build_id_size == 0 ||
+        file_entry.build_id_size > kMaxBuildIDSize) {
+      LOG(ERROR) << "invalid module metadata cache entry " << path_.value();
+      entries->clear();
+      return false;
+    }
+
+    Key key;
+    key.device = file_entry.device;
+    key.inode = file_entry.inode;
+    key.modification_time = file_entry.modification_time;
+
+    Entry entry;
+    entry.build_id.assign(file_entry.build_id,
+                          file_entry.build_id + file_entry.build_id_size);
+    entry.build_id_offset = file_entry.build_id_offset;
+    entry.crashpad_info_offset = file_entry.crashpad_info_offset;
+    entry.has_crashpad_info = file_entry.has_crashpad_info != 0;
+
+    entries->emplace_back(key, std::move(entry));
+  }
+
+  *file_entry_count = header.entry_count;
+  return true;
+}
+
+void ModuleMetadataCache::Clear() {
+  entries_.clear();
+  index_.clear();
+}
+
+}  // namespace crashpad
@@ -0,0 +1,169 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_ELF_MODULE_METADATA_CACHE_H_
+#define CRASHPAD_SNAPSHOT_ELF_MODULE_METADATA_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+
+namespace crashpad {
+
+//! \brief A persistent cache of metadata parsed from ELF modules.
+//!
+//! A process that crashes repeatedly loads the same modules each time, and
+//! the notes that identify each module would otherwise be searched for anew in
+//! every snapshot. This cache records where they were found, keyed by the
+//! identity of the module’s file on disk, so that they can be read directly in
+//! later snapshots.
+//!
+//! Each entry also records the module’s build ID, which must be found in the
+//! target process at the recorded location before the entry is used. The
+//! cache holds a bounded number of entries, evicting the least recently used
+//! entry first.
+//!
+//! This class is not thread-safe. Threads or processes that share a cache file
+//! must each use their own ModuleMetadataCache object.
+class ModuleMetadataCache {
+ public:
+  //! \brief Identifies a module’s file on disk.
+  struct Key {
+    //! \brief The device containing the file.
+    uint64_t device;
+
+    //! \brief The file’s inode number.
+    uint64_t inode;
+
+    //! \brief The file’s modification time, in nanoseconds since the epoch.
+    int64_t modification_time;
+
+    bool operator<(const Key& other) const {
+      return std::tie(device, inode, modification_time) <
+             std::tie(other.device, other.inode, other.modification_time);
+    }
+    bool operator==(const Key& other) const {
+      return device == other.device && inode == other.inode &&
+             modification_time == other.modification_time;
+    }
+  };
+
+  //! \brief Metadata for a module, with addresses given as offsets from the
+  //!     module’s load address.
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    //! \brief The module’s build ID.
+    std::vector<uint8_t> build_id;
+
+    //! \brief The offset of the build ID note’s descriptor.
+    uint64_t build_id_offset;
+
+    //! \brief The offset of the module’s CrashpadInfo structure. This is only
+    //!     valid if \a has_crashpad_info is `true`.
+    uint64_t crashpad_info_offset;
+
+    //! \brief Whether the module has a CrashpadInfo note.
+    bool has_crashpad_info;
+  };
+
+  //! \brief The largest build ID that can be cached, in bytes.
+  static constexpr size_t kMaxBuildIDSize = 64;
+
+  //! \brief The default maximum number of entries to cache.
+  static constexpr size_t kDefaultMaxEntries = 1024;
+
+  //! \param[in] path The path of the file that the cache is stored in.
+  //! \param[in] max_entries The maximum number of entries to cache.
+  explicit ModuleMetadataCache(const base::FilePath& path,
+                               size_t max_entries = kDefaultMaxEntries);
+
+  ModuleMetadataCache(const ModuleMetadataCache&) = delete;
+  ModuleMetadataCache& operator=(const ModuleMetadataCache&) = delete;
+
+  ~ModuleMetadataCache();
+
+  //! \brief Loads the cache from disk, replacing any entries already present.
+  //!
+  //! A cache file that does not exist is treated as an empty cache.
+  //!
+  //! \return `true` on success. `false` with a message logged if the cache
+  //!     file could not be read or was not valid, in which case the cache is
+  //!     left empty.
+  bool Load();
+
+  //! \brief Writes the cache to disk, if entries have been inserted or
+  //!     discarded since it was last loaded or saved.
+  //!
+  //! Entries that another ModuleMetadataCache object has saved to the same
+  //! file since this one loaded it are kept, as less recently used than the
+  //! entries in this object, up to the maximum number of entries. Objects that
+  //! save the same file at the same time don’t corrupt it, but only the last
+  //! one to finish takes effect.
+  //!
+  //! \return `true` on success, `false` with a message logged on failure.
+  bool Save();
+
+  //! \brief Looks up an entry, marking it as the most recently used.
+  //!
+  //! This does not cause Save() to write the cache, but the new order is
+  //! written along with any later change.
+  //!
+  //! \param[in] key The key to look up.
+  //! \param[out] entry The entry for \a key, if it was found.
+  //! \return `true` if an entry was found, otherwise `false`.
+  bool Lookup(const Key& key, Entry* entry);
+
+  //! \brief Adds or replaces an entry, marking it as the most recently used.
+  //!
+  //! If the cache is full, the least recently used entry is evicted. Entries
+  //! with an empty build ID, or one larger than #kMaxBuildIDSize, are not
+  //! cached.
+  //!
+  //! \param[in] key The key to add an entry for.
+  //! \param[in] entry The entry.
+  void Insert(const Key& key, const Entry& entry);
+
+  //! \brief Returns the number of entries in the cache.
+  size_t Size() const { return entries_.size(); }
+
+ private:
+  using EntryList = std::list<std::pair<Key, Entry>>;
+
+  // Reads the entries in the cache file, from most to least recently used, up
+  // to max_entries_. file_entry_count is set to the number of entries in the
+  // file. A file that does not exist is read as empty.
+  bool ReadFile(std::vector<std::pair<Key, Entry>>* entries,
+                size_t* file_entry_count);
+  void Clear();
+
+  // Entries, ordered from most to least recently used.
+  EntryList entries_;
+  std::map<Key, EntryList::iterator> index_;
+  base::FilePath path_;
+  size_t max_entries_;
+  bool modified_;
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_ELF_MODULE_METADATA_CACHE_H_
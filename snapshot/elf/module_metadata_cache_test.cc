@@ -0,0 +1,349 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/elf/module_metadata_cache.h"
+
+#include <dlfcn.h>
+
+#include "build/build_config.h"
+#include "gtest/gtest.h"
+#include "snapshot/elf/elf_image_reader.h"
+#include "snapshot/elf/module_snapshot_elf.h"
+#include "test/filesystem.h"
+#include "test/process_type.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+#include "util/file/filesystem.h"
+#include "util/misc/from_pointer_cast.h"
+#include "util/process/process_memory_native.h"
+#include "util/process/process_memory_range.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include "test/linux/fake_ptrace_connection.h"
+#endif
+
+namespace crashpad {
+namespace test {
+namespace {
+
+ModuleMetadataCache::Key MakeKey(uint64_t inode) {
+  ModuleMetadataCache::Key key;
+  key.device = 1;
+  key.inode = inode;
+  key.modification_time = 1234567890;
+  return key;
+}
+
+ModuleMetadataCache::Entry MakeEntry(uint8_t build_id) {
+  ModuleMetadataCache::Entry entry;
+  entry.build_id = {build_id, build_id, build_id, build_id};
+  entry.build_id_offset = 0x100 + build_id;
+  entry.crashpad_info_offset = 0x2000 + build_id;
+  entry.has_crashpad_info = build_id % 2 == 0;
+  return entry;
+}
+
+void ExpectEntriesEqual(const ModuleMetadataCache::Entry& actual,
+                        const ModuleMetadataCache::Entry& expected) {
+  EXPECT_EQ(actual.build_id, expected.build_id);
+  EXPECT_EQ(actual.build_id_offset, expected.build_id_offset);
+  EXPECT_EQ(actual.crashpad_info_offset, expected.crashpad_info_offset);
+  EXPECT_EQ(actual.has_crashpad_info, expected.has_crashpad_info);
+}
+
+TEST(ModuleMetadataCache, MissingFile) {
+  ScopedTempDir temp_dir;
+  ModuleMetadataCache cache(temp_dir.path().Append(FILE_PATH_LITERAL("cache")));
+  EXPECT_TRUE(cache.Load());
+  EXPECT_EQ(cache.Size(), 0u);
+
+  ModuleMetadataCache::Entry entry;
+  EXPECT_FALSE(cache.Lookup(MakeKey(1), &entry));
+}
+
+TEST(ModuleMetadataCache, SaveAndLoad) {
+  ScopedTempDir temp_dir;
+  const base::FilePath path =
+      temp_dir.path().Append(FILE_PATH_LITERAL("cache"));
+
+  {
+    ModuleMetadataCache cache(path);
+    ASSERT_TRUE(cache.Load());
+    cache.Insert(MakeKey(1), MakeEntry(1));
+    cache.Insert(MakeKey(2), MakeEntry(2));
+    ASSERT_TRUE(cache.Save());
+  }
+
+  ModuleMetadataCache cache(path);
+  ASSERT_TRUE(cache.Load());
+  EXPECT_EQ(cache.Size(), 2u);
+
+  ModuleMetadataCache::Entry entry;
+  ASSERT_TRUE(cache.Lookup(MakeKey(1), &entry));
+  ExpectEntriesEqual(entry, MakeEntry(1));
+  ASSERT_TRUE(cache.Lookup(MakeKey(2), &entry));
+  ExpectEntriesEqual(entry, MakeEntry(2));
+
+  ModuleMetadataCache::Key key = MakeKey(1);
+  key.modification_time += 1;
+  EXPECT_FALSE(cache.Lookup(key, &entry));
+}
+
+TEST(ModuleMetadataCache, EvictLeastRecentlyUsed) {
+  ScopedTempDir temp_dir;
+  const base::FilePath path =
+      temp_dir.path().Append(FILE_PATH_LITERAL("cache"));
+
+  {
+    ModuleMetadataCache cache(path, 2);
+    ASSERT_TRUE(cache.Load());
+    cache.Insert(MakeKey(1), MakeEntry(1));
+    cache.Insert(MakeKey(2), MakeEntry(2));
+
+    ModuleMetadataCache::Entry entry;
+    ASSERT_TRUE(cache.Lookup(MakeKey(1), &entry));
+
+    cache.Insert(MakeKey(3), MakeEntry(3));
+    EXPECT_EQ(cache.Size(), 2u);
+    EXPECT_TRUE(cache.Lookup(MakeKey(1), &entry));
+    EXPECT_FALSE(cache.Lookup(MakeKey(2), &entry));
+    EXPECT_TRUE(cache.Lookup(MakeKey(3), &entry));
+    ASSERT_TRUE(cache.Save());
+  }
+
+  // The order of use is preserved on disk, with 3 used more recently than 1.
+  ModuleMetadataCache cache(path, 2);
+  ASSERT_TRUE(cache.Load());
+  cache.Insert(MakeKey(4), MakeEntry(4));
+
+  ModuleMetadataCache::Entry entry;
+  EXPECT_FALSE(cache.Lookup(MakeKey(1), &entry));
+  EXPECT_TRUE(cache.Lookup(MakeKey(3), &entry));
+  EXPECT_TRUE(cache.Lookup(MakeKey(4), &entry));
+}
+
+TEST(ModuleMetadataCache, LookupDoesNotSave) {
+  ScopedTempDir temp_dir;
+  const base::FilePath path =
+      temp_dir.path().Append(FILE_PATH_LITERAL("cache"));
+
+  {
+    ModuleMetadataCache cache(path);
+    cache.Insert(MakeKey(1), MakeEntry(1));
+    cache.Insert(MakeKey(2), MakeEntry(2));
+    ASSERT_TRUE(cache.Save());
+  }
+
+  ModuleMetadataCache cache(path);
+  ASSERT_TRUE(cache.Load());
+  ModuleMetadataCache::Entry entry;
+  ASSERT_TRUE(cache.Lookup(MakeKey(1), &entry));
+
+  // Reordering entries doesn’t cause the file to be rewritten.
+  ASSERT_TRUE(LoggingRemoveFile(path));
+  ASSERT_TRUE(cache.Save());
+  EXPECT_FALSE(PathExists(path));
+
+  // The new order is written once an entry is inserted.
+  cache.Insert(MakeKey(3), MakeEntry(3));
+  ASSERT_TRUE(cache.Save());
+  ModuleMetadataCache reloaded(path, 2);
+  ASSERT_TRUE(reloaded.Load());
+  EXPECT_TRUE(reloaded.Lookup(MakeKey(3), &entry));
+  EXPECT_TRUE(reloaded.Lookup(MakeKey(1), &entry));
+  EXPECT_FALSE(reloaded.Lookup(MakeKey(2), &entry));
+}
+
+TEST(ModuleMetadataCache, MergeOnSave) {
+  ScopedTempDir temp_dir;
+  const base::FilePath path =
+      temp_dir.path().Append(FILE_PATH_LITERAL("cache"));
+
+  ModuleMetadataCache cache_1(path);
+  ModuleMetadataCache cache_2(path);
+  ASSERT_TRUE(cache_1.Load());
+  ASSERT_TRUE(cache_2.Load());
+
+  cache_1.Insert(MakeKey(1), MakeEntry(1));
+  cache_2.Insert(MakeKey(2), MakeEntry(2));
+  ASSERT_TRUE(cache_1.Save());
+  ASSERT_TRUE(cache_2.Save());
+
+  ModuleMetadataCache cache(path);
+  ASSERT_TRUE(cache.Load());
+  EXPECT_EQ(cache.Size(), 2u);
+  ModuleMetadataCache::Entry entry;
+  ASSERT_TRUE(cache.Lookup(MakeKey(1), &entry));
+  ExpectEntriesEqual(entry, MakeEntry(1));
+  ASSERT_TRUE(cache.Lookup(MakeKey(2), &entry));
+  ExpectEntriesEqual(entry, MakeEntry(2));
+
+  // The entry saved last is the most recently used.
+  ModuleMetadataCache small_cache(path, 1);
+  ASSERT_TRUE(small_cache.Load());
+  EXPECT_TRUE(small_cache.Lookup(MakeKey(2), &entry));
+  EXPECT_FALSE(small_cache.Lookup(MakeKey(1), &entry));
+}
+
+TEST(ModuleMetadataCache, NoBuildID) {
+  ScopedTempDir temp_dir;
+  ModuleMetadataCache cache(temp_dir.path().Append(FILE_PATH_LITERAL("cache")));
+
+  cache.Insert(MakeKey(1), ModuleMetadataCache::Entry());
+
+  ModuleMetadataCache::Entry entry = MakeEntry(2);
+  entry.build_id.resize(ModuleMetadataCache::kMaxBuildIDSize + 1);
+  cache.Insert(MakeKey(2), entry);
+
+  EXPECT_EQ(cache.Size(), 0u);
+}
+
+TEST(ModuleMetadataCache, InvalidFile) {
+  ScopedTempDir temp_dir;
+  const base::FilePath path =
+      temp_dir.path().Append(FILE_PATH_LITERAL("cache"));
+
+  {
+    ScopedFileHandle handle(LoggingOpenFileForWrite(
+        path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+    ASSERT_TRUE(handle.is_valid());
+    static constexpr char kContents[] = "not a module metadata cache";
+    ASSERT_TRUE(LoggingWriteFile(handle.get(), kContents, sizeof(kContents)));
+  }
+
+  ModuleMetadataCache cache(path);
+  EXPECT_FALSE(cache.Load());
+  EXPECT_EQ(cache.Size(), 0u);
+
+  // The invalid file is replaced once the cache is saved.
+  cache.Insert(MakeKey(1), MakeEntry(1));
+  ASSERT_TRUE(cache.Save());
+  ASSERT_TRUE(cache.Load());
+  EXPECT_EQ(cache.Size(), 1u);
+}
+
+TEST(ModuleMetadataCache, EmptyBuildIDInFile) {
+  ScopedTempDir temp_dir;
+  const base::FilePath path =
+      temp_dir.path().Append(FILE_PATH_LITERAL("cache"));
+
+  {
+    ModuleMetadataCache cache(path);
+    cache.Insert(MakeKey(1), MakeEntry(1));
+    ASSERT_TRUE(cache.Save());
+  }
+
+  // Clear the build ID size of the saved entry. It follows the 16-byte file
+  // header and the entry’s five 64-bit fields.
+  {
+    ScopedFileHandle handle(LoggingOpenFileForReadAndWrite(
+        path, FileWriteMode::kReuseOrFail, FilePermissions::kOwnerOnly));
+    ASSERT_TRUE(handle.is_valid());
+    constexpr FileOffset kBuildIDSizeOffset = 16 + 5 * sizeof(uint64_t);
+    ASSERT_EQ(LoggingSeekFile(handle.get(), kBuildIDSizeOffset, SEEK_SET),
+              kBuildIDSizeOffset);
+    uint8_t build_id_size;
+    ASSERT_TRUE(LoggingReadFileExactly(
+        handle.get(), &build_id_size, sizeof(build_id_size)));
+    ASSERT_EQ(build_id_size, MakeEntry(1).build_id.size());
+    build_id_size = 0;
+    ASSERT_EQ(LoggingSeekFile(handle.get(), kBuildIDSizeOffset, SEEK_SET),
+              kBuildIDSizeOffset);
+    ASSERT_TRUE(
+        LoggingWriteFile(handle.get(), &build_id_size, sizeof(build_id_size)));
+  }
+
+  // An entry without a build ID could never be validated, so the file is
+  // rejected rather than trusting the entry.
+  ModuleMetadataCache cache(path);
+  EXPECT_FALSE(cache.Load());
+  EXPECT_EQ(cache.Size(), 0u);
+  ModuleMetadataCache::Entry entry;
+  EXPECT_FALSE(cache.Lookup(MakeKey(1), &entry));
+}
+
+void ModuleMetadataCacheTestFunction() {}
+
+TEST(ModuleMetadataCache, ModuleSnapshotElf) {
+  Dl_info info;
+  ASSERT_TRUE(
+      dladdr(reinterpret_cast<void*>(ModuleMetadataCacheTestFunction), &info))
+      << dlerror();
+
+#if defined(ARCH_CPU_64_BITS)
+  constexpr bool am_64_bit = true;
+#else
+  constexpr bool am_64_bit = false;
+#endif  // ARCH_CPU_64_BITS
+
+#if BUILDFLAG(IS_FUCHSIA)
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+#else
+  FakePtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(GetSelfProcess()));
+  ProcessMemoryNative memory(&connection);
+#endif  // BUILDFLAG(IS_FUCHSIA)
+  ProcessMemoryRange range;
+  ASSERT_TRUE(range.Initialize(&memory, am_64_bit));
+
+  ElfImageReader reader;
+  ASSERT_TRUE(
+      reader.Initialize(range, FromPointerCast<VMAddress>(info.dli_fbase)));
+
+  ScopedTempDir temp_dir;
+  ModuleMetadataCache cache(temp_dir.path().Append(FILE_PATH_LITERAL("cache")));
+  const ModuleMetadataCache::Key key = MakeKey(1);
+
+  std::vector<uint8_t> build_id;
+  {
+    internal::ModuleSnapshotElf module("self",
+                                       &reader,
+                                       ModuleSnapshot::kModuleTypeExecutable,
+                                       &range,
+                                       &memory);
+    module.SetMetadataCache(&cache, key);
+    ASSERT_TRUE(module.Initialize());
+    build_id = module.BuildID();
+  }
+  if (build_id.empty()) {
+    GTEST_SKIP() << "no build ID";
+  }
+
+  ModuleMetadataCache::Entry entry;
+  ASSERT_TRUE(cache.Lookup(key, &entry));
+  EXPECT_EQ(entry.build_id, build_id);
+
+  // An entry whose build ID isn’t found in the module is replaced.
+  ModuleMetadataCache::Entry stale_entry = entry;
+  stale_entry.build_id.back() ^= 0xff;
+  cache.Insert(key, stale_entry);
+  {
+    internal::ModuleSnapshotElf module("self",
+                                       &reader,
+                                       ModuleSnapshot::kModuleTypeExecutable,
+                                       &range,
+                                       &memory);
+    module.SetMetadataCache(&cache, key);
+    ASSERT_TRUE(module.Initialize());
+    EXPECT_EQ(module.BuildID(), build_id);
+  }
+
+  ASSERT_TRUE(cache.Lookup(key, &entry));
+  EXPECT_EQ(entry.build_id, build_id);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
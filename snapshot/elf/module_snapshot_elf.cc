@@ -33,16 +33,25 @@ ModuleSnapshotElf::ModuleSnapshotElf(const std::string& name,
                                      const ProcessMemory* process_memory)
     : ModuleSnapshot(),
       name_(name),
+      build_id_(),
       elf_reader_(elf_reader),
       process_memory_range_(process_memory_range),
       process_memory_(process_memory),
       crashpad_info_(),
+      metadata_cache_(nullptr),
+      metadata_cache_key_(),
       type_(type),
       initialized_(),
       streams_() {}
 
 ModuleSnapshotElf::~ModuleSnapshotElf() = default;
 
+void ModuleSnapshotElf::SetMetadataCache(ModuleMetadataCache* cache,
+                                         const ModuleMetadataCache::Key& key) {
+  metadata_cache_ = cache;
+  metadata_cache_key_ = key;
+}
+
 bool ModuleSnapshotElf::Initialize() {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
 
@@ -51,31 +60,25 @@ bool ModuleSnapshotElf::Initialize() {
     return false;
   }
 
-  // The data payload is only sizeof(VMAddress) in the note, but add a bit to
-  // account for the name, header, and padding.
-  constexpr ssize_t kMaxNoteSize = 256;
-  std::unique_ptr<ElfImageReader::NoteReader> notes =
-      elf_reader_->NotesWithNameAndType(CRASHPAD_ELF_NOTE_NAME,
-                                        CRASHPAD_ELF_NOTE_TYPE_CRASHPAD_INFO,
-                                        kMaxNoteSize);
-  std::string desc;
-  VMAddress info_address;
-  VMAddress desc_address;
-  if (notes->NextNote(nullptr, nullptr, &desc, &desc_address) ==
-      ElfImageReader::NoteReader::Result::kSuccess) {
-    VMOffset offset;
-    if (elf_reader_->Memory()->Is64Bit()) {
-      offset = *reinterpret_cast<VMOffset*>(&desc[0]);
-    } else {
-      int32_t offset32 = *reinterpret_cast<int32_t*>(&desc[0]);
-      offset = offset32;
+  ModuleMetadataCache::Entry metadata;
+  if (!metadata_cache_ ||
+      !metadata_cache_->Lookup(metadata_cache_key_, &metadata) ||
+      !ValidateMetadata(metadata)) {
+    metadata = ModuleMetadataCache::Entry();
+    ReadMetadata(&metadata);
+    if (metadata_cache_) {
+      metadata_cache_->Insert(metadata_cache_key_, metadata);
     }
-    info_address = desc_address + offset;
+  }
+
+  build_id_ = metadata.build_id;
 
+  if (metadata.has_crashpad_info) {
     ProcessMemoryRange range;
     if (range.Initialize(*elf_reader_->Memory())) {
       auto info = std::make_unique<CrashpadInfoReader>();
-      if (info->Initialize(&range, info_address)) {
+      if (info->Initialize(
+              &range, elf_reader_->Address() + metadata.crashpad_info_offset)) {
         crashpad_info_ = std::move(info);
       }
     }
@@ -174,17 +177,7 @@ std::string ModuleSnapshotElf::DebugFileName() const {
 
 std::vector<uint8_t> ModuleSnapshotElf::BuildID() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-
-  std::unique_ptr<ElfImageReader::NoteReader> notes =
-      elf_reader_->NotesWithNameAndType(ELF_NOTE_GNU, NT_GNU_BUILD_ID, 64);
-  std::string desc;
-  VMAddress desc_addr;
-  notes->NextNote(nullptr, nullptr, &desc, &desc_addr);
-
-  std::vector<uint8_t> build_id;
-  build_id.reserve(desc.size());
-  std::copy(desc.begin(), desc.end(), std::back_inserter(build_id));
-  return build_id;
+  return build_id_;
 }
 
 std::vector<std::string> ModuleSnapshotElf::AnnotationsVector() const {
@@ -249,5 +242,55 @@ ModuleSnapshotElf::CustomMinidumpStreams() const {
   return result;
 }
 
+void ModuleSnapshotElf::ReadMetadata(ModuleMetadataCache::Entry* entry) {
+  const VMAddress address = elf_reader_->Address();
+
+  std::unique_ptr<ElfImageReader::NoteReader> notes =
+      elf_reader_->NotesWithNameAndType(ELF_NOTE_GNU, NT_GNU_BUILD_ID, 64);
+  std::string desc;
+  VMAddress desc_address;
+  if (notes->NextNote(nullptr, nullptr, &desc, &desc_address) ==
+      ElfImageReader::NoteReader::Result::kSuccess) {
+    entry->build_id.assign(desc.begin(), desc.end());
+    entry->build_id_offset = desc_address - address;
+  }
+
+  // The data payload is only sizeof(VMAddress) in the note, but add a bit to
+  // account for the name, header, and padding.
+  constexpr ssize_t kMaxNoteSize = 256;
+  notes =
+      elf_reader_->NotesWithNameAndType(CRASHPAD_ELF_NOTE_NAME,
+                                        CRASHPAD_ELF_NOTE_TYPE_CRASHPAD_INFO,
+                                        kMaxNoteSize);
+  if (notes->NextNote(nullptr, nullptr, &desc, &desc_address) ==
+      ElfImageReader::NoteReader::Result::kSuccess) {
+    VMOffset offset;
+    if (elf_reader_->Memory()->Is64Bit()) {
+      offset = *reinterpret_cast<VMOffset*>(&desc[0]);
+    } else {
+      int32_t offset32 = *reinterpret_cast<int32_t*>(&desc[0]);
+      offset = offset32;
+    }
+    entry->crashpad_info_offset = desc_address + offset - address;
+    entry->has_crashpad_info = true;
+  }
+}
+
+bool ModuleSnapshotElf::ValidateMetadata(
+    const ModuleMetadataCache::Entry& entry) {
+  // Without a build ID, nothing distinguishes the module from a different file
+  // that happens to have the same key, so the entry can’t be trusted.
+  if (entry.build_id.empty()) {
+    return false;
+  }
+
+  std::vector<uint8_t> build_id(entry.build_id.size());
+  return elf_reader_->Memory()->Read(
+             elf_reader_->Address() + entry.build_id_offset,
+             build_id.size(),
+             build_id.data()) &&
+         build_id == entry.build_id;
+}
+
 }  // namespace internal
 }  // namespace crashpad
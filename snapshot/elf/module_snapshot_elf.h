@@ -26,6 +26,7 @@
 #include "snapshot/crashpad_info_client_options.h"
 #include "snapshot/crashpad_types/crashpad_info_reader.h"
 #include "snapshot/elf/elf_image_reader.h"
+#include "snapshot/elf/module_metadata_cache.h"
 #include "snapshot/module_snapshot.h"
 #include "util/misc/initialization_state_dcheck.h"
 
@@ -55,6 +56,17 @@ class ModuleSnapshotElf final : public ModuleSnapshot {
 
   ~ModuleSnapshotElf() override;
 
+  //! \brief Sets a cache of module metadata to consult and update when
+  //!     initializing this object.
+  //!
+  //! If this method is not called, the module’s metadata is always read from
+  //! its notes. This method must be called before Initialize().
+  //!
+  //! \param[in] cache The cache to use.
+  //! \param[in] key The key identifying this module’s file in \a cache.
+  void SetMetadataCache(ModuleMetadataCache* cache,
+                        const ModuleMetadataCache::Key& key);
+
   //! \brief Initializes the object.
   //!
   //! \return `true` if the snapshot could be created, `false` otherwise with
@@ -92,11 +104,22 @@ class ModuleSnapshotElf final : public ModuleSnapshot {
   std::vector<const UserMinidumpStream*> CustomMinidumpStreams() const override;
 
  private:
+  // Reads the module’s build ID and the location of its CrashpadInfo from its
+  // notes.
+  void ReadMetadata(ModuleMetadataCache::Entry* entry);
+
+  // Returns true if the build ID in entry is present at the location it gives
+  // in the module.
+  bool ValidateMetadata(const ModuleMetadataCache::Entry& entry);
+
   std::string name_;
+  std::vector<uint8_t> build_id_;
   ElfImageReader* elf_reader_;
   ProcessMemoryRange* process_memory_range_;
   const ProcessMemory* process_memory_;
   std::unique_ptr<CrashpadInfoReader> crashpad_info_;
+  ModuleMetadataCache* metadata_cache_;  // weak
+  ModuleMetadataCache::Key metadata_cache_key_;
   ModuleType type_;
   InitializationStateDcheck initialized_;
   // Too const-y: https://crashpad.chromium.org/bug/9.
@@ -15,9 +15,14 @@
 #include "snapshot/linux/debug_rendezvous.h"
 
 #include <stdint.h>
+#include <string.h>
 
+#include <algorithm>
+#include <iterator>
 #include <set>
+#include <utility>
 
+#include "base/check_op.h"
 #include "base/logging.h"
 #include "build/build_config.h"
 
@@ -60,25 +65,72 @@ struct LinkEntrySpecific {
 template <typename Traits>
 bool ReadLinkEntry(const ProcessMemoryRange& memory,
                    LinuxVMAddress* address,
-                   DebugRendezvous::LinkEntry* entry_out) {
+                   DebugRendezvous::LinkEntry* entry_out,
+                   LinuxVMAddress* name_address) {
   LinkEntrySpecific<Traits> entry;
   if (!memory.Read(*address, sizeof(entry), &entry)) {
     return false;
   }
 
-  std::string name;
-  if (!memory.ReadCStringSizeLimited(entry.l_name, 4096, &name)) {
-    name.clear();
-  }
-
   entry_out->load_bias = entry.l_addr;
   entry_out->dynamic_array = entry.l_ld;
-  entry_out->name.swap(name);
+  *name_address = entry.l_name;
 
   *address = entry.l_next;
   return true;
 }
 
+// Reads the names of link map entries, whose addresses are given in
+// name_addresses. The names are usually short, so a prefix of each is read
+// speculatively in a single batch. A name is only read on its own if it isn’t
+// terminated within that prefix.
+void ReadLinkEntryNames(const ProcessMemoryRange& memory,
+                        const std::vector<LinuxVMAddress>& name_addresses,
+                        std::vector<DebugRendezvous::LinkEntry>* entries) {
+  constexpr size_t kSpeculativeNameSize = 256;
+  constexpr VMSize kMaxNameSize = 4096;
+
+  DCHECK_EQ(name_addresses.size(), entries->size());
+  const VMAddress range_end = memory.Base() + memory.Size();
+
+  std::vector<char> buffer(name_addresses.size() * kSpeculativeNameSize);
+  std::vector<ProcessMemory::BatchRead> reads;
+  std::vector<size_t> read_indices;
+  for (size_t index = 0; index < name_addresses.size(); ++index) {
+    const LinuxVMAddress address = name_addresses[index];
+    if (address < memory.Base() || address >= range_end) {
+      continue;
+    }
+    ProcessMemory::BatchRead read;
+    read.address = address;
+    read.size = static_cast<size_t>(
+        std::min(VMSize{kSpeculativeNameSize}, range_end - address));
+    read.buffer = &buffer[index * kSpeculativeNameSize];
+    read.bytes_read = 0;
+    reads.push_back(read);
+    read_indices.push_back(index);
+  }
+
+  // Some of these reads are expected to be incomplete, such as those for names
+  // near the end of a mapping. Those are handled individually below.
+  memory.ReadBatch(&reads);
+
+  for (size_t index = 0; index < reads.size(); ++index) {
+    const ProcessMemory::BatchRead& read = reads[index];
+    std::string* name = &(*entries)[read_indices[index]].name;
+    const char* data = static_cast<const char*>(read.buffer);
+    const char* nul =
+        static_cast<const char*>(memchr(data, '\0', read.bytes_read));
+    if (nul) {
+      name->assign(data, nul - data);
+    } else if (read.bytes_read == read.size &&
+               !memory.ReadCStringSizeLimited(
+                   read.address, kMaxNameSize, name)) {
+      name->clear();
+    }
+  }
+}
+
 }  // namespace
 
 DebugRendezvous::LinkEntry::LinkEntry()
@@ -123,8 +175,12 @@ bool DebugRendezvous::InitializeSpecific(const ProcessMemoryRange& memory,
     return false;
   }
 
+  // Walk the link map first, and then read all of the names together.
+  std::vector<LinkEntry> entries(1);
+  std::vector<LinuxVMAddress> name_addresses(1);
   LinuxVMAddress link_entry_address = debug.r_map;
-  if (!ReadLinkEntry<Traits>(memory, &link_entry_address, &executable_)) {
+  if (!ReadLinkEntry<Traits>(
+          memory, &link_entry_address, &entries[0], &name_addresses[0])) {
     return false;
   }
 
@@ -136,12 +192,21 @@ bool DebugRendezvous::InitializeSpecific(const ProcessMemoryRange& memory,
     }
 
     LinkEntry entry;
-    if (!ReadLinkEntry<Traits>(memory, &link_entry_address, &entry)) {
+    LinuxVMAddress name_address;
+    if (!ReadLinkEntry<Traits>(
+            memory, &link_entry_address, &entry, &name_address)) {
       return false;
     }
-    modules_.push_back(entry);
+    entries.push_back(entry);
+    name_addresses.push_back(name_address);
   }
 
+  ReadLinkEntryNames(memory, name_addresses, &entries);
+
+  executable_ = std::move(entries[0]);
+  modules_.assign(std::make_move_iterator(entries.begin() + 1),
+                  std::make_move_iterator(entries.end()));
+
 #if BUILDFLAG(IS_ANDROID)
   // Android P (API 28) mistakenly places the vdso in the first entry in the
   // link map.
@@ -24,11 +24,14 @@
 #include <algorithm>
 
 #include "base/logging.h"
+#include "base/memory/page_size.h"
 #include "base/strings/stringprintf.h"
 #include "build/build_config.h"
 #include "snapshot/linux/debug_rendezvous.h"
 #include "util/linux/auxiliary_vector.h"
 #include "util/linux/proc_stat_reader.h"
+#include "util/misc/clock.h"
+#include "util/misc/metrics.h"
 
 #if BUILDFLAG(IS_ANDROID)
 #include <android/api-level.h>
@@ -47,6 +50,36 @@ bool ShouldMergeStackMappings(const MemoryMap::Mapping& stack_mapping,
           stack_mapping.name.empty() || adj_mapping.name.empty());
 }
 
+// The maximum number of bytes of module metadata to cache, if no cache was
+// provided by SetMetadataMemory(). This is enough for several pages of headers,
+// notes, and dynamic arrays for each of hundreds of modules.
+constexpr size_t kModuleMemoryCacheSize = 8 * 1024 * 1024;
+
+// The number of mappings that may begin a module whose headers are prefetched.
+// The module is normally found in the first of these.
+constexpr size_t kMaxPrefetchedModuleMappings = 4;
+
+// Adds the first page of each of the first few mappings from possible_mappings
+// to ranges. These hold a module’s ELF header and program headers if the
+// module begins there. The page of the first mapping, where the module is
+// normally found, is added to likely_ranges, and the others to
+// unlikely_ranges, so that they can be given a lower priority when
+// prefetching.
+void AddModuleHeaderRanges(
+    MemoryMap::Iterator* possible_mappings,
+    VMSize page_size,
+    std::vector<CheckedRange<VMAddress, VMSize>>* likely_ranges,
+    std::vector<CheckedRange<VMAddress, VMSize>>* unlikely_ranges) {
+  const MemoryMap::Mapping* mapping;
+  for (size_t count = 0; count < kMaxPrefetchedModuleMappings &&
+                         (mapping = possible_mappings->Next());
+       ++count) {
+    (count == 0 ? likely_ranges : unlikely_ranges)
+        ->emplace_back(mapping->range.Base(),
+                       std::min(mapping->range.Size(), page_size));
+  }
+}
+
 }  // namespace
 
 ProcessReaderLinux::Thread::Thread()
@@ -208,12 +241,18 @@ void ProcessReaderLinux::Thread::InitializeStackFromSP(
 }
 
 ProcessReaderLinux::Module::Module()
-    : name(), elf_reader(nullptr), type(ModuleSnapshot::kModuleTypeUnknown) {}
+    : name(),
+      elf_reader(nullptr),
+      type(ModuleSnapshot::kModuleTypeUnknown),
+      mapping(nullptr),
+      parse_time(0) {}
 
 ProcessReaderLinux::Module::~Module() = default;
 
 ProcessReaderLinux::ProcessReaderLinux()
     : connection_(),
+      metadata_memory_(nullptr),
+      module_memory_(),
       process_info_(),
       memory_map_(),
       threads_(),
@@ -245,6 +284,20 @@ bool ProcessReaderLinux::Initialize(PtraceConnection* connection) {
   return true;
 }
 
+void ProcessReaderLinux::SetMetadataMemory(const ProcessMemoryCached* memory) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK(!initialized_modules_);
+  metadata_memory_ = memory;
+}
+
+const ProcessMemory* ProcessReaderLinux::MetadataMemory() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (metadata_memory_) {
+    return metadata_memory_;
+  }
+  return Memory();
+}
+
 bool ProcessReaderLinux::StartTime(timeval* start_time) const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return process_info_.StartTime(start_time);
@@ -345,7 +398,7 @@ struct magic_abort_msg_t {
 template <bool is64Bit>
 void ProcessReaderLinux::ReadAbortMessage(const MemoryMap::Mapping* mapping) {
   magic_abort_msg_t<is64Bit> header;
-  if (!Memory()->Read(
+  if (!MetadataMemory()->Read(
           mapping->range.Base(), sizeof(magic_abort_msg_t<is64Bit>), &header)) {
     return;
   }
@@ -359,7 +412,7 @@ void ProcessReaderLinux::ReadAbortMessage(const MemoryMap::Mapping* mapping) {
   }
 
   abort_message_.resize(size);
-  if (!Memory()->Read(
+  if (!MetadataMemory()->Read(
           mapping->range.Base() + offsetof(magic_abort_msg_t<is64Bit>, msg.msg),
           size,
           &abort_message_[0])) {
@@ -404,21 +457,34 @@ void ProcessReaderLinux::InitializeThreads() {
   std::vector<pid_t> thread_ids;
   bool result = connection_->Threads(&thread_ids);
   DCHECK(result);
+
+  std::vector<pid_t> other_thread_ids;
+  other_thread_ids.reserve(thread_ids.size());
   for (pid_t tid : thread_ids) {
     if (tid == pid) {
       DCHECK(!main_thread_found);
       main_thread_found = true;
       continue;
     }
+    other_thread_ids.push_back(tid);
+  }
+  DCHECK(main_thread_found);
 
+  // Attaching to every thread up front lets the connection wait for them to
+  // stop concurrently. Threads are recorded in the order they were listed.
+  std::vector<pid_t> attached_thread_ids;
+  attached_thread_ids.reserve(other_thread_ids.size());
+  connection_->AttachThreads(other_thread_ids, &attached_thread_ids);
+
+  threads_.reserve(threads_.size() + attached_thread_ids.size());
+  for (pid_t tid : attached_thread_ids) {
     Thread thread;
     thread.tid = tid;
-    if (connection_->Attach(tid) && thread.InitializePtrace(connection_)) {
+    if (thread.InitializePtrace(connection_)) {
       thread.InitializeStack(this);
       threads_.push_back(thread);
     }
   }
-  DCHECK(main_thread_found);
 }
 
 void ProcessReaderLinux::InitializeModules() {
@@ -435,11 +501,26 @@ void ProcessReaderLinux::InitializeModules() {
     return;
   }
 
+  // Modules’ metadata is read through a page cache, so that the pages holding
+  // it can be fetched for every module at once by Prefetch(), instead of by
+  // many small reads for each module.
+  const ProcessMemoryCached* memory = metadata_memory_;
+  if (!memory) {
+    module_memory_ = std::make_unique<ProcessMemoryCached>();
+    if (!module_memory_->Initialize(Memory(), kModuleMemoryCacheSize)) {
+      return;
+    }
+    memory = module_memory_.get();
+  }
+
   ProcessMemoryRange range;
-  if (!range.Initialize(Memory(), is_64_bit_)) {
+  if (!range.Initialize(memory, is_64_bit_)) {
     return;
   }
 
+  const VMSize page_size = base::GetPageSize();
+  std::vector<CheckedRange<VMAddress, VMSize>> prefetch_ranges;
+
   // The strategy used for identifying loaded modules depends on ELF files
   // conventionally loading their header and program headers into memory.
   // Locating the correct module could fail if the headers aren't mapped, are
@@ -447,12 +528,21 @@ void ProcessReaderLinux::InitializeModules() {
   // constructed to look like the ELF module being searched for.
   const MemoryMap::Mapping* exe_mapping = nullptr;
   std::unique_ptr<ElfImageReader> exe_reader;
+  uint64_t exe_parse_time = 0;
   {
     const MemoryMap::Mapping* phdr_mapping = memory_map_.FindMapping(phdrs);
     if (!phdr_mapping) {
       return;
     }
 
+    AddModuleHeaderRanges(
+        memory_map_.FindFilePossibleMmapStarts(*phdr_mapping).get(),
+        page_size,
+        &prefetch_ranges,
+        &prefetch_ranges);
+    memory->Prefetch(prefetch_ranges);
+
+    const uint64_t start_time = ClockMonotonicNanoseconds();
     auto possible_mappings =
         memory_map_.FindFilePossibleMmapStarts(*phdr_mapping);
     const MemoryMap::Mapping* mapping = nullptr;
@@ -473,6 +563,7 @@ void ProcessReaderLinux::InitializeModules() {
                  << phdr_mapping->range.Base();
       return;
     }
+    exe_parse_time = ClockMonotonicNanoseconds() - start_time;
   }
 
   LinuxVMAddress debug_address;
@@ -490,6 +581,9 @@ void ProcessReaderLinux::InitializeModules() {
                                                : exe_mapping->name;
   exe.elf_reader = exe_reader.get();
   exe.type = ModuleSnapshot::ModuleType::kModuleTypeExecutable;
+  exe.mapping = exe_mapping;
+  exe.parse_time = exe_parse_time;
+  Metrics::ModuleParseTime(exe.parse_time);
 
   modules_.push_back(exe);
   elf_readers_.push_back(std::move(exe_reader));
@@ -497,68 +591,120 @@ void ProcessReaderLinux::InitializeModules() {
   LinuxVMAddress loader_base = 0;
   aux.GetValue(AT_BASE, &loader_base);
 
-  for (const DebugRendezvous::LinkEntry& entry : debug.Modules()) {
-    const MemoryMap::Mapping* module_mapping = nullptr;
+  // Modules are ingested in stages, with the memory that each stage will read
+  // for all modules prefetched before it begins. First, the mappings that may
+  // begin each module are found, and their ELF headers are fetched along with
+  // the module’s dynamic array. If there are too many modules for all of these
+  // to fit in the cache, the headers of mappings that are unlikely to begin a
+  // module are left out first.
+  struct PendingModule {
+    const DebugRendezvous::LinkEntry* entry;
+    const MemoryMap::Mapping* dyn_mapping;
+    const MemoryMap::Mapping* module_mapping;
     std::unique_ptr<ElfImageReader> elf_reader;
-    {
-      const MemoryMap::Mapping* dyn_mapping =
-          memory_map_.FindMapping(entry.dynamic_array);
-      if (!dyn_mapping) {
-        continue;
-      }
+    uint64_t parse_time;
+  };
+  std::vector<PendingModule> pending_modules;
+  pending_modules.reserve(debug.Modules().size());
+  prefetch_ranges.clear();
+  std::vector<CheckedRange<VMAddress, VMSize>> unlikely_prefetch_ranges;
+  for (const DebugRendezvous::LinkEntry& entry : debug.Modules()) {
+    const MemoryMap::Mapping* dyn_mapping =
+        memory_map_.FindMapping(entry.dynamic_array);
+    if (!dyn_mapping) {
+      continue;
+    }
 
-#if BUILDFLAG(IS_ANDROID)
-      // Beginning at API 21, Bionic provides android_dlopen_ext() which allows
-      // passing a file descriptor with an existing relro segment to the loader.
-      // This means that the mapping attributes of dyn_mapping may be unrelated
-      // to the attributes of the other mappings for the module. In this case,
-      // search all mappings in reverse order from dyn_mapping until a module is
-      // parsed whose dynamic address matches the value in the debug link.
-      static int api_level = android_get_device_api_level();
-      auto possible_mappings =
-          (api_level >= 21 || api_level < 0)
-              ? memory_map_.ReverseIteratorFrom(*dyn_mapping)
-              : memory_map_.FindFilePossibleMmapStarts(*dyn_mapping);
-#else
-      auto possible_mappings =
-          memory_map_.FindFilePossibleMmapStarts(*dyn_mapping);
-#endif
-      const MemoryMap::Mapping* mapping = nullptr;
-      while ((mapping = possible_mappings->Next())) {
-        auto parsed_module = std::make_unique<ElfImageReader>();
-        VMAddress dynamic_address;
-        if (parsed_module->Initialize(
-                range,
-                mapping->range.Base(),
-                /* verbose= */ possible_mappings->Count() == 0) &&
-            parsed_module->GetDynamicArrayAddress(&dynamic_address) &&
-            dynamic_address == entry.dynamic_array) {
-          module_mapping = mapping;
-          elf_reader = std::move(parsed_module);
-          break;
-        }
-      }
-      if (!module_mapping) {
-        LOG(ERROR) << "no module mappings 0x" << std::hex
-                   << dyn_mapping->range.Base();
-        continue;
+    AddModuleHeaderRanges(PossibleModuleMappings(*dyn_mapping).get(),
+                          page_size,
+                          &prefetch_ranges,
+                          &unlikely_prefetch_ranges);
+    prefetch_ranges.emplace_back(
+        entry.dynamic_array,
+        std::min(dyn_mapping->range.End() - entry.dynamic_array, page_size));
+    pending_modules.push_back({&entry, dyn_mapping, nullptr, nullptr, 0});
+  }
+  prefetch_ranges.insert(prefetch_ranges.end(),
+                         unlikely_prefetch_ranges.begin(),
+                         unlikely_prefetch_ranges.end());
+  memory->Prefetch(prefetch_ranges);
+
+  // Next, each module’s ELF image is located and parsed, and the regions
+  // holding its notes and name are prefetched.
+  prefetch_ranges.clear();
+  for (PendingModule& pending : pending_modules) {
+    const uint64_t start_time = ClockMonotonicNanoseconds();
+    auto possible_mappings = PossibleModuleMappings(*pending.dyn_mapping);
+    const MemoryMap::Mapping* mapping = nullptr;
+    while ((mapping = possible_mappings->Next())) {
+      auto parsed_module = std::make_unique<ElfImageReader>();
+      VMAddress dynamic_address;
+      if (parsed_module->Initialize(
+              range,
+              mapping->range.Base(),
+              /* verbose= */ possible_mappings->Count() == 0) &&
+          parsed_module->GetDynamicArrayAddress(&dynamic_address) &&
+          dynamic_address == pending.entry->dynamic_array) {
+        pending.module_mapping = mapping;
+        pending.elf_reader = std::move(parsed_module);
+        break;
       }
     }
+    if (!pending.module_mapping) {
+      LOG(ERROR) << "no module mappings 0x" << std::hex
+                 << pending.dyn_mapping->range.Base();
+      continue;
+    }
+
+    pending.elf_reader->GetMetadataRanges(&prefetch_ranges);
+    pending.parse_time = ClockMonotonicNanoseconds() - start_time;
+  }
+  memory->Prefetch(prefetch_ranges);
+
+  // Finally, each module is named and recorded.
+  for (PendingModule& pending : pending_modules) {
+    if (!pending.elf_reader) {
+      continue;
+    }
 
+    const uint64_t start_time = ClockMonotonicNanoseconds();
     Module module = {};
     std::string soname;
-    if (elf_reader->SoName(&soname) && !soname.empty()) {
+    if (pending.elf_reader->SoName(&soname) && !soname.empty()) {
       module.name = soname;
     } else {
-      module.name = !entry.name.empty() ? entry.name : module_mapping->name;
+      module.name = !pending.entry->name.empty() ? pending.entry->name
+                                                 : pending.module_mapping->name;
     }
-    module.elf_reader = elf_reader.get();
-    module.type = loader_base && elf_reader->Address() == loader_base
+    module.elf_reader = pending.elf_reader.get();
+    module.type = loader_base && pending.elf_reader->Address() == loader_base
                       ? ModuleSnapshot::kModuleTypeDynamicLoader
                       : ModuleSnapshot::kModuleTypeSharedLibrary;
+    module.mapping = pending.module_mapping;
+    module.parse_time =
+        pending.parse_time + (ClockMonotonicNanoseconds() - start_time);
+    Metrics::ModuleParseTime(module.parse_time);
     modules_.push_back(module);
-    elf_readers_.push_back(std::move(elf_reader));
+    elf_readers_.push_back(std::move(pending.elf_reader));
   }
 }
 
+std::unique_ptr<MemoryMap::Iterator> ProcessReaderLinux::PossibleModuleMappings(
+    const MemoryMap::Mapping& dyn_mapping) const {
+#if BUILDFLAG(IS_ANDROID)
+  // Beginning at API 21, Bionic provides android_dlopen_ext() which allows
+  // passing a file descriptor with an existing relro segment to the loader.
+  // This means that the mapping attributes of dyn_mapping may be unrelated
+  // to the attributes of the other mappings for the module. In this case,
+  // search all mappings in reverse order from dyn_mapping until a module is
+  // parsed whose dynamic address matches the value in the debug link.
+  static int api_level = android_get_device_api_level();
+  return (api_level >= 21 || api_level < 0)
+             ? memory_map_.ReverseIteratorFrom(dyn_mapping)
+             : memory_map_.FindFilePossibleMmapStarts(dyn_mapping);
+#else
+  return memory_map_.FindFilePossibleMmapStarts(dyn_mapping);
+#endif
+}
+
 }  // namespace crashpad
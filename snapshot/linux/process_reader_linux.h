@@ -15,6 +15,7 @@
 #ifndef CRASHPAD_SNAPSHOT_LINUX_PROCESS_READER_LINUX_H_
 #define CRASHPAD_SNAPSHOT_LINUX_PROCESS_READER_LINUX_H_
 
+#include <stdint.h>
 #include <sys/time.h>
 #include <sys/types.h>
 
@@ -31,6 +32,7 @@
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/posix/process_info.h"
 #include "util/process/process_memory.h"
+#include "util/process/process_memory_cached.h"
 
 namespace crashpad {
 
@@ -96,6 +98,21 @@ class ProcessReaderLinux {
 
     //! \brief The module's type.
     ModuleSnapshot::ModuleType type;
+
+    //! \brief The mapping that the module’s ELF image begins in.
+    //!
+    //! The lifetime of this Mapping is scoped to the lifetime of the
+    //! ProcessReaderLinux that created it. This field may be `nullptr` if the
+    //! mapping is not known.
+    const MemoryMap::Mapping* mapping;
+
+    //! \brief The time, in nanoseconds, spent locating and parsing the
+    //!     module.
+    //!
+    //! This excludes the time spent fetching memory that was prefetched for
+    //! all modules together. It is also reported by
+    //! Metrics::ModuleParseTime().
+    uint64_t parse_time;
   };
 
   ProcessReaderLinux();
@@ -126,6 +143,24 @@ class ProcessReaderLinux {
   //! \brief Return a memory reader for the target process.
   const ProcessMemoryLinux* Memory() const { return connection_->Memory(); }
 
+  //! \brief Sets a cache to be used in place of Memory() for reading modules’
+  //!     metadata and the abort message.
+  //!
+  //! This allows the many small reads made while parsing these structures to
+  //! share a cache with other readers of the target process. If used, this
+  //! must be called before Modules() or AbortMessage(). If not used, modules’
+  //! metadata is read through a cache owned by this object.
+  //!
+  //! \param[in] memory A cache of the target process’ memory, which must
+  //!     outlive this object.
+  void SetMetadataMemory(const ProcessMemoryCached* memory);
+
+  //! \brief Return the memory reader used for reading modules’ metadata.
+  //!
+  //! This is the reader set by SetMetadataMemory(), or Memory() if none was
+  //! set.
+  const ProcessMemory* MetadataMemory() const;
+
   //! \brief Return a memory map of the target process.
   MemoryMap* GetMemoryMap() { return &memory_map_; }
 
@@ -168,7 +203,14 @@ class ProcessReaderLinux {
   template <bool Is64Bit>
   void ReadAbortMessage(const MemoryMap::Mapping* mapping);
 
+  // Returns an iterator over the mappings that may begin the module whose
+  // dynamic array is in dyn_mapping, in the order they should be tried.
+  std::unique_ptr<MemoryMap::Iterator> PossibleModuleMappings(
+      const MemoryMap::Mapping& dyn_mapping) const;
+
   PtraceConnection* connection_;  // weak
+  const ProcessMemoryCached* metadata_memory_;  // weak
+  std::unique_ptr<ProcessMemoryCached> module_memory_;
   ProcessInfo process_info_;
   MemoryMap memory_map_;
   std::vector<Thread> threads_;
@@ -53,6 +53,7 @@
 #include "util/misc/from_pointer_cast.h"
 #include "util/misc/memory_sanitizer.h"
 #include "util/posix/scoped_mmap.h"
+#include "util/process/process_memory_cached.h"
 #include "util/synchronization/semaphore.h"
 
 #if BUILDFLAG(IS_ANDROID)
@@ -636,6 +637,27 @@ TEST(ProcessReaderLinux, SelfModules) {
 #endif  // !ADDRESS_SANITIZER && !MEMORY_SANITIZER
 }
 
+TEST(ProcessReaderLinux, SelfModulesWithMetadataCache) {
+  FakePtraceConnection connection;
+  connection.Initialize(getpid());
+
+  ProcessReaderLinux process_reader;
+  ASSERT_TRUE(process_reader.Initialize(&connection));
+
+  ProcessMemoryCached cache;
+  ASSERT_TRUE(cache.Initialize(process_reader.Memory(), 1024 * 1024));
+  process_reader.SetMetadataMemory(&cache);
+  EXPECT_EQ(process_reader.MetadataMemory(), &cache);
+
+  ExpectModulesFromSelf(process_reader.Modules());
+
+  // Module parsing makes many small reads from the same pages, most of which
+  // are prefetched for all modules together.
+  ProcessMemoryCached::Stats stats = cache.GetStats();
+  EXPECT_GT(stats.prefetched, 0u);
+  EXPECT_GT(stats.hits, stats.misses);
+}
+
 class ChildModuleTest : public Multiprocess {
  public:
   ChildModuleTest() : Multiprocess(), module_soname_("test_module_soname") {}
@@ -14,6 +14,8 @@
 
 #include "snapshot/linux/process_snapshot_linux.h"
 
+#include <sys/stat.h>
+
 #include <utility>
 
 #include "base/logging.h"
@@ -22,11 +24,42 @@
 
 namespace crashpad {
 
+namespace {
+
+// Identifies the file that mapping was loaded from, for use as a key in a
+// ModuleMetadataCache. Returns false if the file can’t be identified, such as
+// when it has been replaced on disk since it was loaded, or when its path
+// refers to another mount namespace.
+bool ModuleMetadataCacheKey(const MemoryMap::Mapping& mapping,
+                            ModuleMetadataCache::Key* key) {
+  if (mapping.inode == 0 || mapping.name.empty() || mapping.name[0] != '/') {
+    return false;
+  }
+
+  struct stat st;
+  if (stat(mapping.name.c_str(), &st) != 0 || st.st_dev != mapping.device ||
+      st.st_ino != mapping.inode) {
+    return false;
+  }
+
+  key->device = mapping.device;
+  key->inode = mapping.inode;
+  key->modification_time =
+      static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+      st.st_mtim.tv_nsec;
+  return true;
+}
+
+}  // namespace
+
 ProcessSnapshotLinux::ProcessSnapshotLinux() = default;
 
 ProcessSnapshotLinux::~ProcessSnapshotLinux() = default;
 
-bool ProcessSnapshotLinux::Initialize(PtraceConnection* connection) {
+bool ProcessSnapshotLinux::Initialize(
+    PtraceConnection* connection,
+    size_t memory_cache_size,
+    ModuleMetadataCache* module_metadata_cache) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
 
   if (gettimeofday(&snapshot_time_, nullptr) != 0) {
@@ -34,8 +67,20 @@ bool ProcessSnapshotLinux::Initialize(PtraceConnection* connection) {
     return false;
   }
 
-  if (!process_reader_.Initialize(connection) ||
-      !memory_range_.Initialize(process_reader_.Memory(),
+  if (!process_reader_.Initialize(connection)) {
+    return false;
+  }
+
+  if (memory_cache_size) {
+    memory_cache_ = std::make_unique<ProcessMemoryCached>();
+    if (!memory_cache_->Initialize(process_reader_.Memory(),
+                                   memory_cache_size)) {
+      return false;
+    }
+    process_reader_.SetMetadataMemory(memory_cache_.get());
+  }
+
+  if (!memory_range_.Initialize(process_reader_.MetadataMemory(),
                                 process_reader_.Is64Bit())) {
     return false;
   }
@@ -43,7 +88,7 @@ bool ProcessSnapshotLinux::Initialize(PtraceConnection* connection) {
   client_id_.InitializeToZero();
   system_.Initialize(&process_reader_, &snapshot_time_);
 
-  InitializeModules();
+  InitializeModules(module_metadata_cache);
   GetCrashpadOptionsInternal((&options_));
   InitializeThreads();
   InitializeAnnotations();
@@ -52,6 +97,11 @@ bool ProcessSnapshotLinux::Initialize(PtraceConnection* connection) {
   return true;
 }
 
+const ProcessMemoryCached* ProcessSnapshotLinux::MemoryCache() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return memory_cache_.get();
+}
+
 pid_t ProcessSnapshotLinux::FindThreadWithStackAddress(
     VMAddress stack_address) {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
@@ -291,7 +341,8 @@ void ProcessSnapshotLinux::InitializeThreads() {
   }
 }
 
-void ProcessSnapshotLinux::InitializeModules() {
+void ProcessSnapshotLinux::InitializeModules(
+    ModuleMetadataCache* module_metadata_cache) {
   for (const ProcessReaderLinux::Module& reader_module :
        process_reader_.Modules()) {
     auto module =
@@ -300,6 +351,11 @@ void ProcessSnapshotLinux::InitializeModules() {
                                                       reader_module.type,
                                                       &memory_range_,
                                                       process_reader_.Memory());
+    ModuleMetadataCache::Key key;
+    if (module_metadata_cache && reader_module.mapping &&
+        ModuleMetadataCacheKey(*reader_module.mapping, &key)) {
+      module->SetMetadataCache(module_metadata_cache, key);
+    }
     if (module->Initialize()) {
       modules_.push_back(std::move(module));
     }
@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "snapshot/crashpad_info_client_options.h"
+#include "snapshot/elf/module_metadata_cache.h"
 #include "snapshot/elf/module_snapshot_elf.h"
 #include "snapshot/linux/exception_snapshot_linux.h"
 #include "snapshot/linux/process_reader_linux.h"
@@ -39,6 +40,7 @@
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/misc/uuid.h"
 #include "util/process/process_id.h"
+#include "util/process/process_memory_cached.h"
 #include "util/process/process_memory_range.h"
 
 namespace crashpad {
@@ -57,10 +59,26 @@ class ProcessSnapshotLinux final : public ProcessSnapshot {
   //! \brief Initializes the object.
   //!
   //! \param[in] connection A connection to the process to snapshot.
+  //! \param[in] memory_cache_size If non-zero, the small reads made while
+  //!     parsing the target process’ modules and annotations are served from a
+  //!     cache of the target’s pages, retaining at most this many bytes. The
+  //!     cache is discarded with this object. If `0`, no cache is used.
+  //! \param[in] module_metadata_cache If not `nullptr`, a cache of metadata
+  //!     parsed from modules in earlier snapshots. Modules whose files are
+  //!     found in the cache reuse its metadata, and the cache is updated with
+  //!     modules that are not. The caller is responsible for saving it.
   //!
   //! \return `true` if the snapshot could be created, `false` otherwise with
   //!     an appropriate message logged.
-  bool Initialize(PtraceConnection* connection);
+  bool Initialize(PtraceConnection* connection,
+                  size_t memory_cache_size = 0,
+                  ModuleMetadataCache* module_metadata_cache = nullptr);
+
+  //! \brief Returns the cache of the target process’ memory used while
+  //!     creating this snapshot, or `nullptr` if none was requested.
+  //!
+  //! This may be used to inspect the cache’s effectiveness.
+  const ProcessMemoryCached* MemoryCache() const;
 
   //! \brief Finds the thread whose stack contains \a stack_address.
   //!
@@ -136,7 +154,7 @@ class ProcessSnapshotLinux final : public ProcessSnapshot {
 
  private:
   void InitializeThreads();
-  void InitializeModules();
+  void InitializeModules(ModuleMetadataCache* module_metadata_cache);
   void InitializeAnnotations();
 
   // Initializes options_ on behalf of Initialize().
@@ -151,6 +169,7 @@ class ProcessSnapshotLinux final : public ProcessSnapshot {
   std::unique_ptr<internal::ExceptionSnapshotLinux> exception_;
   internal::SystemSnapshotLinux system_;
   ProcessReaderLinux process_reader_;
+  std::unique_ptr<ProcessMemoryCached> memory_cache_;
   ProcessMemoryRange memory_range_;
   CrashpadInfoClientOptions options_;
   InitializationStateDcheck initialized_;
@@ -50,6 +50,21 @@ class MemorySnapshot {
     //! \return `true` on success, `false` on failure. MemoryDelegate::Read()
     //!     will use this as its own return value.
     virtual bool MemorySnapshotDelegateRead(void* data, size_t size) = 0;
+
+    //! \brief Returns `true` if this delegate is able to receive a memory
+    //!     snapshot’s data in several chunks.
+    //!
+    //! When this method returns `true`, MemorySnapshot::Read() may call
+    //! MemorySnapshotDelegateRead() several times, passing consecutive chunks
+    //! of the memory snapshot’s data in order, instead of holding all of the
+    //! data in memory at once. Every chunk but the first begins at a
+    //! pointer-aligned address in the snapshot process. Reading stops at the
+    //! first call that returns `false`. If reading fails after some chunks
+    //! have been passed to the delegate, MemorySnapshot::Read() returns
+    //! `false`.
+    //!
+    //! The default implementation returns `false`.
+    virtual bool MemorySnapshotDelegateAcceptsChunks() const { return false; }
   };
 
   virtual ~MemorySnapshot() {}
@@ -75,6 +90,12 @@ class MemorySnapshot {
   //!     success and `false` on failure.
   virtual bool Read(Delegate* delegate) const = 0;
 
+  //! \brief Returns `true` if Read() may be called on several threads at once,
+  //!     including concurrently with other memory snapshots’ Read() methods.
+  //!
+  //! The default implementation returns `false`.
+  virtual bool SupportsConcurrentReads() const { return false; }
+
   //! \brief Creates a new MemorySnapshot based on merging this one with \a
   //!     other.
   //!
@@ -18,6 +18,8 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <algorithm>
+
 #include "base/containers/heap_array.h"
 #include "base/logging.h"
 #include "base/numerics/safe_math.h"
@@ -45,7 +47,8 @@ class MemorySnapshotGeneric final : public MemorySnapshot {
   //!
   //! Memory is read lazily. No attempt is made to read the memory snapshot data
   //! until Read() is called, and the memory snapshot data is discared when
-  //! Read() returns.
+  //! Read() returns. If the delegate accepts chunks, at most kChunkSize bytes
+  //! are held in memory at once.
   //!
   //! \param[in] process_memory A reader for the process being snapshotted.
   //! \param[in] address The base address of the memory region to snapshot, in
@@ -80,11 +83,35 @@ class MemorySnapshotGeneric final : public MemorySnapshot {
       return delegate->MemorySnapshotDelegateRead(nullptr, size_);
     }
 
-    auto buffer = base::HeapArray<uint8_t>::Uninit(size_);
-    if (!process_memory_->Read(address_, buffer.size(), buffer.data())) {
-      return false;
+    if (size_ <= kChunkSize ||
+        !delegate->MemorySnapshotDelegateAcceptsChunks()) {
+      auto buffer = base::HeapArray<uint8_t>::Uninit(size_);
+      if (!process_memory_->Read(address_, buffer.size(), buffer.data())) {
+        return false;
+      }
+      return delegate->MemorySnapshotDelegateRead(buffer.data(), buffer.size());
+    }
+
+    // Chunks after the first begin at kChunkSize-aligned addresses.
+    auto buffer = base::HeapArray<uint8_t>::Uninit(kChunkSize);
+    VMAddress address = address_;
+    size_t remaining = size_;
+    while (remaining > 0) {
+      const size_t chunk_size = std::min(
+          remaining, static_cast<size_t>(kChunkSize - address % kChunkSize));
+      if (!process_memory_->Read(address, chunk_size, buffer.data()) ||
+          !delegate->MemorySnapshotDelegateRead(buffer.data(), chunk_size)) {
+        return false;
+      }
+      address += chunk_size;
+      remaining -= chunk_size;
     }
-    return delegate->MemorySnapshotDelegateRead(buffer.data(), buffer.size());
+    return true;
+  }
+
+  bool SupportsConcurrentReads() const override {
+    INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+    return process_memory_->SupportsConcurrentReads();
   }
 
   const MemorySnapshot* MergeWithOtherSnapshot(
@@ -105,6 +132,10 @@ class MemorySnapshotGeneric final : public MemorySnapshot {
   }
 
  private:
+  // The largest chunk read at once for delegates that accept chunks. This must
+  // be a power of two.
+  static constexpr size_t kChunkSize = 64 * 1024;
+
   template <class T>
   friend const MemorySnapshot* MergeWithOtherSnapshotImpl(
       const T* self,
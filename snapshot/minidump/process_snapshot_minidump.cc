@@ -61,6 +61,7 @@ ProcessSnapshotMinidump::ProcessSnapshotMinidump()
       exception_snapshot_(),
       arch_(CPUArchitecture::kCPUArchitectureUnknown),
       annotations_simple_map_(),
+      gzip_file_reader_(),
       file_reader_(nullptr),
       process_id_(kInvalidProcessID),
       create_time_(0),
@@ -79,6 +80,14 @@ bool ProcessSnapshotMinidump::Initialize(FileReaderInterface* file_reader) {
     return false;
   }
 
+  if (GzipFileReader::IsGzip(file_reader_)) {
+    gzip_file_reader_ = std::make_unique<GzipFileReader>();
+    if (!gzip_file_reader_->Initialize(file_reader_)) {
+      return false;
+    }
+    file_reader_ = gzip_file_reader_.get();
+  }
+
   if (!file_reader_->ReadExactly(&header_, sizeof(header_))) {
     return false;
   }
@@ -93,7 +102,7 @@ bool ProcessSnapshotMinidump::Initialize(FileReaderInterface* file_reader) {
     return false;
   }
 
-  if (!file_reader->SeekSet(header_.StreamDirectoryRva)) {
+  if (!file_reader_->SeekSet(header_.StreamDirectoryRva)) {
     return false;
   }
 
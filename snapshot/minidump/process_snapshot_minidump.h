@@ -39,6 +39,7 @@
 #include "snapshot/thread_snapshot.h"
 #include "snapshot/unloaded_module_snapshot.h"
 #include "util/file/file_reader.h"
+#include "util/file/gzip_file_reader.h"
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/misc/uuid.h"
 #include "util/process/process_id.h"
@@ -62,7 +63,8 @@ class ProcessSnapshotMinidump final : public ProcessSnapshot {
   //! \brief Initializes the object.
   //!
   //! \param[in] file_reader A file reader corresponding to a minidump file.
-  //!     The file reader must support seeking.
+  //!     The file reader must support seeking. The minidump may be stored
+  //!     `gzip`-compressed, in which case it is decompressed into memory.
   //!
   //! \return `true` if the snapshot could be created, `false` otherwise with
   //!     an appropriate message logged.
@@ -164,6 +166,7 @@ class ProcessSnapshotMinidump final : public ProcessSnapshot {
   CPUArchitecture arch_;
   std::map<std::string, std::string> annotations_simple_map_;
   std::string full_version_;
+  std::unique_ptr<GzipFileReader> gzip_file_reader_;
   FileReaderInterface* file_reader_;  // weak
   crashpad::ProcessID process_id_;
   uint32_t create_time_;
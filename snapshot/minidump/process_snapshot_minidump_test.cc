@@ -31,6 +31,8 @@
 #include "snapshot/module_snapshot.h"
 #include "util/file/string_file.h"
 #include "util/misc/pdb_structures.h"
+#include "util/stream/output_stream_interface.h"
+#include "util/stream/zlib_output_stream.h"
 
 namespace crashpad {
 namespace test {
@@ -47,6 +49,21 @@ class ReadToVector : public crashpad::MemorySnapshot::Delegate {
   }
 };
 
+class StringFileOutputStream : public OutputStreamInterface {
+ public:
+  explicit StringFileOutputStream(StringFile* string_file)
+      : string_file_(string_file) {}
+
+  bool Write(const uint8_t* data, size_t size) override {
+    return string_file_->Write(data, size);
+  }
+
+  bool Flush() override { return true; }
+
+ private:
+  StringFile* string_file_;  // weak
+};
+
 MinidumpContextARM64 GetArm64MinidumpContext() {
   MinidumpContextARM64 minidump_context;
 
@@ -121,6 +138,29 @@ TEST(ProcessSnapshotMinidump, Empty) {
   EXPECT_TRUE(process_snapshot.AnnotationsSimpleMap().empty());
 }
 
+TEST(ProcessSnapshotMinidump, Compressed) {
+  MINIDUMP_HEADER header = {};
+  header.Signature = MINIDUMP_SIGNATURE;
+  header.Version = MINIDUMP_VERSION;
+  header.TimeDateStamp = 0x12345678;
+
+  StringFile string_file;
+  ZlibOutputStream zlib_output_stream(
+      ZlibOutputStream::Mode::kCompress,
+      ZlibOutputStream::Format::kGzip,
+      std::make_unique<StringFileOutputStream>(&string_file));
+  ASSERT_TRUE(zlib_output_stream.Write(reinterpret_cast<uint8_t*>(&header),
+                                       sizeof(header)));
+  ASSERT_TRUE(zlib_output_stream.Flush());
+
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.Initialize(&string_file));
+
+  timeval snapshot_time;
+  process_snapshot.SnapshotTime(&snapshot_time);
+  EXPECT_EQ(snapshot_time.tv_sec, 0x12345678);
+}
+
 // Writes |string| to |writer| as a MinidumpUTF8String, and returns the file
 // offset of the beginning of the string.
 RVA WriteString(FileWriterInterface* writer, const std::string& string) {
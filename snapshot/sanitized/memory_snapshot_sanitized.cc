@@ -47,9 +47,18 @@ class MemorySanitizer : public MemorySnapshot::Delegate {
     } else {
       Sanitize<uint32_t>(data, size);
     }
+
+    // The next chunk, if any, follows this one.
+    address_ += size;
     return delegate_->MemorySnapshotDelegateRead(data, size);
   }
 
+  bool MemorySnapshotDelegateAcceptsChunks() const override {
+    // Chunks after the first are pointer-aligned, so no word is split between
+    // chunks.
+    return delegate_->MemorySnapshotDelegateAcceptsChunks();
+  }
+
  private:
   template <typename Pointer>
   void Sanitize(void* data, size_t size) {
@@ -62,14 +71,22 @@ class MemorySanitizer : public MemorySnapshot::Delegate {
         ((address_ + sizeof(Pointer) - 1) & ~(sizeof(Pointer) - 1)) - address_);
     memcpy(data, &defaced, aligned_offset);
 
-    // Sanitize words that aren't small and don't look like pointers.
+    // Sanitize words that aren't small and don't look like pointers. Pointers
+    // tend to be followed by others into the same range, such as the stack
+    // being sanitized, so the range most recently found is checked before the
+    // set is searched again.
     size_t word_count = (size - aligned_offset) / sizeof(Pointer);
     auto words =
         reinterpret_cast<Pointer*>(static_cast<char*>(data) + aligned_offset);
+    VMAddress found_base = 1;
+    VMAddress found_last = 0;
     for (size_t index = 0; index < word_count; ++index) {
       auto word = StripPACBits(words[index]);
-      if (word > MemorySnapshotSanitized::kSmallWordMax &&
-          !ranges_->Contains(word)) {
+      if (word <= MemorySnapshotSanitized::kSmallWordMax ||
+          (word >= found_base && word <= found_last)) {
+        continue;
+      }
+      if (!ranges_->FindRange(word, &found_base, &found_last)) {
         words[index] = defaced;
       }
     }
@@ -17,10 +17,13 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
+#include <random>
 #include <vector>
 
 #include "base/containers/heap_array.h"
 #include "gtest/gtest.h"
+#include "util/linux/pac_helper.h"
 #include "util/misc/range_set.h"
 
 namespace crashpad {
@@ -92,6 +95,119 @@ void ExpectSanitizedShortUnalignedRegion(uint64_t address,
   }
 }
 
+// Delivers the contents of a buffer in chunks that begin at chunk_size-aligned
+// addresses, as MemorySnapshotGeneric does, when the delegate accepts chunks.
+class ChunkedMemorySnapshot final : public MemorySnapshot {
+ public:
+  ChunkedMemorySnapshot(uint64_t address,
+                        const std::vector<uint8_t>& data,
+                        size_t chunk_size)
+      : data_(data), address_(address), chunk_size_(chunk_size) {}
+
+  ChunkedMemorySnapshot(const ChunkedMemorySnapshot&) = delete;
+  ChunkedMemorySnapshot& operator=(const ChunkedMemorySnapshot&) = delete;
+
+  uint64_t Address() const override { return address_; }
+  size_t Size() const override { return data_.size(); }
+
+  bool Read(Delegate* delegate) const override {
+    std::vector<uint8_t> buffer(data_);
+    if (!delegate->MemorySnapshotDelegateAcceptsChunks()) {
+      return delegate->MemorySnapshotDelegateRead(buffer.data(),
+                                                  buffer.size());
+    }
+    size_t offset = 0;
+    while (offset < buffer.size()) {
+      const size_t size =
+          std::min(buffer.size() - offset,
+                   chunk_size_ - (address_ + offset) % chunk_size_);
+      if (!delegate->MemorySnapshotDelegateRead(&buffer[offset], size)) {
+        return false;
+      }
+      offset += size;
+    }
+    return true;
+  }
+
+  const MemorySnapshot* MergeWithOtherSnapshot(
+      const MemorySnapshot*) const override {
+    return nullptr;
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+  uint64_t address_;
+  size_t chunk_size_;
+};
+
+class AppendingDelegate : public MemorySnapshot::Delegate {
+ public:
+  explicit AppendingDelegate(bool accepts_chunks)
+      : accepts_chunks_(accepts_chunks) {}
+
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    ++read_count_;
+    captured_.insert(captured_.end(),
+                     static_cast<uint8_t*>(data),
+                     static_cast<uint8_t*>(data) + size);
+    return true;
+  }
+
+  bool MemorySnapshotDelegateAcceptsChunks() const override {
+    return accepts_chunks_;
+  }
+
+  const std::vector<uint8_t>& captured() const { return captured_; }
+  size_t read_count() const { return read_count_; }
+
+ private:
+  std::vector<uint8_t> captured_;
+  size_t read_count_ = 0;
+  bool accepts_chunks_;
+};
+
+TEST(MemorySnapshotSanitized, Chunked) {
+  constexpr uint64_t kPointer = 0x10000010;
+  constexpr size_t kChunkSize = 64;
+  constexpr uint64_t kAddress = 0x1003;
+
+  std::vector<uint8_t> data(kChunkSize * 4 + 13);
+  for (size_t index = 0; index < data.size(); ++index) {
+    data[index] = static_cast<uint8_t>(0x80 + index);
+  }
+  // Place pointers at word-aligned addresses in each chunk.
+  for (uint64_t address = (kAddress + 7) & ~uint64_t{7};
+       address + sizeof(kPointer) <= kAddress + data.size();
+       address += 3 * sizeof(kPointer)) {
+    memcpy(&data[address - kAddress], &kPointer, sizeof(kPointer));
+  }
+
+  RangeSet ranges;
+  ranges.Insert(kPointer, 0x100);
+
+  for (bool is_64_bit : {true, false}) {
+    SCOPED_TRACE(is_64_bit ? "64-bit" : "32-bit");
+    ChunkedMemorySnapshot wrapped(kAddress, data, kChunkSize);
+    internal::MemorySnapshotSanitized sanitized(&wrapped, &ranges, is_64_bit);
+
+    AppendingDelegate whole(/*accepts_chunks=*/false);
+    ASSERT_TRUE(sanitized.Read(&whole));
+    EXPECT_EQ(whole.read_count(), 1u);
+
+    AppendingDelegate chunked(/*accepts_chunks=*/true);
+    ASSERT_TRUE(sanitized.Read(&chunked));
+    EXPECT_EQ(chunked.read_count(), 5u);
+
+    EXPECT_EQ(chunked.captured(), whole.captured());
+    EXPECT_NE(whole.captured(), data);
+
+    // The pointers survive sanitization.
+    uint64_t first_pointer;
+    memcpy(&first_pointer, &whole.captured()[5], sizeof(first_pointer));
+    EXPECT_EQ(first_pointer, kPointer);
+  }
+}
+
 TEST(MemorySnapshotSanitized, ShortUnalignedRegion64) {
   for (uint64_t offset = 1; offset < sizeof(uint64_t); ++offset) {
     for (size_t size = 1; size < sizeof(uint64_t); ++size) {
@@ -110,6 +226,77 @@ TEST(MemorySnapshotSanitized, ShortUnalignedRegion32) {
   }
 }
 
+template <typename Pointer>
+void ExpectSanitizedWordsMatchReference(bool is_64_bit) {
+  constexpr uint64_t kAddress = 0x10000;
+  constexpr size_t kWordCount = 4096;
+
+  RangeSet ranges;
+  ranges.Insert(0x7000, 0x1000);
+  ranges.Insert(0x20000, 0x8000);
+  ranges.Insert(0x40000, 0x40);
+
+  // A mix of small words, pointers into and just outside each range, and
+  // random values, in runs so that consecutive words often share a range.
+  constexpr uint64_t kSmallWordMax =
+      internal::MemorySnapshotSanitized::kSmallWordMax;
+  static constexpr uint64_t kValues[] = {
+      0,       kSmallWordMax, kSmallWordMax + 1, 0x6fff,  0x7000,  0x7fff,
+      0x8000,  0x1ffff,       0x20000,           0x24000, 0x27fff, 0x28000,
+      0x3ffff, 0x40000,       0x4003f,           0x40040};
+  std::mt19937_64 urng(0x5eed);
+  std::vector<Pointer> words(kWordCount);
+  for (size_t index = 0; index < words.size(); ++index) {
+    switch (urng() % 4) {
+      case 0:
+        words[index] =
+            static_cast<Pointer>(kValues[urng() % std::size(kValues)]);
+        break;
+      case 1:
+        words[index] = static_cast<Pointer>(0x20000 + urng() % 0x8000);
+        break;
+      case 2:
+        words[index] = index > 0 ? words[index - 1] + sizeof(Pointer) : 0;
+        break;
+      default:
+        words[index] = static_cast<Pointer>(urng());
+        break;
+    }
+  }
+
+  std::vector<uint8_t> data(words.size() * sizeof(Pointer));
+  memcpy(data.data(), words.data(), data.size());
+
+  // Each word is checked on its own against the set.
+  std::vector<Pointer> expected(words);
+  for (Pointer& word : expected) {
+    const VMAddress stripped = StripPACBits(word);
+    if (stripped > kSmallWordMax && !ranges.Contains(stripped)) {
+      word = static_cast<Pointer>(internal::MemorySnapshotSanitized::kDefaced);
+    }
+  }
+
+  ChunkedMemorySnapshot wrapped(kAddress, data, data.size());
+  internal::MemorySnapshotSanitized sanitized(&wrapped, &ranges, is_64_bit);
+  AppendingDelegate delegate(/*accepts_chunks=*/false);
+  ASSERT_TRUE(sanitized.Read(&delegate));
+  ASSERT_EQ(delegate.captured().size(), data.size());
+
+  std::vector<Pointer> actual(words.size());
+  memcpy(actual.data(), delegate.captured().data(), data.size());
+  for (size_t index = 0; index < words.size(); ++index) {
+    EXPECT_EQ(actual[index], expected[index]) << "index=" << index;
+  }
+}
+
+TEST(MemorySnapshotSanitized, MatchesReference64) {
+  ExpectSanitizedWordsMatchReference<uint64_t>(/*is_64_bit=*/true);
+}
+
+TEST(MemorySnapshotSanitized, MatchesReference32) {
+  ExpectSanitizedWordsMatchReference<uint32_t>(/*is_64_bit=*/false);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
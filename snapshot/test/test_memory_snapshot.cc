@@ -21,8 +21,11 @@ namespace crashpad {
 namespace test {
 
 TestMemorySnapshot::TestMemorySnapshot()
-    : address_(0), size_(0), value_('\0'), should_fail_(false) {
-}
+    : address_(0),
+      size_(0),
+      value_('\0'),
+      should_fail_(false),
+      supports_concurrent_reads_(false) {}
 
 TestMemorySnapshot::~TestMemorySnapshot() {
 }
@@ -48,6 +51,10 @@ bool TestMemorySnapshot::Read(Delegate* delegate) const {
   return delegate->MemorySnapshotDelegateRead(&buffer[0], size_);
 }
 
+bool TestMemorySnapshot::SupportsConcurrentReads() const {
+  return supports_concurrent_reads_;
+}
+
 const MemorySnapshot* TestMemorySnapshot::MergeWithOtherSnapshot(
     const MemorySnapshot* other) const {
   CheckedRange<uint64_t, size_t> merged(0, 0);
@@ -58,6 +65,7 @@ const MemorySnapshot* TestMemorySnapshot::MergeWithOtherSnapshot(
   result->SetAddress(merged.base());
   result->SetSize(merged.size());
   result->SetValue(value_);
+  result->SetSupportsConcurrentReads(supports_concurrent_reads_);
   return result.release();
 }
 
@@ -45,11 +45,16 @@ class TestMemorySnapshot final : public MemorySnapshot {
 
   void SetShouldFailRead(bool should_fail) { should_fail_ = true; }
 
+  void SetSupportsConcurrentReads(bool supports_concurrent_reads) {
+    supports_concurrent_reads_ = supports_concurrent_reads;
+  }
+
   // MemorySnapshot:
 
   uint64_t Address() const override;
   size_t Size() const override;
   bool Read(Delegate* delegate) const override;
+  bool SupportsConcurrentReads() const override;
   const MemorySnapshot* MergeWithOtherSnapshot(
       const MemorySnapshot* other) const override;
 
@@ -58,6 +63,7 @@ class TestMemorySnapshot final : public MemorySnapshot {
   size_t size_;
   char value_;
   bool should_fail_;
+  bool supports_concurrent_reads_;
 };
 
 }  // namespace test
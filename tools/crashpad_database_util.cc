@@ -246,6 +246,9 @@ void ShowReport(const CrashReportDatabase::Report& report,
          spaces.c_str(),
          TimeToString(report.last_upload_attempt_time, utc).c_str());
   printf("%sUpload attempts: %d\n", spaces.c_str(), report.upload_attempts);
+  printf("%sCompressed: %s\n",
+         spaces.c_str(),
+         BoolToString(report.compressed).c_str());
 }
 
 // Shows information about a vector of |reports|. |space_count| is the number of
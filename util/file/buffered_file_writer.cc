@@ -0,0 +1,93 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/buffered_file_writer.h"
+
+#include <string.h>
+
+#include "base/check_op.h"
+#include "base/logging.h"
+
+namespace crashpad {
+
+BufferedFileWriter::BufferedFileWriter(FileWriterInterface* writer,
+                                       size_t buffer_size)
+    : buffer_(new uint8_t[buffer_size]),
+      buffer_size_(buffer_size),
+      buffer_used_(0),
+      writer_(writer) {
+  DCHECK_GT(buffer_size_, 0u);
+}
+
+BufferedFileWriter::~BufferedFileWriter() {}
+
+bool BufferedFileWriter::Flush() {
+  if (buffer_used_ == 0) {
+    return true;
+  }
+
+  const size_t size = buffer_used_;
+  buffer_used_ = 0;
+  return writer_->Write(buffer_.get(), size);
+}
+
+bool BufferedFileWriter::Write(const void* data, size_t size) {
+  if (size <= buffer_size_ - buffer_used_) {
+    if (size > 0) {
+      memcpy(&buffer_[buffer_used_], data, size);
+      buffer_used_ += size;
+    }
+    return true;
+  }
+
+  if (size < buffer_size_) {
+    if (!Flush()) {
+      return false;
+    }
+    memcpy(buffer_.get(), data, size);
+    buffer_used_ = size;
+    return true;
+  }
+
+  std::vector<WritableIoVec> iovecs;
+  if (buffer_used_ > 0) {
+    iovecs.push_back({buffer_.get(), buffer_used_});
+    buffer_used_ = 0;
+  }
+  iovecs.push_back({data, size});
+  return writer_->WriteIoVec(&iovecs);
+}
+
+bool BufferedFileWriter::WriteIoVec(std::vector<WritableIoVec>* iovecs) {
+  if (iovecs->empty()) {
+    LOG(ERROR) << "WriteIoVec(): no iovecs";
+    return false;
+  }
+
+  for (const WritableIoVec& iov : *iovecs) {
+    if (!Write(iov.iov_base, iov.iov_len)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FileOffset BufferedFileWriter::Seek(FileOffset offset, int whence) {
+  if (!Flush()) {
+    return -1;
+  }
+  return writer_->Seek(offset, whence);
+}
+
+}  // namespace crashpad
@@ -0,0 +1,81 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_FILE_BUFFERED_FILE_WRITER_H_
+#define CRASHPAD_UTIL_FILE_BUFFERED_FILE_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "util/file/file_writer.h"
+
+namespace crashpad {
+
+//! \brief A file writer that coalesces small writes to another
+//!     FileWriterInterface.
+//!
+//! Data written to this object is collected in a buffer and written to the
+//! underlying writer when the buffer fills, when Seek() is called, or when
+//! Flush() is called. Writes at least as large as the buffer bypass it, and
+//! are written to the underlying writer together with any buffered data in a
+//! single FileWriterInterface::WriteIoVec() call.
+//!
+//! Users must call Flush() after the final write. Data that remains buffered
+//! when this object is destroyed is discarded.
+class BufferedFileWriter : public FileWriterInterface {
+ public:
+  //! \brief The default size of the buffer, in bytes.
+  static constexpr size_t kDefaultBufferSize = 1024 * 1024;
+
+  //! \param[in] writer The writer that this object writes to. This object
+  //!     does not take ownership of \a writer, which must outlive it.
+  //! \param[in] buffer_size The size of the buffer, in bytes.
+  explicit BufferedFileWriter(FileWriterInterface* writer,
+                              size_t buffer_size = kDefaultBufferSize);
+
+  BufferedFileWriter(const BufferedFileWriter&) = delete;
+  BufferedFileWriter& operator=(const BufferedFileWriter&) = delete;
+
+  ~BufferedFileWriter() override;
+
+  //! \brief Writes any buffered data to the underlying writer.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged.
+  bool Flush();
+
+  // FileWriterInterface:
+  bool Write(const void* data, size_t size) override;
+  bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
+
+  // FileSeekerInterface:
+
+  //! \copydoc FileWriterInterface::Seek()
+  //!
+  //! \note Any buffered data is flushed before seeking.
+  FileOffset Seek(FileOffset offset, int whence) override;
+
+ private:
+  std::unique_ptr<uint8_t[]> buffer_;
+  size_t buffer_size_;
+  size_t buffer_used_;
+  FileWriterInterface* writer_;  // weak
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_FILE_BUFFERED_FILE_WRITER_H_
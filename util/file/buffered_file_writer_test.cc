@@ -0,0 +1,142 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/buffered_file_writer.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/file/string_file.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// A StringFile that counts the write operations made to it.
+class CountingStringFile : public StringFile {
+ public:
+  CountingStringFile() : StringFile(), writes_(0) {}
+
+  CountingStringFile(const CountingStringFile&) = delete;
+  CountingStringFile& operator=(const CountingStringFile&) = delete;
+
+  ~CountingStringFile() override {}
+
+  size_t writes() const { return writes_; }
+
+  // FileWriterInterface:
+  bool Write(const void* data, size_t size) override {
+    ++writes_;
+    return StringFile::Write(data, size);
+  }
+
+  bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override {
+    ++writes_;
+    std::string data;
+    for (const WritableIoVec& iov : *iovecs) {
+      data.append(static_cast<const char*>(iov.iov_base), iov.iov_len);
+    }
+    return StringFile::Write(data.data(), data.size());
+  }
+
+ private:
+  size_t writes_;
+};
+
+TEST(BufferedFileWriter, CoalescesSmallWrites) {
+  CountingStringFile string_file;
+  BufferedFileWriter writer(&string_file, 16);
+
+  std::string expected;
+  for (char c = 'a'; c <= 'z'; ++c) {
+    ASSERT_TRUE(writer.Write(&c, 1));
+    expected.push_back(c);
+  }
+  EXPECT_TRUE(writer.Write(nullptr, 0));
+
+  // The first 16 bytes were written when the buffer filled, and the rest
+  // remain buffered.
+  EXPECT_EQ(string_file.writes(), 1u);
+  EXPECT_EQ(string_file.string(), expected.substr(0, 16));
+
+  ASSERT_TRUE(writer.Flush());
+  EXPECT_EQ(string_file.writes(), 2u);
+  EXPECT_EQ(string_file.string(), expected);
+
+  // Flushing an empty buffer doesn’t write.
+  ASSERT_TRUE(writer.Flush());
+  EXPECT_EQ(string_file.writes(), 2u);
+}
+
+TEST(BufferedFileWriter, LargeWritesPassThrough) {
+  CountingStringFile string_file;
+  BufferedFileWriter writer(&string_file, 16);
+
+  ASSERT_TRUE(writer.Write("head", 4));
+  const std::string large(64, 'x');
+  ASSERT_TRUE(writer.Write(large.data(), large.size()));
+
+  // The buffered data and the large write were made together.
+  EXPECT_EQ(string_file.writes(), 1u);
+  EXPECT_EQ(string_file.string(), "head" + large);
+
+  // With nothing buffered, a large write is made directly.
+  ASSERT_TRUE(writer.Write(large.data(), large.size()));
+  EXPECT_EQ(string_file.writes(), 2u);
+  EXPECT_EQ(string_file.string(), "head" + large + large);
+
+  ASSERT_TRUE(writer.Flush());
+  EXPECT_EQ(string_file.writes(), 2u);
+}
+
+TEST(BufferedFileWriter, WriteIoVec) {
+  CountingStringFile string_file;
+  BufferedFileWriter writer(&string_file, 16);
+
+  const std::string large(32, 'L');
+  std::vector<WritableIoVec> iovecs;
+  iovecs.push_back({"abc", 3});
+  iovecs.push_back({"defgh", 5});
+  iovecs.push_back({large.data(), large.size()});
+  iovecs.push_back({"ij", 2});
+  ASSERT_TRUE(writer.WriteIoVec(&iovecs));
+  ASSERT_TRUE(writer.Flush());
+
+  EXPECT_EQ(string_file.writes(), 2u);
+  EXPECT_EQ(string_file.string(), "abcdefgh" + large + "ij");
+
+  iovecs.clear();
+  EXPECT_FALSE(writer.WriteIoVec(&iovecs));
+}
+
+TEST(BufferedFileWriter, Seek) {
+  CountingStringFile string_file;
+  BufferedFileWriter writer(&string_file, 16);
+
+  ASSERT_TRUE(writer.Write("0123456789", 10));
+  EXPECT_EQ(writer.Seek(0, SEEK_CUR), 10);
+  EXPECT_EQ(string_file.writes(), 1u);
+
+  EXPECT_EQ(writer.Seek(2, SEEK_SET), 2);
+  ASSERT_TRUE(writer.Write("ab", 2));
+  EXPECT_EQ(writer.Seek(0, SEEK_END), 10);
+  EXPECT_EQ(string_file.string(), "01ab456789");
+
+  ASSERT_TRUE(writer.Flush());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -52,6 +52,10 @@ FileOperationResult WeakFileHandleFileReader::Read(void* data, size_t size) {
   return rv;
 }
 
+FileHandle WeakFileHandleFileReader::DirectFileHandle() {
+  return file_handle_;
+}
+
 FileOffset WeakFileHandleFileReader::Seek(FileOffset offset, int whence) {
   DCHECK_NE(file_handle_, kInvalidFileHandle);
   return LoggingSeekFile(file_handle_, offset, whence);
@@ -88,6 +92,11 @@ FileOperationResult FileReader::Read(void* data, size_t size) {
   return weak_file_handle_file_reader_.Read(data, size);
 }
 
+FileHandle FileReader::DirectFileHandle() {
+  DCHECK(file_.is_valid());
+  return weak_file_handle_file_reader_.DirectFileHandle();
+}
+
 FileOffset FileReader::Seek(FileOffset offset, int whence) {
   DCHECK(file_.is_valid());
   return weak_file_handle_file_reader_.Seek(offset, whence);
@@ -45,6 +45,18 @@ class FileReaderInterface : public virtual FileSeekerInterface {
   //! \return `true` if the operation succeeded, `false` if it failed, with an
   //!     error message logged. Short reads are treated as failures.
   bool ReadExactly(void* data, size_t size);
+
+  //! \brief Returns the file handle that Read() reads from, if Read() provides
+  //!     the file’s contents unchanged.
+  //!
+  //! Callers may use the handle to transfer data directly from the file, for
+  //! example with `sendfile()`, starting at the position returned by SeekGet().
+  //! Callers that do so must Seek() past the data that they consume.
+  //!
+  //! \return The file handle, which remains owned by this object, or
+  //!     kInvalidFileHandle if this object does not read from a file handle or
+  //!     transforms the data that it reads.
+  virtual FileHandle DirectFileHandle() { return kInvalidFileHandle; }
 };
 
 //! \brief A file reader backed by a FileHandle.
@@ -72,6 +84,7 @@ class WeakFileHandleFileReader : public FileReaderInterface {
 
   // FileReaderInterface:
   FileOperationResult Read(void* data, size_t size) override;
+  FileHandle DirectFileHandle() override;
 
   // FileSeekerInterface:
 
@@ -131,6 +144,12 @@ class FileReader : public FileReaderInterface {
   //!     a Close().
   FileOperationResult Read(void* data, size_t size) override;
 
+  //! \copydoc FileReaderInterface::DirectFileHandle()
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  FileHandle DirectFileHandle() override;
+
   // FileSeekerInterface:
 
   //! \copydoc FileReaderInterface::Seek()
@@ -0,0 +1,325 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/gzip_file_reader.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/numerics/safe_math.h"
+#include "util/misc/zlib.h"
+
+namespace crashpad {
+
+namespace {
+
+// Decompression state is recorded at least this often, in bytes of
+// decompressed data, until there are kMaxCheckpoints checkpoints. Each
+// checkpoint holds a copy of zlib’s window, about 40 kB.
+constexpr FileOffset kMinCheckpointInterval = 1024 * 1024;
+
+// When there would be more checkpoints than this, every other one is
+// discarded and the interval between them is doubled.
+constexpr size_t kMaxCheckpoints = 32;
+
+// The size of a gzip member’s header and trailer, without optional fields.
+constexpr FileOffset kGzipMinimumSize = 18;
+
+}  // namespace
+
+struct GzipFileReader::Checkpoint {
+  Checkpoint() : zlib_stream(), input_offset(0), position(0) {}
+
+  Checkpoint(const Checkpoint&) = delete;
+  Checkpoint& operator=(const Checkpoint&) = delete;
+
+  ~Checkpoint() { inflateEnd(&zlib_stream); }
+
+  z_stream zlib_stream;
+
+  // The offset of the next compressed byte in the underlying file.
+  FileOffset input_offset;
+
+  // The position in the decompressed data.
+  FileOffset position;
+};
+
+GzipFileReader::GzipFileReader()
+    : zlib_stream_(),
+      checkpoints_(),
+      file_reader_(nullptr),
+      size_(0),
+      position_(0),
+      checkpoint_interval_(kMinCheckpointInterval),
+      zlib_stream_initialized_(false),
+      stream_end_(false),
+      initialized_() {}
+
+GzipFileReader::~GzipFileReader() {
+  if (zlib_stream_initialized_) {
+    inflateEnd(&zlib_stream_);
+  }
+}
+
+// static
+bool GzipFileReader::IsGzip(FileReaderInterface* file_reader) {
+  FileOffset position = file_reader->SeekGet();
+  if (position < 0) {
+    return false;
+  }
+
+  uint8_t magic[2];
+  FileOperationResult bytes_read = file_reader->Read(magic, sizeof(magic));
+  if (!file_reader->SeekSet(position)) {
+    return false;
+  }
+
+  return bytes_read == sizeof(magic) && magic[0] == 0x1f && magic[1] == 0x8b;
+}
+
+bool GzipFileReader::Initialize(FileReaderInterface* file_reader) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  file_reader_ = file_reader;
+
+  constexpr int kZlibMaxWindowBits = 15;
+  int zr = inflateInit2(&zlib_stream_,
+                        ZlibWindowBitsWithGzipWrapper(kZlibMaxWindowBits));
+  if (zr != Z_OK) {
+    LOG(ERROR) << "inflateInit2: " << ZlibErrorString(zr);
+    return false;
+  }
+  zlib_stream_initialized_ = true;
+
+  // The member’s trailer records the size of the uncompressed data, modulo
+  // 2^32. The data read from this object is limited to that size, so larger
+  // data is not supported. Minidumps, which use 32-bit offsets, fit.
+  const FileOffset start_offset = file_reader_->SeekGet();
+  if (start_offset < 0) {
+    return false;
+  }
+  const FileOffset end_offset = file_reader_->Seek(0, SEEK_END);
+  if (end_offset < 0) {
+    return false;
+  }
+  uint8_t trailer_size[4];
+  if (end_offset - start_offset < kGzipMinimumSize ||
+      !file_reader_->SeekSet(end_offset - sizeof(trailer_size)) ||
+      !file_reader_->ReadExactly(trailer_size, sizeof(trailer_size))) {
+    LOG(ERROR) << "gzip trailer not found";
+    return false;
+  }
+  size_ = static_cast<FileOffset>(trailer_size[0]) |
+          static_cast<FileOffset>(trailer_size[1]) << 8 |
+          static_cast<FileOffset>(trailer_size[2]) << 16 |
+          static_cast<FileOffset>(trailer_size[3]) << 24;
+
+  if (!file_reader_->SeekSet(start_offset) || !AddCheckpoint()) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+FileOperationResult GzipFileReader::Read(void* data, size_t size) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (position_ >= size_) {
+    return 0;
+  }
+  return Inflate(
+      static_cast<uint8_t*>(data),
+      std::min(size, base::checked_cast<size_t>(size_ - position_)));
+}
+
+FileOffset GzipFileReader::Seek(FileOffset offset, int whence) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  FileOffset base_offset;
+  switch (whence) {
+    case SEEK_SET:
+      base_offset = 0;
+      break;
+
+    case SEEK_CUR:
+      base_offset = position_;
+      break;
+
+    case SEEK_END:
+      base_offset = size_;
+      break;
+
+    default:
+      LOG(ERROR) << "Seek(): invalid whence " << whence;
+      return -1;
+  }
+
+  base::CheckedNumeric<FileOffset> new_offset(base_offset);
+  new_offset += offset;
+  FileOffset target;
+  if (!new_offset.AssignIfValid(&target) || target < 0) {
+    LOG(ERROR) << "Seek(): new_offset invalid";
+    return -1;
+  }
+
+  // Decompression stops at the end of the data, even if the position is
+  // beyond it.
+  const FileOffset current = std::min(position_, size_);
+  const FileOffset goal = std::min(target, size_);
+
+  // Resume from the last checkpoint at or before the goal if that is closer
+  // than the current position.
+  auto checkpoint = std::upper_bound(
+      checkpoints_.begin(),
+      checkpoints_.end(),
+      goal,
+      [](FileOffset goal, const std::unique_ptr<Checkpoint>& checkpoint) {
+        return goal < checkpoint->position;
+      });
+  DCHECK(checkpoint != checkpoints_.begin());
+  --checkpoint;
+  if (goal < current || (*checkpoint)->position > current) {
+    if (!RestoreCheckpoint(checkpoint->get())) {
+      return -1;
+    }
+  }
+
+  if (!Skip(goal - position_)) {
+    return -1;
+  }
+
+  position_ = target;
+  return position_;
+}
+
+FileOperationResult GzipFileReader::Inflate(uint8_t* data, size_t size) {
+  size_t bytes_inflated = 0;
+  while (bytes_inflated < size && !stream_end_) {
+    if (zlib_stream_.avail_in == 0) {
+      FileOperationResult bytes_read =
+          file_reader_->Read(input_, sizeof(input_));
+      if (bytes_read < 0) {
+        return -1;
+      }
+      if (bytes_read == 0) {
+        LOG(ERROR) << "inflate: unexpected end of file";
+        return -1;
+      }
+      zlib_stream_.next_in = input_;
+      zlib_stream_.avail_in = base::checked_cast<uInt>(bytes_read);
+    }
+
+    const uInt output_size =
+        base::saturated_cast<uInt>(size - bytes_inflated);
+    zlib_stream_.next_out = data + bytes_inflated;
+    zlib_stream_.avail_out = output_size;
+    int zr = inflate(&zlib_stream_, Z_NO_FLUSH);
+    if (zr == Z_STREAM_END) {
+      stream_end_ = true;
+    } else if (zr != Z_OK) {
+      LOG(ERROR) << "inflate: " << ZlibErrorString(zr);
+      return -1;
+    }
+    const size_t output_inflated = output_size - zlib_stream_.avail_out;
+    bytes_inflated += output_inflated;
+    position_ += output_inflated;
+
+    if (stream_end_) {
+      // zlib has verified the trailer, including the size that Initialize()
+      // read from it.
+      if (position_ != size_) {
+        LOG(ERROR) << "inflate: size mismatch";
+        return -1;
+      }
+    } else if (position_ - checkpoints_.back()->position >=
+                   checkpoint_interval_ &&
+               !AddCheckpoint()) {
+      return -1;
+    }
+  }
+
+  return base::checked_cast<FileOperationResult>(bytes_inflated);
+}
+
+bool GzipFileReader::Skip(FileOffset size) {
+  uint8_t output[32 * 1024];
+  while (size > 0) {
+    FileOperationResult bytes_inflated = Inflate(
+        output,
+        static_cast<size_t>(std::min(size, FileOffset{sizeof(output)})));
+    if (bytes_inflated <= 0) {
+      LOG_IF(ERROR, bytes_inflated == 0) << "inflate: unexpected end of data";
+      return false;
+    }
+    size -= bytes_inflated;
+  }
+  return true;
+}
+
+bool GzipFileReader::AddCheckpoint() {
+  if (checkpoints_.size() == kMaxCheckpoints) {
+    // Keep every other checkpoint, so that they remain evenly spaced.
+    size_t kept = 0;
+    for (size_t index = 0; index < checkpoints_.size(); index += 2) {
+      checkpoints_[kept++] = std::move(checkpoints_[index]);
+    }
+    checkpoints_.resize(kept);
+    checkpoint_interval_ *= 2;
+    if (position_ - checkpoints_.back()->position < checkpoint_interval_) {
+      return true;
+    }
+  }
+
+  const FileOffset input_offset = file_reader_->SeekGet();
+  if (input_offset < 0) {
+    return false;
+  }
+
+  auto checkpoint = std::make_unique<Checkpoint>();
+  int zr = inflateCopy(&checkpoint->zlib_stream, &zlib_stream_);
+  if (zr != Z_OK) {
+    LOG(ERROR) << "inflateCopy: " << ZlibErrorString(zr);
+    return false;
+  }
+  checkpoint->input_offset = input_offset - zlib_stream_.avail_in;
+  checkpoint->position = position_;
+  checkpoints_.push_back(std::move(checkpoint));
+  return true;
+}
+
+bool GzipFileReader::RestoreCheckpoint(Checkpoint* checkpoint) {
+  if (!file_reader_->SeekSet(checkpoint->input_offset)) {
+    return false;
+  }
+
+  inflateEnd(&zlib_stream_);
+  zlib_stream_initialized_ = false;
+  int zr = inflateCopy(&zlib_stream_, &checkpoint->zlib_stream);
+  if (zr != Z_OK) {
+    LOG(ERROR) << "inflateCopy: " << ZlibErrorString(zr);
+    return false;
+  }
+  zlib_stream_initialized_ = true;
+
+  zlib_stream_.next_in = input_;
+  zlib_stream_.avail_in = 0;
+  position_ = checkpoint->position;
+  stream_end_ = false;
+  return true;
+}
+
+}  // namespace crashpad
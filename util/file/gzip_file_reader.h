@@ -0,0 +1,109 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_FILE_GZIP_FILE_READER_H_
+#define CRASHPAD_UTIL_FILE_GZIP_FILE_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <vector>
+
+#include "third_party/zlib/zlib_crashpad.h"
+#include "util/file/file_io.h"
+#include "util/file/file_reader.h"
+#include "util/misc/initialization_state_dcheck.h"
+
+namespace crashpad {
+
+//! \brief A file reader that presents the decompressed contents of
+//!     gzip-compressed data read from another file reader.
+//!
+//! The data is decompressed as it is read, so that only a bounded amount of it
+//! is held in memory. Its size is taken from the gzip trailer, which records
+//! it modulo 2^32, so the decompressed data must be smaller than 4 GiB.
+//! Decompression records checkpoints from which it can be resumed, so that
+//! seeking backwards resumes from the nearest checkpoint instead of from the
+//! beginning. Corrupt data is detected as it is read.
+class GzipFileReader : public FileReaderInterface {
+ public:
+  GzipFileReader();
+
+  GzipFileReader(const GzipFileReader&) = delete;
+  GzipFileReader& operator=(const GzipFileReader&) = delete;
+
+  ~GzipFileReader() override;
+
+  //! \brief Determines whether the data in \a file_reader at its current
+  //!     position begins with a gzip header.
+  //!
+  //! The position of \a file_reader is restored before this method returns.
+  //!
+  //! \param[in] file_reader The file reader to examine.
+  //!
+  //! \return `true` if the data begins with the gzip magic number, `false` if
+  //!     it does not or could not be read.
+  static bool IsGzip(FileReaderInterface* file_reader);
+
+  //! \brief Initializes this object to decompress a gzip member.
+  //!
+  //! \param[in] file_reader A seekable file reader positioned at the start of
+  //!     a gzip member that extends to the end of the file. The member is read
+  //!     as this object is read. This object does not take ownership of \a
+  //!     file_reader, which must outlive it. \a file_reader must not be used
+  //!     by anything else while this object is in use.
+  //!
+  //! \return `true` on success. `false` on failure, with a message logged.
+  bool Initialize(FileReaderInterface* file_reader);
+
+  // FileReaderInterface:
+  FileOperationResult Read(void* data, size_t size) override;
+
+  // FileSeekerInterface:
+  FileOffset Seek(FileOffset offset, int whence) override;
+
+ private:
+  struct Checkpoint;
+
+  // Decompresses up to size bytes into data. Returns the number of bytes
+  // decompressed, which is less than size only at the end of the member, or
+  // -1 on failure with a message logged.
+  FileOperationResult Inflate(uint8_t* data, size_t size);
+
+  // Decompresses and discards size bytes.
+  bool Skip(FileOffset size);
+
+  // Records a checkpoint at the current position.
+  bool AddCheckpoint();
+
+  // Resumes decompression from checkpoint.
+  bool RestoreCheckpoint(Checkpoint* checkpoint);
+
+  z_stream zlib_stream_;
+  std::vector<std::unique_ptr<Checkpoint>> checkpoints_;
+  FileReaderInterface* file_reader_;  // weak
+  FileOffset size_;
+  FileOffset position_;
+  FileOffset checkpoint_interval_;
+  bool zlib_stream_initialized_;
+  bool stream_end_;
+  uint8_t input_[16 * 1024];
+  InitializationStateDcheck initialized_;
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_FILE_GZIP_FILE_READER_H_
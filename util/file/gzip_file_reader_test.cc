@@ -0,0 +1,163 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file/gzip_file_reader.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/rand_util.h"
+#include "gtest/gtest.h"
+#include "util/file/string_file.h"
+#include "util/stream/test_output_stream.h"
+#include "util/stream/zlib_output_stream.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+std::string GzipCompress(const std::string& data) {
+  auto test_output_stream = std::make_unique<TestOutputStream>();
+  TestOutputStream* test_output_stream_weak = test_output_stream.get();
+  ZlibOutputStream zlib_output_stream(ZlibOutputStream::Mode::kCompress,
+                                      ZlibOutputStream::Format::kGzip,
+                                      std::move(test_output_stream));
+  EXPECT_TRUE(zlib_output_stream.Write(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+  EXPECT_TRUE(zlib_output_stream.Flush());
+  const std::vector<uint8_t>& compressed = test_output_stream_weak->all_data();
+  return std::string(compressed.begin(), compressed.end());
+}
+
+TEST(GzipFileReader, IsGzip) {
+  StringFile string_file;
+  EXPECT_FALSE(GzipFileReader::IsGzip(&string_file));
+
+  string_file.SetString("MDMP");
+  EXPECT_FALSE(GzipFileReader::IsGzip(&string_file));
+  EXPECT_EQ(string_file.SeekGet(), 0);
+
+  string_file.SetString(GzipCompress("MDMP"));
+  EXPECT_TRUE(GzipFileReader::IsGzip(&string_file));
+  EXPECT_EQ(string_file.SeekGet(), 0);
+}
+
+TEST(GzipFileReader, ReadAndSeek) {
+  const std::string data = base::RandBytesAsString(100000);
+  StringFile string_file;
+  string_file.SetString(GzipCompress(data));
+
+  GzipFileReader reader;
+  ASSERT_TRUE(reader.Initialize(&string_file));
+
+  std::string contents(data.size(), '\0');
+  ASSERT_TRUE(reader.ReadExactly(&contents[0], contents.size()));
+  EXPECT_EQ(contents, data);
+
+  char c;
+  EXPECT_EQ(reader.Read(&c, 1), 0);
+
+  ASSERT_TRUE(reader.SeekSet(1234));
+  ASSERT_TRUE(reader.ReadExactly(&c, 1));
+  EXPECT_EQ(c, data[1234]);
+  EXPECT_EQ(reader.Seek(0, SEEK_END), static_cast<FileOffset>(data.size()));
+}
+
+TEST(GzipFileReader, SeekAcrossCheckpoints) {
+  // Large enough that checkpoints must be discarded and respaced while
+  // reading. The data is mostly a short repeating pattern, so that it
+  // compresses quickly, with the offset of each page stored at its start, so
+  // that data from the wrong place is recognized.
+  std::string data(48 * 1024 * 1024, '\0');
+  for (size_t offset = 0; offset < data.size(); ++offset) {
+    data[offset] = static_cast<char>(offset % 251);
+  }
+  for (size_t offset = 0; offset < data.size(); offset += 4096) {
+    const uint32_t page_offset = static_cast<uint32_t>(offset);
+    memcpy(&data[offset], &page_offset, sizeof(page_offset));
+  }
+  StringFile string_file;
+  string_file.SetString(GzipCompress(data));
+
+  GzipFileReader reader;
+  ASSERT_TRUE(reader.Initialize(&string_file));
+  EXPECT_EQ(reader.Seek(0, SEEK_END), static_cast<FileOffset>(data.size()));
+
+  constexpr size_t kReadSize = 100;
+  const size_t offsets[] = {data.size() - kReadSize,
+                            0,
+                            data.size() / 2 + 1,
+                            data.size() / 2 - 3,
+                            5 * 1024 * 1024 + 17,
+                            5 * 1024 * 1024 + 17,
+                            data.size() / 3,
+                            data.size() - 1234567,
+                            42};
+  for (size_t offset : offsets) {
+    SCOPED_TRACE(offset);
+    ASSERT_TRUE(reader.SeekSet(offset));
+    char buffer[kReadSize];
+    ASSERT_TRUE(reader.ReadExactly(buffer, sizeof(buffer)));
+    EXPECT_EQ(std::string(buffer, sizeof(buffer)),
+              data.substr(offset, sizeof(buffer)));
+  }
+
+  // Seeking beyond the end is permitted, and reads there return no data.
+  EXPECT_EQ(reader.Seek(10, SEEK_END),
+            static_cast<FileOffset>(data.size() + 10));
+  char c;
+  EXPECT_EQ(reader.Read(&c, 1), 0);
+  ASSERT_TRUE(reader.SeekSet(data.size() - 1));
+  ASSERT_TRUE(reader.ReadExactly(&c, 1));
+  EXPECT_EQ(c, data.back());
+}
+
+TEST(GzipFileReader, Truncated) {
+  std::string compressed = GzipCompress(base::RandBytesAsString(10000));
+  compressed.resize(compressed.size() / 2);
+  StringFile string_file;
+  string_file.SetString(compressed);
+
+  // The size in the trailer is missing, so whatever is found in its place can’t
+  // be trusted. Reading the data fails either way.
+  GzipFileReader reader;
+  if (reader.Initialize(&string_file)) {
+    std::string contents(10000, '\0');
+    EXPECT_FALSE(reader.ReadExactly(&contents[0], contents.size()));
+  }
+}
+
+TEST(GzipFileReader, SizeMismatch) {
+  // The trailer of a member records the size of its data. A member whose data
+  // is shorter than that is rejected when the end of the data is reached.
+  const std::string data = base::RandBytesAsString(10000);
+  std::string compressed = GzipCompress(data);
+  compressed[compressed.size() - 4] ^= 1;
+  StringFile string_file;
+  string_file.SetString(compressed);
+
+  GzipFileReader reader;
+  ASSERT_TRUE(reader.Initialize(&string_file));
+  std::string contents(data.size(), '\0');
+  EXPECT_FALSE(reader.ReadExactly(&contents[0], contents.size()));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -57,6 +57,18 @@ bool DirectPtraceConnection::Attach(pid_t tid) {
   return true;
 }
 
+void DirectPtraceConnection::AttachThreads(const std::vector<pid_t>& tids,
+                                           std::vector<pid_t>* attached) {
+  std::vector<pid_t> local_attached;
+  PtraceAttachMultiple(tids, &local_attached);
+  for (pid_t tid : local_attached) {
+    std::unique_ptr<ScopedPtraceAttach> attach(new ScopedPtraceAttach);
+    attach->ResetAttached(tid);
+    attachments_.push_back(std::move(attach));
+    attached->push_back(tid);
+  }
+}
+
 bool DirectPtraceConnection::Is64Bit() {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return ptracer_.Is64Bit();
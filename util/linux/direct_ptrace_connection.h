@@ -54,6 +54,8 @@ class DirectPtraceConnection : public PtraceConnection {
 
   pid_t GetProcessID() override;
   bool Attach(pid_t tid) override;
+  void AttachThreads(const std::vector<pid_t>& tids,
+                     std::vector<pid_t>* attached) override;
   bool Is64Bit() override;
   bool GetThreadInfo(pid_t tid, ThreadInfo* info) override;
   bool ReadFileContents(const base::FilePath& path,
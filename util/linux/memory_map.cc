@@ -18,82 +18,97 @@
 #include <string.h>
 #include <sys/sysmacros.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "base/check_op.h"
 #include "base/files/file_path.h"
 #include "base/logging.h"
 #include "build/build_config.h"
-#include "util/file/delimited_file_reader.h"
 #include "util/file/file_io.h"
-#include "util/file/string_file.h"
-#include "util/stdlib/string_number_conversion.h"
 
 namespace crashpad {
 
 namespace {
 
+// Parses a number in base 10 or 16 from the field beginning at *cursor and
+// terminated by delimiter, advancing *cursor past the delimiter. The field must
+// contain at least min_digits digits, and nothing else.
 template <typename Type>
-bool HexStringToNumber(const std::string& string, Type* number) {
-  return StringToNumber("0x" + string, number);
-}
-
-// The result from parsing a line from the maps file.
-enum class ParseResult {
-  // A line was successfully parsed.
-  kSuccess = 0,
-
-  // The end of the file was successfully reached.
-  kEndOfFile,
+bool ParseNumber(const char** cursor,
+                 const char* end,
+                 unsigned int base,
+                 char delimiter,
+                 size_t min_digits,
+                 Type* number) {
+  static_assert(std::numeric_limits<Type>::is_integer, "Type must be integer");
+  constexpr uint64_t kMax = std::numeric_limits<Type>::max();
+
+  const char* c = *cursor;
+  uint64_t value = 0;
+  for (; c < end && *c != delimiter; ++c) {
+    unsigned int digit;
+    if (*c >= '0' && *c <= '9') {
+      digit = *c - '0';
+    } else if (base == 16 && *c >= 'a' && *c <= 'f') {
+      digit = *c - 'a' + 10;
+    } else if (base == 16 && *c >= 'A' && *c <= 'F') {
+      digit = *c - 'A' + 10;
+    } else {
+      return false;
+    }
+    if (value > (kMax - digit) / base) {
+      return false;
+    }
+    value = value * base + digit;
+  }
 
-  // There was an error in the file, likely because it was read non-atmoically.
-  // We should try to read it again.
-  kRetry,
+  if (c == end ||
+      static_cast<size_t>(c - *cursor) < std::max(min_digits, size_t{1})) {
+    return false;
+  }
+  *number = static_cast<Type>(value);
+  *cursor = c + 1;
+  return true;
+}
 
-  // An error with a message logged.
-  kError
-};
+// Parses a line from a maps file beginning at *cursor, advancing *cursor to the
+// beginning of the next line, and extends mappings with a new
+// MemoryMap::Mapping describing the line.
+internal::MapsParseResult ParseMapsLine(
+    const char** cursor,
+    const char* end,
+    std::vector<MemoryMap::Mapping>* mappings) {
+  using internal::MapsParseResult;
 
-// Reads a line from a maps file being read by maps_file_reader and extends
-// mappings with a new MemoryMap::Mapping describing the line.
-ParseResult ParseMapsLine(DelimitedFileReader* maps_file_reader,
-                          std::vector<MemoryMap::Mapping>* mappings) {
-  std::string field;
   LinuxVMAddress start_address;
-  switch (maps_file_reader->GetDelim('-', &field)) {
-    case DelimitedFileReader::Result::kError:
-      return ParseResult::kError;
-    case DelimitedFileReader::Result::kEndOfFile:
-      return ParseResult::kEndOfFile;
-    case DelimitedFileReader::Result::kSuccess:
-      field.pop_back();
-      if (!HexStringToNumber(field, &start_address)) {
-        LOG(ERROR) << "format error";
-        return ParseResult::kError;
-      }
-      if (!mappings->empty() && start_address < mappings->back().range.End()) {
-        return ParseResult::kRetry;
-      }
+  if (!ParseNumber(cursor, end, 16, '-', 1, &start_address)) {
+    LOG(ERROR) << "format error";
+    return MapsParseResult::kError;
+  }
+  if (!mappings->empty() && start_address < mappings->back().range.End()) {
+    return MapsParseResult::kRetry;
   }
 
   LinuxVMAddress end_address;
-  if (maps_file_reader->GetDelim(' ', &field) !=
-          DelimitedFileReader::Result::kSuccess ||
-      (field.pop_back(), !HexStringToNumber(field, &end_address))) {
-    LOG(ERROR) << "format error";
-    return ParseResult::kError;
-  }
-  if (end_address < start_address) {
+  if (!ParseNumber(cursor, end, 16, ' ', 1, &end_address) ||
+      end_address < start_address) {
     LOG(ERROR) << "format error";
-    return ParseResult::kError;
+    return MapsParseResult::kError;
   }
+
+  const char* line_end =
+      static_cast<const char*>(memchr(*cursor, '\n', end - *cursor));
+
   // Skip zero-length mappings.
   if (end_address == start_address) {
-    std::string rest_of_line;
-    if (maps_file_reader->GetLine(&rest_of_line) !=
-        DelimitedFileReader::Result::kSuccess) {
-      LOG(ERROR) << "format error";
-      return ParseResult::kError;
-    }
-    return ParseResult::kSuccess;
+    *cursor = line_end ? line_end + 1 : end;
+    return MapsParseResult::kSuccess;
+  }
+
+  if (!line_end) {
+    LOG(ERROR) << "format error";
+    return MapsParseResult::kError;
   }
 
   // TODO(jperaza): set bitness properly
@@ -106,11 +121,10 @@ ParseResult ParseMapsLine(DelimitedFileReader* maps_file_reader,
   MemoryMap::Mapping mapping;
   mapping.range.SetRange(is_64_bit, start_address, end_address - start_address);
 
-  if (maps_file_reader->GetDelim(' ', &field) !=
-          DelimitedFileReader::Result::kSuccess ||
-      (field.pop_back(), field.size() != 4)) {
+  const char* perms = *cursor;
+  if (line_end - perms < 5 || perms[4] != ' ') {
     LOG(ERROR) << "format error";
-    return ParseResult::kError;
+    return MapsParseResult::kError;
   }
 #define SET_FIELD(actual_c, outval, true_chars, false_chars) \
   do {                                                       \
@@ -120,67 +134,43 @@ ParseResult ParseMapsLine(DelimitedFileReader* maps_file_reader,
       *outval = false;                                       \
     } else {                                                 \
       LOG(ERROR) << "format error";                          \
-      return ParseResult::kError;                            \
+      return MapsParseResult::kError;                        \
     }                                                        \
   } while (false)
-  SET_FIELD(field[0], &mapping.readable, "r", "-");
-  SET_FIELD(field[1], &mapping.writable, "w", "-");
-  SET_FIELD(field[2], &mapping.executable, "x", "-");
-  SET_FIELD(field[3], &mapping.shareable, "sS", "p");
+  SET_FIELD(perms[0], &mapping.readable, "r", "-");
+  SET_FIELD(perms[1], &mapping.writable, "w", "-");
+  SET_FIELD(perms[2], &mapping.executable, "x", "-");
+  SET_FIELD(perms[3], &mapping.shareable, "sS", "p");
 #undef SET_FIELD
-
-  if (maps_file_reader->GetDelim(' ', &field) !=
-          DelimitedFileReader::Result::kSuccess ||
-      (field.pop_back(), !HexStringToNumber(field, &mapping.offset))) {
-    LOG(ERROR) << "format error";
-    return ParseResult::kError;
-  }
+  *cursor = perms + 5;
 
   uint32_t major;
-  if (maps_file_reader->GetDelim(':', &field) !=
-          DelimitedFileReader::Result::kSuccess ||
-      (field.pop_back(), field.size()) < 2 ||
-      !HexStringToNumber(field, &major)) {
-    LOG(ERROR) << "format error";
-    return ParseResult::kError;
-  }
-
   uint32_t minor;
-  if (maps_file_reader->GetDelim(' ', &field) !=
-          DelimitedFileReader::Result::kSuccess ||
-      (field.pop_back(), field.size()) < 2 ||
-      !HexStringToNumber(field, &minor)) {
+  if (!ParseNumber(cursor, line_end, 16, ' ', 1, &mapping.offset) ||
+      !ParseNumber(cursor, line_end, 16, ':', 2, &major) ||
+      !ParseNumber(cursor, line_end, 16, ' ', 2, &minor)) {
     LOG(ERROR) << "format error";
-    return ParseResult::kError;
+    return MapsParseResult::kError;
   }
-
   mapping.device = makedev(major, minor);
 
-  if (maps_file_reader->GetDelim(' ', &field) !=
-          DelimitedFileReader::Result::kSuccess ||
-      (field.pop_back(), !StringToNumber(field, &mapping.inode))) {
-    LOG(ERROR) << "format error";
-    return ParseResult::kError;
-  }
-
-  if (maps_file_reader->GetDelim('\n', &field) !=
-      DelimitedFileReader::Result::kSuccess) {
-    LOG(ERROR) << "format error";
-    return ParseResult::kError;
-  }
-  if (field.back() != '\n') {
+  if (!ParseNumber(cursor, line_end, 10, ' ', 1, &mapping.inode)) {
     LOG(ERROR) << "format error";
-    return ParseResult::kError;
+    return MapsParseResult::kError;
   }
-  field.pop_back();
 
   mappings->push_back(mapping);
 
-  size_t path_start = field.find_first_not_of(' ');
-  if (path_start != std::string::npos) {
-    mappings->back().name = field.substr(path_start);
+  const char* name = *cursor;
+  while (name < line_end && *name == ' ') {
+    ++name;
   }
-  return ParseResult::kSuccess;
+  if (name < line_end) {
+    mappings->back().name.assign(name, line_end - name);
+  }
+
+  *cursor = line_end + 1;
+  return MapsParseResult::kSuccess;
 }
 
 class SparseReverseIterator : public MemoryMap::Iterator {
@@ -235,6 +225,29 @@ struct FastRange {
 
 }  // namespace
 
+namespace internal {
+
+MapsParseResult ParseMapsFile(const char* contents,
+                              size_t size,
+                              std::vector<MemoryMap::Mapping>* mappings) {
+  mappings->clear();
+
+  // Most lines in a maps file are between 50 and 150 bytes long.
+  mappings->reserve(size / 100);
+
+  const char* cursor = contents;
+  const char* const end = contents + size;
+  while (cursor < end) {
+    MapsParseResult result = ParseMapsLine(&cursor, end, mappings);
+    if (result != MapsParseResult::kSuccess) {
+      return result;
+    }
+  }
+  return MapsParseResult::kSuccess;
+}
+
+}  // namespace internal
+
 MemoryMap::Mapping::Mapping()
     : name(),
       range(false, 0, 0),
@@ -246,7 +259,8 @@ MemoryMap::Mapping::Mapping()
       executable(false),
       shareable(false) {}
 
-MemoryMap::MemoryMap() : mappings_(), connection_(nullptr), initialized_() {}
+MemoryMap::MemoryMap()
+    : mappings_(), name_index_(), connection_(nullptr), initialized_() {}
 
 MemoryMap::~MemoryMap() {}
 
@@ -268,49 +282,76 @@ bool MemoryMap::Initialize(PtraceConnection* connection) {
   // or missed entirely. The kernel reads entries from this file into a page
   // sized buffer, so maps files larger than a page require multiple reads.
   // Attempt to reduce the time between reads by reading the entire file into a
-  // StringFile before attempting to parse it. If ParseMapsLine detects
-  // duplicate, overlapping, or out-of-order entries, it will trigger restarting
-  // the read up to |attempts| times.
+  // string before attempting to parse it. If ParseMapsFile detects duplicate,
+  // overlapping, or out-of-order entries, it will trigger restarting the read
+  // up to |attempts| times.
+  std::string contents;
   int attempts = 3;
   do {
-    std::string contents;
     char path[32];
     snprintf(path, sizeof(path), "/proc/%d/maps", connection_->GetProcessID());
     if (!connection_->ReadFileContents(base::FilePath(path), &contents)) {
       return false;
     }
 
-    StringFile maps_file;
-    maps_file.SetString(contents);
-    DelimitedFileReader maps_file_reader(&maps_file);
-
-    ParseResult result;
-    while ((result = ParseMapsLine(&maps_file_reader, &mappings_)) ==
-           ParseResult::kSuccess) {
-    }
-    if (result == ParseResult::kEndOfFile) {
+    internal::MapsParseResult result =
+        internal::ParseMapsFile(contents.data(), contents.size(), &mappings_);
+    if (result == internal::MapsParseResult::kSuccess) {
+      // Mappings are sorted by address, so the first mapping seen with each
+      // name is the lowest-addressed one.
+      for (size_t index = 0; index < mappings_.size(); ++index) {
+        if (!mappings_[index].name.empty()) {
+          name_index_.emplace(mappings_[index].name, index);
+        }
+      }
       INITIALIZATION_STATE_SET_VALID(initialized_);
       return true;
     }
-    if (result == ParseResult::kError) {
+    if (result == internal::MapsParseResult::kError) {
       return false;
     }
 
-    DCHECK(result == ParseResult::kRetry);
+    DCHECK(result == internal::MapsParseResult::kRetry);
   } while (--attempts > 0);
 
   LOG(ERROR) << "retry count exceeded";
   return false;
 }
 
+size_t MemoryMap::LowerBoundByEnd(LinuxVMAddress address) const {
+  // ParseMapsLine() guarantees that mappings are sorted and don’t overlap, so
+  // their end addresses are sorted too.
+  auto iterator = std::lower_bound(
+      mappings_.begin(),
+      mappings_.end(),
+      address,
+      [](const Mapping& mapping, LinuxVMAddress address) {
+        return mapping.range.End() < address;
+      });
+  return iterator - mappings_.begin();
+}
+
+const MemoryMap::Mapping* MemoryMap::FindEqualMapping(
+    const Mapping& target) const {
+  size_t index = LowerBoundByEnd(target.range.End());
+  if (index < mappings_.size() && mappings_[index].Equals(target)) {
+    return &mappings_[index];
+  }
+  return nullptr;
+}
+
 const MemoryMap::Mapping* MemoryMap::FindMapping(LinuxVMAddress address) const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   address = connection_->Memory()->PointerToAddress(address);
 
-  for (const auto& mapping : mappings_) {
-    if (mapping.range.Base() <= address && mapping.range.End() > address) {
-      return &mapping;
-    }
+  // The first mapping ending after address is the only one which may contain
+  // it.
+  size_t index = LowerBoundByEnd(address);
+  if (index < mappings_.size() && mappings_[index].range.End() == address) {
+    ++index;
+  }
+  if (index < mappings_.size() && mappings_[index].range.Base() <= address) {
+    return &mappings_[index];
   }
   return nullptr;
 }
@@ -319,12 +360,9 @@ const MemoryMap::Mapping* MemoryMap::FindMappingWithName(
     const std::string& name) const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
 
-  for (const auto& mapping : mappings_) {
-    if (mapping.name == name) {
-      return &mapping;
-    }
-  }
-  return nullptr;
+  auto iterator = name_index_.find(name);
+  return iterator != name_index_.end() ? &mappings_[iterator->second]
+                                       : nullptr;
 }
 
 std::vector<CheckedRange<VMAddress>> MemoryMap::GetReadableRanges(
@@ -336,12 +374,14 @@ std::vector<CheckedRange<VMAddress>> MemoryMap::GetReadableRanges(
   std::vector<FastRange> overlapping;
 
   // Find all readable ranges overlapping the target range, maintaining order.
-  for (const auto& mapping : mappings_) {
-    if (!mapping.readable)
-      continue;
-    if (mapping.range.End() < range_base)
-      continue;
+  // Mappings are sorted, so begin with the first mapping which doesn’t end
+  // before the target range and stop at the first which begins after it.
+  for (size_t index = LowerBoundByEnd(range_base); index < mappings_.size();
+       ++index) {
+    const Mapping& mapping = mappings_[index];
     if (mapping.range.Base() >= range_end)
+      break;
+    if (!mapping.readable)
       continue;
     // Special case: the "[vvar]" region is marked readable, but we can't
     // access it.
@@ -387,11 +427,10 @@ std::unique_ptr<MemoryMap::Iterator> MemoryMap::FindFilePossibleMmapStarts(
   // If the mapping is anonymous, as is for the VDSO, there is no mapped file to
   // find the start of, so just return the input mapping.
   if (mapping.device == 0 && mapping.inode == 0) {
-    for (const auto& candidate : mappings_) {
-      if (mapping.Equals(candidate)) {
-        possible_starts.push_back(&candidate);
-        return std::make_unique<SparseReverseIterator>(possible_starts);
-      }
+    const Mapping* candidate = FindEqualMapping(mapping);
+    if (candidate) {
+      possible_starts.push_back(candidate);
+      return std::make_unique<SparseReverseIterator>(possible_starts);
     }
 
     LOG(ERROR) << "mapping not found";
@@ -451,10 +490,12 @@ std::unique_ptr<MemoryMap::Iterator> MemoryMap::FindFilePossibleMmapStarts(
 
 std::unique_ptr<MemoryMap::Iterator> MemoryMap::ReverseIteratorFrom(
     const Mapping& target) const {
-  for (auto riter = mappings_.crbegin(); riter != mappings_.rend(); ++riter) {
-    if (riter->Equals(target)) {
-      return std::make_unique<FullReverseIterator>(riter, mappings_.rend());
-    }
+  const Mapping* mapping = FindEqualMapping(target);
+  if (mapping) {
+    // A reverse iterator refers to the element before its base iterator.
+    auto riter = std::make_reverse_iterator(mappings_.cbegin() +
+                                            (mapping - mappings_.data()) + 1);
+    return std::make_unique<FullReverseIterator>(riter, mappings_.crend());
   }
   return std::make_unique<FullReverseIterator>(mappings_.rend(),
                                                mappings_.rend());
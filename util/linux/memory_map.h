@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "util/linux/address_types.h"
@@ -34,6 +35,10 @@ namespace crashpad {
 //! target process is not stopped, mappings may be invalid after the return from
 //! Initialize(), and even mappings existing at the time Initialize() was called
 //! may not be found.
+//!
+//! Mappings are kept sorted by address, so lookups by address are logarithmic
+//! in the number of mappings. Lookups by name use an index built by
+//! Initialize().
 class MemoryMap {
  public:
   //! \brief Information about a mapped region of memory.
@@ -138,11 +143,57 @@ class MemoryMap {
   std::unique_ptr<Iterator> ReverseIteratorFrom(const Mapping& mapping) const;
 
  private:
+  // Returns the index of the first mapping whose end is greater than or equal
+  // to address, or mappings_.size() if there is no such mapping.
+  size_t LowerBoundByEnd(LinuxVMAddress address) const;
+
+  // Returns the mapping equal to target, or nullptr if there is none.
+  const Mapping* FindEqualMapping(const Mapping& target) const;
+
   std::vector<Mapping> mappings_;
+
+  // Maps the name of each named mapping to the index in mappings_ of the
+  // lowest-addressed mapping with that name.
+  std::unordered_map<std::string, size_t> name_index_;
+
   PtraceConnection* connection_;
   InitializationStateDcheck initialized_;
 };
 
+namespace internal {
+
+//! \brief The result of ParseMapsFile().
+enum class MapsParseResult {
+  //! \brief The entire file was parsed successfully.
+  kSuccess = 0,
+
+  //! \brief The file contained duplicate, overlapping, or out-of-order
+  //!     entries, likely because it was read non-atomically. It should be read
+  //!     again.
+  kRetry,
+
+  //! \brief The file was malformed. A message has been logged.
+  kError,
+};
+
+//! \brief Parses the contents of a `/proc/<pid>/maps` file.
+//!
+//! This is used by MemoryMap::Initialize(), and is exposed for testing. The
+//! contents are parsed in place, without copying them or splitting them into
+//! lines.
+//!
+//! \param[in] contents The contents of the file. This need not be
+//!     `NUL`-terminated.
+//! \param[in] size The size of \a contents.
+//! \param[out] mappings The mappings described by the file, in order. Any
+//!     previous contents are discarded.
+//! \return A result indicating whether the file was parsed successfully.
+MapsParseResult ParseMapsFile(const char* contents,
+                              size_t size,
+                              std::vector<MemoryMap::Mapping>* mappings);
+
+}  // namespace internal
+
 }  // namespace crashpad
 
 #endif  // CRASHPAD_UTIL_LINUX_MEMORY_MAP_H_
@@ -0,0 +1,51 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/check_op.h"
+#include "base/logging.h"
+#include "util/linux/memory_map.h"
+
+using namespace crashpad;
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) {
+  // Swallow all logs to avoid spam.
+  logging::SetLogMessageHandler(
+      [](logging::LogSeverity, const char*, int, size_t, const std::string&) {
+        return true;
+      });
+  return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  std::vector<MemoryMap::Mapping> mappings;
+  if (internal::ParseMapsFile(reinterpret_cast<const char*>(data),
+                              size,
+                              &mappings) !=
+      internal::MapsParseResult::kSuccess) {
+    return 0;
+  }
+
+  // Successfully parsed mappings must be sorted and non-overlapping, which
+  // MemoryMap relies on for its lookups.
+  for (size_t index = 1; index < mappings.size(); ++index) {
+    CHECK_LE(mappings[index - 1].range.End(), mappings[index].range.Base());
+  }
+  return 0;
+}
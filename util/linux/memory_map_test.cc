@@ -16,8 +16,10 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/sysmacros.h>
 #include <unistd.h>
 
 #include "base/files/file_path.h"
@@ -41,6 +43,83 @@ namespace crashpad {
 namespace test {
 namespace {
 
+TEST(MemoryMap, ParseMapsFile) {
+  static constexpr char kContents[] =
+      "00400000-00452000 r-xp 00000000 08:02 173521      /usr/bin/dbus-daemon\n"
+      "00651000-00652000 rw-p 00051000 08:02 173521      /usr/bin/dbus-daemon\n"
+      "00652000-00652000 rw-p 00000000 00:00 0 \n"
+      "00e03000-00e24000 rw-p 00000000 00:00 0           [heap]\n"
+      "35b1800000-35b1820000 r--s 00000000 fd:0a 123 \n";
+
+  std::vector<MemoryMap::Mapping> mappings;
+  ASSERT_EQ(internal::ParseMapsFile(kContents, strlen(kContents), &mappings),
+            internal::MapsParseResult::kSuccess);
+
+  // The zero-length mapping is skipped.
+  ASSERT_EQ(mappings.size(), 4u);
+
+  EXPECT_EQ(mappings[0].range.Base(), 0x400000u);
+  EXPECT_EQ(mappings[0].range.End(), 0x452000u);
+  EXPECT_TRUE(mappings[0].readable);
+  EXPECT_FALSE(mappings[0].writable);
+  EXPECT_TRUE(mappings[0].executable);
+  EXPECT_FALSE(mappings[0].shareable);
+  EXPECT_EQ(mappings[0].offset, 0);
+  EXPECT_EQ(mappings[0].device, makedev(8, 2));
+  EXPECT_EQ(mappings[0].inode, 173521u);
+  EXPECT_EQ(mappings[0].name, "/usr/bin/dbus-daemon");
+
+  EXPECT_EQ(mappings[1].offset, 0x51000);
+  EXPECT_TRUE(mappings[1].writable);
+  EXPECT_FALSE(mappings[1].executable);
+
+  EXPECT_EQ(mappings[2].name, "[heap]");
+  EXPECT_EQ(mappings[2].device, 0u);
+
+  EXPECT_EQ(mappings[3].range.Base(), 0x35b1800000u);
+  EXPECT_TRUE(mappings[3].shareable);
+  EXPECT_EQ(mappings[3].device, makedev(0xfd, 0x0a));
+  EXPECT_EQ(mappings[3].inode, 123u);
+  EXPECT_TRUE(mappings[3].name.empty());
+
+  // Only the given size is parsed.
+  const char* second_line = strchr(kContents, '\n') + 1;
+  ASSERT_EQ(internal::ParseMapsFile(
+                kContents, second_line - kContents, &mappings),
+            internal::MapsParseResult::kSuccess);
+  ASSERT_EQ(mappings.size(), 1u);
+  EXPECT_EQ(mappings[0].name, "/usr/bin/dbus-daemon");
+}
+
+TEST(MemoryMap, ParseMapsFileErrors) {
+  static constexpr const char* kMalformed[] = {
+      "00400000-00452000 r-xp 00000000 08:02 173521",
+      "00400000 r-xp 00000000 08:02 173521\n",
+      "00452000-00400000 r-xp 00000000 08:02 173521\n",
+      "00400000-00452000 r-xq 00000000 08:02 173521\n",
+      "00400000-00452000 r-x 00000000 08:02 173521\n",
+      "00400000-00452000 r-xp 0000000g 08:02 173521\n",
+      "00400000-00452000 r-xp 00000000 8:02 173521\n",
+      "00400000-00452000 r-xp 00000000 08:02 0x1\n",
+      "00400000-10000000000000000 r-xp 00000000 08:02 0\n",
+  };
+
+  std::vector<MemoryMap::Mapping> mappings;
+  for (const char* contents : kMalformed) {
+    SCOPED_TRACE(contents);
+    EXPECT_EQ(internal::ParseMapsFile(contents, strlen(contents), &mappings),
+              internal::MapsParseResult::kError);
+  }
+
+  // Overlapping entries indicate that the file should be read again.
+  static constexpr char kOverlapping[] =
+      "00400000-00452000 r-xp 00000000 08:02 1 \n"
+      "00451000-00453000 r-xp 00000000 08:02 1 \n";
+  EXPECT_EQ(
+      internal::ParseMapsFile(kOverlapping, strlen(kOverlapping), &mappings),
+      internal::MapsParseResult::kRetry);
+}
+
 TEST(MemoryMap, SelfLargeFiles) {
   // This test is meant to test the handler's ability to understand files
   // mapped from large offsets, even if the handler wasn't built with
@@ -323,6 +402,28 @@ TEST(MemoryMap, SelfLargeMapFile) {
 
   ExpectMappings(
       map, mappings.addr_as<LinuxVMAddress>(), kNumMappings, page_size);
+
+  // Adjacent readable mappings are coalesced and the ends are trimmed to the
+  // requested range.
+  const LinuxVMAddress region_start =
+      mappings.addr_as<LinuxVMAddress>() + page_size / 2;
+  const LinuxVMSize region_size = (kNumMappings - 1) * page_size;
+  auto ranges = map.GetReadableRanges(
+      CheckedRange<LinuxVMAddress, LinuxVMSize>(region_start, region_size));
+  ASSERT_EQ(ranges.size(), 1u);
+  EXPECT_EQ(ranges[0].base(), region_start);
+  EXPECT_EQ(ranges[0].size(), region_size);
+
+  const MemoryMap::Mapping* last_mapping = map.FindMapping(
+      mappings.addr_as<LinuxVMAddress>() + (kNumMappings - 1) * page_size);
+  ASSERT_TRUE(last_mapping);
+  auto iterator = map.ReverseIteratorFrom(*last_mapping);
+  for (size_t index = kNumMappings; index > 0; --index) {
+    const MemoryMap::Mapping* mapping = iterator->Next();
+    ASSERT_TRUE(mapping);
+    EXPECT_EQ(mapping->range.Base(),
+              mappings.addr_as<LinuxVMAddress>() + (index - 1) * page_size);
+  }
 }
 
 class MapRunningChildTest : public Multiprocess {
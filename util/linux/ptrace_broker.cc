@@ -33,6 +33,8 @@
 
 namespace crashpad {
 
+constexpr char PtraceBroker::kProtocolVersionPath[];
+
 namespace {
 
 size_t FormatPID(char* buffer, pid_t pid) {
@@ -55,6 +57,11 @@ size_t FormatPID(char* buffer, pid_t pid) {
   return length;
 }
 
+// The size of the buffer used to relay memory, including the int32_t header
+// preceding each chunk. Larger chunks require fewer system calls on both ends
+// of the connection, and are understood by clients of any version.
+constexpr size_t kMemoryBufferSize = 128 * 1024;
+
 }  // namespace
 
 class PtraceBroker::AttachmentsArray {
@@ -107,6 +114,7 @@ PtraceBroker::PtraceBroker(int sock, pid_t pid, bool is_64_bit)
     : ptracer_(is_64_bit, /* can_log= */ false),
       file_root_(file_root_buffer_),
       memory_file_(),
+      memory_buffer_(false),
       sock_(sock),
       memory_pid_(pid),
       tried_opening_mem_file_(false) {
@@ -251,6 +259,14 @@ int PtraceBroker::RunImpl(AttachmentsArray* attachments) {
 
       case Request::kTypeExit:
         return 0;
+
+      case Request::kTypeReadMemoryRanges: {
+        int result = SendMemoryRanges(request.tid, request.ranges.count);
+        if (result != 0) {
+          return result;
+        }
+        continue;
+      }
     }
 
     DCHECK(false);
@@ -333,17 +349,35 @@ int PtraceBroker::SendMemory(pid_t pid, VMAddress address, VMSize size) {
                : this->ptracer_.ReadUpTo(pid, address, size, buffer);
   };
 
-  char buffer[4096];
+  if (!memory_buffer_.is_valid()) {
+    memory_buffer_.ResetMmap(nullptr,
+                             kMemoryBufferSize,
+                             PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS,
+                             -1,
+                             0);
+  }
+
+  // Each chunk is read into the buffer following space for its header so that
+  // the header and data can be sent with a single write.
+  char stack_buffer[4096];
+  char* buffer = memory_buffer_.is_valid() ? memory_buffer_.addr_as<char*>()
+                                           : stack_buffer;
+  const size_t buffer_size =
+      memory_buffer_.is_valid() ? memory_buffer_.len() : sizeof(stack_buffer);
+  char* const data = buffer + sizeof(int32_t);
+
   while (size > 0) {
-    size_t to_read = std::min(size, VMSize{sizeof(buffer)});
+    size_t to_read = std::min(size, VMSize{buffer_size - sizeof(int32_t)});
 
-    int32_t bytes_read = read_memory(address, to_read, buffer);
+    int32_t bytes_read = read_memory(address, to_read, data);
 
     if (bytes_read < 0) {
       return SendReadError(static_cast<ReadError>(errno));
     }
 
-    if (!WriteFile(sock_, &bytes_read, sizeof(bytes_read))) {
+    memcpy(buffer, &bytes_read, sizeof(bytes_read));
+    if (!WriteFile(sock_, buffer, sizeof(bytes_read) + bytes_read)) {
       return errno;
     }
 
@@ -351,16 +385,49 @@ int PtraceBroker::SendMemory(pid_t pid, VMAddress address, VMSize size) {
       return 0;
     }
 
-    if (!WriteFile(sock_, buffer, bytes_read)) {
-      return errno;
-    }
-
     size -= bytes_read;
     address += bytes_read;
   }
   return 0;
 }
 
+int PtraceBroker::SendMemoryRanges(pid_t pid, VMSize count) {
+  if (count > kMaxMemoryRanges) {
+    return EINVAL;
+  }
+
+  // Receive the entire request before responding so that a client which sends
+  // all of its ranges before reading any responses can’t deadlock with the
+  // broker.
+  MemoryRange ranges[kMaxMemoryRanges];
+  if (!ReadFileExactly(sock_, ranges, sizeof(ranges[0]) * count)) {
+    return errno;
+  }
+
+  for (size_t index = 0; index < count; ++index) {
+    int result = SendMemory(pid, ranges[index].base, ranges[index].size);
+    if (result != 0) {
+      return result;
+    }
+  }
+  return 0;
+}
+
+int PtraceBroker::SendProtocolVersion() {
+  int result = SendOpenResult(kOpenResultSuccess);
+  if (result != 0) {
+    return result;
+  }
+
+  // The version is sent in the same format as the contents of a file.
+  struct {
+    int32_t size;
+    uint32_t version;
+    int32_t eof;
+  } response = {sizeof(uint32_t), kProtocolVersion, 0};
+  return WriteFile(sock_, &response, sizeof(response)) ? 0 : errno;
+}
+
 #if defined(MEMORY_SANITIZER)
 // MSan doesn't intercept syscall() and doesn't see that buffer is initialized.
 __attribute__((no_sanitize("memory")))
@@ -403,6 +470,10 @@ int PtraceBroker::ReceiveAndOpenFilePath(VMSize path_length,
   }
   path[path_length] = '\0';
 
+  if (!is_directory && strcmp(path, kProtocolVersionPath) == 0) {
+    return SendProtocolVersion();
+  }
+
   if (strncmp(path, file_root_, strlen(file_root_)) != 0) {
     return SendOpenResult(kOpenResultAccessDenied);
   }
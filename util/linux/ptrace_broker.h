@@ -25,6 +25,7 @@
 #include "util/linux/ptracer.h"
 #include "util/linux/thread_info.h"
 #include "util/misc/address_types.h"
+#include "util/posix/scoped_mmap.h"
 
 namespace crashpad {
 
@@ -85,11 +86,20 @@ class PtraceBroker {
 
       //! \brief Causes the broker to return from Run(), detaching all attached
       //!     threads. Does not respond.
-      kTypeExit
+      kTypeExit,
+
+      //! \brief Reads several regions of memory from the attached process.
+      //!     The request is followed by ranges.count MemoryRange structures,
+      //!     at most kMaxMemoryRanges. The response for each range is sent in
+      //!     order, in the same format as the response to kTypeReadMemory.
+      //!
+      //! Only brokers reporting a kProtocolVersion of at least 2 serve this
+      //! request. Older brokers will exit on receiving it.
+      kTypeReadMemoryRanges,
     } type;
 
     //! \brief The thread ID associated with this request. Valid for kTypeAttach,
-    //!     kTypeGetThreadInfo, and kTypeReadMemory.
+    //!     kTypeGetThreadInfo, kTypeReadMemory, and kTypeReadMemoryRanges.
     pid_t tid;
 
     union {
@@ -112,9 +122,26 @@ class PtraceBroker {
         //! \brief The file path to read.
         char path[];
       } path;
+
+      //! \brief Specifies the number of memory regions to read for a
+      //!     kTypeReadMemoryRanges request.
+      struct {
+        //! \brief The number of MemoryRange structures following the request.
+        VMSize count;
+      } ranges;
     };
   };
 
+  //! \brief A memory region sent following a Request with type
+  //!     kTypeReadMemoryRanges.
+  struct MemoryRange {
+    //! \brief The base address of the memory region.
+    VMAddress base;
+
+    //! \brief The size of the memory region.
+    VMSize size;
+  };
+
   //! \brief A result used in operations that accept paths.
   //!
   //! Positive values of this enum are reserved for sending errno values.
@@ -148,6 +175,27 @@ class PtraceBroker {
   };
 #pragma pack(pop)
 
+  //! \brief The version of the protocol served by this broker.
+  //!
+  //! Request::kVersion describes the format of a Request, which is unchanged
+  //! since version 1. This value describes which request types the broker is
+  //! able to serve. Version 1 brokers don’t report a version.
+  //!
+  //! Version 2 added kTypeReadMemoryRanges.
+  static constexpr uint32_t kProtocolVersion = 2;
+
+  //! \brief A path which, when requested with kTypeReadFile, causes the broker
+  //!     to respond with its kProtocolVersion as the contents of the file.
+  //!
+  //! Brokers which predate protocol negotiation respond to this request with a
+  //! failing OpenResult, which identifies them as version 1 brokers.
+  static constexpr char kProtocolVersionPath[] =
+      "/proc/self/crashpad_ptrace_broker_protocol_version";
+
+  //! \brief The maximum number of MemoryRange structures which may follow a
+  //!     Request with type kTypeReadMemoryRanges.
+  static constexpr size_t kMaxMemoryRanges = 64;
+
   //! \brief Constructs this object.
   //!
   //! \param[in] sock A socket on which to read requests from a connected
@@ -201,6 +249,8 @@ class PtraceBroker {
   int SendDirectory(FileHandle handle);
   void TryOpeningMemFile();
   int SendMemory(pid_t pid, VMAddress address, VMSize size);
+  int SendMemoryRanges(pid_t pid, VMSize count);
+  int SendProtocolVersion();
   int ReceiveAndOpenFilePath(VMSize path_length,
                              bool is_directory,
                              ScopedFileHandle* handle);
@@ -209,6 +259,7 @@ class PtraceBroker {
   Ptracer ptracer_;
   const char* file_root_;
   ScopedFileHandle memory_file_;
+  ScopedMmap memory_buffer_;
   int sock_;
   pid_t memory_pid_;
   bool tried_opening_mem_file_;
@@ -14,12 +14,14 @@
 
 #include "util/linux/ptrace_broker.h"
 
+#include <string.h>
 #include <sys/socket.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <utility>
+#include <vector>
 
 #include "build/build_config.h"
 #include "gtest/gtest.h"
@@ -205,6 +207,34 @@ class SameBitnessTest : public Multiprocess {
                               &unmapped),
               -1);
 
+    EXPECT_EQ(client.BrokerProtocolVersion(), PtraceBroker::kProtocolVersion);
+
+    // The second region runs off the end of the mapping and the third begins
+    // after it.
+    std::vector<char> batch_buffer(mapping_.len() * 2);
+    std::vector<ProcessMemory::BatchRead> reads(3);
+    reads[0] = {mapping_.addr_as<VMAddress>(),
+                mapping_.len(),
+                &batch_buffer[0],
+                0};
+    reads[1] = {mapping_.addr_as<VMAddress>() + mapping_.len() / 2,
+                mapping_.len(),
+                &batch_buffer[mapping_.len()],
+                0};
+    reads[2] = {mapping_.addr_as<VMAddress>() + mapping_.len(),
+                sizeof(unmapped),
+                &unmapped,
+                0};
+    client.ReadMemoryBatch(&reads);
+    EXPECT_EQ(reads[0].bytes_read, mapping_.len());
+    EXPECT_EQ(memcmp(&batch_buffer[0], expected_buffer, mapping_.len()), 0);
+    EXPECT_EQ(reads[1].bytes_read, mapping_.len() / 2);
+    EXPECT_EQ(memcmp(&batch_buffer[mapping_.len()],
+                     expected_buffer + mapping_.len() / 2,
+                     mapping_.len() / 2),
+              0);
+    EXPECT_EQ(reads[2].bytes_read, 0u);
+
     std::string file_root = file_dir.value() + '/';
     broker.SetFileRoot(file_root.c_str());
 
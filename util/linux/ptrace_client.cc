@@ -133,6 +133,7 @@ PtraceClient::PtraceClient()
       memory_(),
       sock_(kInvalidFileHandle),
       pid_(-1),
+      broker_version_(1),
       is_64_bit_(false),
       initialized_() {}
 
@@ -167,10 +168,19 @@ bool PtraceClient::Initialize(int sock, pid_t pid) {
   }
   is_64_bit_ = is_64_bit == ExceptionHandlerProtocol::kBoolTrue;
 
+  if (!ReceiveProtocolVersion()) {
+    return false;
+  }
+
   INITIALIZATION_STATE_SET_VALID(initialized_);
   return true;
 }
 
+uint32_t PtraceClient::BrokerProtocolVersion() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return broker_version_;
+}
+
 pid_t PtraceClient::GetProcessID() {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return pid_;
@@ -304,7 +314,6 @@ bool PtraceClient::Threads(std::vector<pid_t>* threads) {
 
 ssize_t PtraceClient::ReadUpTo(VMAddress address, size_t size, void* buffer) {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-  char* buffer_c = reinterpret_cast<char*>(buffer);
 
   PtraceBroker::Request request = {};
   request.type = PtraceBroker::Request::kTypeReadMemory;
@@ -316,37 +325,159 @@ ssize_t PtraceClient::ReadUpTo(VMAddress address, size_t size, void* buffer) {
     return false;
   }
 
-  ssize_t total_read = 0;
+  size_t bytes_read;
+  bool read_error;
+  if (!ReceiveMemory(
+          size, static_cast<char*>(buffer), &bytes_read, &read_error) ||
+      read_error) {
+    return -1;
+  }
+  return bytes_read;
+}
+
+void PtraceClient::ReadMemoryBatch(
+    std::vector<ProcessMemory::BatchRead>* reads) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (broker_version_ < 2) {
+    PtraceConnection::ReadMemoryBatch(reads);
+    return;
+  }
+
+  for (ProcessMemory::BatchRead& read : *reads) {
+    read.bytes_read = 0;
+  }
+
+  size_t begin = 0;
+  while (begin < reads->size()) {
+    PtraceBroker::MemoryRange ranges[PtraceBroker::kMaxMemoryRanges];
+    size_t count = 0;
+    size_t end;
+    for (end = begin;
+         end < reads->size() && count < PtraceBroker::kMaxMemoryRanges;
+         ++end) {
+      const ProcessMemory::BatchRead& read = (*reads)[end];
+      if (read.size == 0) {
+        continue;
+      }
+      ranges[count].base = read.address;
+      ranges[count].size = read.size;
+      ++count;
+    }
+
+    if (count > 0) {
+      PtraceBroker::Request request = {};
+      request.type = PtraceBroker::Request::kTypeReadMemoryRanges;
+      request.tid = pid_;
+      request.ranges.count = count;
+
+      if (!LoggingWriteFile(sock_, &request, sizeof(request)) ||
+          !LoggingWriteFile(sock_, ranges, sizeof(ranges[0]) * count)) {
+        return;
+      }
+
+      for (size_t index = begin; index < end; ++index) {
+        ProcessMemory::BatchRead& read = (*reads)[index];
+        if (read.size == 0) {
+          continue;
+        }
+
+        bool read_error;
+        if (!ReceiveMemory(read.size,
+                           static_cast<char*>(read.buffer),
+                           &read.bytes_read,
+                           &read_error)) {
+          return;
+        }
+      }
+    }
+
+    begin = end;
+  }
+}
+
+bool PtraceClient::ReceiveMemory(size_t size,
+                                 char* buffer,
+                                 size_t* bytes_read,
+                                 bool* read_error) {
+  *bytes_read = 0;
+  *read_error = false;
   while (size > 0) {
-    int32_t bytes_read;
-    if (!LoggingReadFileExactly(sock_, &bytes_read, sizeof(bytes_read))) {
-      return -1;
+    int32_t chunk_size;
+    if (!LoggingReadFileExactly(sock_, &chunk_size, sizeof(chunk_size))) {
+      return false;
     }
 
-    if (bytes_read < 0) {
-      ReceiveAndLogReadError(sock_, "PtraceBroker ReadMemory");
-      return -1;
+    if (chunk_size < 0) {
+      *read_error = true;
+      return ReceiveAndLogReadError(sock_, "PtraceBroker ReadMemory");
     }
 
-    if (bytes_read == 0) {
-      return total_read;
+    if (chunk_size == 0) {
+      return true;
     }
 
-    if (static_cast<size_t>(bytes_read) > size) {
-      LOG(ERROR) << "invalid size " << bytes_read;
-      return -1;
+    if (static_cast<size_t>(chunk_size) > size) {
+      LOG(ERROR) << "invalid size " << chunk_size;
+      return false;
     }
 
-    if (!LoggingReadFileExactly(sock_, buffer_c, bytes_read)) {
-      return -1;
+    if (!LoggingReadFileExactly(sock_, buffer, chunk_size)) {
+      return false;
     }
 
-    size -= bytes_read;
-    buffer_c += bytes_read;
-    total_read += bytes_read;
+    size -= chunk_size;
+    buffer += chunk_size;
+    *bytes_read += chunk_size;
   }
 
-  return total_read;
+  return true;
+}
+
+bool PtraceClient::ReceiveProtocolVersion() {
+  PtraceBroker::Request request = {};
+  request.type = PtraceBroker::Request::kTypeReadFile;
+  request.path.path_length = strlen(PtraceBroker::kProtocolVersionPath);
+
+  if (!LoggingWriteFile(sock_, &request, sizeof(request)) ||
+      !LoggingWriteFile(sock_,
+                        PtraceBroker::kProtocolVersionPath,
+                        request.path.path_length)) {
+    return false;
+  }
+
+  PtraceBroker::OpenResult result;
+  if (!LoggingReadFileExactly(sock_, &result, sizeof(result))) {
+    return false;
+  }
+
+  // Brokers which predate protocol negotiation refuse to open the path.
+  if (result != PtraceBroker::kOpenResultSuccess) {
+    broker_version_ = 1;
+    return true;
+  }
+
+  int32_t size;
+  uint32_t version;
+  int32_t eof;
+  if (!LoggingReadFileExactly(sock_, &size, sizeof(size))) {
+    return false;
+  }
+  if (size != sizeof(version)) {
+    LOG(ERROR) << "invalid size " << size;
+    return false;
+  }
+  if (!LoggingReadFileExactly(sock_, &version, sizeof(version)) ||
+      !LoggingReadFileExactly(sock_, &eof, sizeof(eof))) {
+    return false;
+  }
+  if (eof != 0) {
+    LOG(ERROR) << "invalid size " << eof;
+    return false;
+  }
+
+  broker_version_ = version;
+  return true;
 }
 
 bool PtraceClient::SendFilePath(const char* path, size_t length) {
@@ -15,9 +15,11 @@
 #ifndef CRASHPAD_UTIL_LINUX_PTRACE_CLIENT_H_
 #define CRASHPAD_UTIL_LINUX_PTRACE_CLIENT_H_
 
+#include <stdint.h>
 #include <sys/types.h>
 
 #include <memory>
+#include <vector>
 
 #include "util/linux/ptrace_connection.h"
 #include "util/misc/address_types.h"
@@ -52,6 +54,10 @@ class PtraceClient : public PtraceConnection {
   //! \return `true` on success. `false` on failure with a message logged.
   bool Initialize(int sock, pid_t pid);
 
+  //! \brief Returns the PtraceBroker::kProtocolVersion of the connected
+  //!     broker, negotiated during Initialize().
+  uint32_t BrokerProtocolVersion() const;
+
   // PtraceConnection:
 
   pid_t GetProcessID() override;
@@ -63,13 +69,26 @@ class PtraceClient : public PtraceConnection {
   ProcessMemoryLinux* Memory() override;
   bool Threads(std::vector<pid_t>* threads) override;
   ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) override;
+  void ReadMemoryBatch(std::vector<ProcessMemory::BatchRead>* reads) override;
 
  private:
   bool SendFilePath(const char* path, size_t length);
+  bool ReceiveProtocolVersion();
+
+  // Receives the response to a request to read size bytes of memory into
+  // buffer. bytes_read is set to the number of bytes received and read_error is
+  // set if the broker reported an error after sending them. Returns `false` if
+  // the connection failed or the response was malformed, in which case no
+  // further responses can be received.
+  bool ReceiveMemory(size_t size,
+                     char* buffer,
+                     size_t* bytes_read,
+                     bool* read_error);
 
   std::unique_ptr<ProcessMemoryLinux> memory_;
   int sock_;
   pid_t pid_;
+  uint32_t broker_version_;
   bool is_64_bit_;
   InitializationStateDcheck initialized_;
 };
@@ -41,6 +41,24 @@ class PtraceConnection {
   //! \return `true` on success. `false` on failure with a message logged.
   virtual bool Attach(pid_t tid) = 0;
 
+  //! \brief Adds several new threads to this connection.
+  //!
+  //! The default implementation calls Attach() for each thread in turn.
+  //! Connections able to attach to several threads concurrently should override
+  //! this method.
+  //!
+  //! \param[in] tids The thread IDs of the threads to attach.
+  //! \param[out] attached The thread IDs of the threads successfully attached,
+  //!     in the order they appear in \a tids.
+  virtual void AttachThreads(const std::vector<pid_t>& tids,
+                             std::vector<pid_t>* attached) {
+    for (pid_t tid : tids) {
+      if (Attach(tid)) {
+        attached->push_back(tid);
+      }
+    }
+  }
+
   //! \brief Returns `true` if connected to a 64-bit process.
   virtual bool Is64Bit() = 0;
 
@@ -87,6 +105,32 @@ class PtraceConnection {
   //! \return the number of bytes copied, 0 if there is no more data to read, or
   //!     -1 on failure with a message logged.
   virtual ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) = 0;
+
+  //! \brief Copies several regions of memory from the connected process into
+  //!     caller-provided buffers in the current process.
+  //!
+  //! The default implementation calls ReadUpTo() for each region in turn.
+  //! Connections able to service several regions with a single request should
+  //! override this method.
+  //!
+  //! \param[in,out] reads The regions to read. On return, the `bytes_read`
+  //!     field of each region is set to the number of bytes successfully read
+  //!     into its buffer. Regions are not required to have been zeroed.
+  virtual void ReadMemoryBatch(std::vector<ProcessMemory::BatchRead>* reads) {
+    for (ProcessMemory::BatchRead& read : *reads) {
+      read.bytes_read = 0;
+      char* buffer = static_cast<char*>(read.buffer);
+      while (read.bytes_read < read.size) {
+        ssize_t bytes_read = ReadUpTo(read.address + read.bytes_read,
+                                      read.size - read.bytes_read,
+                                      buffer + read.bytes_read);
+        if (bytes_read <= 0) {
+          break;
+        }
+        read.bytes_read += bytes_read;
+      }
+    }
+  }
 };
 
 }  // namespace crashpad
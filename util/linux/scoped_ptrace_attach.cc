@@ -17,6 +17,7 @@
 #include <sys/ptrace.h>
 #include <sys/wait.h>
 
+#include "base/check.h"
 #include "base/logging.h"
 #include "base/posix/eintr_wrapper.h"
 
@@ -40,6 +41,38 @@ bool PtraceAttach(pid_t pid, bool can_log) {
   return true;
 }
 
+void PtraceAttachMultiple(const std::vector<pid_t>& tids,
+                          std::vector<pid_t>* attached,
+                          bool can_log) {
+  DCHECK(attached->empty());
+
+  std::vector<pid_t> pending;
+  pending.reserve(tids.size());
+  for (pid_t tid : tids) {
+    if (ptrace(PTRACE_ATTACH, tid, nullptr, nullptr) != 0) {
+      PLOG_IF(ERROR, can_log) << "ptrace";
+      continue;
+    }
+    pending.push_back(tid);
+  }
+
+  attached->reserve(pending.size());
+  for (pid_t tid : pending) {
+    int status;
+    if (HANDLE_EINTR(waitpid(tid, &status, __WALL)) < 0) {
+      PLOG_IF(ERROR, can_log) << "waitpid";
+      PtraceDetach(tid, false);
+      continue;
+    }
+    if (!WIFSTOPPED(status)) {
+      LOG_IF(ERROR, can_log) << "process not stopped";
+      PtraceDetach(tid, false);
+      continue;
+    }
+    attached->push_back(tid);
+  }
+}
+
 bool PtraceDetach(pid_t pid, bool can_log) {
   if (pid >= 0 && ptrace(PTRACE_DETACH, pid, nullptr, nullptr) != 0) {
     PLOG_IF(ERROR, can_log) << "ptrace";
@@ -63,6 +96,11 @@ bool ScopedPtraceAttach::Reset() {
   return true;
 }
 
+void ScopedPtraceAttach::ResetAttached(pid_t pid) {
+  Reset();
+  pid_ = pid;
+}
+
 bool ScopedPtraceAttach::ResetAttach(pid_t pid) {
   Reset();
 
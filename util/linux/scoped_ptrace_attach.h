@@ -17,6 +17,8 @@
 
 #include <sys/types.h>
 
+#include <vector>
+
 namespace crashpad {
 
 //! \brief Attaches to the process with process ID \a pid and blocks until the
@@ -28,6 +30,21 @@ namespace crashpad {
 //!     can_log is `true`.
 bool PtraceAttach(pid_t pid, bool can_log = true);
 
+//! \brief Attaches to several threads and blocks until each of them has
+//!     stopped.
+//!
+//! A thread may take some time to stop after being attached. All of the
+//! threads are attached before waiting for any of them to stop, so that the
+//! threads stop concurrently instead of one after another.
+//!
+//! \param[in] tids The thread IDs of the threads to attach to.
+//! \param[out] attached The thread IDs of the threads which were attached and
+//!     stopped, in the order they appear in \a tids.
+//! \param can_log Whether this function may log messages on failure.
+void PtraceAttachMultiple(const std::vector<pid_t>& tids,
+                          std::vector<pid_t>* attached,
+                          bool can_log = true);
+
 //! \brief Detaches the process  with process ID \a pid. The process must
 //!     already be ptrace attached.
 //!
@@ -61,6 +78,11 @@ class ScopedPtraceAttach {
   //! \return `true` on success. `false` on failure, with a message logged.
   bool ResetAttach(pid_t pid);
 
+  //! \brief Detaches from any previously attached process and takes ownership
+  //!     of an existing attachment to the process with process ID \a pid, as
+  //!     made by PtraceAttach() or PtraceAttachMultiple().
+  void ResetAttached(pid_t pid);
+
  private:
   pid_t pid_;
 };
@@ -18,6 +18,8 @@
 #include <sys/ptrace.h>
 #include <unistd.h>
 
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "test/errors.h"
 #include "test/multiprocess.h"
@@ -181,6 +183,55 @@ TEST(ScopedPtraceAttach, AttachParentDestructor) {
   test.Run();
 }
 
+class AttachMultipleTest : public AttachTest {
+ public:
+  AttachMultipleTest() : AttachTest() {}
+
+  AttachMultipleTest(const AttachMultipleTest&) = delete;
+  AttachMultipleTest& operator=(const AttachMultipleTest&) = delete;
+
+  ~AttachMultipleTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    // Wait for the child to set the parent as its ptracer.
+    char c;
+    CheckedReadFileExactly(ReadPipeHandle(), &c, sizeof(c));
+
+    pid_t pid = ChildPID();
+
+    // The second thread ID can’t be attached.
+    std::vector<pid_t> attached;
+    PtraceAttachMultiple({pid, -1}, &attached, /* can_log= */ false);
+    ASSERT_EQ(attached.size(), 1u);
+    EXPECT_EQ(attached[0], pid);
+
+    {
+      ScopedPtraceAttach attachment;
+      attachment.ResetAttached(pid);
+      EXPECT_EQ(ptrace(PTRACE_PEEKDATA, pid, &kWord, nullptr), kWord)
+          << ErrnoMessage("ptrace");
+    }
+
+    ASSERT_EQ(ptrace(PTRACE_PEEKDATA, pid, &kWord, nullptr), -1);
+    EXPECT_EQ(errno, ESRCH) << ErrnoMessage("ptrace");
+  }
+
+  void MultiprocessChild() override {
+    ScopedPrSetPtracer set_ptracer(getppid(), /* may_log= */ true);
+
+    char c = '\0';
+    CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
+
+    CheckedReadFileAtEOF(ReadPipeHandle());
+  }
+};
+
+TEST(ScopedPtraceAttach, AttachMultiple) {
+  AttachMultipleTest test;
+  test.Run();
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
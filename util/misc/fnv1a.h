@@ -0,0 +1,44 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MISC_FNV1A_H_
+#define CRASHPAD_UTIL_MISC_FNV1A_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace crashpad {
+
+//! \brief The initial value of a 32-bit FNV-1a hash.
+constexpr uint32_t kFNV1aOffsetBasis = 2166136261u;
+
+//! \brief Computes the 32-bit FNV-1a hash of some data.
+//!
+//! This is a fast non-cryptographic hash. It is suitable for detecting
+//! accidental corruption and for spreading bits, but not for anything that must
+//! resist deliberate collisions.
+//!
+//! \param[in] data The data to hash.
+//! \param[in] size The size of \a data, in bytes.
+//! \param[in] hash The value to continue hashing from. To hash data stored in
+//!     several pieces, pass the result of hashing the preceding pieces.
+//!
+//! \return The hash of \a data.
+uint32_t FNV1a(const void* data,
+               size_t size,
+               uint32_t hash = kFNV1aOffsetBasis);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MISC_FNV1A_H_
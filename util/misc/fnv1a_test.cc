@@ -0,0 +1,44 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/fnv1a.h"
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(FNV1a, KnownValues) {
+  // Reference values from the FNV test suite.
+  EXPECT_EQ(FNV1a(nullptr, 0), 0x811c9dc5u);
+  EXPECT_EQ(FNV1a("a", 1), 0xe40c292cu);
+  EXPECT_EQ(FNV1a("foobar", 6), 0xbf9cf968u);
+}
+
+TEST(FNV1a, Continued) {
+  static constexpr char kData[] = "crashpad";
+  const size_t size = strlen(kData);
+  for (size_t split = 0; split <= size; ++split) {
+    SCOPED_TRACE(split);
+    EXPECT_EQ(FNV1a(kData + split, size - split, FNV1a(kData, split)),
+              FNV1a(kData, size));
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
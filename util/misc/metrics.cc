@@ -109,6 +109,36 @@ void Metrics::ExceptionEncountered() {
   ExceptionProcessing(ExceptionProcessingState::kStarted);
 }
 
+// static
+void Metrics::CrashDumpRequestQueueDepth(size_t depth) {
+  UMA_HISTOGRAM_CUSTOM_COUNTS("Crashpad.CrashDumpRequest.QueueDepth",
+                              base::saturated_cast<int32_t>(depth),
+                              1,
+                              100,
+                              50);
+}
+
+// static
+void Metrics::CrashDumpRequestLatency(uint64_t nanoseconds) {
+  // Recorded in milliseconds, up to ten minutes.
+  UMA_HISTOGRAM_CUSTOM_COUNTS(
+      "Crashpad.CrashDumpRequest.Latency",
+      base::saturated_cast<int32_t>(nanoseconds / 1000000),
+      1,
+      10 * 60 * 1000,
+      50);
+}
+
+// static
+void Metrics::ModuleParseTime(uint64_t nanoseconds) {
+  // Recorded in microseconds, up to one second.
+  UMA_HISTOGRAM_CUSTOM_COUNTS("Crashpad.ModuleParseTime",
+                              base::saturated_cast<int32_t>(nanoseconds / 1000),
+                              1,
+                              1000 * 1000,
+                              50);
+}
+
 // static
 void Metrics::HandlerLifetimeMilestone(LifetimeMilestone milestone) {
   UMA_HISTOGRAM_ENUMERATION("Crashpad.HandlerLifetimeMilestone",
@@ -16,6 +16,7 @@
 #define CRASHPAD_UTIL_MISC_METRICS_H_
 
 #include <inttypes.h>
+#include <stddef.h>
 
 #include "build/build_config.h"
 #include "util/file/file_io.h"
@@ -177,6 +178,19 @@ class Metrics {
   //! \brief The exception handler server started capturing an exception.
   static void ExceptionEncountered();
 
+  //! \brief Reports the number of crash dump requests waiting to be handled
+  //!     by the exception handler server, including a request that was just
+  //!     received.
+  static void CrashDumpRequestQueueDepth(size_t depth);
+
+  //! \brief Reports the time taken by the exception handler server to handle
+  //!     a crash dump request, from its receipt until the client was resumed.
+  static void CrashDumpRequestLatency(uint64_t nanoseconds);
+
+  //! \brief Reports the time taken to locate and parse a module while
+  //!     capturing a snapshot of a process.
+  static void ModuleParseTime(uint64_t nanoseconds);
+
   //! \brief An important event in a handler process’ lifetime.
   //!
   //! \note These are used as metrics enumeration values, so new values should
@@ -29,27 +29,51 @@ void RangeSet::Insert(VMAddress base, VMSize size) {
 
   VMAddress last = base + size - 1;
 
-  auto overlapping_range = ranges_.lower_bound(base);
-#define OVERLAPPING_RANGES_BASE overlapping_range->second
-#define OVERLAPPING_RANGES_LAST overlapping_range->first
-  while (overlapping_range != ranges_.end() &&
-         OVERLAPPING_RANGES_BASE <= last) {
-    base = std::min(base, OVERLAPPING_RANGES_BASE);
-    last = std::max(last, OVERLAPPING_RANGES_LAST);
-    auto tmp = overlapping_range;
-    ++overlapping_range;
-    ranges_.erase(tmp);
+  // Merge every range that overlaps the new one into it.
+  auto first_overlapping = std::lower_bound(
+      ranges_.begin(),
+      ranges_.end(),
+      base,
+      [](const Range& range, VMAddress a) { return range.last < a; });
+  auto end_overlapping = first_overlapping;
+  while (end_overlapping != ranges_.end() && end_overlapping->base <= last) {
+    base = std::min(base, end_overlapping->base);
+    last = std::max(last, end_overlapping->last);
+    ++end_overlapping;
   }
-#undef OVERLAPPING_RANGES_BASE
-#undef OVERLAPPING_RANGES_LAST
 
-  ranges_[last] = base;
+  auto inserted = ranges_.erase(first_overlapping, end_overlapping);
+  ranges_.insert(inserted, {base, last});
 }
 
 bool RangeSet::Contains(VMAddress address) const {
-  auto range_above_address = ranges_.lower_bound(address);
-  return range_above_address != ranges_.end() &&
-         range_above_address->second <= address;
+  VMAddress base;
+  VMAddress last;
+  return FindRange(address, &base, &last);
+}
+
+bool RangeSet::FindRange(VMAddress address,
+                         VMAddress* base,
+                         VMAddress* last) const {
+  // Most addresses that aren’t in any range are outside all of them.
+  if (ranges_.empty() || address < ranges_.front().base ||
+      address > ranges_.back().last) {
+    return false;
+  }
+
+  auto range_above_address = std::lower_bound(
+      ranges_.begin(),
+      ranges_.end(),
+      address,
+      [](const Range& range, VMAddress a) { return range.last < a; });
+  if (range_above_address == ranges_.end() ||
+      range_above_address->base > address) {
+    return false;
+  }
+
+  *base = range_above_address->base;
+  *last = range_above_address->last;
+  return true;
 }
 
 }  // namespace crashpad
@@ -15,7 +15,7 @@
 #ifndef CRASHPAD_UTIL_MISC_RANGE_SET_H_
 #define CRASHPAD_UTIL_MISC_RANGE_SET_H_
 
-#include <map>
+#include <vector>
 
 #include "util/misc/address_types.h"
 
@@ -40,11 +40,28 @@ class RangeSet {
   //! \brief Returns `true` if \a address falls within a range in this set.
   bool Contains(VMAddress address) const;
 
+  //! \brief Finds the range in this set that contains \a address.
+  //!
+  //! Callers checking many addresses that tend to fall within the same range
+  //! can check the range returned here before calling this method again.
+  //!
+  //! \param[in] address The address to look up.
+  //! \param[out] base The low address of the range containing \a address.
+  //! \param[out] last The highest address in the range containing \a address.
+  //! \return `true` if \a address falls within a range in this set, with \a
+  //!     base and \a last set. Otherwise, `false`.
+  bool FindRange(VMAddress address, VMAddress* base, VMAddress* last) const;
+
  private:
-  // Keys are the highest address in the range. Values are the base address of
-  // the range. Overlapping ranges are merged on insertion. Adjacent ranges may
-  // be merged.
-  std::map<VMAddress, VMAddress> ranges_;
+  struct Range {
+    VMAddress base;
+    VMAddress last;
+  };
+
+  // Sorted by address, so that lookups are binary searches over contiguous
+  // memory. Overlapping ranges are merged on insertion. Adjacent ranges may be
+  // merged.
+  std::vector<Range> ranges_;
 };
 
 }  // namespace crashpad
@@ -17,6 +17,9 @@
 #include <sys/types.h>
 
 #include <memory>
+#include <random>
+#include <utility>
+#include <vector>
 
 #include "base/format_macros.h"
 #include "base/strings/stringprintf.h"
@@ -111,6 +114,74 @@ TEST(RangeSet, LargeOverlappingRanges) {
   EXPECT_TRUE(ranges.Contains(addr + kBufferSize - 1));
 }
 
+TEST(RangeSet, FindRange) {
+  RangeSet ranges;
+  VMAddress base;
+  VMAddress last;
+  EXPECT_FALSE(ranges.FindRange(0x1000, &base, &last));
+
+  ranges.Insert(0x1000, 0x100);
+  ranges.Insert(0x3000, 0x100);
+  ranges.Insert(0x1080, 0x100);
+
+  ASSERT_TRUE(ranges.FindRange(0x1000, &base, &last));
+  EXPECT_EQ(base, 0x1000u);
+  EXPECT_EQ(last, 0x117fu);
+  ASSERT_TRUE(ranges.FindRange(0x117f, &base, &last));
+  EXPECT_EQ(base, 0x1000u);
+  EXPECT_EQ(last, 0x117fu);
+  ASSERT_TRUE(ranges.FindRange(0x30ff, &base, &last));
+  EXPECT_EQ(base, 0x3000u);
+  EXPECT_EQ(last, 0x30ffu);
+
+  EXPECT_FALSE(ranges.FindRange(0xfff, &base, &last));
+  EXPECT_FALSE(ranges.FindRange(0x1180, &base, &last));
+  EXPECT_FALSE(ranges.FindRange(0x2fff, &base, &last));
+  EXPECT_FALSE(ranges.FindRange(0x3100, &base, &last));
+}
+
+TEST(RangeSet, MatchesReference) {
+  std::mt19937_64 urng(0x5eed);
+  std::uniform_int_distribution<VMAddress> address_dist(0, 0xffff);
+  std::uniform_int_distribution<VMSize> size_dist(0, 0x400);
+
+  RangeSet ranges;
+  std::vector<std::pair<VMAddress, VMSize>> reference;
+  auto reference_contains = [&reference](VMAddress address) {
+    for (const auto& [base, size] : reference) {
+      if (address >= base && address - base < size) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  for (size_t iteration = 0; iteration < 64; ++iteration) {
+    VMAddress base = address_dist(urng);
+    VMSize size = size_dist(urng);
+    ranges.Insert(base, size);
+    reference.emplace_back(base, size);
+
+    for (size_t probe = 0; probe < 256; ++probe) {
+      const VMAddress address = address_dist(urng);
+      SCOPED_TRACE(base::StringPrintf("0x%" PRIx64, address));
+      const bool contained = reference_contains(address);
+      EXPECT_EQ(ranges.Contains(address), contained);
+
+      VMAddress found_base;
+      VMAddress found_last;
+      ASSERT_EQ(ranges.FindRange(address, &found_base, &found_last),
+                contained);
+      if (contained) {
+        EXPECT_LE(found_base, address);
+        EXPECT_GE(found_last, address);
+        EXPECT_TRUE(reference_contains(found_base));
+        EXPECT_TRUE(reference_contains(found_last));
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
@@ -22,6 +22,11 @@
 
 namespace crashpad {
 
+static_assert(kZlibDefaultCompressionLevel == Z_DEFAULT_COMPRESSION,
+              "kZlibDefaultCompressionLevel must match zlib");
+static_assert(kZlibBestCompressionLevel == Z_BEST_COMPRESSION,
+              "kZlibBestCompressionLevel must match zlib");
+
 int ZlibWindowBitsWithGzipWrapper(int window_bits) {
   // See the documentation for deflateInit2() and inflateInit2() in <zlib.h>. 0
   // is only valid during decompression.
@@ -32,6 +37,11 @@ int ZlibWindowBitsWithGzipWrapper(int window_bits) {
   return 16 + window_bits;
 }
 
+bool ZlibIsValidCompressionLevel(int level) {
+  return level == Z_DEFAULT_COMPRESSION ||
+         (level >= Z_NO_COMPRESSION && level <= Z_BEST_COMPRESSION);
+}
+
 std::string ZlibErrorString(int zr) {
   return base::StringPrintf("%s (%d)", zError(zr), zr);
 }
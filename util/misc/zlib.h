@@ -19,6 +19,25 @@
 
 namespace crashpad {
 
+//! \brief The compression level that selects zlib’s default balance between
+//!     speed and compressed size, equal to `Z_DEFAULT_COMPRESSION`.
+//!
+//! Other valid compression levels range from `0` (no compression) through
+//! kZlibBestCompressionLevel. Lower levels are faster but compress less.
+constexpr int kZlibDefaultCompressionLevel = -1;
+
+//! \brief The compression level that produces the smallest output, equal to
+//!     `Z_BEST_COMPRESSION`.
+constexpr int kZlibBestCompressionLevel = 9;
+
+//! \brief Determines whether \a level is a valid zlib compression level.
+//!
+//! \param[in] level A compression level.
+//!
+//! \return `true` if \a level is kZlibDefaultCompressionLevel or is in the
+//!     range `0` through kZlibBestCompressionLevel, `false` otherwise.
+bool ZlibIsValidCompressionLevel(int level);
+
 //! \brief Obtain a \a window_bits parameter to pass to `deflateInit2()` or
 //!     `inflateInit2()` that specifies a `gzip` wrapper instead of the default
 //!     zlib wrapper.
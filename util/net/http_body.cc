@@ -14,16 +14,34 @@
 
 #include "util/net/http_body.h"
 
+#include <stdio.h>
 #include <string.h>
 
 #include <algorithm>
 #include <limits>
 
 #include "base/check.h"
+#include "base/notreached.h"
 #include "util/misc/implicit_cast.h"
 
 namespace crashpad {
 
+bool HTTPBodyStream::GetRemainingSize(FileOffset* size) {
+  return false;
+}
+
+FileHandle HTTPBodyStream::GetFileRange(FileOffset* offset, FileOffset* size) {
+  return kInvalidFileHandle;
+}
+
+bool HTTPBodyStream::SkipFileRange(FileOffset size) {
+  NOTREACHED();
+}
+
+bool HTTPBodyStream::Reset() {
+  return false;
+}
+
 StringHTTPBodyStream::StringHTTPBodyStream(const std::string& string)
     : HTTPBodyStream(), string_(string), bytes_read_() {
 }
@@ -46,8 +64,21 @@ FileOperationResult StringHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
   return num_bytes_returned;
 }
 
+bool StringHTTPBodyStream::GetRemainingSize(FileOffset* size) {
+  *size = string_.length() - bytes_read_;
+  return true;
+}
+
+bool StringHTTPBodyStream::Reset() {
+  bytes_read_ = 0;
+  return true;
+}
+
 FileReaderHTTPBodyStream::FileReaderHTTPBodyStream(FileReaderInterface* reader)
-    : HTTPBodyStream(), reader_(reader), reached_eof_(false) {
+    : HTTPBodyStream(),
+      reader_(reader),
+      start_offset_(reader->SeekGet()),
+      reached_eof_(false) {
   DCHECK(reader_);
 }
 
@@ -66,6 +97,73 @@ FileOperationResult FileReaderHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
   return rv;
 }
 
+bool FileReaderHTTPBodyStream::GetRemainingSize(FileOffset* size) {
+  if (reached_eof_) {
+    *size = 0;
+    return true;
+  }
+
+  FileOffset offset;
+  FileOffset file_size;
+  if (GetFileAndPosition(&offset, &file_size) == kInvalidFileHandle) {
+    return false;
+  }
+
+  *size = std::max(file_size - offset, FileOffset{0});
+  return true;
+}
+
+FileHandle FileReaderHTTPBodyStream::GetFileRange(FileOffset* offset,
+                                                  FileOffset* size) {
+  if (reached_eof_) {
+    return kInvalidFileHandle;
+  }
+
+  FileOffset file_size;
+  FileHandle file = GetFileAndPosition(offset, &file_size);
+  if (file == kInvalidFileHandle || file_size <= *offset) {
+    // At the end of the file, GetBytesBuffer() will observe EOF.
+    return kInvalidFileHandle;
+  }
+
+  *size = file_size - *offset;
+  return file;
+}
+
+bool FileReaderHTTPBodyStream::SkipFileRange(FileOffset size) {
+  DCHECK(!reached_eof_);
+  return reader_->Seek(size, SEEK_CUR) >= 0;
+}
+
+bool FileReaderHTTPBodyStream::Reset() {
+  if (start_offset_ < 0 || !reader_->SeekSet(start_offset_)) {
+    return false;
+  }
+
+  reached_eof_ = false;
+  return true;
+}
+
+FileHandle FileReaderHTTPBodyStream::GetFileAndPosition(FileOffset* offset,
+                                                        FileOffset* file_size) {
+  FileHandle file = reader_->DirectFileHandle();
+  if (file == kInvalidFileHandle) {
+    return kInvalidFileHandle;
+  }
+
+  *offset = reader_->SeekGet();
+  if (*offset < 0) {
+    return kInvalidFileHandle;
+  }
+
+  *file_size = LoggingFileSizeByHandle(file);
+  if (*file_size < 0) {
+    return kInvalidFileHandle;
+  }
+
+  return file;
+}
+
 CompositeHTTPBodyStream::CompositeHTTPBodyStream(
     const CompositeHTTPBodyStream::PartsList& parts)
     : HTTPBodyStream(), parts_(parts), current_part_(parts_.begin()) {
@@ -100,4 +198,50 @@ FileOperationResult CompositeHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
   return bytes_copied;
 }
 
+bool CompositeHTTPBodyStream::GetRemainingSize(FileOffset* size) {
+  FileOffset total_size = 0;
+  for (auto part = current_part_; part != parts_.end(); ++part) {
+    FileOffset part_size;
+    if (!(*part)->GetRemainingSize(&part_size)) {
+      return false;
+    }
+    total_size += part_size;
+  }
+
+  *size = total_size;
+  return true;
+}
+
+FileHandle CompositeHTTPBodyStream::GetFileRange(FileOffset* offset,
+                                                 FileOffset* size) {
+  // Advance past parts known to be exhausted, as GetBytesBuffer() would, so
+  // that a file range following them can be found.
+  while (current_part_ != parts_.end()) {
+    FileOffset remaining_size;
+    if (!(*current_part_)->GetRemainingSize(&remaining_size) ||
+        remaining_size != 0) {
+      return (*current_part_)->GetFileRange(offset, size);
+    }
+    ++current_part_;
+  }
+
+  return kInvalidFileHandle;
+}
+
+bool CompositeHTTPBodyStream::SkipFileRange(FileOffset size) {
+  DCHECK(current_part_ != parts_.end());
+  return (*current_part_)->SkipFileRange(size);
+}
+
+bool CompositeHTTPBodyStream::Reset() {
+  for (HTTPBodyStream* part : parts_) {
+    if (!part->Reset()) {
+      return false;
+    }
+  }
+
+  current_part_ = parts_.begin();
+  return true;
+}
+
 }  // namespace crashpad
@@ -44,6 +44,47 @@ class HTTPBodyStream {
   virtual FileOperationResult GetBytesBuffer(uint8_t* buffer,
                                              size_t max_len) = 0;
 
+  //! \brief Determines the number of bytes remaining in the stream, when that
+  //!     is possible without reading them.
+  //!
+  //! \param[out] size The number of bytes that GetBytesBuffer() will provide
+  //!     before indicating the end of the stream.
+  //!
+  //! \return `true` on success, with \a size set. `false` if the remaining size
+  //!     is not known, without an error message logged.
+  virtual bool GetRemainingSize(FileOffset* size);
+
+  //! \brief Obtains a range of a file holding the next bytes of the stream, so
+  //!     that they may be transferred without being copied through
+  //!     GetBytesBuffer().
+  //!
+  //! A caller that transfers the range must then call SkipFileRange(). A caller
+  //! may instead ignore the range and continue with GetBytesBuffer().
+  //!
+  //! \param[out] offset The offset of the range within the file.
+  //! \param[out] size The size of the range, which is always positive.
+  //!
+  //! \return The file handle, which remains owned by this object, or
+  //!     kInvalidFileHandle if the next bytes of the stream are not available
+  //!     from a file.
+  virtual FileHandle GetFileRange(FileOffset* offset, FileOffset* size);
+
+  //! \brief Advances the stream past a range obtained from GetFileRange().
+  //!
+  //! \param[in] size The size of the range, as returned by GetFileRange().
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  virtual bool SkipFileRange(FileOffset size);
+
+  //! \brief Returns the stream to its beginning, so that its contents may be
+  //!     provided again, for example, to retry a request.
+  //!
+  //! The default implementation returns `false`.
+  //!
+  //! \return `true` on success. `false` if the stream can’t be returned to its
+  //!     beginning.
+  virtual bool Reset();
+
  protected:
   HTTPBodyStream() {}
 };
@@ -64,6 +105,8 @@ class StringHTTPBodyStream : public HTTPBodyStream {
 
   // HTTPBodyStream:
   FileOperationResult GetBytesBuffer(uint8_t* buffer, size_t max_len) override;
+  bool GetRemainingSize(FileOffset* size) override;
+  bool Reset() override;
 
  private:
   std::string string_;
@@ -77,7 +120,7 @@ class FileReaderHTTPBodyStream : public HTTPBodyStream {
   //! \brief Creates a stream for reading from a FileReaderInterface.
   //!
   //! \param[in] reader A FileReaderInterface from which this HTTPBodyStream
-  //!     will read.
+  //!     will read, starting at its current position.
   explicit FileReaderHTTPBodyStream(FileReaderInterface* reader);
 
   FileReaderHTTPBodyStream(const FileReaderHTTPBodyStream&) = delete;
@@ -88,8 +131,39 @@ class FileReaderHTTPBodyStream : public HTTPBodyStream {
   // HTTPBodyStream:
   FileOperationResult GetBytesBuffer(uint8_t* buffer, size_t max_len) override;
 
+  //! \copydoc HTTPBodyStream::GetRemainingSize()
+  //!
+  //! The remaining size is only known when the reader provides a
+  //! FileReaderInterface::DirectFileHandle().
+  bool GetRemainingSize(FileOffset* size) override;
+
+  //! \copydoc HTTPBodyStream::GetFileRange()
+  //!
+  //! A range is only available when the reader provides a
+  //! FileReaderInterface::DirectFileHandle(). It extends from the reader’s
+  //! current position to the end of the file.
+  FileHandle GetFileRange(FileOffset* offset, FileOffset* size) override;
+
+  bool SkipFileRange(FileOffset size) override;
+
+  //! \copydoc HTTPBodyStream::Reset()
+  //!
+  //! This is only possible when the reader supports seeking.
+  bool Reset() override;
+
  private:
+  // Returns the reader’s DirectFileHandle(), setting offset to the reader’s
+  // position and file_size to the size of the file. Returns
+  // kInvalidFileHandle if the reader has no DirectFileHandle() or either value
+  // can’t be determined.
+  FileHandle GetFileAndPosition(FileOffset* offset, FileOffset* file_size);
+
   FileReaderInterface* reader_;  // weak
+
+  // The reader’s position when this object was created, or -1 if it couldn’t
+  // be determined.
+  FileOffset start_offset_;
+
   bool reached_eof_;
 };
 
@@ -115,6 +189,24 @@ class CompositeHTTPBodyStream : public HTTPBodyStream {
   // HTTPBodyStream:
   FileOperationResult GetBytesBuffer(uint8_t* buffer, size_t max_len) override;
 
+  //! \copydoc HTTPBodyStream::GetRemainingSize()
+  //!
+  //! The remaining size is only known when it is known for every remaining
+  //! part.
+  bool GetRemainingSize(FileOffset* size) override;
+
+  //! \copydoc HTTPBodyStream::GetFileRange()
+  //!
+  //! A range is available when one is available from the current part.
+  FileHandle GetFileRange(FileOffset* offset, FileOffset* size) override;
+
+  bool SkipFileRange(FileOffset size) override;
+
+  //! \copydoc HTTPBodyStream::Reset()
+  //!
+  //! This is only possible when it is possible for every part.
+  bool Reset() override;
+
  private:
   PartsList parts_;
   PartsList::iterator current_part_;
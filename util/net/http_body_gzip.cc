@@ -14,6 +14,10 @@
 
 #include "util/net/http_body_gzip.h"
 
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
 #include <utility>
 
 #include "base/check_op.h"
@@ -24,11 +28,60 @@
 
 namespace crashpad {
 
+namespace {
+
+// The default values for zlib’s internal MAX_WBITS and DEF_MEM_LEVEL. These
+// are the values that deflateInit() would use, but they’re not exported from
+// zlib.
+constexpr int kZlibMaxWindowBits = 15;
+constexpr int kZlibDefaultMemoryLevel = 8;
+
+// A gzip member header with no optional fields, no modification time, and an
+// unknown operating system. See RFC 1952 §2.3.
+constexpr uint8_t kGzipHeader[] = {
+    0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff};
+
+// The end of the deflate data written by ZlibOutputStream using
+// ZlibOutputStream::Format::kGzip: the empty stored block of a sync flush,
+// followed by an empty final block with fixed Huffman codes.
+constexpr uint8_t kSyncFlushAndFinalBlock[] = {0x00, 0x00, 0xff, 0xff, 0x03,
+                                               0x00};
+
+// The size of the empty final block in kSyncFlushAndFinalBlock.
+constexpr size_t kFinalBlockSize = 2;
+
+// The size of a gzip member trailer, holding the CRC-32 and size of the
+// uncompressed data.
+constexpr size_t kGzipTrailerSize = 8;
+
+void AppendLittleEndian32(uint32_t value, std::string* string) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    string->push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+uint32_t ReadLittleEndian32(const uint8_t* data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) |
+         (static_cast<uint32_t>(data[3]) << 24);
+}
+
+}  // namespace
+
 GzipHTTPBodyStream::GzipHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source)
-    : input_(),
+    : GzipHTTPBodyStream(
+          std::move(source), Z_DEFAULT_COMPRESSION, kDefaultInputBufferSize) {}
+
+GzipHTTPBodyStream::GzipHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source,
+                                       int level,
+                                       size_t input_buffer_size)
+    : input_(input_buffer_size),
       source_(std::move(source)),
       z_stream_(new z_stream()),
-      state_(State::kUninitialized) {}
+      level_(level),
+      state_(State::kUninitialized) {
+  DCHECK_GT(input_.size(), 0u);
+  DCHECK(ZlibIsValidCompressionLevel(level_)) << level_;
+}
 
 GzipHTTPBodyStream::~GzipHTTPBodyStream() {
   DCHECK(state_ == State::kUninitialized ||
@@ -51,15 +104,9 @@ FileOperationResult GzipHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
     z_stream_->zfree = Z_NULL;
     z_stream_->opaque = Z_NULL;
 
-    // The default values for zlib’s internal MAX_WBITS and DEF_MEM_LEVEL. These
-    // are the values that deflateInit() would use, but they’re not exported
-    // from zlib. deflateInit2() is used instead of deflateInit() to get the
-    // gzip wrapper.
-    constexpr int kZlibMaxWindowBits = 15;
-    constexpr int kZlibDefaultMemoryLevel = 8;
-
+    // deflateInit2() is used instead of deflateInit() to get the gzip wrapper.
     int zr = deflateInit2(z_stream_.get(),
-                          Z_DEFAULT_COMPRESSION,
+                          level_,
                           Z_DEFLATED,
                           ZlibWindowBitsWithGzipWrapper(kZlibMaxWindowBits),
                           kZlibDefaultMemoryLevel,
@@ -79,7 +126,7 @@ FileOperationResult GzipHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
   while (state_ != State::kFinished && z_stream_->avail_out > 0) {
     if (state_ != State::kInputEOF && z_stream_->avail_in == 0) {
       FileOperationResult input_bytes =
-          source_->GetBytesBuffer(input_, sizeof(input_));
+          source_->GetBytesBuffer(input_.data(), input_.size());
       if (input_bytes == -1) {
         Done(State::kError);
         return -1;
@@ -89,7 +136,7 @@ FileOperationResult GzipHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
         state_ = State::kInputEOF;
       }
 
-      z_stream_->next_in = input_;
+      z_stream_->next_in = input_.data();
       z_stream_->avail_in = base::checked_cast<uInt>(input_bytes);
     }
 
@@ -111,6 +158,19 @@ FileOperationResult GzipHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
   return max_len - z_stream_->avail_out;
 }
 
+bool GzipHTTPBodyStream::Reset() {
+  if (!source_->Reset()) {
+    return false;
+  }
+
+  if (state_ == State::kOperating || state_ == State::kInputEOF) {
+    deflateEnd(z_stream_.get());
+  }
+  z_stream_->avail_in = 0;
+  state_ = State::kUninitialized;
+  return true;
+}
+
 void GzipHTTPBodyStream::Done(State state) {
   DCHECK(state_ == State::kOperating || state_ == State::kInputEOF) << state_;
   DCHECK(state == State::kFinished || state == State::kError) << state;
@@ -124,4 +184,316 @@ void GzipHTTPBodyStream::Done(State state) {
   }
 }
 
+SplicingGzipHTTPBodyStream::Part::Part()
+    : source(), compressed_source(nullptr), compressed_start(-1) {}
+
+SplicingGzipHTTPBodyStream::Part::Part(Part&& other) = default;
+
+SplicingGzipHTTPBodyStream::Part&
+SplicingGzipHTTPBodyStream::Part::operator=(Part&& other) = default;
+
+SplicingGzipHTTPBodyStream::Part::~Part() = default;
+
+SplicingGzipHTTPBodyStream::SplicingGzipHTTPBodyStream()
+    : SplicingGzipHTTPBodyStream(Z_DEFAULT_COMPRESSION) {}
+
+SplicingGzipHTTPBodyStream::SplicingGzipHTTPBodyStream(int level)
+    : input_(GzipHTTPBodyStream::kDefaultInputBufferSize),
+      parts_(),
+      z_stream_(new z_stream()),
+      level_(level),
+      pending_(),
+      pending_offset_(0),
+      current_part_(0),
+      current_part_started_(false),
+      input_eof_(false),
+      compressed_remaining_(0),
+      crc_(0),
+      length_(0),
+      state_(State::kUninitialized) {
+  DCHECK(ZlibIsValidCompressionLevel(level_)) << level_;
+}
+
+SplicingGzipHTTPBodyStream::~SplicingGzipHTTPBodyStream() {
+  if (state_ == State::kOperating) {
+    deflateEnd(z_stream_.get());
+  }
+}
+
+void SplicingGzipHTTPBodyStream::AddPart(
+    std::unique_ptr<HTTPBodyStream> source) {
+  DCHECK_EQ(state_, State::kUninitialized);
+  Part part;
+  part.source = std::move(source);
+  parts_.push_back(std::move(part));
+}
+
+void SplicingGzipHTTPBodyStream::AddCompressedPart(
+    FileReaderInterface* reader) {
+  DCHECK_EQ(state_, State::kUninitialized);
+  Part part;
+  part.compressed_source = reader;
+  parts_.push_back(std::move(part));
+}
+
+FileOperationResult SplicingGzipHTTPBodyStream::GetBytesBuffer(
+    uint8_t* buffer,
+    size_t max_len) {
+  if (state_ == State::kError) {
+    return -1;
+  }
+
+  if (state_ == State::kUninitialized) {
+    // The body must end with a final deflate block, which only compressed parts
+    // provide.
+    if (parts_.empty() || !parts_.back().source) {
+      AddPart(std::make_unique<StringHTTPBodyStream>(std::string()));
+    }
+
+    z_stream_->zalloc = Z_NULL;
+    z_stream_->zfree = Z_NULL;
+    z_stream_->opaque = Z_NULL;
+
+    // A negative window_bits value produces raw deflate data, without a zlib
+    // or gzip wrapper.
+    int zr = deflateInit2(z_stream_.get(),
+                          level_,
+                          Z_DEFLATED,
+                          -kZlibMaxWindowBits,
+                          kZlibDefaultMemoryLevel,
+                          Z_DEFAULT_STRATEGY);
+    if (zr != Z_OK) {
+      LOG(ERROR) << "deflateInit2: " << ZlibErrorString(zr);
+      state_ = State::kError;
+      return -1;
+    }
+
+    pending_.assign(std::begin(kGzipHeader), std::end(kGzipHeader));
+    crc_ = crc32(0, Z_NULL, 0);
+    state_ = State::kOperating;
+  }
+
+  size_t length = 0;
+  while (length < max_len) {
+    if (pending_offset_ < pending_.size()) {
+      const size_t copy_size =
+          std::min(max_len - length, pending_.size() - pending_offset_);
+      memcpy(buffer + length, pending_.data() + pending_offset_, copy_size);
+      pending_offset_ += copy_size;
+      length += copy_size;
+      continue;
+    }
+
+    if (state_ == State::kFinished) {
+      break;
+    }
+
+    if (current_part_ == parts_.size()) {
+      int zr = deflateEnd(z_stream_.get());
+      if (zr != Z_OK) {
+        LOG(ERROR) << "deflateEnd: " << ZlibErrorString(zr);
+        state_ = State::kError;
+        return -1;
+      }
+
+      pending_.clear();
+      pending_offset_ = 0;
+      AppendLittleEndian32(crc_, &pending_);
+      AppendLittleEndian32(static_cast<uint32_t>(length_), &pending_);
+      state_ = State::kFinished;
+      continue;
+    }
+
+    FileOperationResult result =
+        parts_[current_part_].source
+            ? DeflatePart(buffer + length, max_len - length)
+            : CopyCompressedPart(buffer + length, max_len - length);
+    if (result < 0) {
+      deflateEnd(z_stream_.get());
+      state_ = State::kError;
+      return -1;
+    }
+    length += result;
+  }
+
+  return length;
+}
+
+bool SplicingGzipHTTPBodyStream::Reset() {
+  for (Part& part : parts_) {
+    if (part.source) {
+      if (!part.source->Reset()) {
+        return false;
+      }
+    } else if (part.compressed_start >= 0) {
+      if (!part.compressed_source->SeekSet(part.compressed_start)) {
+        return false;
+      }
+      part.compressed_start = -1;
+    }
+  }
+
+  if (state_ == State::kOperating) {
+    deflateEnd(z_stream_.get());
+  }
+  z_stream_->avail_in = 0;
+  pending_.clear();
+  pending_offset_ = 0;
+  current_part_ = 0;
+  current_part_started_ = false;
+  input_eof_ = false;
+  compressed_remaining_ = 0;
+  crc_ = 0;
+  length_ = 0;
+  state_ = State::kUninitialized;
+  return true;
+}
+
+FileOperationResult SplicingGzipHTTPBodyStream::DeflatePart(uint8_t* buffer,
+                                                            size_t max_len) {
+  Part& part = parts_[current_part_];
+  const bool last_part = current_part_ + 1 == parts_.size();
+
+  z_stream_->next_out = buffer;
+  z_stream_->avail_out = base::saturated_cast<uInt>(max_len);
+
+  while (z_stream_->avail_out > 0) {
+    if (!input_eof_ && z_stream_->avail_in == 0) {
+      FileOperationResult input_bytes =
+          part.source->GetBytesBuffer(input_.data(), input_.size());
+      if (input_bytes < 0) {
+        return -1;
+      }
+
+      if (input_bytes == 0) {
+        input_eof_ = true;
+      } else {
+        crc_ = crc32(
+            crc_, input_.data(), base::checked_cast<uInt>(input_bytes));
+        length_ += input_bytes;
+      }
+
+      z_stream_->next_in = input_.data();
+      z_stream_->avail_in = base::checked_cast<uInt>(input_bytes);
+    }
+
+    // Parts other than the last end at a byte-aligned sync point, so that a
+    // compressed part may follow.
+    const int flush =
+        input_eof_ ? (last_part ? Z_FINISH : Z_SYNC_FLUSH) : Z_NO_FLUSH;
+    int zr = deflate(z_stream_.get(), flush);
+    if (zr == Z_STREAM_END && flush == Z_FINISH) {
+      ++current_part_;
+      break;
+    }
+    if (zr != Z_OK && zr != Z_BUF_ERROR) {
+      LOG(ERROR) << "deflate: " << ZlibErrorString(zr);
+      return -1;
+    }
+
+    if (flush == Z_SYNC_FLUSH && z_stream_->avail_out > 0) {
+      // The following part’s data must not refer back to this part’s, so start
+      // a new deflate stream for it.
+      zr = deflateReset(z_stream_.get());
+      if (zr != Z_OK) {
+        LOG(ERROR) << "deflateReset: " << ZlibErrorString(zr);
+        return -1;
+      }
+      ++current_part_;
+      input_eof_ = false;
+      break;
+    }
+  }
+
+  DCHECK_LE(z_stream_->avail_out, max_len);
+  return max_len - z_stream_->avail_out;
+}
+
+FileOperationResult SplicingGzipHTTPBodyStream::CopyCompressedPart(
+    uint8_t* buffer,
+    size_t max_len) {
+  Part& part = parts_[current_part_];
+  FileReaderInterface* reader = part.compressed_source;
+  if (!current_part_started_) {
+    part.compressed_start = reader->SeekGet();
+    if (!StartCompressedPart(reader)) {
+      return -1;
+    }
+    current_part_started_ = true;
+  }
+
+  const size_t read_size = static_cast<size_t>(
+      std::min(static_cast<FileOffset>(max_len), compressed_remaining_));
+  FileOperationResult bytes_read = reader->Read(buffer, read_size);
+  if (bytes_read < 0) {
+    return -1;
+  }
+  if (bytes_read == 0) {
+    LOG(ERROR) << "unexpected end of compressed part";
+    return -1;
+  }
+
+  compressed_remaining_ -= bytes_read;
+  if (compressed_remaining_ == 0) {
+    ++current_part_;
+    current_part_started_ = false;
+  }
+  return bytes_read;
+}
+
+bool SplicingGzipHTTPBodyStream::StartCompressedPart(
+    FileReaderInterface* reader) {
+  const FileOffset start = reader->SeekGet();
+  if (start < 0) {
+    return false;
+  }
+  const FileOffset end = reader->Seek(0, SEEK_END);
+  if (end < 0) {
+    return false;
+  }
+
+  constexpr size_t kTailSize =
+      sizeof(kSyncFlushAndFinalBlock) + kGzipTrailerSize;
+  if (end - start <
+      static_cast<FileOffset>(sizeof(kGzipHeader) + kTailSize)) {
+    LOG(ERROR) << "compressed part too short";
+    return false;
+  }
+
+  uint8_t tail[kTailSize];
+  if (!reader->SeekSet(end - kTailSize) ||
+      !reader->ReadExactly(tail, sizeof(tail))) {
+    return false;
+  }
+  if (memcmp(tail, kSyncFlushAndFinalBlock, sizeof(kSyncFlushAndFinalBlock)) !=
+      0) {
+    LOG(ERROR) << "compressed part doesn’t end at a sync point";
+    return false;
+  }
+
+  uint8_t header[sizeof(kGzipHeader)];
+  if (!reader->SeekSet(start) || !reader->ReadExactly(header, sizeof(header))) {
+    return false;
+  }
+  // Check the magic number, compression method, and flags. Optional header
+  // fields aren’t supported.
+  if (header[0] != kGzipHeader[0] || header[1] != kGzipHeader[1] ||
+      header[2] != kGzipHeader[2] || header[3] != 0) {
+    LOG(ERROR) << "unexpected gzip header";
+    return false;
+  }
+
+  const uint8_t* trailer = tail + sizeof(kSyncFlushAndFinalBlock);
+  const uint32_t part_crc = ReadLittleEndian32(trailer);
+  const uint32_t part_length = ReadLittleEndian32(trailer + 4);
+  crc_ = crc32_combine(crc_, part_crc, part_length);
+  length_ += part_length;
+
+  // Copy the deflate data through the end of the sync flush, leaving out the
+  // final block and the trailer.
+  compressed_remaining_ =
+      end - start - sizeof(kGzipHeader) - kFinalBlockSize - kGzipTrailerSize;
+  return true;
+}
+
 }  // namespace crashpad
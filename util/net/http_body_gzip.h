@@ -19,8 +19,11 @@
 #include <sys/types.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "util/file/file_io.h"
+#include "util/file/file_reader.h"
 #include "util/net/http_body.h"
 
 extern "C" {
@@ -33,8 +36,25 @@ namespace crashpad {
 //!     HTTPBodyStream.
 class GzipHTTPBodyStream : public HTTPBodyStream {
  public:
+  //! \brief The default size of the buffer that data to be compressed is read
+  //!     into from the source stream.
+  static constexpr size_t kDefaultInputBufferSize = 32 * 1024;
+
+  //! \brief Compresses \a source with zlib’s default compression level.
   explicit GzipHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source);
 
+  //! \param[in] source The stream whose contents will be compressed.
+  //! \param[in] level The compression level, from `0` through
+  //!     kZlibBestCompressionLevel, or kZlibDefaultCompressionLevel. Lower
+  //!     levels use less CPU time but produce a larger body.
+  //! \param[in] input_buffer_size The size of the buffer that data to be
+  //!     compressed is read into from \a source. Larger buffers reduce the
+  //!     number of reads from \a source, and allow zlib to work on larger
+  //!     blocks of input at a time.
+  GzipHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source,
+                     int level,
+                     size_t input_buffer_size);
+
   GzipHTTPBodyStream(const GzipHTTPBodyStream&) = delete;
   GzipHTTPBodyStream& operator=(const GzipHTTPBodyStream&) = delete;
 
@@ -43,6 +63,11 @@ class GzipHTTPBodyStream : public HTTPBodyStream {
   // HTTPBodyStream:
   FileOperationResult GetBytesBuffer(uint8_t* buffer, size_t max_len) override;
 
+  //! \copydoc HTTPBodyStream::Reset()
+  //!
+  //! This is only possible when it is possible for the source stream.
+  bool Reset() override;
+
  private:
   enum State : int {
     kUninitialized,
@@ -56,9 +81,121 @@ class GzipHTTPBodyStream : public HTTPBodyStream {
   // logs a message and transitions state_ to State::kError.
   void Done(State state);
 
-  uint8_t input_[4096];
+  std::vector<uint8_t> input_;
   std::unique_ptr<HTTPBodyStream> source_;
   std::unique_ptr<z_stream> z_stream_;
+  int level_;
+  State state_;
+};
+
+//! \brief An implementation of HTTPBodyStream that produces a `gzip`-compressed
+//!     body from a sequence of parts, some of which are already compressed.
+//!
+//! Parts that are already compressed are placed into the body without being
+//! decompressed or recompressed. Each must be a single `gzip` member written by
+//! ZlibOutputStream using ZlibOutputStream::Format::kGzip, whose uncompressed
+//! size is less than 4 GiB. Decompressing the body produces the concatenation
+//! of the uncompressed contents of every part.
+class SplicingGzipHTTPBodyStream : public HTTPBodyStream {
+ public:
+  //! \brief Compresses parts with zlib’s default compression level.
+  SplicingGzipHTTPBodyStream();
+
+  //! \param[in] level The compression level for parts added by AddPart(),
+  //!     from `0` through kZlibBestCompressionLevel, or
+  //!     kZlibDefaultCompressionLevel. Parts added by AddCompressedPart() are
+  //!     not recompressed.
+  explicit SplicingGzipHTTPBodyStream(int level);
+
+  SplicingGzipHTTPBodyStream(const SplicingGzipHTTPBodyStream&) = delete;
+  SplicingGzipHTTPBodyStream& operator=(const SplicingGzipHTTPBodyStream&) =
+      delete;
+
+  ~SplicingGzipHTTPBodyStream() override;
+
+  //! \brief Appends a part whose contents will be compressed.
+  //!
+  //! This method must not be called after GetBytesBuffer().
+  void AddPart(std::unique_ptr<HTTPBodyStream> source);
+
+  //! \brief Appends a part whose contents are already compressed.
+  //!
+  //! This method must not be called after GetBytesBuffer().
+  //!
+  //! \param[in] reader A reader positioned at the start of the compressed
+  //!     part, which extends to the end of the file. The reader must support
+  //!     seeking. This object does not take ownership of \a reader, which must
+  //!     outlive this object.
+  void AddCompressedPart(FileReaderInterface* reader);
+
+  // HTTPBodyStream:
+  FileOperationResult GetBytesBuffer(uint8_t* buffer, size_t max_len) override;
+
+  //! \copydoc HTTPBodyStream::Reset()
+  //!
+  //! This is only possible when it is possible for every part added by
+  //! AddPart().
+  bool Reset() override;
+
+ private:
+  struct Part {
+    Part();
+    Part(Part&& other);
+    Part& operator=(Part&& other);
+    ~Part();
+
+    // Exactly one of these is set.
+    std::unique_ptr<HTTPBodyStream> source;
+    FileReaderInterface* compressed_source;  // weak
+
+    // The position of compressed_source at the start of the part, or -1 if
+    // the part hasn’t been started.
+    FileOffset compressed_start;
+  };
+
+  enum State : int {
+    kUninitialized,
+    kOperating,
+    kFinished,
+    kError,
+  };
+
+  // Compresses data from the current part, which has a source, into buffer.
+  // Moves on to the next part once the part’s compressed data is complete.
+  // Returns the number of bytes placed in buffer, or -1 on error with a message
+  // logged.
+  FileOperationResult DeflatePart(uint8_t* buffer, size_t max_len);
+
+  // Copies compressed data from the current part, which has a
+  // compressed_source, into buffer. Moves on to the next part once all of the
+  // part’s data has been copied. Returns the number of bytes placed in buffer,
+  // or -1 on error with a message logged.
+  FileOperationResult CopyCompressedPart(uint8_t* buffer, size_t max_len);
+
+  // Validates the gzip member at the current position of reader, and prepares
+  // to copy its deflate data.
+  bool StartCompressedPart(FileReaderInterface* reader);
+
+  std::vector<uint8_t> input_;
+  std::vector<Part> parts_;
+  std::unique_ptr<z_stream> z_stream_;
+  int level_;
+
+  // Header or trailer bytes waiting to be placed in the body.
+  std::string pending_;
+  size_t pending_offset_;
+
+  size_t current_part_;
+  bool current_part_started_;
+  bool input_eof_;
+
+  // The number of bytes remaining to be copied from a compressed part.
+  FileOffset compressed_remaining_;
+
+  // The CRC-32 and length of the uncompressed contents of all parts so far.
+  uint32_t crc_;
+  uint64_t length_;
+
   State state_;
 };
 
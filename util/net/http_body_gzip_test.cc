@@ -26,8 +26,11 @@
 #include "base/rand_util.h"
 #include "gtest/gtest.h"
 #include "third_party/zlib/zlib_crashpad.h"
+#include "util/file/string_file.h"
 #include "util/misc/zlib.h"
 #include "util/net/http_body.h"
+#include "util/stream/test_output_stream.h"
+#include "util/stream/zlib_output_stream.h"
 
 namespace crashpad {
 namespace test {
@@ -175,6 +178,171 @@ TEST(GzipHTTPBodyStream, ManyBytes_Random) {
   TestGzipDeflateInflate(base::RandBytesAsString(kManyBytes));
 }
 
+TEST(GzipHTTPBodyStream, Reset) {
+  const std::string string = MakeString(kManyBytes);
+  GzipHTTPBodyStream stream(std::make_unique<StringHTTPBodyStream>(string));
+
+  // Reset partway through, before any output is produced, and after reaching
+  // the end.
+  uint8_t buf[4096];
+  ASSERT_GT(stream.GetBytesBuffer(buf, sizeof(buf)), 0);
+  ASSERT_TRUE(stream.Reset());
+  ASSERT_TRUE(stream.Reset());
+
+  for (int iteration = 0; iteration < 2; ++iteration) {
+    SCOPED_TRACE(iteration);
+    std::string compressed;
+    FileOperationResult bytes;
+    while ((bytes = stream.GetBytesBuffer(buf, sizeof(buf))) > 0) {
+      compressed.append(reinterpret_cast<char*>(buf), bytes);
+    }
+    ASSERT_EQ(bytes, 0);
+
+    std::string decompressed;
+    ASSERT_NO_FATAL_FAILURE(
+        GzipInflate(compressed, &decompressed, string.size()));
+    EXPECT_EQ(decompressed, string);
+
+    ASSERT_TRUE(stream.Reset());
+  }
+}
+
+std::string GzipCompressForSplicing(const std::string& string) {
+  auto test_output_stream = std::make_unique<TestOutputStream>();
+  TestOutputStream* test_output_stream_weak = test_output_stream.get();
+  ZlibOutputStream zlib_output_stream(ZlibOutputStream::Mode::kCompress,
+                                      ZlibOutputStream::Format::kGzip,
+                                      std::move(test_output_stream));
+  EXPECT_TRUE(zlib_output_stream.Write(
+      reinterpret_cast<const uint8_t*>(string.data()), string.size()));
+  EXPECT_TRUE(zlib_output_stream.Flush());
+  const std::vector<uint8_t>& compressed = test_output_stream_weak->all_data();
+  return std::string(compressed.begin(), compressed.end());
+}
+
+void TestSplicing(size_t buffer_size) {
+  const std::string prefix = MakeString(kFourKBytes);
+  const std::string compressed_contents = base::RandBytesAsString(kManyBytes);
+  const std::string middle("--boundary\r\n");
+  const std::string second_compressed_contents(kFourKBytes, '\0');
+  const std::string suffix = MakeString(kManyBytes);
+
+  StringFile compressed_file;
+  compressed_file.SetString(GzipCompressForSplicing(compressed_contents));
+  StringFile second_compressed_file;
+  second_compressed_file.SetString(
+      GzipCompressForSplicing(second_compressed_contents));
+
+  SplicingGzipHTTPBodyStream stream;
+  stream.AddPart(std::make_unique<StringHTTPBodyStream>(prefix));
+  stream.AddCompressedPart(&compressed_file);
+  stream.AddPart(std::make_unique<StringHTTPBodyStream>(middle));
+  stream.AddCompressedPart(&second_compressed_file);
+  stream.AddPart(std::make_unique<StringHTTPBodyStream>(suffix));
+
+  auto buf = base::HeapArray<uint8_t>::Uninit(buffer_size);
+  std::string compressed;
+  FileOperationResult bytes;
+  while ((bytes = stream.GetBytesBuffer(buf.data(), buf.size())) > 0) {
+    compressed.append(reinterpret_cast<char*>(buf.data()), bytes);
+  }
+  ASSERT_EQ(bytes, 0);
+
+  const std::string expected = prefix + compressed_contents + middle +
+                               second_compressed_contents + suffix;
+  std::string decompressed;
+  ASSERT_NO_FATAL_FAILURE(
+      GzipInflate(compressed, &decompressed, expected.size()));
+  EXPECT_EQ(decompressed, expected);
+}
+
+TEST(SplicingGzipHTTPBodyStream, Splice) {
+  TestSplicing(4096);
+}
+
+TEST(SplicingGzipHTTPBodyStream, SpliceSmallBuffer) {
+  TestSplicing(7);
+}
+
+TEST(SplicingGzipHTTPBodyStream, EndsWithCompressedPart) {
+  const std::string contents = MakeString(kFourKBytes);
+  StringFile compressed_file;
+  compressed_file.SetString(GzipCompressForSplicing(contents));
+
+  SplicingGzipHTTPBodyStream stream;
+  stream.AddCompressedPart(&compressed_file);
+
+  uint8_t buf[4096];
+  std::string compressed;
+  FileOperationResult bytes;
+  while ((bytes = stream.GetBytesBuffer(buf, sizeof(buf))) > 0) {
+    compressed.append(reinterpret_cast<char*>(buf), bytes);
+  }
+  ASSERT_EQ(bytes, 0);
+
+  std::string decompressed;
+  ASSERT_NO_FATAL_FAILURE(
+      GzipInflate(compressed, &decompressed, contents.size()));
+  EXPECT_EQ(decompressed, contents);
+}
+
+TEST(SplicingGzipHTTPBodyStream, Reset) {
+  const std::string prefix("prefix");
+  const std::string contents = base::RandBytesAsString(kManyBytes);
+  const std::string suffix("suffix");
+
+  // The compressed part doesn’t start at the beginning of its file.
+  const std::string garbage("garbage");
+  StringFile compressed_file;
+  compressed_file.SetString(garbage + GzipCompressForSplicing(contents));
+  ASSERT_TRUE(compressed_file.SeekSet(garbage.size()));
+
+  SplicingGzipHTTPBodyStream stream;
+  stream.AddPart(std::make_unique<StringHTTPBodyStream>(prefix));
+  stream.AddCompressedPart(&compressed_file);
+  stream.AddPart(std::make_unique<StringHTTPBodyStream>(suffix));
+
+  // Reset partway through the compressed part.
+  uint8_t buf[4096];
+  ASSERT_GT(stream.GetBytesBuffer(buf, sizeof(buf)), 0);
+  ASSERT_GT(stream.GetBytesBuffer(buf, sizeof(buf)), 0);
+  ASSERT_TRUE(stream.Reset());
+
+  const std::string expected = prefix + contents + suffix;
+  for (int iteration = 0; iteration < 2; ++iteration) {
+    SCOPED_TRACE(iteration);
+    std::string compressed;
+    FileOperationResult bytes;
+    while ((bytes = stream.GetBytesBuffer(buf, sizeof(buf))) > 0) {
+      compressed.append(reinterpret_cast<char*>(buf), bytes);
+    }
+    ASSERT_EQ(bytes, 0);
+
+    std::string decompressed;
+    ASSERT_NO_FATAL_FAILURE(
+        GzipInflate(compressed, &decompressed, expected.size()));
+    EXPECT_EQ(decompressed, expected);
+
+    ASSERT_TRUE(stream.Reset());
+  }
+}
+
+TEST(SplicingGzipHTTPBodyStream, RejectsUnsplicableMember) {
+  // A member written by GzipHTTPBodyStream doesn’t end at a sync point.
+  GzipHTTPBodyStream gzip_stream(
+      std::make_unique<StringHTTPBodyStream>(MakeString(kFourKBytes)));
+  uint8_t buf[8192];
+  FileOperationResult bytes = gzip_stream.GetBytesBuffer(buf, sizeof(buf));
+  ASSERT_GT(bytes, 0);
+  StringFile compressed_file;
+  compressed_file.SetString(std::string(reinterpret_cast<char*>(buf), bytes));
+
+  SplicingGzipHTTPBodyStream stream;
+  stream.AddPart(std::make_unique<StringHTTPBodyStream>("prefix"));
+  stream.AddCompressedPart(&compressed_file);
+  EXPECT_EQ(stream.GetBytesBuffer(buf, sizeof(buf)), -1);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
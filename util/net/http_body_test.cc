@@ -18,6 +18,7 @@
 
 #include "gtest/gtest.h"
 #include "test/test_paths.h"
+#include "util/file/string_file.h"
 #include "util/misc/implicit_cast.h"
 #include "util/net/http_body_test_util.h"
 
@@ -148,6 +149,56 @@ TEST(FileReaderHTTPBodyStream, ReadBinaryFile) {
   ExpectBufferSet(buf, '!', sizeof(buf));
 }
 
+TEST(FileReaderHTTPBodyStream, FileRange) {
+  base::FilePath path = TestPaths::TestDataRoot().Append(
+      FILE_PATH_LITERAL("util/net/testdata/ascii_http_body.txt"));
+
+  FileReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  FileReaderHTTPBodyStream stream(&reader);
+
+  // Read part of the file normally. The range covers the remainder.
+  uint8_t buf[5];
+  EXPECT_EQ(stream.GetBytesBuffer(buf, sizeof(buf)), 5);
+
+  FileOffset size;
+  ASSERT_TRUE(stream.GetRemainingSize(&size));
+  EXPECT_EQ(size, 11);
+
+  FileOffset offset;
+  ASSERT_EQ(stream.GetFileRange(&offset, &size), reader.DirectFileHandle());
+  EXPECT_EQ(offset, 5);
+  EXPECT_EQ(size, 11);
+
+  std::string contents(size, '\0');
+  ASSERT_EQ(LoggingSeekFile(reader.DirectFileHandle(), offset, SEEK_SET),
+            offset);
+  ASSERT_TRUE(LoggingReadFileExactly(
+      reader.DirectFileHandle(), &contents[0], contents.size()));
+  EXPECT_EQ(contents, "is a test.\n");
+
+  // Reading from the file handle moved the reader’s position, so restore it
+  // before skipping the range.
+  ASSERT_TRUE(reader.SeekSet(offset));
+  ASSERT_TRUE(stream.SkipFileRange(size));
+  ASSERT_TRUE(stream.GetRemainingSize(&size));
+  EXPECT_EQ(size, 0);
+  EXPECT_EQ(stream.GetFileRange(&offset, &size), kInvalidFileHandle);
+  EXPECT_EQ(stream.GetBytesBuffer(buf, sizeof(buf)), 0);
+}
+
+TEST(FileReaderHTTPBodyStream, NoFileRange) {
+  StringFile string_file;
+  string_file.SetString("This is a test.\n");
+  FileReaderHTTPBodyStream stream(&string_file);
+
+  FileOffset offset;
+  FileOffset size;
+  EXPECT_FALSE(stream.GetRemainingSize(&size));
+  EXPECT_EQ(stream.GetFileRange(&offset, &size), kInvalidFileHandle);
+  EXPECT_EQ(ReadStreamToString(&stream), "This is a test.\n");
+}
+
 TEST(CompositeHTTPBodyStream, TwoEmptyStrings) {
   std::vector<HTTPBodyStream*> parts;
   parts.push_back(new StringHTTPBodyStream(std::string()));
@@ -207,6 +258,74 @@ TEST_P(CompositeHTTPBodyStreamBufferSize, StringsAndFile) {
   EXPECT_EQ(actual_string, expected_string);
 }
 
+TEST(CompositeHTTPBodyStream, FileRange) {
+  std::string string1("Hello! ");
+  std::string string2(" Goodbye :)");
+
+  std::vector<HTTPBodyStream*> parts;
+  parts.push_back(new StringHTTPBodyStream(string1));
+  base::FilePath path = TestPaths::TestDataRoot().Append(
+      FILE_PATH_LITERAL("util/net/testdata/ascii_http_body.txt"));
+
+  FileReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  parts.push_back(new FileReaderHTTPBodyStream(&reader));
+  parts.push_back(new StringHTTPBodyStream(string2));
+
+  CompositeHTTPBodyStream stream(parts);
+
+  FileOffset size;
+  ASSERT_TRUE(stream.GetRemainingSize(&size));
+  EXPECT_EQ(size, 34);
+
+  // The first part isn’t a file.
+  FileOffset offset;
+  EXPECT_EQ(stream.GetFileRange(&offset, &size), kInvalidFileHandle);
+
+  uint8_t buf[7];
+  ASSERT_EQ(stream.GetBytesBuffer(buf, sizeof(buf)), 7);
+  EXPECT_EQ(std::string(reinterpret_cast<char*>(buf), sizeof(buf)), string1);
+
+  // Once the first part has been read, the second part’s range is available.
+  ASSERT_EQ(stream.GetFileRange(&offset, &size), reader.DirectFileHandle());
+  EXPECT_EQ(offset, 0);
+  EXPECT_EQ(size, 16);
+  ASSERT_TRUE(stream.SkipFileRange(size));
+
+  ASSERT_TRUE(stream.GetRemainingSize(&size));
+  EXPECT_EQ(size, 11);
+  EXPECT_EQ(stream.GetFileRange(&offset, &size), kInvalidFileHandle);
+  EXPECT_EQ(ReadStreamToString(&stream), string2);
+}
+
+TEST(CompositeHTTPBodyStream, Reset) {
+  std::string string1("Hello! ");
+  std::string string2(" Goodbye :)");
+
+  std::vector<HTTPBodyStream*> parts;
+  parts.push_back(new StringHTTPBodyStream(string1));
+  base::FilePath path = TestPaths::TestDataRoot().Append(
+      FILE_PATH_LITERAL("util/net/testdata/ascii_http_body.txt"));
+
+  FileReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  ASSERT_TRUE(reader.SeekSet(5));
+  parts.push_back(new FileReaderHTTPBodyStream(&reader));
+  parts.push_back(new StringHTTPBodyStream(string2));
+
+  CompositeHTTPBodyStream stream(parts);
+
+  // Reset partway through the file part, and again after reaching the end.
+  uint8_t buf[10];
+  ASSERT_EQ(stream.GetBytesBuffer(buf, sizeof(buf)), 10);
+  ASSERT_TRUE(stream.Reset());
+
+  const std::string expected_string = string1 + "is a test.\n" + string2;
+  EXPECT_EQ(ReadStreamToString(&stream, 3), expected_string);
+  ASSERT_TRUE(stream.Reset());
+  EXPECT_EQ(ReadStreamToString(&stream, 3), expected_string);
+}
+
 INSTANTIATE_TEST_SUITE_P(VariableBufferSize,
                          CompositeHTTPBodyStreamBufferSize,
                          testing::Values(1, 2, 9, 16, 31, 128, 1024));
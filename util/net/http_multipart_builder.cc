@@ -14,6 +14,7 @@
 
 #include "util/net/http_multipart_builder.h"
 
+#include <inttypes.h>
 #include <string.h>
 #include <sys/types.h>
 
@@ -24,6 +25,7 @@
 #include "base/rand_util.h"
 #include "base/strings/stringprintf.h"
 #include "util/net/http_body.h"
+#include "util/misc/zlib.h"
 #include "util/net/http_body_gzip.h"
 
 namespace crashpad {
@@ -96,6 +98,36 @@ std::string GetFormDataBoundary(const std::string& boundary,
       EncodeMIMEField(name).c_str());
 }
 
+// Returns a string containing the entire part for the form data field at
+// |name|, with the value |value|.
+std::string GetFormDataPart(const std::string& boundary,
+                            const std::string& name,
+                            const std::string& value) {
+  std::string field = GetFormDataBoundary(boundary, name);
+  field += kBoundaryCRLF;
+  field += value;
+  field += kCRLF;
+  return field;
+}
+
+// Returns a string containing the headers of the part for the file attachment
+// at |name|, after which the file’s contents can be appended.
+std::string GetFileAttachmentHeader(const std::string& boundary,
+                                    const std::string& name,
+                                    const std::string& filename,
+                                    const std::string& content_type) {
+  std::string header = GetFormDataBoundary(boundary, name);
+  header += base::StringPrintf("; filename=\"%s\"%s", filename.c_str(), kCRLF);
+  header += base::StringPrintf(
+      "Content-Type: %s%s", content_type.c_str(), kBoundaryCRLF);
+  return header;
+}
+
+// Returns the string that terminates a multipart body.
+std::string GetFinalBoundary(const std::string& boundary) {
+  return "--" + boundary + "--" + kCRLF;
+}
+
 void AssertSafeMIMEType(const std::string& string) {
   for (size_t i = 0; i < string.length(); ++i) {
     char c = string[i];
@@ -116,6 +148,7 @@ HTTPMultipartBuilder::HTTPMultipartBuilder()
     : boundary_(GenerateBoundaryString()),
       form_data_(),
       file_attachments_(),
+      gzip_compression_level_(kZlibDefaultCompressionLevel),
       gzip_enabled_(false) {}
 
 HTTPMultipartBuilder::~HTTPMultipartBuilder() {
@@ -125,6 +158,11 @@ void HTTPMultipartBuilder::SetGzipEnabled(bool gzip_enabled) {
   gzip_enabled_ = gzip_enabled;
 }
 
+void HTTPMultipartBuilder::SetGzipCompressionLevel(int level) {
+  DCHECK(ZlibIsValidCompressionLevel(level)) << level;
+  gzip_compression_level_ = level;
+}
+
 void HTTPMultipartBuilder::SetFormData(const std::string& key,
                                        const std::string& value) {
   EraseKey(key);
@@ -141,6 +179,7 @@ void HTTPMultipartBuilder::SetFileAttachment(
   FileAttachment attachment;
   attachment.filename = EncodeMIMEField(upload_file_name);
   attachment.reader = reader;
+  attachment.compressed = false;
 
   if (content_type.empty()) {
     attachment.content_type = "application/octet-stream";
@@ -152,41 +191,72 @@ void HTTPMultipartBuilder::SetFileAttachment(
   file_attachments_[key] = attachment;
 }
 
+void HTTPMultipartBuilder::SetCompressedFileAttachment(
+    const std::string& key,
+    const std::string& upload_file_name,
+    FileReaderInterface* reader,
+    const std::string& content_type) {
+  DCHECK(gzip_enabled_);
+  SetFileAttachment(key, upload_file_name, reader, content_type);
+  file_attachments_[key].compressed = true;
+}
+
 std::unique_ptr<HTTPBodyStream> HTTPMultipartBuilder::GetBodyStream() {
   // The objects inserted into this vector will be owned by the returned
   // CompositeHTTPBodyStream. Take care to not early-return without deleting
   // this memory.
   std::vector<HTTPBodyStream*> streams;
 
+  // When any attachment is already compressed, the body is assembled from runs
+  // of uncompressed streams, which will be compressed, separated by the
+  // compressed attachments, which won’t be.
+  std::unique_ptr<SplicingGzipHTTPBodyStream> splicing;
+  if (gzip_enabled_) {
+    for (const auto& pair : file_attachments_) {
+      if (pair.second.compressed) {
+        splicing = std::make_unique<SplicingGzipHTTPBodyStream>(
+            gzip_compression_level_);
+        break;
+      }
+    }
+  }
+
   for (const auto& pair : form_data_) {
-    std::string field = GetFormDataBoundary(boundary_, pair.first);
-    field += kBoundaryCRLF;
-    field += pair.second;
-    field += kCRLF;
-    streams.push_back(new StringHTTPBodyStream(field));
+    streams.push_back(new StringHTTPBodyStream(
+        GetFormDataPart(boundary_, pair.first, pair.second)));
   }
 
   for (const auto& pair : file_attachments_) {
     const FileAttachment& attachment = pair.second;
-    std::string header = GetFormDataBoundary(boundary_, pair.first);
-    header += base::StringPrintf("; filename=\"%s\"%s",
-        attachment.filename.c_str(), kCRLF);
-    header += base::StringPrintf("Content-Type: %s%s",
-        attachment.content_type.c_str(), kBoundaryCRLF);
-
-    streams.push_back(new StringHTTPBodyStream(header));
-    streams.push_back(new FileReaderHTTPBodyStream(attachment.reader));
+    streams.push_back(new StringHTTPBodyStream(
+        GetFileAttachmentHeader(boundary_,
+                                pair.first,
+                                attachment.filename,
+                                attachment.content_type)));
+    if (splicing && attachment.compressed) {
+      splicing->AddPart(std::make_unique<CompositeHTTPBodyStream>(streams));
+      streams.clear();
+      splicing->AddCompressedPart(attachment.reader);
+    } else {
+      streams.push_back(new FileReaderHTTPBodyStream(attachment.reader));
+    }
     streams.push_back(new StringHTTPBodyStream(kCRLF));
   }
 
-  streams.push_back(
-      new StringHTTPBodyStream("--"  + boundary_ + "--" + kCRLF));
+  streams.push_back(new StringHTTPBodyStream(GetFinalBoundary(boundary_)));
+
+  if (splicing) {
+    splicing->AddPart(std::make_unique<CompositeHTTPBodyStream>(streams));
+    return splicing;
+  }
 
   auto composite =
       std::unique_ptr<HTTPBodyStream>(new CompositeHTTPBodyStream(streams));
   if (gzip_enabled_) {
-    return std::unique_ptr<HTTPBodyStream>(
-        new GzipHTTPBodyStream(std::move(composite)));
+    return std::make_unique<GzipHTTPBodyStream>(
+        std::move(composite),
+        gzip_compression_level_,
+        GzipHTTPBodyStream::kDefaultInputBufferSize);
   }
   return composite;
 }
@@ -199,7 +269,46 @@ void HTTPMultipartBuilder::PopulateContentHeaders(
 
   if (gzip_enabled_) {
     (*http_headers)[kContentEncoding] = "gzip";
+    return;
   }
+
+  // The length of an uncompressed body can be determined in advance as long
+  // as the sizes of all of the attachments can be. Providing it allows the body
+  // to be sent without chunked encoding.
+  FileOffset content_length;
+  if (GetBodyLength(&content_length)) {
+    (*http_headers)[kContentLength] =
+        base::StringPrintf("%" PRId64, static_cast<int64_t>(content_length));
+  }
+}
+
+bool HTTPMultipartBuilder::GetBodyLength(FileOffset* length) const {
+  DCHECK(!gzip_enabled_);
+
+  FileOffset body_length = 0;
+  for (const auto& pair : form_data_) {
+    body_length += GetFormDataPart(boundary_, pair.first, pair.second).size();
+  }
+
+  for (const auto& pair : file_attachments_) {
+    const FileAttachment& attachment = pair.second;
+    body_length += GetFileAttachmentHeader(boundary_,
+                                           pair.first,
+                                           attachment.filename,
+                                           attachment.content_type)
+                       .size();
+
+    FileOffset file_size;
+    if (!FileReaderHTTPBodyStream(attachment.reader)
+             .GetRemainingSize(&file_size)) {
+      return false;
+    }
+    body_length += file_size + strlen(kCRLF);
+  }
+
+  body_length += GetFinalBoundary(boundary_).size();
+  *length = body_length;
+  return true;
 }
 
 void HTTPMultipartBuilder::EraseKey(const std::string& key) {
@@ -46,6 +46,14 @@ class HTTPMultipartBuilder {
   //! PopulateContentHeaders() will contain `Content-Encoding: gzip`.
   void SetGzipEnabled(bool gzip_enabled);
 
+  //! \brief Sets the level of `gzip` compression.
+  //!
+  //! \param[in] level The compression level, from `0` through
+  //!     kZlibBestCompressionLevel, or kZlibDefaultCompressionLevel, which is
+  //!     the default. Lower levels use less CPU time but produce a larger body.
+  //!     Attachments set by SetCompressedFileAttachment() are not recompressed.
+  void SetGzipCompressionLevel(int level);
+
   //! \brief Sets a `Content-Disposition: form-data` key-value pair.
   //!
   //! \param[in] key The key of the form data, specified as the `name` in the
@@ -71,6 +79,30 @@ class HTTPMultipartBuilder {
                          FileReaderInterface* reader,
                          const std::string& content_type);
 
+  //! \brief Specifies `gzip`-compressed contents read from \a reader to be
+  //!     uploaded as multipart data, available at `name` of \a
+  //!     upload_file_name.
+  //!
+  //! The compressed data is placed into the body without being decompressed
+  //! or recompressed, so this may only be used when `gzip` compression is
+  //! enabled by SetGzipEnabled(). The data read from \a reader must be a single
+  //! `gzip` member suitable for
+  //! SplicingGzipHTTPBodyStream::AddCompressedPart().
+  //!
+  //! \param[in] key The key of the form data, specified as the `name` in the
+  //!     multipart message. Any data previously set on this class with this
+  //!     key will be overwritten.
+  //! \param[in] upload_file_name The `filename` to specify for this multipart
+  //!     data attachment.
+  //! \param[in] reader A FileReaderInterface from which to read the
+  //!     compressed content to upload.
+  //! \param[in] content_type The `Content-Type` to specify for the attachment.
+  //!     If this is empty, `"application/octet-stream"` will be used.
+  void SetCompressedFileAttachment(const std::string& key,
+                                   const std::string& upload_file_name,
+                                   FileReaderInterface* reader,
+                                   const std::string& content_type);
+
   //! \brief Generates the HTTPBodyStream for the data currently supplied to
   //!     the builder.
   //!
@@ -81,6 +113,11 @@ class HTTPMultipartBuilder {
   //!
   //! Any headers that this method adds will replace existing headers by the
   //! same name in \a http_headers.
+  //!
+  //! When `gzip` compression is not enabled and the size of every file
+  //! attachment can be determined, this includes `Content-Length`, so that the
+  //! body can be sent without chunked encoding. The attachments must not be
+  //! modified between calling this method and sending the body.
   void PopulateContentHeaders(HTTPHeaders* http_headers) const;
 
  private:
@@ -88,15 +125,22 @@ class HTTPMultipartBuilder {
     std::string filename;
     std::string content_type;
     FileReaderInterface* reader;
+    bool compressed;
   };
 
   // Removes elements from both data maps at the specified |key|, to ensure
   // uniqueness across the entire HTTP body.
   void EraseKey(const std::string& key);
 
+  // Computes the length of the uncompressed body that GetBodyStream() will
+  // produce. Returns false if the size of any file attachment can’t be
+  // determined.
+  bool GetBodyLength(FileOffset* length) const;
+
   std::string boundary_;
   std::map<std::string, std::string> form_data_;
   std::map<std::string, FileAttachment> file_attachments_;
+  int gzip_compression_level_;
   bool gzip_enabled_;
 };
 
@@ -21,8 +21,10 @@
 #include "gtest/gtest.h"
 #include "test/gtest_death.h"
 #include "test/test_paths.h"
+#include "util/file/string_file.h"
 #include "util/net/http_body.h"
 #include "util/net/http_body_test_util.h"
+#include "util/net/http_headers.h"
 
 namespace crashpad {
 namespace test {
@@ -157,6 +159,54 @@ TEST(HTTPMultipartBuilder, ThreeFileAttachments) {
   EXPECT_EQ(lines_it, lines.end());
 }
 
+TEST(HTTPMultipartBuilder, ContentLength) {
+  HTTPMultipartBuilder builder;
+  builder.SetFormData("key1", "test");
+
+  base::FilePath ascii_http_body_path = TestPaths::TestDataRoot().Append(
+      FILE_PATH_LITERAL("util/net/testdata/ascii_http_body.txt"));
+  FileReader reader;
+  ASSERT_TRUE(reader.Open(ascii_http_body_path));
+  builder.SetFileAttachment("first", "minidump.dmp", &reader, "");
+
+  HTTPHeaders headers;
+  builder.PopulateContentHeaders(&headers);
+
+  std::unique_ptr<HTTPBodyStream> body(builder.GetBodyStream());
+  ASSERT_TRUE(body.get());
+  std::string contents = ReadStreamToString(body.get());
+
+  const auto content_length = headers.find(kContentLength);
+  ASSERT_NE(content_length, headers.end());
+  EXPECT_EQ(content_length->second, std::to_string(contents.size()));
+}
+
+TEST(HTTPMultipartBuilder, ContentLengthUnknown) {
+  // The size of an attachment that isn’t read directly from a file isn’t
+  // known in advance.
+  HTTPMultipartBuilder builder;
+  StringFile string_file;
+  string_file.SetString("This is a test.\n");
+  builder.SetFileAttachment("first", "minidump.dmp", &string_file, "");
+
+  HTTPHeaders headers;
+  builder.PopulateContentHeaders(&headers);
+  EXPECT_EQ(headers.find(kContentLength), headers.end());
+  EXPECT_NE(headers.find(kContentType), headers.end());
+}
+
+TEST(HTTPMultipartBuilder, ContentLengthGzip) {
+  // The length of a compressed body isn’t known in advance.
+  HTTPMultipartBuilder builder;
+  builder.SetGzipEnabled(true);
+  builder.SetFormData("key1", "test");
+
+  HTTPHeaders headers;
+  builder.PopulateContentHeaders(&headers);
+  EXPECT_EQ(headers.find(kContentLength), headers.end());
+  EXPECT_EQ(headers[kContentEncoding], "gzip");
+}
+
 TEST(HTTPMultipartBuilder, OverwriteFormDataWithEscapedKey) {
   HTTPMultipartBuilder builder;
   static constexpr char kKey[] = "a 100% \"silly\"\r\ntest";
@@ -12,13 +12,25 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <poll.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include "base/check_op.h"
 #include "base/logging.h"
@@ -29,12 +41,17 @@
 #include "base/strings/stringprintf.h"
 #include "build/build_config.h"
 #include "util/file/file_io.h"
+#include "util/misc/clock.h"
 #include "util/net/http_body.h"
 #include "util/net/http_transport.h"
 #include "util/net/url.h"
 #include "util/stdlib/string_number_conversion.h"
 #include "util/string/split_string.h"
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include <sys/sendfile.h>
+#endif
+
 #if defined(CRASHPAD_USE_BORINGSSL)
 #include <openssl/ssl.h>
 #endif
@@ -45,6 +62,15 @@ namespace {
 
 constexpr const char kCRLFTerminator[] = "\r\n";
 
+// Idle connections are kept open for reuse by later requests to the same
+// server for at most this long, and at most this many are kept.
+constexpr uint64_t kIdleConnectionTimeoutNanoseconds = 30 * 1000000000ull;
+constexpr size_t kMaxIdleConnections = 8;
+
+// getaddrinfo() doesn’t expose the time-to-live of the records it returns, so
+// host name resolutions are cached for a fixed time.
+constexpr uint64_t kResolutionTimeoutNanoseconds = 60 * 1000000000ull;
+
 class HTTPTransportSocket final : public HTTPTransport {
  public:
   HTTPTransportSocket() = default;
@@ -70,6 +96,38 @@ class Stream {
   virtual bool LoggingWrite(const void* data, size_t size) = 0;
   virtual bool LoggingRead(void* data, size_t size) = 0;
   virtual bool LoggingReadToEOF(std::string* contents) = 0;
+
+  // Writes size bytes from file, starting at offset, without changing the
+  // file’s position. Streams that can’t transfer data directly from a file
+  // copy it through a buffer.
+  virtual bool LoggingSendFile(FileHandle file,
+                               FileOffset offset,
+                               FileOffset size) {
+    std::vector<uint8_t> buffer(
+        std::min(size, FileOffset{kSendFileBufferSize}));
+    while (size > 0) {
+      size_t read_size =
+          static_cast<size_t>(std::min(size, FileOffset{kSendFileBufferSize}));
+      ssize_t rv = HANDLE_EINTR(pread(file, buffer.data(), read_size, offset));
+      if (rv < 0) {
+        PLOG(ERROR) << "pread";
+        return false;
+      }
+      if (rv == 0) {
+        LOG(ERROR) << "pread: unexpected EOF";
+        return false;
+      }
+      if (!LoggingWrite(buffer.data(), rv)) {
+        return false;
+      }
+      offset += rv;
+      size -= rv;
+    }
+    return true;
+  }
+
+ private:
+  static constexpr size_t kSendFileBufferSize = 64 * 1024;
 };
 
 class FdStream : public Stream {
@@ -91,62 +149,109 @@ class FdStream : public Stream {
     return crashpad::LoggingReadToEOF(fd_, result);
   }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  bool LoggingSendFile(FileHandle file,
+                       FileOffset offset,
+                       FileOffset size) override {
+    // sendfile() transfers the data within the kernel, without copying it
+    // through a buffer here.
+    off_t file_offset = offset;
+    while (size > 0) {
+      ssize_t rv = HANDLE_EINTR(sendfile(
+          fd_, file, &file_offset, base::saturated_cast<size_t>(size)));
+      if (rv < 0) {
+        if (errno == EINVAL || errno == ENOSYS) {
+          // The file doesn’t support sendfile().
+          return Stream::LoggingSendFile(file, file_offset, size);
+        }
+        PLOG(ERROR) << "sendfile";
+        return false;
+      }
+      if (rv == 0) {
+        LOG(ERROR) << "sendfile: unexpected EOF";
+        return false;
+      }
+      size -= rv;
+    }
+    return true;
+  }
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+
  private:
   int fd_;
 };
 
 #if defined(CRASHPAD_USE_BORINGSSL)
-class SSLStream : public Stream {
- public:
-  SSLStream() = default;
+struct ScopedSSLCTXTraits {
+  static SSL_CTX* InvalidValue() { return nullptr; }
+  static void Free(SSL_CTX* ctx) { SSL_CTX_free(ctx); }
+};
+using ScopedSSLCTX = base::ScopedGeneric<SSL_CTX*, ScopedSSLCTXTraits>;
 
-  SSLStream(const SSLStream&) = delete;
-  SSLStream& operator=(const SSLStream&) = delete;
+struct ScopedSSLSessionTraits {
+  static SSL_SESSION* InvalidValue() { return nullptr; }
+  static void Free(SSL_SESSION* session) { SSL_SESSION_free(session); }
+};
+using ScopedSSLSession =
+    base::ScopedGeneric<SSL_SESSION*, ScopedSSLSessionTraits>;
 
-  bool Initialize(const base::FilePath& root_cert_path,
-                  int sock,
-                  const std::string& hostname) {
-    SSL_library_init();
+ScopedSSLCTX CreateSSLContext(const base::FilePath& root_cert_path) {
+  SSL_library_init();
 
-    ctx_.reset(SSL_CTX_new(TLS_method()));
-    if (!ctx_.is_valid()) {
-      LOG(ERROR) << "SSL_CTX_new";
-      return false;
-    }
+  ScopedSSLCTX ctx(SSL_CTX_new(TLS_method()));
+  if (!ctx.is_valid()) {
+    LOG(ERROR) << "SSL_CTX_new";
+    return ScopedSSLCTX();
+  }
 
-    if (SSL_CTX_set_min_proto_version(ctx_.get(), TLS1_2_VERSION) <= 0) {
-      LOG(ERROR) << "SSL_CTX_set_min_proto_version";
-      return false;
-    }
+  if (SSL_CTX_set_min_proto_version(ctx.get(), TLS1_2_VERSION) <= 0) {
+    LOG(ERROR) << "SSL_CTX_set_min_proto_version";
+    return ScopedSSLCTX();
+  }
 
-    SSL_CTX_set_verify(ctx_.get(), SSL_VERIFY_PEER, nullptr);
-    SSL_CTX_set_verify_depth(ctx_.get(), 5);
+  SSL_CTX_set_verify(ctx.get(), SSL_VERIFY_PEER, nullptr);
+  SSL_CTX_set_verify_depth(ctx.get(), 5);
 
-    if (!root_cert_path.empty()) {
-      if (SSL_CTX_load_verify_locations(
-              ctx_.get(), root_cert_path.value().c_str(), nullptr) <= 0) {
-        LOG(ERROR) << "SSL_CTX_load_verify_locations";
-        return false;
-      }
-    } else {
+  if (!root_cert_path.empty()) {
+    if (SSL_CTX_load_verify_locations(
+            ctx.get(), root_cert_path.value().c_str(), nullptr) <= 0) {
+      LOG(ERROR) << "SSL_CTX_load_verify_locations";
+      return ScopedSSLCTX();
+    }
+  } else {
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
-      if (SSL_CTX_load_verify_locations(
-              ctx_.get(), nullptr, "/etc/ssl/certs") <= 0) {
-        LOG(ERROR) << "SSL_CTX_load_verify_locations";
-        return false;
-      }
+    if (SSL_CTX_load_verify_locations(ctx.get(), nullptr, "/etc/ssl/certs") <=
+        0) {
+      LOG(ERROR) << "SSL_CTX_load_verify_locations";
+      return ScopedSSLCTX();
+    }
 #elif BUILDFLAG(IS_FUCHSIA)
-      if (SSL_CTX_load_verify_locations(
-              ctx_.get(), "/config/ssl/cert.pem", nullptr) <= 0) {
-        LOG(ERROR) << "SSL_CTX_load_verify_locations";
-        return false;
-      }
+    if (SSL_CTX_load_verify_locations(
+            ctx.get(), "/config/ssl/cert.pem", nullptr) <= 0) {
+      LOG(ERROR) << "SSL_CTX_load_verify_locations";
+      return ScopedSSLCTX();
+    }
 #else
 #error cert store location
 #endif
-    }
+  }
 
-    ssl_.reset(SSL_new(ctx_.get()));
+  return ctx;
+}
+
+class SSLStream : public Stream {
+ public:
+  SSLStream() = default;
+
+  SSLStream(const SSLStream&) = delete;
+  SSLStream& operator=(const SSLStream&) = delete;
+
+  bool Initialize(SSL_CTX* ctx,
+                  SSL_SESSION* session,
+                  int sock,
+                  const std::string& hostname) {
+    ssl_.reset(SSL_new(ctx));
     if (!ssl_.is_valid()) {
       LOG(ERROR) << "SSL_new";
       return false;
@@ -166,6 +271,12 @@ class SSLStream : public Stream {
       return false;
     }
 
+    // Offer to resume a session established by an earlier connection. If the
+    // server declines, a full handshake takes place.
+    if (session && SSL_set_session(ssl_.get(), session) == 0) {
+      LOG(WARNING) << "SSL_set_session";
+    }
+
     if (SSL_connect(ssl_.get()) <= 0) {
       LOG(ERROR) << "SSL_connect";
       return false;
@@ -174,12 +285,34 @@ class SSLStream : public Stream {
     return true;
   }
 
+  // Returns the session most recently established on this connection, which
+  // may be used to resume it on a later connection.
+  ScopedSSLSession GetSession() {
+    return ScopedSSLSession(SSL_get1_session(ssl_.get()));
+  }
+
   bool LoggingWrite(const void* data, size_t size) override {
-    return SSL_write(ssl_.get(), data, size) != 0;
+    if (SSL_write(ssl_.get(), data, base::checked_cast<int>(size)) <= 0) {
+      LOG(ERROR) << "SSL_write";
+      return false;
+    }
+    return true;
   }
 
   bool LoggingRead(void* data, size_t size) override {
-    return SSL_read(ssl_.get(), data, size) != 0;
+    // A connection may carry more than one response, so exactly |size| bytes
+    // must be read, and no more.
+    char* buffer = static_cast<char*>(data);
+    while (size > 0) {
+      int rv = SSL_read(ssl_.get(), buffer, base::saturated_cast<int>(size));
+      if (rv <= 0) {
+        LOG(ERROR) << "SSL_read";
+        return false;
+      }
+      buffer += rv;
+      size -= rv;
+    }
+    return true;
   }
 
   bool LoggingReadToEOF(std::string* contents) override {
@@ -199,12 +332,6 @@ class SSLStream : public Stream {
   }
 
  private:
-  struct ScopedSSLCTXTraits {
-    static SSL_CTX* InvalidValue() { return nullptr; }
-    static void Free(SSL_CTX* ctx) { SSL_CTX_free(ctx); }
-  };
-  using ScopedSSLCTX = base::ScopedGeneric<SSL_CTX*, ScopedSSLCTXTraits>;
-
   struct ScopedSSLTraits {
     static SSL* InvalidValue() { return nullptr; }
     static void Free(SSL* ssl) {
@@ -214,7 +341,6 @@ class SSLStream : public Stream {
   };
   using ScopedSSL = base::ScopedGeneric<SSL*, ScopedSSLTraits>;
 
-  ScopedSSLCTX ctx_;
   ScopedSSL ssl_;
 };
 #endif
@@ -287,40 +413,317 @@ class ScopedSetNonblocking {
   int sock_;
 };
 
+// A connection to a server, which may carry more than one request.
+class Connection {
+ public:
+  Connection(const std::string& key, base::ScopedFD sock)
+      : key_(key),
+        sock_(std::move(sock)),
+        stream_(),
+#if defined(CRASHPAD_USE_BORINGSSL)
+        ssl_stream_(nullptr),
+#endif
+        idle_since_(0) {
+  }
+
+  Connection(const Connection&) = delete;
+  Connection& operator=(const Connection&) = delete;
+
+  const std::string& key() const { return key_; }
+  int sock() const { return sock_.get(); }
+  Stream* stream() const { return stream_.get(); }
+
+  void SetStream(std::unique_ptr<Stream> stream) {
+    stream_ = std::move(stream);
+  }
+
+#if defined(CRASHPAD_USE_BORINGSSL)
+  SSLStream* ssl_stream() const { return ssl_stream_; }
+
+  void SetSSLStream(std::unique_ptr<SSLStream> ssl_stream) {
+    ssl_stream_ = ssl_stream.get();
+    stream_ = std::move(ssl_stream);
+  }
+#endif
+
+  uint64_t idle_since() const { return idle_since_; }
+  void set_idle_since(uint64_t idle_since) { idle_since_ = idle_since; }
+
+  // Returns true if nothing has arrived on the connection while it was idle.
+  // When the server closes an idle connection, the end of the stream becomes
+  // readable, and the connection must not be used again.
+  bool IsIdle() const {
+    pollfd pollfds;
+    pollfds.fd = sock_.get();
+    pollfds.events = POLLIN;
+    pollfds.revents = 0;
+    return HANDLE_EINTR(poll(&pollfds, 1, 0)) == 0;
+  }
+
+ private:
+  std::string key_;
+  base::ScopedFD sock_;
+
+  // Declared after sock_ so that it’s destroyed first, because an SSLStream
+  // writes to the socket while shutting down.
+  std::unique_ptr<Stream> stream_;
+
+#if defined(CRASHPAD_USE_BORINGSSL)
+  // Weak, owned by stream_ when not nullptr.
+  SSLStream* ssl_stream_;
+#endif
+
+  uint64_t idle_since_;
+};
+
+// An address to which a socket may connect, as returned by getaddrinfo().
+struct ResolvedAddress {
+  int family;
+  int socktype;
+  int protocol;
+  socklen_t address_length;
+  sockaddr_storage address;
+};
+
+// State shared by all HTTPTransportSocket objects in a process, so that
+// requests made to a server by one HTTPTransportSocket can reuse the
+// connection, TLS session, and host name resolution from earlier requests made
+// by others. A new HTTPTransportSocket is created for each report upload, and
+// uploads may take place on more than one thread.
+class ConnectionPool {
+ public:
+  ConnectionPool(const ConnectionPool&) = delete;
+  ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+  static ConnectionPool* Get() {
+    static ConnectionPool* instance = new ConnectionPool();
+    return instance;
+  }
+
+  // Removes an idle connection for |key| from the pool and returns it, or
+  // returns nullptr if none is available.
+  std::unique_ptr<Connection> TakeIdleConnection(const std::string& key) {
+    // Connections that can’t be reused are destroyed after the lock is
+    // released.
+    std::vector<std::unique_ptr<Connection>> expired_connections;
+    std::lock_guard<std::mutex> lock(lock_);
+    RemoveExpiredConnections(&expired_connections);
+
+    // Prefer the connection that became idle most recently, because it’s the
+    // least likely to have been closed by the server.
+    for (auto rit = idle_connections_.rbegin(); rit != idle_connections_.rend();
+         ++rit) {
+      if ((*rit)->key() == key) {
+        std::unique_ptr<Connection> connection = std::move(*rit);
+        idle_connections_.erase(std::next(rit).base());
+        return connection;
+      }
+    }
+    return nullptr;
+  }
+
+  // Adds |connection|, which must have completed a request and response, to
+  // the pool so that it may be used by a later request.
+  void ReturnIdleConnection(std::unique_ptr<Connection> connection) {
+    // Connections that can’t be reused are destroyed after the lock is
+    // released, so that sockets to servers that aren’t contacted again don’t
+    // linger until the process exits.
+    std::vector<std::unique_ptr<Connection>> expired_connections;
+    std::lock_guard<std::mutex> lock(lock_);
+    RemoveExpiredConnections(&expired_connections);
+    connection->set_idle_since(ClockMonotonicNanoseconds());
+    idle_connections_.push_back(std::move(connection));
+    if (idle_connections_.size() > kMaxIdleConnections) {
+      expired_connections.push_back(std::move(idle_connections_.front()));
+      idle_connections_.erase(idle_connections_.begin());
+    }
+  }
+
+  // Resolves |hostname| and |port| to the addresses that a socket may connect
+  // to, reusing a recent resolution if one is available.
+  bool Resolve(const std::string& hostname,
+               const std::string& port,
+               std::vector<ResolvedAddress>* addresses) {
+    const std::string key = hostname + ":" + port;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      auto it = resolutions_.find(key);
+      if (it != resolutions_.end() &&
+          ClockMonotonicNanoseconds() - it->second.resolved_at <
+              kResolutionTimeoutNanoseconds) {
+        *addresses = it->second.addresses;
+        return true;
+      }
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = 0;
+    hints.ai_flags = 0;
+
+    addrinfo* addrinfo_raw;
+    if (getaddrinfo(hostname.c_str(), port.c_str(), &hints, &addrinfo_raw) <
+        0) {
+      PLOG(ERROR) << "getaddrinfo";
+      return false;
+    }
+    ScopedAddrinfo addrinfo(addrinfo_raw);
+
+    Resolution resolution;
+    resolution.resolved_at = ClockMonotonicNanoseconds();
+    for (const auto* ap = addrinfo.get(); ap; ap = ap->ai_next) {
+      if (ap->ai_addrlen > sizeof(ResolvedAddress::address)) {
+        continue;
+      }
+      ResolvedAddress address = {};
+      address.family = ap->ai_family;
+      address.socktype = ap->ai_socktype;
+      address.protocol = ap->ai_protocol;
+      address.address_length = ap->ai_addrlen;
+      memcpy(&address.address, ap->ai_addr, ap->ai_addrlen);
+      resolution.addresses.push_back(address);
+    }
+
+    *addresses = resolution.addresses;
+
+    std::lock_guard<std::mutex> lock(lock_);
+    resolutions_[key] = std::move(resolution);
+    return true;
+  }
+
+  // Discards any cached resolution of |hostname| and |port|, so that the next
+  // connection attempt resolves it again.
+  void ForgetResolution(const std::string& hostname, const std::string& port) {
+    std::lock_guard<std::mutex> lock(lock_);
+    resolutions_.erase(hostname + ":" + port);
+  }
+
+#if defined(CRASHPAD_USE_BORINGSSL)
+  // Returns a context for TLS connections verified against the certificates at
+  // |root_cert_path|, or the system’s certificates if it is empty. The context
+  // is owned by the pool.
+  SSL_CTX* GetSSLContext(const base::FilePath& root_cert_path) {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = ssl_contexts_.find(root_cert_path.value());
+    if (it != ssl_contexts_.end()) {
+      return it->second.get();
+    }
+
+    ScopedSSLCTX ctx(CreateSSLContext(root_cert_path));
+    if (!ctx.is_valid()) {
+      return nullptr;
+    }
+    SSL_CTX* ctx_raw = ctx.get();
+    ssl_contexts_[root_cert_path.value()] = std::move(ctx);
+    return ctx_raw;
+  }
+
+  // Returns a new reference to the TLS session most recently established for
+  // |key|, or an invalid session if there is none.
+  ScopedSSLSession GetSSLSession(const std::string& key) {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = ssl_sessions_.find(key);
+    if (it == ssl_sessions_.end()) {
+      return ScopedSSLSession();
+    }
+    SSL_SESSION_up_ref(it->second.get());
+    return ScopedSSLSession(it->second.get());
+  }
+
+  void SetSSLSession(const std::string& key, ScopedSSLSession session) {
+    std::lock_guard<std::mutex> lock(lock_);
+    ssl_sessions_[key] = std::move(session);
+  }
+#endif  // CRASHPAD_USE_BORINGSSL
+
+ private:
+  struct Resolution {
+    uint64_t resolved_at;
+    std::vector<ResolvedAddress> addresses;
+  };
+
+  ConnectionPool() = default;
+  ~ConnectionPool() = delete;
+
+  // Moves connections that have been idle for too long, or that the server has
+  // closed, from idle_connections_ to |expired_connections|. lock_ must be
+  // held.
+  void RemoveExpiredConnections(
+      std::vector<std::unique_ptr<Connection>>* expired_connections) {
+    const uint64_t now = ClockMonotonicNanoseconds();
+    auto it = idle_connections_.begin();
+    while (it != idle_connections_.end()) {
+      if (now - (*it)->idle_since() >= kIdleConnectionTimeoutNanoseconds ||
+          !(*it)->IsIdle()) {
+        expired_connections->push_back(std::move(*it));
+        it = idle_connections_.erase(it);
+        continue;
+      }
+      ++it;
+    }
+  }
+
+  std::mutex lock_;
+
+  // Ordered by the time that each connection became idle, oldest first.
+  std::vector<std::unique_ptr<Connection>> idle_connections_;
+
+  // Keyed by host name and port.
+  std::map<std::string, Resolution> resolutions_;
+
+#if defined(CRASHPAD_USE_BORINGSSL)
+  // Keyed by root certificate path.
+  std::map<std::string, ScopedSSLCTX> ssl_contexts_;
+
+  // Keyed by connection key.
+  std::map<std::string, ScopedSSLSession> ssl_sessions_;
+#endif
+};
+
 base::ScopedFD CreateSocket(const std::string& hostname,
                             const std::string& port) {
-  addrinfo hints = {};
-  hints.ai_family = AF_UNSPEC;
-  hints.ai_socktype = SOCK_STREAM;
-  hints.ai_protocol = 0;
-  hints.ai_flags = 0;
-
-  addrinfo* addrinfo_raw;
-  if (getaddrinfo(hostname.c_str(), port.c_str(), &hints, &addrinfo_raw) < 0) {
-    PLOG(ERROR) << "getaddrinfo";
+  ConnectionPool* pool = ConnectionPool::Get();
+  std::vector<ResolvedAddress> addresses;
+  if (!pool->Resolve(hostname, port, &addresses)) {
     return base::ScopedFD();
   }
-  ScopedAddrinfo addrinfo(addrinfo_raw);
 
-  for (const auto* ap = addrinfo.get(); ap; ap = ap->ai_next) {
+  for (const ResolvedAddress& address : addresses) {
     base::ScopedFD result(
-        socket(ap->ai_family, ap->ai_socktype, ap->ai_protocol));
+        socket(address.family, address.socktype, address.protocol));
     if (!result.is_valid()) {
       continue;
     }
 
+    // The request header and body are written separately, and a response is
+    // awaited after each request. With Nagle’s algorithm, the body would be
+    // held until the server acknowledged the header, which it may delay.
+    int nodelay = 1;
+    if (setsockopt(result.get(),
+                   IPPROTO_TCP,
+                   TCP_NODELAY,
+                   &nodelay,
+                   sizeof(nodelay)) != 0) {
+      PLOG(WARNING) << "setsockopt";
+    }
+
     {
       // Set socket to non-blocking to avoid hanging for a long time if the
       // network is down.
       ScopedSetNonblocking nonblocking(result.get());
 
-      if (HANDLE_EINTR(connect(result.get(), ap->ai_addr, ap->ai_addrlen)) <
-          0) {
+      if (HANDLE_EINTR(connect(result.get(),
+                               reinterpret_cast<const sockaddr*>(
+                                   &address.address),
+                               address.address_length)) < 0) {
         if (errno != EINPROGRESS) {
           PLOG(ERROR) << "connect";
         } else if (WaitUntilSocketIsReady(result.get())) {
           return result;
         }
+        // The cached resolution may be stale.
+        pool->ForgetResolution(hostname, port);
         return base::ScopedFD();
       }
 
@@ -328,50 +731,152 @@ base::ScopedFD CreateSocket(const std::string& hostname,
     }
   }
 
+  pool->ForgetResolution(hostname, port);
   return base::ScopedFD();
 }
 
+// Returns a key identifying the connections and TLS sessions that may be
+// reused for a request. TLS connections are only shared among requests that
+// verify the server against the same certificates.
+std::string ConnectionKey(const std::string& scheme,
+                          const std::string& hostname,
+                          const std::string& port,
+                          const base::FilePath& root_cert_path) {
+  std::string key = scheme + "://" + hostname + ":" + port;
+  if (scheme == "https") {
+    key += " " + root_cert_path.value();
+  }
+  return key;
+}
+
+std::unique_ptr<Connection> Connect(const std::string& scheme,
+                                    const std::string& hostname,
+                                    const std::string& port,
+                                    const std::string& key,
+                                    const base::FilePath& root_cert_path) {
+  base::ScopedFD sock(CreateSocket(hostname, port));
+  if (!sock.is_valid()) {
+    return nullptr;
+  }
+
+  auto connection = std::make_unique<Connection>(key, std::move(sock));
+
+#if defined(CRASHPAD_USE_BORINGSSL)
+  if (scheme == "https") {
+    ConnectionPool* pool = ConnectionPool::Get();
+    SSL_CTX* ctx = pool->GetSSLContext(root_cert_path);
+    if (!ctx) {
+      return nullptr;
+    }
+
+    ScopedSSLSession session(pool->GetSSLSession(key));
+    auto ssl_stream = std::make_unique<SSLStream>();
+    if (!ssl_stream->Initialize(
+            ctx, session.get(), connection->sock(), hostname)) {
+      LOG(ERROR) << "SSLStream Initialize";
+      return nullptr;
+    }
+    connection->SetSSLStream(std::move(ssl_stream));
+    return connection;
+  }
+#endif  // CRASHPAD_USE_BORINGSSL
+
+  connection->SetStream(std::make_unique<FdStream>(connection->sock()));
+  return connection;
+}
+
+// Returns the value of the header named |name|, compared case-insensitively,
+// or nullptr if there is no such header.
+const std::string* FindHeader(const HTTPHeaders& headers, const char* name) {
+  for (const auto& header : headers) {
+    if (strcasecmp(header.first.c_str(), name) == 0) {
+      return &header.second;
+    }
+  }
+  return nullptr;
+}
+
+// Writes size bytes from file at offset as part of a request body, as a single
+// chunk if chunked is true.
+bool WriteFileRange(Stream* stream,
+                    bool chunked,
+                    FileHandle file,
+                    FileOffset offset,
+                    FileOffset size) {
+  if (chunked) {
+    std::string chunk_header = base::StringPrintf(
+        "%" PRIx64 "%s", static_cast<uint64_t>(size), kCRLFTerminator);
+    if (!stream->LoggingWrite(chunk_header.data(), chunk_header.size())) {
+      return false;
+    }
+  }
+
+  if (!stream->LoggingSendFile(file, offset, size)) {
+    return false;
+  }
+
+  return !chunked || stream->LoggingWrite(kCRLFTerminator,
+                                          std::size(kCRLFTerminator) - 1);
+}
+
 bool WriteRequest(Stream* stream,
                   const std::string& method,
+                  const std::string& host,
                   const std::string& resource,
                   const HTTPHeaders& headers,
                   HTTPBodyStream* body_stream) {
-  std::string request_line = base::StringPrintf(
-      "%s %s HTTP/1.0\r\n", method.c_str(), resource.c_str());
-  if (!stream->LoggingWrite(request_line.data(), request_line.size()))
-    return false;
+  // HTTP/1.1 is required for the connection to persist after the response
+  // without further negotiation, and it requires a Host header.
+  //
+  // The request line and headers are collected and written at once, so that
+  // they aren’t split into many small packets.
+  std::string request_header = base::StringPrintf(
+      "%s %s HTTP/1.1\r\n", method.c_str(), resource.c_str());
+  if (!FindHeader(headers, "Host")) {
+    request_header += base::StringPrintf("Host: %s\r\n", host.c_str());
+  }
 
   // Write headers, and determine if Content-Length has been specified.
   bool chunked = true;
   size_t content_length = 0;
   for (const auto& header : headers) {
-    std::string header_str = base::StringPrintf(
+    request_header += base::StringPrintf(
         "%s: %s\r\n", header.first.c_str(), header.second.c_str());
     if (header.first == kContentLength) {
       chunked = !base::StringToSizeT(header.second, &content_length);
       DCHECK(!chunked);
     }
-
-    if (!stream->LoggingWrite(header_str.data(), header_str.size()))
-      return false;
   }
 
   // If no Content-Length, then encode as chunked, so add that header too.
   if (chunked) {
-    static constexpr const char kTransferEncodingChunked[] =
-        "Transfer-Encoding: chunked\r\n";
-    if (!stream->LoggingWrite(kTransferEncodingChunked,
-                              strlen(kTransferEncodingChunked))) {
-      return false;
-    }
+    request_header += "Transfer-Encoding: chunked\r\n";
   }
 
-  if (!stream->LoggingWrite(kCRLFTerminator, strlen(kCRLFTerminator))) {
+  request_header += kCRLFTerminator;
+  if (!stream->LoggingWrite(request_header.data(), request_header.size())) {
     return false;
   }
 
+  FileOffset body_size = 0;
   FileOperationResult data_bytes;
   do {
+    // Parts of the body available from a file are transferred directly from
+    // it, without being copied through buf.
+    for (;;) {
+      FileOffset file_offset;
+      FileOffset file_size;
+      FileHandle file = body_stream->GetFileRange(&file_offset, &file_size);
+      if (file == kInvalidFileHandle) {
+        break;
+      }
+      if (!WriteFileRange(stream, chunked, file, file_offset, file_size) ||
+          !body_stream->SkipFileRange(file_size)) {
+        return false;
+      }
+      body_size += file_size;
+    }
+
     constexpr size_t kCRLFSize = std::size(kCRLFTerminator) - 1;
     struct __attribute__((packed)) {
       char size[8];
@@ -390,6 +895,7 @@ bool WriteRequest(Stream* stream,
     }
     DCHECK_GE(data_bytes, 0);
     DCHECK_LE(static_cast<size_t>(data_bytes), sizeof(buf.data) - kCRLFSize);
+    body_size += data_bytes;
 
     void* write_start;
     size_t write_size;
@@ -438,6 +944,14 @@ bool WriteRequest(Stream* stream,
     }
   } while (data_bytes > 0);
 
+  // A body that doesn’t match its Content-Length would leave the server
+  // waiting for more data, or misinterpreting the remainder as another request.
+  if (!chunked && body_size != base::checked_cast<FileOffset>(content_length)) {
+    LOG(ERROR) << "body size " << body_size << " != Content-Length "
+               << content_length;
+    return false;
+  }
+
   return true;
 }
 
@@ -459,24 +973,35 @@ bool StartsWith(const std::string& str, const char* with, size_t len) {
   return str.compare(0, len, with) == 0;
 }
 
-bool ReadResponseLine(Stream* stream) {
+// On success, |persistent| is set to whether the connection persists after the
+// response by default, absent a Connection header. |response_started| is set to
+// whether any part of the response was received, even on failure.
+bool ReadResponseLine(Stream* stream,
+                      bool* persistent,
+                      bool* response_started) {
   std::string response_line;
-  if (!ReadLine(stream, &response_line)) {
+  const bool read_line = ReadLine(stream, &response_line);
+  *response_started = !response_line.empty();
+  if (!read_line) {
     LOG(ERROR) << "ReadLine";
     return false;
   }
   static constexpr const char kHttp10[] = "HTTP/1.0 ";
   static constexpr const char kHttp11[] = "HTTP/1.1 ";
-  if (!(StartsWith(response_line, kHttp10, strlen(kHttp10)) ||
-        StartsWith(response_line, kHttp11, strlen(kHttp11))) ||
+  const bool http_11 = StartsWith(response_line, kHttp11, strlen(kHttp11));
+  if (!(StartsWith(response_line, kHttp10, strlen(kHttp10)) || http_11) ||
       response_line.size() < strlen(kHttp10) + 3 ||
       response_line.at(strlen(kHttp10) + 3) != ' ') {
     return false;
   }
   unsigned int http_status = 0;
-  return base::StringToUint(response_line.substr(strlen(kHttp10), 3),
-                            &http_status) &&
-         http_status >= 200 && http_status <= 203;
+  if (!base::StringToUint(response_line.substr(strlen(kHttp10), 3),
+                          &http_status) ||
+      http_status < 200 || http_status > 203) {
+    return false;
+  }
+  *persistent = http_11;
+  return true;
 }
 
 bool ReadResponseHeaders(Stream* stream, HTTPHeaders* headers) {
@@ -505,15 +1030,78 @@ bool ReadResponseHeaders(Stream* stream, HTTPHeaders* headers) {
 }
 
 bool ReadContentChunked(Stream* stream, std::string* body) {
-  // TODO(scottmg): https://crashpad.chromium.org/bug/196.
-  LOG(ERROR) << "TODO(scottmg): chunked response read";
-  return false;
+  for (;;) {
+    std::string line;
+    if (!ReadLine(stream, &line)) {
+      return false;
+    }
+
+    // The chunk size is in hexadecimal, and may be followed by extensions,
+    // which are ignored.
+    size_t chunk_size = 0;
+    size_t digits = 0;
+    for (; digits < line.size(); ++digits) {
+      const char c = line[digits];
+      unsigned int value;
+      if (c >= '0' && c <= '9') {
+        value = c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        value = c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        value = c - 'A' + 10;
+      } else {
+        break;
+      }
+      if (digits == sizeof(chunk_size) * 2) {
+        LOG(ERROR) << "chunk size overflow";
+        return false;
+      }
+      chunk_size = chunk_size * 16 + value;
+    }
+    if (digits == 0) {
+      LOG(ERROR) << "invalid chunk size";
+      return false;
+    }
+
+    if (chunk_size == 0) {
+      // Skip any trailer fields up to the empty line that ends the body.
+      do {
+        if (!ReadLine(stream, &line)) {
+          return false;
+        }
+      } while (line != kCRLFTerminator);
+      return true;
+    }
+
+    const size_t offset = body->size();
+    body->resize(offset + chunk_size);
+    if (!stream->LoggingRead(&(*body)[offset], chunk_size)) {
+      return false;
+    }
+
+    char crlf[2];
+    if (!stream->LoggingRead(crlf, sizeof(crlf))) {
+      return false;
+    }
+    if (memcmp(crlf, kCRLFTerminator, sizeof(crlf)) != 0) {
+      LOG(ERROR) << "invalid chunk terminator";
+      return false;
+    }
+  }
 }
 
-bool ReadResponse(Stream* stream, std::string* response_body) {
+// On success, |keep_alive| is set to whether the connection may be used for
+// another request. |response_started| is set to whether any part of the
+// response was received, even on failure.
+bool ReadResponse(Stream* stream,
+                  std::string* response_body,
+                  bool* keep_alive,
+                  bool* response_started) {
   response_body->clear();
+  *keep_alive = false;
 
-  if (!ReadResponseLine(stream)) {
+  bool persistent;
+  if (!ReadResponseLine(stream, &persistent, response_started)) {
     return false;
   }
 
@@ -522,28 +1110,49 @@ bool ReadResponse(Stream* stream, std::string* response_body) {
     return false;
   }
 
-  auto it = response_headers.find("Content-Length");
-  size_t len = 0;
-  if (it != response_headers.end()) {
-    if (!base::StringToSizeT(it->second, &len)) {
+  const std::string* connection = FindHeader(response_headers, "Connection");
+  if (connection) {
+    if (strcasecmp(connection->c_str(), "close") == 0) {
+      persistent = false;
+    } else if (strcasecmp(connection->c_str(), "keep-alive") == 0) {
+      persistent = true;
+    }
+  }
+
+  const std::string* content_length =
+      FindHeader(response_headers, kContentLength);
+  if (content_length) {
+    size_t len;
+    if (!base::StringToSizeT(*content_length, &len)) {
       LOG(ERROR) << "invalid Content-Length";
       return false;
     }
-  }
 
-  if (len) {
-    response_body->resize(len, 0);
-    return stream->LoggingRead(&(*response_body)[0], len);
+    if (len) {
+      response_body->resize(len, 0);
+      if (!stream->LoggingRead(&(*response_body)[0], len)) {
+        return false;
+      }
+    }
+
+    *keep_alive = persistent;
+    return true;
   }
 
-  it = response_headers.find("Transfer-Encoding");
-  bool chunked = false;
-  if (it != response_headers.end() && it->second == "chunked") {
-    chunked = true;
+  const std::string* transfer_encoding =
+      FindHeader(response_headers, "Transfer-Encoding");
+  if (transfer_encoding && *transfer_encoding == "chunked") {
+    if (!ReadContentChunked(stream, response_body)) {
+      return false;
+    }
+
+    *keep_alive = persistent;
+    return true;
   }
 
-  return chunked ? ReadContentChunked(stream, response_body)
-                 : stream->LoggingReadToEOF(response_body);
+  // Without a length, the body extends to the end of the stream, so the
+  // connection can’t be used again.
+  return stream->LoggingReadToEOF(response_body);
 }
 
 bool HTTPTransportSocket::ExecuteSynchronously(std::string* response_body) {
@@ -557,35 +1166,65 @@ bool HTTPTransportSocket::ExecuteSynchronously(std::string* response_body) {
                           << "'";
 #endif
 
-  base::ScopedFD sock(CreateSocket(hostname, port));
-  if (!sock.is_valid()) {
-    return false;
+  ConnectionPool* pool = ConnectionPool::Get();
+  const std::string key =
+      ConnectionKey(scheme, hostname, port, root_ca_certificate_path());
+  std::unique_ptr<Connection> connection(pool->TakeIdleConnection(key));
+  bool reused = connection != nullptr;
+
+  std::string host = hostname;
+  if (port != (scheme == "https" ? "443" : "80")) {
+    host += ":" + port;
   }
 
-#if defined(CRASHPAD_USE_BORINGSSL)
-  std::unique_ptr<Stream> stream;
-  if (scheme == "https") {
-    auto ssl_stream = std::make_unique<SSLStream>();
-    if (!ssl_stream->Initialize(
-            root_ca_certificate_path(), sock.get(), hostname)) {
-      LOG(ERROR) << "SSLStream Initialize";
+  bool keep_alive;
+  for (;;) {
+    if (!connection) {
+      connection =
+          Connect(scheme, hostname, port, key, root_ca_certificate_path());
+      if (!connection) {
+        return false;
+      }
+    }
+
+    bool response_started = false;
+    if (WriteRequest(connection->stream(),
+                     method(),
+                     host,
+                     resource,
+                     headers(),
+                     body_stream()) &&
+        ReadResponse(connection->stream(),
+                     response_body,
+                     &keep_alive,
+                     &response_started)) {
+      break;
+    }
+
+    // The server may close an idle connection at any time, including after
+    // the pool checked it, in which case no response arrives. Retry once on a
+    // new connection, where a failure isn’t caused by a stale connection.
+    if (!reused || response_started || !body_stream()->Reset()) {
       return false;
     }
-    stream = std::move(ssl_stream);
-  } else {
-    stream = std::make_unique<FdStream>(sock.get());
+    LOG(WARNING) << "retrying on a new connection";
+    connection.reset();
+    reused = false;
   }
-#else  // CRASHPAD_USE_BORINGSSL
-  std::unique_ptr<Stream> stream(std::make_unique<FdStream>(sock.get()));
-#endif  // CRASHPAD_USE_BORINGSSL
 
-  if (!WriteRequest(
-          stream.get(), method(), resource, headers(), body_stream())) {
-    return false;
+#if defined(CRASHPAD_USE_BORINGSSL)
+  // With TLS 1.3, the session to resume is only available once the server has
+  // sent a ticket after the handshake, so take it after the response.
+  if (connection->ssl_stream()) {
+    ScopedSSLSession session(connection->ssl_stream()->GetSession());
+    if (session.is_valid()) {
+      pool->SetSSLSession(key, std::move(session));
+    }
   }
+#endif  // CRASHPAD_USE_BORINGSSL
 
-  if (!ReadResponse(stream.get(), response_body)) {
-    return false;
+  if (keep_alive) {
+    pool->ReturnIdleConnection(std::move(connection));
   }
 
   return true;
@@ -20,22 +20,43 @@
 #include <sys/types.h>
 
 #include <memory>
+#include <mutex>
+#include <set>
 #include <utility>
 #include <vector>
 
 #include "base/files/file_path.h"
 #include "base/format_macros.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "gtest/gtest.h"
 #include "test/multiprocess_exec.h"
+#include "test/scoped_temp_dir.h"
 #include "test/test_paths.h"
 #include "util/file/file_io.h"
+#include "util/file/file_reader.h"
 #include "util/misc/random_string.h"
 #include "util/net/http_body.h"
 #include "util/net/http_headers.h"
 #include "util/net/http_multipart_builder.h"
+#include "util/thread/thread.h"
+
+#if COMPILER_MSVC
+#pragma warning(push)
+#pragma warning(disable: 4244 4245 4267 4702)
+#endif
+
+#if defined(CRASHPAD_USE_BORINGSSL)
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#endif
+
+#include "third_party/cpp-httplib/cpp-httplib/httplib.h"
+
+#if COMPILER_MSVC
+#pragma warning(pop)
+#endif
 
 namespace crashpad {
 namespace test {
@@ -360,6 +381,207 @@ TEST_P(HTTPTransport, Upload33k_LengthUnknown) {
   RunUpload33k(GetParam(), false);
 }
 
+constexpr char kUploadFilePrefix[] = "Hello! ";
+constexpr char kUploadFileSuffix[] = " Goodbye :)";
+
+// Returns the contents of the file uploaded by RunUploadFile(). It’s large
+// enough to require several writes to send.
+std::string UploadFileContents() {
+  std::string contents(200 * 1024, '\0');
+  for (size_t index = 0; index < contents.size(); ++index) {
+    contents[index] = 'a' + index % 26;
+  }
+  return contents;
+}
+
+void RunUploadFile(const std::string& scheme, bool has_content_length) {
+  // HTTPTransport implementations may send a part of the body that’s read from
+  // a file directly from the file. Make sure that the file’s contents arrive
+  // intact and in place among the other parts.
+  ScopedTempDir temp_dir;
+  base::FilePath path = temp_dir.path().Append(FILE_PATH_LITERAL("upload"));
+  const std::string file_contents = UploadFileContents();
+  {
+    ScopedFileHandle handle(LoggingOpenFileForWrite(
+        path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+    ASSERT_TRUE(handle.is_valid());
+    ASSERT_TRUE(LoggingWriteFile(
+        handle.get(), file_contents.data(), file_contents.size()));
+  }
+
+  FileReader reader;
+  ASSERT_TRUE(reader.Open(path));
+
+  std::vector<HTTPBodyStream*> parts;
+  parts.push_back(new StringHTTPBodyStream(kUploadFilePrefix));
+  parts.push_back(new FileReaderHTTPBodyStream(&reader));
+  parts.push_back(new StringHTTPBodyStream(kUploadFileSuffix));
+
+  HTTPHeaders headers;
+  headers[kContentType] = "application/octet-stream";
+  if (has_content_length) {
+    headers[kContentLength] = base::StringPrintf(
+        "%" PRIuS,
+        strlen(kUploadFilePrefix) + file_contents.size() +
+            strlen(kUploadFileSuffix));
+  }
+  HTTPTransportTestFixture test(
+      scheme,
+      headers,
+      std::make_unique<CompositeHTTPBodyStream>(parts),
+      200,
+      [](HTTPTransportTestFixture* fixture, const std::string& request) {
+        size_t body_start = request.find("\r\n\r\n");
+        ASSERT_NE(body_start, std::string::npos);
+        EXPECT_EQ(request.substr(body_start + 4),
+                  kUploadFilePrefix + UploadFileContents() +
+                      kUploadFileSuffix);
+      });
+  test.Run();
+}
+
+TEST_P(HTTPTransport, UploadFile) {
+  RunUploadFile(GetParam(), true);
+}
+
+TEST_P(HTTPTransport, UploadFile_LengthUnknown) {
+  // The same as UploadFile, but without declaring Content-Length ahead of time.
+  RunUploadFile(GetParam(), false);
+}
+
+// A server that handles any number of requests on a local port, echoing each
+// request body in its response. Unlike http_transport_test_server, it permits
+// connections to persist between requests.
+class KeepAliveTestServer : public Thread {
+ public:
+  explicit KeepAliveTestServer(const std::string& scheme)
+      : server_(), lock_(), client_ports_(), port_(0) {
+    if (scheme == "http") {
+      server_ = std::make_unique<httplib::Server>();
+#if defined(CRASHPAD_USE_BORINGSSL)
+    } else {
+      server_ = std::make_unique<httplib::SSLServer>(
+          ToUTF8IfWin(CertificatePath().value()).c_str(),
+          ToUTF8IfWin(TestPaths::TestDataRoot()
+                          .Append(FILE_PATH_LITERAL(
+                              "util/net/testdata/crashpad_util_test_key.pem"))
+                          .value())
+              .c_str());
+#endif
+    }
+
+    // Requests to /upload receive a response with Content-Length, and requests
+    // to /upload_chunked receive a response with chunked encoding.
+    server_->Post("/upload",
+                  [this](const httplib::Request& request,
+                         httplib::Response& response) {
+                    RecordClientPort(request.remote_port);
+                    response.set_content(request.body, kTextPlain);
+                  });
+    server_->Post("/upload_chunked",
+                  [this](const httplib::Request& request,
+                         httplib::Response& response) {
+                    RecordClientPort(request.remote_port);
+                    const std::string body = request.body;
+                    response.set_chunked_content_provider(
+                        kTextPlain,
+                        [body](size_t offset, httplib::DataSink& sink) {
+                          sink.write(body.data(), body.size());
+                          sink.done();
+                          return true;
+                        });
+                  });
+    port_ =
+        base::checked_cast<uint16_t>(server_->bind_to_any_port("localhost"));
+  }
+
+  KeepAliveTestServer(const KeepAliveTestServer&) = delete;
+  KeepAliveTestServer& operator=(const KeepAliveTestServer&) = delete;
+
+  ~KeepAliveTestServer() override = default;
+
+  static base::FilePath CertificatePath() {
+    return TestPaths::TestDataRoot().Append(
+        FILE_PATH_LITERAL("util/net/testdata/crashpad_util_test_cert.pem"));
+  }
+
+  uint16_t port() const { return port_; }
+
+  void StopServer() { server_->stop(); }
+
+  // Returns the number of distinct connections that requests arrived on.
+  size_t connections() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return client_ports_.size();
+  }
+
+ private:
+  void RecordClientPort(int port) {
+    std::lock_guard<std::mutex> lock(lock_);
+    client_ports_.insert(port);
+  }
+
+  // Thread:
+  void ThreadMain() override { server_->listen_after_bind(); }
+
+  std::unique_ptr<httplib::Server> server_;
+  std::mutex lock_;
+  std::set<int> client_ports_;
+  uint16_t port_;
+};
+
+TEST_P(HTTPTransport, KeepAlive) {
+  KeepAliveTestServer server(GetParam());
+  server.Start();
+
+  constexpr size_t kRequests = 4;
+  for (size_t index = 0; index < kRequests; ++index) {
+    SCOPED_TRACE(base::StringPrintf("index %" PRIuS, index));
+
+    // Alternate between the response framings that permit a connection to be
+    // reused, and between request bodies with and without Content-Length.
+    const bool chunked = index % 2 != 0;
+    const std::string request_body = RandomString();
+
+    // HTTPTransport names the test fixture here.
+    std::unique_ptr<crashpad::HTTPTransport> transport(
+        crashpad::HTTPTransport::Create());
+    transport->SetMethod("POST");
+    if (GetParam() == "https") {
+      transport->SetRootCACertificatePath(
+          KeepAliveTestServer::CertificatePath());
+    }
+    transport->SetURL(
+        base::StringPrintf("%s://localhost:%d/%s",
+                           GetParam().c_str(),
+                           server.port(),
+                           chunked ? "upload_chunked" : "upload"));
+    transport->SetHeader(kContentType, kTextPlain);
+    if (!chunked) {
+      transport->SetHeader(
+          kContentLength,
+          base::StringPrintf("%" PRIuS, request_body.size()));
+    }
+    transport->SetBodyStream(
+        std::make_unique<StringHTTPBodyStream>(request_body));
+
+    std::string response_body;
+    EXPECT_TRUE(transport->ExecuteSynchronously(&response_body));
+    EXPECT_EQ(response_body, request_body);
+  }
+
+  server.StopServer();
+  server.Join();
+
+#if defined(CRASHPAD_HTTP_TRANSPORT_SOCKET)
+  // The connection made for the first request should have been reused for
+  // every request that followed it.
+  EXPECT_EQ(server.connections(), 1u);
+#else
+  EXPECT_GE(server.connections(), 1u);
+#endif
+}
+
 // This should be on for Fuchsia, but DX-382. Debug and re-enabled.
 #if defined(CRASHPAD_USE_BORINGSSL) && !BUILDFLAG(IS_FUCHSIA)
 // The test server requires BoringSSL or OpenSSL, so https in tests can only be
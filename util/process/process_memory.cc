@@ -49,6 +49,23 @@ bool ProcessMemory::Read(VMAddress address, VMSize size, void* buffer) const {
   return true;
 }
 
+bool ProcessMemory::ReadBatch(std::vector<BatchRead>* reads) const {
+  for (auto& read : *reads) {
+    read.bytes_read = 0;
+  }
+
+  ReadBatchInternal(reads);
+
+  bool success = true;
+  for (const auto& read : *reads) {
+    DCHECK_LE(read.bytes_read, read.size);
+    if (read.bytes_read != read.size) {
+      success = false;
+    }
+  }
+  return success;
+}
+
 bool ProcessMemory::ReadCStringInternal(VMAddress address,
                                         bool has_size,
                                         VMSize size,
@@ -93,4 +110,20 @@ bool ProcessMemory::ReadCStringInternal(VMAddress address,
   return false;
 }
 
+void ProcessMemory::ReadBatchInternal(std::vector<BatchRead>* reads) const {
+  for (auto& read : *reads) {
+    char* buffer = static_cast<char*>(read.buffer);
+    while (read.bytes_read < read.size) {
+      ssize_t bytes_read = ReadUpTo(read.address + read.bytes_read,
+                                    read.size - read.bytes_read,
+                                    buffer + read.bytes_read);
+      if (bytes_read <= 0) {
+        break;
+      }
+      DCHECK_LE(static_cast<size_t>(bytes_read), read.size - read.bytes_read);
+      read.bytes_read += bytes_read;
+    }
+  }
+}
+
 }  // namespace crashpad
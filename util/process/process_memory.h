@@ -18,6 +18,7 @@
 #include <sys/types.h>
 
 #include <string>
+#include <vector>
 
 #include "build/build_config.h"
 #include "util/misc/address_types.h"
@@ -34,6 +35,27 @@ namespace crashpad {
 //! Implementations are platform-specific.
 class ProcessMemory {
  public:
+  //! \brief A single memory region to be copied by ReadBatch().
+  struct BatchRead {
+    //! \brief The address, in the target process' address space, of the
+    //!     memory region to copy.
+    VMAddress address;
+
+    //! \brief The size, in bytes, of the memory region to copy. #buffer must
+    //!     be at least this size.
+    size_t size;
+
+    //! \brief The buffer into which the contents of the other process' memory
+    //!     will be copied.
+    void* buffer;
+
+    //! \brief The number of bytes copied into #buffer, set by ReadBatch().
+    //!
+    //! This is less than #size if the region could only be partially read,
+    //! for example, because it runs into an unmapped page.
+    size_t bytes_read;
+  };
+
   //! \brief Copies memory from the target process into a caller-provided buffer
   //!     in the current process.
   //!
@@ -48,6 +70,22 @@ class ProcessMemory {
   //!     failure, with a message logged.
   bool Read(VMAddress address, VMSize size, void* buffer) const;
 
+  //! \brief Copies several memory regions from the target process into
+  //!     caller-provided buffers in the current process.
+  //!
+  //! Each region is read independently: a failure to read one region does not
+  //! prevent the others from being read. Implementations may use this to
+  //! service many small reads with fewer system calls than would be required
+  //! by calling Read() for each region.
+  //!
+  //! \param[in,out] reads The regions to read. On return, the `bytes_read`
+  //!     field of each element is set to the number of bytes copied into its
+  //!     buffer.
+  //!
+  //! \return `true` if every region was read in full. `false` if any region
+  //!     was read only partially or not at all. Failing reads may be logged.
+  bool ReadBatch(std::vector<BatchRead>* reads) const;
+
   //! \brief Reads a `NUL`-terminated C string from the target process into a
   //!     string in the current process.
   //!
@@ -84,6 +122,12 @@ class ProcessMemory {
     return ReadCStringInternal(address, true, size, string);
   }
 
+  //! \brief Returns `true` if this object may be read from on several threads
+  //!     at once.
+  //!
+  //! The default implementation returns `false`.
+  virtual bool SupportsConcurrentReads() const { return false; }
+
   virtual ~ProcessMemory() = default;
 
  protected:
@@ -127,7 +171,18 @@ class ProcessMemory {
                                    VMSize size,
                                    std::string* string) const;
 
-  // Allow ProcessMemorySanitized to call ReadUpTo.
+  //! \brief Copies several memory regions from the target process.
+  //!
+  //! The `bytes_read` field of each element of \a reads is `0` on entry and
+  //! must be set to the number of bytes read for that region on return.
+  //!
+  //! The default implementation calls ReadUpTo() for each region in turn.
+  //!
+  //! \param[in,out] reads The regions to read.
+  virtual void ReadBatchInternal(std::vector<BatchRead>* reads) const;
+
+  // Allow ProcessMemoryCached and ProcessMemorySanitized to call ReadUpTo.
+  friend class ProcessMemoryCached;
   friend class ProcessMemorySanitized;
 };
 
@@ -0,0 +1,187 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/process/process_memory_cached.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/logging.h"
+#include "base/memory/page_size.h"
+
+namespace crashpad {
+
+ProcessMemoryCached::ProcessMemoryCached()
+    : ProcessMemory(),
+      memory_(nullptr),
+      page_size_(0),
+      max_pages_(0),
+      pages_(),
+      page_index_(),
+      stats_(),
+      initialized_() {}
+
+ProcessMemoryCached::~ProcessMemoryCached() {}
+
+bool ProcessMemoryCached::Initialize(const ProcessMemory* memory,
+                                     size_t max_cache_size) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  memory_ = memory;
+  page_size_ = base::GetPageSize();
+  max_pages_ = std::max(max_cache_size / page_size_, size_t{1});
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+void ProcessMemoryCached::Invalidate() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  page_index_.clear();
+  pages_.clear();
+}
+
+void ProcessMemoryCached::Prefetch(
+    const std::vector<CheckedRange<VMAddress, VMSize>>& ranges) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  // Covering more pages than the cache can hold would evict pages covered by
+  // this call before they can be used, so stop once the cache is full, leaving
+  // the pages of later ranges to be fetched when they’re read. Pages that are
+  // already cached count towards the limit, and are marked as recently used so
+  // that they aren’t evicted.
+  std::set<VMAddress> covered_pages;
+  std::vector<VMAddress> page_addresses;
+  for (const auto& range : ranges) {
+    if (range.size() == 0 || !range.IsValid()) {
+      continue;
+    }
+    const VMAddress first_page = range.base() & ~VMAddress{page_size_ - 1};
+    const VMAddress last_page = (range.end() - 1) & ~VMAddress{page_size_ - 1};
+    for (VMAddress page_address = first_page;
+         covered_pages.size() < max_pages_;
+         page_address += page_size_) {
+      if (covered_pages.insert(page_address).second) {
+        auto index_entry = page_index_.find(page_address);
+        if (index_entry == page_index_.end()) {
+          page_addresses.push_back(page_address);
+        } else {
+          pages_.splice(pages_.begin(), pages_, index_entry->second);
+        }
+      }
+      if (page_address == last_page) {
+        break;
+      }
+    }
+  }
+  if (page_addresses.empty()) {
+    return;
+  }
+
+  std::sort(page_addresses.begin(), page_addresses.end());
+  std::vector<Page> pages(page_addresses.size());
+  std::vector<ProcessMemory::BatchRead> reads(page_addresses.size());
+  for (size_t index = 0; index < page_addresses.size(); ++index) {
+    pages[index].address = page_addresses[index];
+    pages[index].data = base::HeapArray<char>::Uninit(page_size_);
+    reads[index] = {
+        page_addresses[index], page_size_, pages[index].data.data(), 0};
+  }
+  memory_->ReadBatch(&reads);
+
+  for (size_t index = 0; index < pages.size(); ++index) {
+    stats_.bytes_fetched += reads[index].bytes_read;
+    if (reads[index].bytes_read == page_size_) {
+      ++stats_.prefetched;
+      AddPage(std::move(pages[index]));
+    }
+  }
+}
+
+ProcessMemoryCached::Stats ProcessMemoryCached::GetStats() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return stats_;
+}
+
+ssize_t ProcessMemoryCached::ReadUpTo(VMAddress address,
+                                      size_t size,
+                                      void* buffer) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (size > page_size_) {
+    ++stats_.uncached_reads;
+    ssize_t bytes_read = memory_->ReadUpTo(address, size, buffer);
+    if (bytes_read > 0) {
+      stats_.bytes_fetched += bytes_read;
+    }
+    return bytes_read;
+  }
+
+  // Satisfy as much of the read as falls within the first page. The caller
+  // will ask for the rest, if any, separately.
+  const VMAddress page_address = address & ~VMAddress{page_size_ - 1};
+  const Page* page = GetPage(page_address);
+  if (!page) {
+    return -1;
+  }
+
+  const size_t offset = static_cast<size_t>(address - page_address);
+  const size_t bytes_read = std::min(size, page_size_ - offset);
+  memcpy(buffer, page->data.data() + offset, bytes_read);
+  return bytes_read;
+}
+
+const ProcessMemoryCached::Page* ProcessMemoryCached::GetPage(
+    VMAddress page_address) const {
+  auto index_entry = page_index_.find(page_address);
+  if (index_entry != page_index_.end()) {
+    ++stats_.hits;
+    pages_.splice(pages_.begin(), pages_, index_entry->second);
+    return &pages_.front();
+  }
+
+  ++stats_.misses;
+
+  Page page;
+  page.address = page_address;
+  page.data = base::HeapArray<char>::Uninit(page_size_);
+  size_t page_bytes = 0;
+  while (page_bytes < page_size_) {
+    ssize_t bytes_read = memory_->ReadUpTo(page_address + page_bytes,
+                                           page_size_ - page_bytes,
+                                           page.data.data() + page_bytes);
+    if (bytes_read <= 0) {
+      return nullptr;
+    }
+    page_bytes += bytes_read;
+    stats_.bytes_fetched += bytes_read;
+  }
+
+  AddPage(std::move(page));
+  return &pages_.front();
+}
+
+void ProcessMemoryCached::AddPage(Page page) const {
+  if (pages_.size() >= max_pages_) {
+    page_index_.erase(pages_.back().address);
+    pages_.pop_back();
+  }
+  const VMAddress page_address = page.address;
+  pages_.push_front(std::move(page));
+  page_index_[page_address] = pages_.begin();
+}
+
+}  // namespace crashpad
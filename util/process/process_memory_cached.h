@@ -0,0 +1,142 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_PROCESS_PROCESS_MEMORY_CACHED_H_
+#define CRASHPAD_UTIL_PROCESS_PROCESS_MEMORY_CACHED_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "base/containers/heap_array.h"
+#include "util/misc/address_types.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/numeric/checked_range.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+
+//! \brief Access to the memory of another process through a cache of whole
+//!     pages.
+//!
+//! Small reads are satisfied from a least-recently-used cache of the target
+//! process’ pages, which are fetched from the underlying ProcessMemory on first
+//! use. Reads larger than a page bypass the cache. This suits parsers that make
+//! many small, nearby reads, such as those for ELF structures and annotations.
+//!
+//! Cached contents are never refreshed, so this object must only be used while
+//! the target process is suspended, or Invalidate() must be called when it may
+//! have run. This class is not thread-safe.
+class ProcessMemoryCached final : public ProcessMemory {
+ public:
+  //! \brief Counters describing the effectiveness of the cache.
+  struct Stats {
+    //! \brief The number of page lookups satisfied by the cache.
+    uint64_t hits;
+
+    //! \brief The number of page lookups that required fetching a page.
+    uint64_t misses;
+
+    //! \brief The number of reads too large to be cached, which were passed
+    //!     directly to the underlying ProcessMemory.
+    uint64_t uncached_reads;
+
+    //! \brief The total number of bytes read from the underlying
+    //!     ProcessMemory, including both page fetches and uncached reads.
+    uint64_t bytes_fetched;
+
+    //! \brief The number of pages fetched by Prefetch().
+    uint64_t prefetched;
+  };
+
+  ProcessMemoryCached();
+
+  ProcessMemoryCached(const ProcessMemoryCached&) = delete;
+  ProcessMemoryCached& operator=(const ProcessMemoryCached&) = delete;
+
+  ~ProcessMemoryCached();
+
+  //! \brief Initializes this object to read memory from the underlying
+  //!     \a memory object.
+  //!
+  //! This method must be called successfully prior to calling any other method
+  //! in this class.
+  //!
+  //! \param[in] memory The memory object to read memory from.
+  //! \param[in] max_cache_size The maximum number of bytes of page data to
+  //!     retain. At least one page is always retained.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(const ProcessMemory* memory, size_t max_cache_size);
+
+  //! \brief Fetches the pages covering several regions of the target
+  //!     process’ memory into the cache.
+  //!
+  //! Pages that are not already cached are fetched together with a single
+  //! ProcessMemory::ReadBatch() call, which may need far fewer operations than
+  //! fetching each page when it is first read. This is useful when the
+  //! locations of many small structures are known ahead of the reads that will
+  //! parse them. Pages that can’t be read in full are not cached.
+  //!
+  //! No more pages are fetched than the cache can hold. When \a ranges cover
+  //! more pages than that, earlier ranges take priority, so callers should
+  //! list the regions that are most certain to be read first.
+  //!
+  //! \param[in] ranges The regions to fetch, in order of priority.
+  void Prefetch(
+      const std::vector<CheckedRange<VMAddress, VMSize>>& ranges) const;
+
+  //! \brief Discards all cached pages.
+  //!
+  //! Counters returned by GetStats() are not reset.
+  void Invalidate();
+
+  //! \brief Returns counters describing the effectiveness of the cache.
+  Stats GetStats() const;
+
+ private:
+  struct Page {
+    VMAddress address;
+    base::HeapArray<char> data;
+  };
+
+  ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) const override;
+
+  // Returns the cached page at page_address, fetching it if necessary. Returns
+  // nullptr if the page could not be read in full.
+  const Page* GetPage(VMAddress page_address) const;
+
+  // Adds page to the cache as the most recently used page, evicting the least
+  // recently used page if the cache is full.
+  void AddPage(Page page) const;
+
+  const ProcessMemory* memory_;  // weak
+  size_t page_size_;
+  size_t max_pages_;
+
+  // Cached pages, ordered from most to least recently used, and an index into
+  // them by address.
+  mutable std::list<Page> pages_;
+  mutable std::map<VMAddress, std::list<Page>::iterator> page_index_;
+
+  mutable Stats stats_;
+  InitializationStateDcheck initialized_;
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_PROCESS_PROCESS_MEMORY_CACHED_H_
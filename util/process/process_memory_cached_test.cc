@@ -0,0 +1,217 @@
+// Copyright 2026 The Crashpad Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/process/process_memory_cached.h"
+
+#include <memory>
+
+#include "base/containers/heap_array.h"
+#include "base/memory/page_size.h"
+#include "gtest/gtest.h"
+#include "test/linux/fake_ptrace_connection.h"
+#include "test/process_type.h"
+#include "util/misc/from_pointer_cast.h"
+#include "util/process/process_memory_linux.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+class ProcessMemoryCachedTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(connection_.Initialize(GetSelfProcess()));
+    memory_ = std::make_unique<ProcessMemoryLinux>(&connection_);
+
+    page_size_ = base::GetPageSize();
+    region_ = base::HeapArray<char>::Uninit(4 * page_size_);
+    for (size_t index = 0; index < region_.size(); ++index) {
+      region_[index] = static_cast<char>(index % 251);
+    }
+
+    // Use the first page boundary within the region as the base, so that the
+    // expected hit and miss counts are exact.
+    VMAddress region_address = FromPointerCast<VMAddress>(region_.data());
+    base_ = (region_address + page_size_ - 1) & ~VMAddress{page_size_ - 1};
+    base_offset_ = base_ - region_address;
+  }
+
+  char Expected(size_t offset) const {
+    return static_cast<char>((base_offset_ + offset) % 251);
+  }
+
+  FakePtraceConnection connection_;
+  std::unique_ptr<ProcessMemoryLinux> memory_;
+  base::HeapArray<char> region_;
+  size_t page_size_;
+  VMAddress base_;
+  size_t base_offset_;
+};
+
+TEST_F(ProcessMemoryCachedTest, HitsAndMisses) {
+  ProcessMemoryCached cached;
+  ASSERT_TRUE(cached.Initialize(memory_.get(), 2 * page_size_));
+
+  char buffer[16];
+  ASSERT_TRUE(cached.Read(base_ + 8, sizeof(buffer), buffer));
+  for (size_t index = 0; index < sizeof(buffer); ++index) {
+    EXPECT_EQ(buffer[index], Expected(8 + index));
+  }
+
+  ASSERT_TRUE(cached.Read(base_ + 100, sizeof(buffer), buffer));
+  for (size_t index = 0; index < sizeof(buffer); ++index) {
+    EXPECT_EQ(buffer[index], Expected(100 + index));
+  }
+
+  ProcessMemoryCached::Stats stats = cached.GetStats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.uncached_reads, 0u);
+  EXPECT_EQ(stats.bytes_fetched, page_size_);
+
+  // A read spanning a page boundary fetches the second page.
+  ASSERT_TRUE(cached.Read(base_ + page_size_ - 4, sizeof(buffer), buffer));
+  for (size_t index = 0; index < sizeof(buffer); ++index) {
+    EXPECT_EQ(buffer[index], Expected(page_size_ - 4 + index));
+  }
+  stats = cached.GetStats();
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.bytes_fetched, 2 * page_size_);
+}
+
+TEST_F(ProcessMemoryCachedTest, LargeReadsBypassCache) {
+  ProcessMemoryCached cached;
+  ASSERT_TRUE(cached.Initialize(memory_.get(), 4 * page_size_));
+
+  auto buffer = base::HeapArray<char>::Uninit(2 * page_size_);
+  ASSERT_TRUE(cached.Read(base_, buffer.size(), buffer.data()));
+  for (size_t index = 0; index < buffer.size(); ++index) {
+    EXPECT_EQ(buffer[index], Expected(index));
+  }
+
+  ProcessMemoryCached::Stats stats = cached.GetStats();
+  EXPECT_EQ(stats.misses, 0u);
+  EXPECT_EQ(stats.hits, 0u);
+  EXPECT_GE(stats.uncached_reads, 1u);
+  EXPECT_EQ(stats.bytes_fetched, buffer.size());
+}
+
+TEST_F(ProcessMemoryCachedTest, EvictionAndInvalidation) {
+  ProcessMemoryCached cached;
+  ASSERT_TRUE(cached.Initialize(memory_.get(), page_size_));
+
+  char c;
+  ASSERT_TRUE(cached.Read(base_, 1, &c));
+  EXPECT_EQ(c, Expected(0));
+  ASSERT_TRUE(cached.Read(base_ + page_size_, 1, &c));
+  EXPECT_EQ(c, Expected(page_size_));
+
+  // The first page was evicted to make room for the second.
+  ASSERT_TRUE(cached.Read(base_, 1, &c));
+  EXPECT_EQ(cached.GetStats().misses, 3u);
+  EXPECT_EQ(cached.GetStats().hits, 0u);
+
+  ASSERT_TRUE(cached.Read(base_ + 1, 1, &c));
+  EXPECT_EQ(cached.GetStats().hits, 1u);
+
+  // Cached contents are stale until invalidated.
+  const size_t offset = base_offset_ + 2;
+  const char original = region_[offset];
+  region_[offset] = static_cast<char>(original + 1);
+  ASSERT_TRUE(cached.Read(base_ + 2, 1, &c));
+  EXPECT_EQ(c, original);
+
+  cached.Invalidate();
+  ASSERT_TRUE(cached.Read(base_ + 2, 1, &c));
+  EXPECT_EQ(c, static_cast<char>(original + 1));
+  EXPECT_EQ(cached.GetStats().misses, 4u);
+}
+
+TEST_F(ProcessMemoryCachedTest, Prefetch) {
+  ProcessMemoryCached cached;
+  ASSERT_TRUE(cached.Initialize(memory_.get(), 4 * page_size_));
+
+  // The ranges cover the first two pages, one of them twice, and an empty
+  // range that covers none.
+  cached.Prefetch({CheckedRange<VMAddress, VMSize>(base_ + 8, 16),
+                   CheckedRange<VMAddress, VMSize>(base_ + page_size_ - 4, 8),
+                   CheckedRange<VMAddress, VMSize>(base_ + 2 * page_size_, 0)});
+  ProcessMemoryCached::Stats stats = cached.GetStats();
+  EXPECT_EQ(stats.prefetched, 2u);
+  EXPECT_EQ(stats.misses, 0u);
+  EXPECT_EQ(stats.bytes_fetched, 2 * page_size_);
+
+  char buffer[16];
+  ASSERT_TRUE(cached.Read(base_ + page_size_ - 4, sizeof(buffer), buffer));
+  for (size_t index = 0; index < sizeof(buffer); ++index) {
+    EXPECT_EQ(buffer[index], Expected(page_size_ - 4 + index));
+  }
+  stats = cached.GetStats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 0u);
+
+  // Pages that are already cached aren't fetched again.
+  cached.Prefetch({CheckedRange<VMAddress, VMSize>(base_, 2 * page_size_)});
+  EXPECT_EQ(cached.GetStats().prefetched, 2u);
+}
+
+TEST_F(ProcessMemoryCachedTest, PrefetchLimitedToCacheSize) {
+  ProcessMemoryCached cached;
+  ASSERT_TRUE(cached.Initialize(memory_.get(), 2 * page_size_));
+
+  // The ranges cover three pages, and the first is already cached.
+  char c;
+  ASSERT_TRUE(cached.Read(base_ + page_size_, 1, &c));
+  cached.Prefetch({CheckedRange<VMAddress, VMSize>(base_ + page_size_, 1),
+                   CheckedRange<VMAddress, VMSize>(base_ + 2 * page_size_, 1),
+                   CheckedRange<VMAddress, VMSize>(base_, 1)});
+  EXPECT_EQ(cached.GetStats().prefetched, 1u);
+
+  // The pages of the earlier ranges were fetched, rather than the lowest.
+  ASSERT_TRUE(cached.Read(base_ + page_size_, 1, &c));
+  EXPECT_EQ(c, Expected(page_size_));
+  ASSERT_TRUE(cached.Read(base_ + 2 * page_size_, 1, &c));
+  EXPECT_EQ(c, Expected(2 * page_size_));
+  EXPECT_EQ(cached.GetStats().hits, 2u);
+  EXPECT_EQ(cached.GetStats().misses, 1u);
+
+  ASSERT_TRUE(cached.Read(base_, 1, &c));
+  EXPECT_EQ(c, Expected(0));
+  EXPECT_EQ(cached.GetStats().misses, 2u);
+}
+
+TEST_F(ProcessMemoryCachedTest, PrefetchKeepsCoveredPages) {
+  ProcessMemoryCached cached;
+  ASSERT_TRUE(cached.Initialize(memory_.get(), 2 * page_size_));
+
+  char c;
+  ASSERT_TRUE(cached.Read(base_, 1, &c));
+  ASSERT_TRUE(cached.Read(base_ + page_size_, 1, &c));
+
+  // The first page is the least recently used, but it’s covered by the ranges,
+  // so the second page is evicted to make room for the third.
+  cached.Prefetch({CheckedRange<VMAddress, VMSize>(base_, 1),
+                   CheckedRange<VMAddress, VMSize>(base_ + 2 * page_size_, 1)});
+  EXPECT_EQ(cached.GetStats().prefetched, 1u);
+
+  ASSERT_TRUE(cached.Read(base_, 1, &c));
+  ASSERT_TRUE(cached.Read(base_ + 2 * page_size_, 1, &c));
+  EXPECT_EQ(cached.GetStats().hits, 2u);
+  EXPECT_EQ(cached.GetStats().misses, 2u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -14,9 +14,11 @@
 
 #include "util/process/process_memory_linux.h"
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -31,8 +33,21 @@
 
 namespace crashpad {
 
+namespace {
+
+// The maximum number of regions submitted to a single process_vm_readv() call.
+// This is well below the kernel’s UIO_MAXIOV limit of 1024.
+constexpr size_t kMaxIovecsPerCall = 256;
+
+}  // namespace
+
 ProcessMemoryLinux::ProcessMemoryLinux(PtraceConnection* connection)
-    : ProcessMemory(), mem_fd_(), ignore_top_byte_(false) {
+    : ProcessMemory(),
+      connection_(connection),
+      mem_fd_(),
+      pid_(connection->GetProcessID()),
+      ignore_top_byte_(false),
+      use_process_vm_readv_(false) {
 #if defined(ARCH_CPU_ARM_FAMILY)
   if (connection->Is64Bit()) {
     ignore_top_byte_ = true;
@@ -43,6 +58,9 @@ ProcessMemoryLinux::ProcessMemoryLinux(PtraceConnection* connection)
   snprintf(path, sizeof(path), "/proc/%d/mem", connection->GetProcessID());
   mem_fd_.reset(HANDLE_EINTR(open(path, O_RDONLY | O_NOCTTY | O_CLOEXEC)));
   if (mem_fd_.is_valid()) {
+    // Being able to open /proc/<pid>/mem implies ptrace access to the target in
+    // this process’ pid namespace, which is what process_vm_readv() requires.
+    use_process_vm_readv_ = true;
     read_up_to_ = [this](VMAddress address, size_t size, void* buffer) {
       ssize_t bytes_read =
           HANDLE_EINTR(pread64(mem_fd_.get(), buffer, size, address));
@@ -67,11 +85,142 @@ VMAddress ProcessMemoryLinux::PointerToAddress(VMAddress address) const {
   return ignore_top_byte_ ? address & 0x00ffffffffffffff : address;
 }
 
+bool ProcessMemoryLinux::SupportsConcurrentReads() const {
+  return mem_fd_.is_valid();
+}
+
 ssize_t ProcessMemoryLinux::ReadUpTo(VMAddress address,
                                      size_t size,
                                      void* buffer) const {
   DCHECK_LE(size, size_t{std::numeric_limits<ssize_t>::max()});
-  return read_up_to_(PointerToAddress(address), size, buffer);
+  address = PointerToAddress(address);
+
+  if (use_process_vm_readv_ &&
+      address <= std::numeric_limits<uintptr_t>::max()) {
+    iovec local = {buffer, size};
+    iovec remote = {reinterpret_cast<void*>(address), size};
+    ssize_t bytes_read = ProcessVMReadv(&local, &remote, 1);
+    if (bytes_read >= 0) {
+      return bytes_read;
+    }
+  }
+
+  return read_up_to_(address, size, buffer);
+}
+
+void ProcessMemoryLinux::ReadBatchInternal(
+    std::vector<BatchRead>* reads) const {
+  if (!mem_fd_.is_valid()) {
+    // Every read goes through the connection, which may be able to service all
+    // of the regions with a single request.
+    std::vector<BatchRead> connection_reads(*reads);
+    for (BatchRead& read : connection_reads) {
+      read.address = PointerToAddress(read.address);
+    }
+    connection_->ReadMemoryBatch(&connection_reads);
+    for (size_t index = 0; index < reads->size(); ++index) {
+      (*reads)[index].bytes_read = connection_reads[index].bytes_read;
+    }
+    return;
+  }
+
+  size_t index = 0;
+  while (index < reads->size()) {
+    if (use_process_vm_readv_) {
+      index = ReadBatchWithProcessVMReadv(reads, index);
+      if (index == reads->size()) {
+        break;
+      }
+    }
+
+    // Finish any region that process_vm_readv() was unable to read, or that it
+    // wasn’t used for, with the slower readers. /proc/<pid>/mem is able to read
+    // some mappings that process_vm_readv() can’t, such as those without
+    // PROT_READ.
+    BatchRead& read = (*reads)[index];
+    char* buffer = static_cast<char*>(read.buffer);
+    while (read.bytes_read < read.size) {
+      ssize_t bytes_read = read_up_to_(
+          PointerToAddress(read.address + read.bytes_read),
+          read.size - read.bytes_read,
+          buffer + read.bytes_read);
+      if (bytes_read <= 0) {
+        break;
+      }
+      read.bytes_read += bytes_read;
+    }
+    ++index;
+  }
+}
+
+size_t ProcessMemoryLinux::ReadBatchWithProcessVMReadv(
+    std::vector<BatchRead>* reads,
+    size_t begin) const {
+  iovec local[kMaxIovecsPerCall];
+  iovec remote[kMaxIovecsPerCall];
+
+  while (begin < reads->size()) {
+    size_t count = 0;
+    size_t end;
+    for (end = begin; end < reads->size() && count < kMaxIovecsPerCall;
+         ++end) {
+      BatchRead& read = (*reads)[end];
+      size_t remaining = read.size - read.bytes_read;
+      if (remaining == 0) {
+        continue;
+      }
+
+      VMAddress address = PointerToAddress(read.address + read.bytes_read);
+      if (address > std::numeric_limits<uintptr_t>::max()) {
+        // Leave this region for the slower readers.
+        break;
+      }
+
+      local[count].iov_base = static_cast<char*>(read.buffer) + read.bytes_read;
+      local[count].iov_len = remaining;
+      remote[count].iov_base = reinterpret_cast<void*>(address);
+      remote[count].iov_len = remaining;
+      ++count;
+    }
+
+    if (count == 0) {
+      return end;
+    }
+
+    ssize_t bytes_read = ProcessVMReadv(local, remote, count);
+    size_t bytes_remaining = bytes_read < 0 ? 0 : bytes_read;
+
+    // process_vm_readv() stops at the first region that it can’t read in full,
+    // so attribute the bytes read to the regions in order.
+    for (size_t index = begin; index < end; ++index) {
+      BatchRead& read = (*reads)[index];
+      size_t bytes_for_read =
+          std::min(read.size - read.bytes_read, bytes_remaining);
+      read.bytes_read += bytes_for_read;
+      bytes_remaining -= bytes_for_read;
+      if (read.bytes_read != read.size) {
+        return index;
+      }
+    }
+    DCHECK_EQ(bytes_remaining, 0u);
+    begin = end;
+  }
+  return begin;
+}
+
+ssize_t ProcessMemoryLinux::ProcessVMReadv(const iovec* local,
+                                           const iovec* remote,
+                                           size_t count) const {
+  ssize_t bytes_read = HANDLE_EINTR(
+      syscall(SYS_process_vm_readv, pid_, local, count, remote, count, 0));
+  if (bytes_read < 0 && errno != EFAULT) {
+    // process_vm_readv() may be unimplemented by the kernel, blocked by a
+    // seccomp policy, or otherwise not permitted. The other readers still work
+    // in these cases, so use them from now on.
+    PLOG(WARNING) << "process_vm_readv, falling back";
+    use_process_vm_readv_ = false;
+  }
+  return bytes_read;
 }
 
 }  // namespace crashpad
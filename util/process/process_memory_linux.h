@@ -16,9 +16,12 @@
 #define CRASHPAD_UTIL_PROCESS_PROCESS_MEMORY_LINUX_H_
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
+#include <atomic>
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "base/files/scoped_file.h"
 #include "util/misc/address_types.h"
@@ -29,6 +32,12 @@ namespace crashpad {
 class PtraceConnection;
 
 //! \brief Accesses the memory of another Linux process.
+//!
+//! Memory is read with `process_vm_readv()` when it is available, which allows
+//! ReadBatch() to service many regions with a single system call. Otherwise,
+//! or if `process_vm_readv()` fails, memory is read from `/proc/<pid>/mem`, and
+//! if that can't be opened, through the PtraceConnection. ReadBatch() passes
+//! all of its regions to the PtraceConnection at once in that case.
 class ProcessMemoryLinux final : public ProcessMemory {
  public:
   explicit ProcessMemoryLinux(PtraceConnection* connection);
@@ -42,12 +51,33 @@ class ProcessMemoryLinux final : public ProcessMemory {
   //!     tags removed.
   VMAddress PointerToAddress(VMAddress address) const;
 
+  //! \brief Returns `true` if memory is read with `process_vm_readv()` or from
+  //!     `/proc/<pid>/mem`, which may be done on any thread. Reads made through
+  //!     a PtraceConnection may only be made on one thread at a time.
+  bool SupportsConcurrentReads() const override;
+
  private:
   ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) const override;
+  void ReadBatchInternal(std::vector<BatchRead>* reads) const override;
+
+  // Reads the regions in reads, beginning at index begin, with as few
+  // process_vm_readv() calls as possible. Returns the index of the first region
+  // that could not be read completely, or reads->size() if all of them were.
+  size_t ReadBatchWithProcessVMReadv(std::vector<BatchRead>* reads,
+                                     size_t begin) const;
+
+  // Calls process_vm_readv(), disabling its further use if it fails for any
+  // reason other than an invalid remote address.
+  ssize_t ProcessVMReadv(const iovec* local,
+                         const iovec* remote,
+                         size_t count) const;
 
   std::function<ssize_t(VMAddress, size_t, void*)> read_up_to_;
+  PtraceConnection* connection_;  // weak
   base::ScopedFD mem_fd_;
+  pid_t pid_;
   bool ignore_top_byte_;
+  mutable std::atomic<bool> use_process_vm_readv_;
 };
 
 }  // namespace crashpad
@@ -78,6 +78,37 @@ bool ProcessMemoryRange::Read(VMAddress address,
   return memory_->Read(address, size, buffer);
 }
 
+bool ProcessMemoryRange::ReadBatch(
+    std::vector<ProcessMemory::BatchRead>* reads) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  bool success = true;
+  std::vector<ProcessMemory::BatchRead> in_range_reads;
+  std::vector<size_t> in_range_indices;
+  in_range_reads.reserve(reads->size());
+  in_range_indices.reserve(reads->size());
+  for (size_t index = 0; index < reads->size(); ++index) {
+    ProcessMemory::BatchRead& read = (*reads)[index];
+    read.bytes_read = 0;
+    CheckedVMAddressRange read_range(range_.Is64Bit(), read.address, read.size);
+    if (!read_range.IsValid() || !range_.ContainsRange(read_range)) {
+      LOG(ERROR) << "read out of range";
+      success = false;
+      continue;
+    }
+    in_range_reads.push_back(read);
+    in_range_indices.push_back(index);
+  }
+
+  if (!memory_->ReadBatch(&in_range_reads)) {
+    success = false;
+  }
+  for (size_t index = 0; index < in_range_reads.size(); ++index) {
+    (*reads)[in_range_indices[index]].bytes_read =
+        in_range_reads[index].bytes_read;
+  }
+  return success;
+}
+
 bool ProcessMemoryRange::ReadCStringSizeLimited(VMAddress address,
                                                 VMSize size,
                                                 std::string* string) const {
@@ -18,6 +18,7 @@
 #include <sys/types.h>
 
 #include <string>
+#include <vector>
 
 #include "util/misc/address_types.h"
 #include "util/misc/initialization_state_dcheck.h"
@@ -102,6 +103,19 @@ class ProcessMemoryRange {
   //!     failure, with a message logged.
   bool Read(VMAddress address, VMSize size, void* buffer) const;
 
+  //! \brief Copies several memory regions from the target process into
+  //!     caller-provided buffers in the current process.
+  //!
+  //! \see ProcessMemory::ReadBatch()
+  //!
+  //! \param[in,out] reads The regions to read. Regions that are not contained
+  //!     within this object's range are not read, and have their `bytes_read`
+  //!     field set to `0`.
+  //!
+  //! \return `true` if every region was read in full. `false` if any region
+  //!     was out of range, or was read only partially or not at all.
+  bool ReadBatch(std::vector<ProcessMemory::BatchRead>* reads) const;
+
   //! \brief Reads a `NUL`-terminated C string from the target process into a
   //!     string in the current process.
   //!
@@ -16,6 +16,8 @@
 
 #include <string.h>
 
+#include <vector>
+
 #include "base/containers/heap_array.h"
 #include "base/memory/page_size.h"
 #include "build/build_config.h"
@@ -28,6 +30,7 @@
 #include "util/file/file_io.h"
 #include "util/misc/from_pointer_cast.h"
 #include "util/process/process_memory_native.h"
+#include "util/thread/thread.h"
 
 #if BUILDFLAG(IS_APPLE)
 #include "test/mac/mach_multiprocess.h"
@@ -123,6 +126,43 @@ CRASHPAD_CHILD_TEST_MAIN(ReadTestChild) {
   return 0;
 }
 
+#if BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+class ConcurrentReadThread : public Thread {
+ public:
+  ConcurrentReadThread() : memory_(nullptr), address_(0), region_size_(0) {}
+
+  ConcurrentReadThread(const ConcurrentReadThread&) = delete;
+  ConcurrentReadThread& operator=(const ConcurrentReadThread&) = delete;
+
+  ~ConcurrentReadThread() override {}
+
+  void SetTestParameters(const ProcessMemory* memory,
+                         VMAddress address,
+                         size_t region_size) {
+    memory_ = memory;
+    address_ = address;
+    region_size_ = region_size;
+  }
+
+ private:
+  // Thread:
+  void ThreadMain() override {
+    auto result = base::HeapArray<char>::Uninit(region_size_);
+    for (size_t iteration = 0; iteration < 16; ++iteration) {
+      ASSERT_TRUE(memory_->Read(address_, result.size(), result.data()));
+      for (size_t i = 0; i < result.size(); ++i) {
+        ASSERT_EQ(result[i], static_cast<char>(i % 256));
+      }
+    }
+  }
+
+  const ProcessMemory* memory_;
+  VMAddress address_;
+  size_t region_size_;
+};
+#endif  // BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_LINUX) ||
+        // BUILDFLAG(IS_CHROMEOS)
+
 class ReadTest : public MultiprocessAdaptor {
  public:
   ReadTest() : MultiprocessAdaptor() {
@@ -208,6 +248,40 @@ class ReadTest : public MultiprocessAdaptor {
     ASSERT_TRUE(memory.Read(address + 2, 1, result.data()));
     EXPECT_EQ(result[0], 2);
     EXPECT_EQ(result[1], 'J');
+
+    // Ensure that a batch of regions, including an empty one, can be read into
+    // separate parts of the buffer.
+    memset(result.data(), '\0', result.size());
+    std::vector<ProcessMemory::BatchRead> reads(4);
+    reads[0] = {address + 1, 10, &result[0], 0};
+    reads[1] = {address + page_size - 5, 10, &result[10], 0};
+    reads[2] = {address + 7, 0, &result[20], 0};
+    reads[3] = {address + 3, page_size, &result[20], 0};
+    ASSERT_TRUE(memory.ReadBatch(&reads));
+    for (const auto& read : reads) {
+      EXPECT_EQ(read.bytes_read, read.size);
+    }
+    for (size_t i = 0; i < 10; ++i) {
+      EXPECT_EQ(result[i], static_cast<char>((i + 1) % 256));
+      EXPECT_EQ(result[10 + i], static_cast<char>((i + page_size - 5) % 256));
+    }
+    for (size_t i = 0; i < page_size; ++i) {
+      EXPECT_EQ(result[20 + i], static_cast<char>((i + 3) % 256));
+    }
+
+#if BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+    // Memory read from /proc/<pid>/mem may be read on several threads at once.
+    ASSERT_TRUE(memory.SupportsConcurrentReads());
+    ConcurrentReadThread threads[4];
+    for (ConcurrentReadThread& thread : threads) {
+      thread.SetTestParameters(&memory, address, region_size);
+      thread.Start();
+    }
+    for (ConcurrentReadThread& thread : threads) {
+      thread.Join();
+    }
+#endif  // BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_LINUX) ||
+        // BUILDFLAG(IS_CHROMEOS)
   }
 };
 
@@ -439,6 +513,25 @@ class ReadUnmappedTest : public MultiprocessAdaptor {
     EXPECT_FALSE(memory.Read(page_addr1, result.size(), result.data()));
     EXPECT_FALSE(memory.Read(page_addr2, base::GetPageSize(), result.data()));
     EXPECT_FALSE(memory.Read(page_addr2 - 1, 2, result.data()));
+
+    // Regions in a batch are read independently, so an unreadable region
+    // doesn’t prevent those after it from being read, and a region that runs
+    // into the unmapped page is read up to it.
+    std::vector<ProcessMemory::BatchRead> reads(3);
+    reads[0] = {page_addr2 - 4, 8, &result[0], 0};
+    reads[1] = {page_addr2, 8, &result[8], 0};
+    reads[2] = {page_addr1, 8, &result[16], 0};
+    EXPECT_FALSE(memory.ReadBatch(&reads));
+    EXPECT_EQ(reads[0].bytes_read, 4u);
+    EXPECT_EQ(reads[1].bytes_read, 0u);
+    EXPECT_EQ(reads[2].bytes_read, 8u);
+    for (size_t i = 0; i < 4; ++i) {
+      EXPECT_EQ(result[i],
+                static_cast<char>((i + base::GetPageSize() - 4) % 256));
+    }
+    for (size_t i = 0; i < 8; ++i) {
+      EXPECT_EQ(result[16 + i], static_cast<char>(i % 256));
+    }
   }
 };
 
@@ -23,13 +23,43 @@
 
 namespace crashpad {
 
+namespace {
+
+// The default values for zlib’s internal MAX_WBITS and DEF_MEM_LEVEL, which
+// aren’t exported from zlib.
+constexpr int kZlibMaxWindowBits = 15;
+constexpr int kZlibDefaultMemoryLevel = 8;
+
+}  // namespace
+
+ZlibOutputStream::ZlibOutputStream(
+    Mode mode,
+    std::unique_ptr<OutputStreamInterface> output_stream)
+    : ZlibOutputStream(mode, Format::kZlib, std::move(output_stream)) {}
+
+ZlibOutputStream::ZlibOutputStream(
+    Mode mode,
+    Format format,
+    std::unique_ptr<OutputStreamInterface> output_stream)
+    : ZlibOutputStream(mode,
+                       format,
+                       format == Format::kGzip ? Z_DEFAULT_COMPRESSION
+                                               : Z_BEST_COMPRESSION,
+                       std::move(output_stream)) {}
+
 ZlibOutputStream::ZlibOutputStream(
     Mode mode,
+    Format format,
+    int level,
     std::unique_ptr<OutputStreamInterface> output_stream)
     : output_stream_(std::move(output_stream)),
       mode_(mode),
+      format_(format),
+      level_(level),
       initialized_(),
-      flush_needed_(false) {}
+      flush_needed_(false) {
+  DCHECK(ZlibIsValidCompressionLevel(level_)) << level_;
+}
 
 ZlibOutputStream::~ZlibOutputStream() {
   if (!initialized_.is_valid())
@@ -53,13 +83,25 @@ bool ZlibOutputStream::Write(const uint8_t* data, size_t size) {
     zlib_stream_.opaque = Z_NULL;
 
     if (mode_ == Mode::kDecompress) {
-      int result = inflateInit(&zlib_stream_);
+      int result =
+          format_ == Format::kGzip
+              ? inflateInit2(&zlib_stream_,
+                             ZlibWindowBitsWithGzipWrapper(kZlibMaxWindowBits))
+              : inflateInit(&zlib_stream_);
       if (result != Z_OK) {
         LOG(ERROR) << "inflateInit: " << ZlibErrorString(result);
         return false;
       }
     } else if (mode_ == Mode::kCompress) {
-      int result = deflateInit(&zlib_stream_, Z_BEST_COMPRESSION);
+      int result =
+          format_ == Format::kGzip
+              ? deflateInit2(&zlib_stream_,
+                             level_,
+                             Z_DEFLATED,
+                             ZlibWindowBitsWithGzipWrapper(kZlibMaxWindowBits),
+                             kZlibDefaultMemoryLevel,
+                             Z_DEFAULT_STRATEGY)
+              : deflateInit(&zlib_stream_, level_);
       if (result != Z_OK) {
         LOG(ERROR) << "deflateInit: " << ZlibErrorString(result);
         return false;
@@ -105,6 +147,22 @@ bool ZlibOutputStream::Write(const uint8_t* data, size_t size) {
 bool ZlibOutputStream::Flush() {
   if (initialized_.is_valid() && flush_needed_) {
     flush_needed_ = false;
+    if (mode_ == Mode::kCompress && format_ == Format::kGzip) {
+      // End the deflate data at a byte-aligned sync point, so that only the
+      // empty final block follows it.
+      bool flushed;
+      do {
+        int result = deflate(&zlib_stream_, Z_SYNC_FLUSH);
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+          LOG(ERROR) << "deflate: " << zlib_stream_.msg;
+          return false;
+        }
+        flushed = zlib_stream_.avail_out != 0;
+        if (!WriteOutputStream())
+          return false;
+      } while (!flushed);
+    }
+
     int result = Z_OK;
     do {
       if (mode_ == Mode::kCompress) {
@@ -37,6 +37,20 @@ class ZlibOutputStream : public OutputStreamInterface {
     kDecompress = true
   };
 
+  //! \brief The format of compressed data.
+  enum class Format {
+    //! \brief A zlib stream, as described in RFC 1950.
+    kZlib,
+
+    //! \brief A gzip member, as described in RFC 1952.
+    //!
+    //! When compressing, the deflate data is ended with a sync flush followed
+    //! by an empty final block. This allows the deflate data up to and including the
+    //! sync flush to be copied into another deflate stream without being
+    //! recompressed, as SplicingGzipHTTPBodyStream does.
+    kGzip,
+  };
+
   //! \param[in] mode The work mode of this object.
   //! \param[in] output_stream The output_stream that this object writes to.
   //!
@@ -53,7 +67,30 @@ class ZlibOutputStream : public OutputStreamInterface {
   //! </code>
   //!
   //!
+  //! When compressing, data is compressed with the best compression level.
+  ZlibOutputStream(Mode mode,
+                   std::unique_ptr<OutputStreamInterface> output_stream);
+
+  //! \param[in] mode The work mode of this object.
+  //! \param[in] format The format of the compressed data.
+  //! \param[in] output_stream The output_stream that this object writes to.
+  //!
+  //! When compressing, Format::kZlib data is compressed with the best
+  //! compression level, and Format::kGzip data with zlib’s default level.
+  ZlibOutputStream(Mode mode,
+                   Format format,
+                   std::unique_ptr<OutputStreamInterface> output_stream);
+
+  //! \param[in] mode The work mode of this object.
+  //! \param[in] format The format of the compressed data.
+  //! \param[in] level The compression level, from `0` through
+  //!     kZlibBestCompressionLevel, or kZlibDefaultCompressionLevel. Lower
+  //!     levels use less CPU time but produce more data. This is ignored when
+  //!     decompressing.
+  //! \param[in] output_stream The output_stream that this object writes to.
   ZlibOutputStream(Mode mode,
+                   Format format,
+                   int level,
                    std::unique_ptr<OutputStreamInterface> output_stream);
 
   ZlibOutputStream(const ZlibOutputStream&) = delete;
@@ -74,6 +111,8 @@ class ZlibOutputStream : public OutputStreamInterface {
   z_stream zlib_stream_;
   std::unique_ptr<OutputStreamInterface> output_stream_;
   Mode mode_;
+  Format format_;
+  int level_;
   InitializationState initialized_;  // protects zlib_stream_
   bool flush_needed_;
 };
@@ -182,6 +182,52 @@ TEST_F(ZlibOutputStreamTest, WriteEmptyData) {
   EXPECT_TRUE(test_output_stream().all_data().empty());
 }
 
+TEST(ZlibOutputStream, GzipFormat) {
+  auto test_output_stream = std::make_unique<TestOutputStream>();
+  TestOutputStream* test_output_stream_weak = test_output_stream.get();
+  ZlibOutputStream zlib_output_stream(
+      ZlibOutputStream::Mode::kCompress,
+      ZlibOutputStream::Format::kGzip,
+      std::make_unique<ZlibOutputStream>(ZlibOutputStream::Mode::kDecompress,
+                                         ZlibOutputStream::Format::kGzip,
+                                         std::move(test_output_stream)));
+
+  auto input = base::HeapArray<uint8_t>::Uninit(kLongDataLength);
+  base::RandBytes(input);
+  EXPECT_TRUE(zlib_output_stream.Write(input.data(), input.size()));
+  EXPECT_TRUE(zlib_output_stream.Flush());
+  EXPECT_EQ(test_output_stream_weak->all_data().size(), kLongDataLength);
+  EXPECT_EQ(memcmp(test_output_stream_weak->all_data().data(),
+                   input.data(),
+                   kLongDataLength),
+            0);
+}
+
+TEST(ZlibOutputStream, GzipFormatEndsWithSyncFlush) {
+  auto test_output_stream = std::make_unique<TestOutputStream>();
+  TestOutputStream* test_output_stream_weak = test_output_stream.get();
+  ZlibOutputStream zlib_output_stream(ZlibOutputStream::Mode::kCompress,
+                                      ZlibOutputStream::Format::kGzip,
+                                      std::move(test_output_stream));
+
+  static constexpr uint8_t kInput[] = "gzip";
+  EXPECT_TRUE(zlib_output_stream.Write(kInput, sizeof(kInput)));
+  EXPECT_TRUE(zlib_output_stream.Flush());
+
+  // A gzip header, the compressed data ending with an empty stored block and an
+  // empty final block, and an 8-byte trailer.
+  static constexpr uint8_t kSyncFlushAndFinalBlock[] = {
+      0x00, 0x00, 0xff, 0xff, 0x03, 0x00};
+  const std::vector<uint8_t>& data = test_output_stream_weak->all_data();
+  ASSERT_GE(data.size(), 10 + sizeof(kSyncFlushAndFinalBlock) + 8);
+  EXPECT_EQ(data[0], 0x1f);
+  EXPECT_EQ(data[1], 0x8b);
+  EXPECT_EQ(memcmp(&data[data.size() - 8 - sizeof(kSyncFlushAndFinalBlock)],
+                   kSyncFlushAndFinalBlock,
+                   sizeof(kSyncFlushAndFinalBlock)),
+            0);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
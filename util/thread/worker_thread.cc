@@ -34,9 +34,10 @@ class WorkerThreadImpl final : public Thread {
       semaphore_.TimedWait(initial_work_delay_);
 
     while (self_->running_ || self_->do_work_now_) {
+      self_->next_work_delay_ = self_->work_interval_;
       self_->delegate_->DoWork(self_);
       self_->do_work_now_ = false;
-      semaphore_.TimedWait(self_->work_interval_);
+      semaphore_.TimedWait(self_->next_work_delay_);
     }
   }
 
@@ -56,6 +57,7 @@ class WorkerThreadImpl final : public Thread {
 WorkerThread::WorkerThread(double work_interval,
                            WorkerThread::Delegate* delegate)
     : work_interval_(work_interval),
+      next_work_delay_(work_interval),
       delegate_(delegate),
       impl_(),
       running_(false),
@@ -94,4 +96,8 @@ void WorkerThread::DoWorkNow() {
   impl_->SignalSemaphore();
 }
 
+void WorkerThread::SetNextWorkDelay(double delay) {
+  next_work_delay_ = delay;
+}
+
 }  // namespace crashpad
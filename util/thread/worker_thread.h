@@ -86,6 +86,19 @@ class WorkerThread {
   //!     \a work_interval.
   void DoWorkNow();
 
+  //! \brief Sets the time to wait after the current invocation of
+  //!     Delegate::DoWork() returns before invoking it again, in place of the
+  //!     \a work_interval.
+  //!
+  //! This may only be called from Delegate::DoWork(), and only affects the
+  //! wait that follows that invocation. DoWorkNow() may still interrupt the
+  //! wait.
+  //!
+  //! \param[in] delay The time in seconds to wait. This can be
+  //!     #kIndefiniteWait if work should not be done again until DoWorkNow()
+  //!     is called.
+  void SetNextWorkDelay(double delay);
+
   //! \return `true` if the thread is running, `false` if it is not.
   bool is_running() const { return running_; }
 
@@ -93,6 +106,7 @@ class WorkerThread {
   friend class internal::WorkerThreadImpl;
 
   double work_interval_;
+  double next_work_delay_;  // Only accessed on the worker thread.
   Delegate* delegate_;  // weak
   std::unique_ptr<internal::WorkerThreadImpl> impl_;
   std::atomic_bool running_;
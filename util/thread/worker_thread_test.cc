@@ -35,6 +35,9 @@ class WorkDelegate : public WorkerThread::Delegate {
   ~WorkDelegate() {}
 
   void DoWork(const WorkerThread* thread) override {
+    if (next_work_delay_thread_) {
+      next_work_delay_thread_->SetNextWorkDelay(next_work_delay_);
+    }
     if (work_count_ < waiting_for_count_) {
       if (++work_count_ == waiting_for_count_) {
         semaphore_.Signal();
@@ -46,6 +49,13 @@ class WorkDelegate : public WorkerThread::Delegate {
     waiting_for_count_ = times;
   }
 
+  //! \brief Causes DoWork() to call WorkerThread::SetNextWorkDelay() on \a
+  //!     thread with \a delay.
+  void SetNextWorkDelay(WorkerThread* thread, double delay) {
+    next_work_delay_thread_ = thread;
+    next_work_delay_ = delay;
+  }
+
   //! \brief Suspends the calling thread until the DoWork() has been called
   //!     the number of times specified by SetDesiredWorkCount().
   void WaitForWorkCount() {
@@ -58,6 +68,8 @@ class WorkDelegate : public WorkerThread::Delegate {
   Semaphore semaphore_{0};
   int work_count_ = 0;
   int waiting_for_count_ = -1;
+  WorkerThread* next_work_delay_thread_ = nullptr;
+  double next_work_delay_ = 0;
 };
 
 TEST(WorkerThread, DoWork) {
@@ -159,6 +171,24 @@ TEST(WorkerThread, DoWorkNowAtStart) {
   EXPECT_FALSE(thread.is_running());
 }
 
+TEST(WorkerThread, SetNextWorkDelay) {
+  WorkDelegate delegate;
+  WorkerThread thread(100, &delegate);
+  delegate.SetNextWorkDelay(&thread, 0.05);
+
+  uint64_t start = ClockMonotonicNanoseconds();
+
+  // The second invocation follows the delay set by the first, rather than the
+  // work interval.
+  delegate.SetDesiredWorkCount(2);
+  thread.Start(0);
+  delegate.WaitForWorkCount();
+  thread.Stop();
+  EXPECT_EQ(delegate.work_count(), 2);
+
+  EXPECT_GE(100 * kNanosecondsPerSecond, ClockMonotonicNanoseconds() - start);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad